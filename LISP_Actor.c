@@ -0,0 +1,400 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Actor -- LMIs on threads of their own, passing messages
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _VMS_
+#include <stdatomic.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#endif
+
+#include "LISP_Actor.h"
+#include "LISP_Dump.h"
+
+#ifdef _VMS_
+
+/* No threads there -- an LMI may still mail itself, or the others of *
+ * the process, but SPAWN fails and RECEIVE never waits, since nobody *
+ * could send anything meanwhile                                      */
+typedef struct LISP$A_Message {
+  struct LISP$A_Message * next;
+  char *                  data;
+  size_t                  length;
+} LISP$A_Message;
+
+struct LISP$Actor {
+  long                    id;
+  LISP$A_Message *        first;
+  LISP$A_Message **       last;
+  bool                    isAlive;
+};
+
+static LISP$Actor * LISP$A_actors [LISP$A_MAXACTORS];
+static long         LISP$A_lastId;
+
+long LISP$A_self (LISP$MachIns * lmi) {
+
+  LISP$Actor * a;
+
+  if (lmi->actor != NULL) return (lmi->actor->id);
+  if (LISP$A_lastId + 1 >= LISP$A_MAXACTORS) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "%s can't make more than %d actors!", "SELF", LISP$A_MAXACTORS - 1);
+    return -1;
+  }
+  if ((a = (LISP$Actor *) calloc (1, sizeof (LISP$Actor))) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", "SELF");
+    return -1;
+  }
+
+  a->id      = ++LISP$A_lastId;
+  a->last    = &(a->first);
+  a->isAlive = true;
+  LISP$A_actors [a->id] = lmi->actor = a;
+  return (a->id);
+}
+
+bool LISP$A_send (LISP$MachIns * lmi, long id, LISP$Ref message) {
+
+  LISP$Actor *     a;
+  LISP$A_Message * m;
+
+  if (id < 1 || id >= LISP$A_MAXACTORS ||
+      (a = LISP$A_actors [id]) == NULL || !a->isAlive)
+    return false;
+
+  if ((m = (LISP$A_Message *) malloc (sizeof (LISP$A_Message))) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for SEND!");
+    return false;
+  }
+  if ((m->data = LISP$D_pack (lmi, message, &(m->length), "SEND")) == NULL) {
+    free (m);
+    return false;
+  }
+
+  m->next    = NULL;
+  *(a->last) = m;
+  a->last    = &(m->next);
+  return true;
+}
+
+LISP$Ref LISP$A_receive (LISP$MachIns * lmi, double timeout) {
+
+  LISP$Actor *     a;
+  LISP$A_Message * m;
+  LISP$Ref         res;
+
+  if (LISP$A_self (lmi) < 0) return (LISP$M_NULLREF);
+  a = lmi->actor;
+
+  if ((m = a->first) == NULL) return (LISP$M_NULLREF);
+  if ((a->first = m->next) == NULL) a->last = &(a->first);
+
+  res = LISP$D_unpack (lmi, m->data, m->length, "RECEIVE");
+  free (m->data);
+  free (m);
+
+  return res;
+}
+
+void LISP$A_exit (LISP$MachIns * lmi) {
+
+  LISP$Actor *     a = lmi->actor;
+  LISP$A_Message * m;
+
+  if (a == NULL) return;
+
+  a->isAlive = false;
+  while ((m = a->first) != NULL) {
+    a->first = m->next;
+    free (m->data);
+    free (m);
+  }
+  a->last    = &(a->first);
+  lmi->actor = NULL;
+}
+
+long LISP$A_spawn (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref args) {
+
+  LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+      "SPAWN can't start the actor!");
+  return -1;
+}
+
+#else
+
+/* Message in a mailbox, packed by its sender */
+typedef struct LISP$A_Message {
+  struct LISP$A_Message * _Atomic next;
+  char *                          data;
+  size_t                          length;
+} LISP$A_Message;
+
+/* The mailbox is a list the senders append to by swapping its tail,   *
+ * the receiver takes the items behind its head, a dummy one; a sender *
+ * which has swapped the tail but hasn't linked its item yet just      *
+ * makes the receiver see it a moment later                            */
+struct LISP$Actor {
+  long                        id;
+  LISP$A_Message * _Atomic    tail;             /* Senders append here  */
+  LISP$A_Message *            head;             /* Receiver's dummy     */
+  atomic_bool                 isAlive;          /* Takes messages?      */
+  atomic_bool                 isWaiting;        /* Receiver sleeps?     */
+  pthread_mutex_t             lock;
+  pthread_cond_t              hasMail;          /* ... or has started   */
+
+  LISP$MachIns *              parent;           /* Of $A_spawn ()       */
+  LISP$Ref                    fun;
+  LISP$Ref                    args;
+  bool                        isStarted;
+  bool                        isFailed;
+};
+
+/* Actors by their ids; an actor is never freed, since any sender may *
+ * still hold it -- just its LMI and its messages are, once it's gone  */
+static LISP$Actor * _Atomic LISP$A_actors [LISP$A_MAXACTORS];
+static atomic_long          LISP$A_lastId;
+
+
+/******************************************************
+ * Mailbox
+ ******************************************************/
+
+static LISP$Actor * LISP$A_create (LISP$MachIns * lmi, const char * name) {
+
+  LISP$Actor *        a;
+  pthread_condattr_t  attr;
+  long                id = atomic_fetch_add (&LISP$A_lastId, 1) + 1;
+
+  if (id >= LISP$A_MAXACTORS) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "%s can't make more than %d actors!", name, LISP$A_MAXACTORS - 1);
+    return NULL;
+  }
+
+  a = (LISP$Actor *) calloc (1, sizeof (LISP$Actor));
+  if (a != NULL &&
+      (a->head = (LISP$A_Message *) calloc (1, sizeof (LISP$A_Message)))
+        == NULL) {
+    free (a);
+    a = NULL;
+  }
+  if (a == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", name);
+    return NULL;
+  }
+
+  /* Timeouts of RECEIVE don't follow changes of the wall clock */
+  pthread_condattr_init (&attr);
+  pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+  pthread_cond_init (&(a->hasMail), &attr);
+  pthread_condattr_destroy (&attr);
+  pthread_mutex_init (&(a->lock), NULL);
+
+  a->id = id;
+  atomic_init (&(a->tail), a->head);
+  atomic_init (&(a->isAlive), true);
+  atomic_init (&(a->isWaiting), false);
+  atomic_store (&(LISP$A_actors [id]), a);
+
+  return a;
+}
+
+/* The first message, or NULL; it's the receiver's dummy item then */
+static LISP$A_Message * LISP$A_take (LISP$Actor * a) {
+
+  LISP$A_Message * next = atomic_load (&(a->head->next));
+
+  if (next == NULL) return NULL;
+  free (a->head);
+  a->head = next;
+  return next;
+}
+
+long LISP$A_self (LISP$MachIns * lmi) {
+
+  if (lmi->actor == NULL) lmi->actor = LISP$A_create (lmi, "SELF");
+  return ((lmi->actor != NULL)? lmi->actor->id : -1);
+}
+
+bool LISP$A_send (LISP$MachIns * lmi, long id, LISP$Ref message) {
+
+  LISP$Actor *     a;
+  LISP$A_Message * m, * prev;
+
+  if (id < 1 || id >= LISP$A_MAXACTORS ||
+      (a = atomic_load (&(LISP$A_actors [id]))) == NULL ||
+      !atomic_load (&(a->isAlive)))
+    return false;
+
+  if ((m = (LISP$A_Message *) malloc (sizeof (LISP$A_Message))) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for SEND!");
+    return false;
+  }
+  if ((m->data = LISP$D_pack (lmi, message, &(m->length), "SEND")) == NULL) {
+    free (m);
+    return false;
+  }
+  atomic_init (&(m->next), NULL);
+
+  prev = atomic_exchange (&(a->tail), m);
+  atomic_store (&(prev->next), m);
+
+  /* The receiver says it sleeps before it looks at the mailbox last *
+   * time, so either it sees the message, or it's woken up           */
+  if (atomic_load (&(a->isWaiting))) {
+    pthread_mutex_lock (&(a->lock));
+    pthread_cond_signal (&(a->hasMail));
+    pthread_mutex_unlock (&(a->lock));
+  }
+
+  return true;
+}
+
+LISP$Ref LISP$A_receive (LISP$MachIns * lmi, double timeout) {
+
+  LISP$Actor *     a;
+  LISP$A_Message * m;
+  LISP$Ref         res;
+  struct timespec  deadline;
+  bool             isTimedOut = false;
+
+  if (LISP$A_self (lmi) < 0) return (LISP$M_NULLREF);
+  a = lmi->actor;
+
+  if (timeout > 0) {
+    clock_gettime (CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec  += (time_t) timeout;
+    deadline.tv_nsec += (long) ((timeout - (time_t) timeout) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+
+  while ((m = LISP$A_take (a)) == NULL && timeout != 0 && !isTimedOut) {
+    pthread_mutex_lock (&(a->lock));
+    atomic_store (&(a->isWaiting), true);
+    if (atomic_load (&(a->head->next)) == NULL) {
+      if (timeout < 0) pthread_cond_wait (&(a->hasMail), &(a->lock));
+      else isTimedOut = (pthread_cond_timedwait (&(a->hasMail), &(a->lock),
+                                                 &deadline) != 0);
+    }
+    atomic_store (&(a->isWaiting), false);
+    pthread_mutex_unlock (&(a->lock));
+  }
+
+  if (m == NULL) return (LISP$M_NULLREF);
+
+  res = LISP$D_unpack (lmi, m->data, m->length, "RECEIVE");
+  free (m->data);
+  m->data = NULL;
+
+  return res;
+}
+
+void LISP$A_exit (LISP$MachIns * lmi) {
+
+  LISP$Actor *     a = lmi->actor;
+  LISP$A_Message * m;
+
+  if (a == NULL) return;
+
+  /* A message sent meanwhile may stay behind, it's never read */
+  atomic_store (&(a->isAlive), false);
+  while ((m = LISP$A_take (a)) != NULL) {
+    free (m->data);
+    m->data = NULL;
+  }
+  lmi->actor = NULL;
+}
+
+
+/******************************************************
+ * Threads of the actors
+ ******************************************************/
+
+static void * LISP$A_run (void * arg) {
+
+  LISP$Actor *   a = (LISP$Actor *) arg;
+  LISP$MachIns * parent = a->parent;
+  LISP$MachIns * lmi;
+  LISP$Ref       fun = a->fun, args = a->args;
+
+  /* The parent waits for the copy -- its heap mustn't change meanwhile */
+  lmi = LISP$M_clone (parent, NULL, parent->outputStream);
+
+  pthread_mutex_lock (&(a->lock));
+  if (lmi != NULL) {
+    lmi->actor   = a;
+    lmi->isQuiet = true;
+  }
+  a->isFailed  = (lmi == NULL);
+  a->isStarted = true;
+  pthread_cond_signal (&(a->hasMail));
+  pthread_mutex_unlock (&(a->lock));
+
+  if (lmi == NULL) {
+    atomic_store (&(a->isAlive), false);
+    return NULL;
+  }
+
+  LISP$M_pushRoot (lmi, fun);
+  LISP$M_pushRoot (lmi, args);
+  if (LISP$S_apply (lmi, fun, args, 0) == LISP$M_NULLREF &&
+      LISP$M_isError (lmi))
+    LISP$M_reportError (lmi);
+
+  LISP$M_destroy (lmi);
+  return NULL;
+}
+
+long LISP$A_spawn (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref args) {
+
+  LISP$Actor *  a = LISP$A_create (lmi, "SPAWN");
+  pthread_t     thread;
+  sigset_t      all, old;
+  bool          isCreated;
+
+  if (a == NULL) return -1;
+  a->parent = lmi;
+  a->fun    = fun;
+  a->args   = args;
+
+  /* Signals are left to the thread which has started LISP */
+  sigfillset (&all);
+  pthread_sigmask (SIG_SETMASK, &all, &old);
+  isCreated = !pthread_create (&thread, NULL, LISP$A_run, a);
+  pthread_sigmask (SIG_SETMASK, &old, NULL);
+
+  if (isCreated) {
+    pthread_detach (thread);
+    pthread_mutex_lock (&(a->lock));
+    while (!a->isStarted)
+      pthread_cond_wait (&(a->hasMail), &(a->lock));
+    pthread_mutex_unlock (&(a->lock));
+  }
+  else atomic_store (&(a->isAlive), false);
+
+  if (!isCreated || a->isFailed) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "SPAWN can't start the actor!");
+    return -1;
+  }
+
+  return (a->id);
+}
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
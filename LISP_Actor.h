@@ -0,0 +1,47 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Actor -- LMIs on threads of their own, passing messages
+ */
+
+#ifndef _LISP_ACTOR_H_
+#define _LISP_ACTOR_H_
+
+#include "LISP_Core.h"
+
+/* Actors there may be in a process, ever -- ids aren't reused */
+#define LISP$A_MAXACTORS  65536
+
+/* An LMI with a mailbox, known to the others by its id, a number. A   *
+ * message is packed by the sender ($D_pack) and unpacked by the       *
+ * receiver, so no heap is ever touched by two threads; the mailbox    *
+ * takes messages of many senders without a lock, the receiver just    *
+ * locks to sleep when it's empty                                       */
+typedef struct LISP$Actor LISP$Actor;
+
+/* The id of the actor of 'lmi', which is made one by the first call;  *
+ * -1 is returned and the error is set if there's no id nor memory    */
+long LISP$A_self (LISP$MachIns * lmi);
+
+/* Start an actor applying 'fun' to 'args' (a list) -- a copy of 'lmi' *
+ * ($M_clone) made by its own thread, while 'lmi' waits; the actor is  *
+ * gone once 'fun' returns. Its id is returned, or -1 (the error set)  */
+long LISP$A_spawn (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref args);
+
+/* Copy 'message' into the mailbox of the actor 'id'; false is returned *
+ * if there's no such actor alive (and the message is dropped), or if   *
+ * it can't be packed (the error is set then)                           */
+bool LISP$A_send (LISP$MachIns * lmi, long id, LISP$Ref message);
+
+/* Take the first message of the mailbox of 'lmi', waiting 'timeout'   *
+ * seconds at most (forever if negative, not at all if zero) for it;    *
+ * LISP$M_NULLREF is returned if there's none (the error is set if it  *
+ * can't be unpacked)                                                  */
+LISP$Ref LISP$A_receive (LISP$MachIns * lmi, double timeout);
+
+/* The LMI is going away -- its mailbox is closed and emptied */
+void LISP$A_exit (LISP$MachIns * lmi);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
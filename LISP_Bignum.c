@@ -0,0 +1,633 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Bignum -- Arbitrary-precision integer arithmetic
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "LISP_Bignum.h"
+
+#define LISP$B_BASE10     1000000000U   /* 10^9 fits into one limb */
+#define LISP$B_BASE10DIG  9
+
+
+/******************************************************
+ * Magnitudes -- arrays of limbs, the least significant first
+ ******************************************************/
+
+/* Length without leading zero limbs */
+static int LISP$B_magNormalize (const uint32_t * a, int an) {
+
+  while (an > 0 && a [an - 1] == 0) an--;
+  return an;
+}
+
+static int LISP$B_magCompare (const uint32_t * a, int an,
+                              const uint32_t * b, int bn) {
+
+  int i;
+
+  an = LISP$B_magNormalize (a, an);
+  bn = LISP$B_magNormalize (b, bn);
+  if (an != bn) return ((an < bn)? -1 : 1);
+
+  for (i = an - 1; i >= 0; i--)
+    if (a [i] != b [i]) return ((a [i] < b [i])? -1 : 1);
+
+  return 0;
+}
+
+/* r = a + b; 'r' has room for max (an, bn) + 1 limbs, its length is *
+ * returned                                                           */
+static int LISP$B_magAdd (uint32_t * r, const uint32_t * a, int an,
+                          const uint32_t * b, int bn) {
+
+  int      i;
+  uint64_t t = 0;
+
+  if (an < bn) {
+    const uint32_t * swp = a; a = b; b = swp;
+    i = an; an = bn; bn = i;
+  }
+
+  for (i = 0; i < bn; i++) {
+    t += (uint64_t) a [i] + b [i];
+    r [i] = (uint32_t) t; t >>= 32;
+  }
+  for (; i < an; i++) {
+    t += a [i];
+    r [i] = (uint32_t) t; t >>= 32;
+  }
+  r [an] = (uint32_t) t;
+
+  return (LISP$B_magNormalize (r, an + 1));
+}
+
+/* r = a - b for a >= b; 'r' may be 'a' itself */
+static int LISP$B_magSub (uint32_t * r, const uint32_t * a, int an,
+                          const uint32_t * b, int bn) {
+
+  int     i;
+  int64_t t = 0;
+
+  for (i = 0; i < bn; i++) {
+    t += (int64_t) a [i] - b [i];
+    r [i] = (uint32_t) t; t >>= 32;
+  }
+  for (; i < an; i++) {
+    t += a [i];
+    r [i] = (uint32_t) t; t >>= 32;
+  }
+
+  return (LISP$B_magNormalize (r, an));
+}
+
+/* r [0 .. rn) += x; the sum must fit into 'rn' limbs */
+static void LISP$B_magAddTo (uint32_t * r, int rn,
+                             const uint32_t * x, int xn) {
+
+  int      i;
+  uint64_t t = 0;
+
+  for (i = 0; i < xn; i++) {
+    t += (uint64_t) r [i] + x [i];
+    r [i] = (uint32_t) t; t >>= 32;
+  }
+  for (; t && i < rn; i++) {
+    t += r [i];
+    r [i] = (uint32_t) t; t >>= 32;
+  }
+}
+
+/* r [0 .. an + bn) = a * b, the classic quadratic way; 'r' is cleared */
+static void LISP$B_magMulSchool (uint32_t * r, const uint32_t * a, int an,
+                                 const uint32_t * b, int bn) {
+
+  int      i, j;
+  uint64_t t;
+
+  for (i = 0; i < an; i++) {
+    t = 0;
+    for (j = 0; j < bn; j++) {
+      t += (uint64_t) a [i] * b [j] + r [i + j];
+      r [i + j] = (uint32_t) t; t >>= 32;
+    }
+    r [i + bn] = (uint32_t) t;
+  }
+}
+
+/* r [0 .. an + bn) = a * b; 'r' is cleared by the caller. Karatsuba:   *
+ * a = a1 B^m + a0 and b = b1 B^m + b0 give a * b = z2 B^2m + z1 B^m + *
+ * z0, where z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1) - z0 - *
+ * z2, so there are three half-sized products instead of four          */
+static bool LISP$B_magMul (uint32_t * r, const uint32_t * a, int an,
+                           const uint32_t * b, int bn) {
+
+  int        m, off, len, san, sbn, sbl, z1n;
+  uint32_t * sa, * sb, * z1;
+
+  if (an < bn) {
+    const uint32_t * swp = a; a = b; b = swp;
+    m = an; an = bn; bn = m;
+  }
+  if (bn == 0) return true;
+
+  if (bn < LISP$B_KARATSUBA_LIMBS) {
+    LISP$B_magMulSchool (r, a, an, b, bn);
+    return true;
+  }
+
+  /* Unbalanced sizes -- multiply 'b' by pieces of 'a' as long as 'b' */
+  if (2 * bn <= an) {
+    z1 = (uint32_t *) malloc (2 * bn * sizeof (uint32_t));
+    if (z1 == NULL) return false;
+
+    for (off = 0; off < an; off += bn) {
+      len = (an - off < bn)? an - off : bn;
+      memset (z1, 0, (len + bn) * sizeof (uint32_t));
+      if (!LISP$B_magMul (z1, a + off, len, b, bn)) { free (z1); return false; }
+      LISP$B_magAddTo (r + off, an + bn - off, z1, len + bn);
+    }
+
+    free (z1);
+    return true;
+  }
+
+  /* Here bn > m, so that both a1 and b1 are non-empty */
+  m   = an / 2;
+  sbl = ((m > bn - m)? m : bn - m) + 1;
+
+  sa = (uint32_t *) malloc ((an - m + 1) * sizeof (uint32_t));
+  sb = (uint32_t *) malloc (sbl * sizeof (uint32_t));
+  z1 = (uint32_t *) calloc (an - m + 1 + sbl, sizeof (uint32_t));
+  if (sa == NULL || sb == NULL || z1 == NULL) {
+    free (sa); free (sb); free (z1);
+    return false;
+  }
+
+  /* z0 and z2 go right to their places in the result */
+  if (!LISP$B_magMul (r, a, m, b, m) ||
+      !LISP$B_magMul (r + 2 * m, a + m, an - m, b + m, bn - m)) {
+    free (sa); free (sb); free (z1);
+    return false;
+  }
+
+  san = LISP$B_magAdd (sa, a, LISP$B_magNormalize (a, m), a + m, an - m);
+  sbn = LISP$B_magAdd (sb, b, LISP$B_magNormalize (b, m), b + m, bn - m);
+  if (!LISP$B_magMul (z1, sa, san, sb, sbn)) {
+    free (sa); free (sb); free (z1);
+    return false;
+  }
+
+  z1n = LISP$B_magNormalize (z1, san + sbn);
+  z1n = LISP$B_magSub (z1, z1, z1n, r, LISP$B_magNormalize (r, 2 * m));
+  z1n = LISP$B_magSub (z1, z1, z1n, r + 2 * m,
+                       LISP$B_magNormalize (r + 2 * m, an + bn - 2 * m));
+  LISP$B_magAddTo (r + m, an + bn - m, z1, z1n);
+
+  free (sa); free (sb); free (z1);
+  return true;
+}
+
+/* q = u / d, returns u % d -- division by a single limb */
+static uint32_t LISP$B_magDivLimb (uint32_t * q, const uint32_t * u, int un,
+                                   uint32_t d) {
+
+  int      i;
+  uint64_t t = 0;
+
+  for (i = un - 1; i >= 0; i--) {
+    t = (t << 32) | u [i];
+    q [i] = (uint32_t) (t / d);
+    t %= d;
+  }
+
+  return ((uint32_t) t);
+}
+
+static int LISP$B_clz (uint32_t x) {
+
+  int n = 0;
+  while (!(x & 0x80000000U)) { x <<= 1; n++; }
+  return n;
+}
+
+/* q [0 .. un - vn] = u / v and r [0 .. vn) = u % v for un >= vn >= 2;  *
+ * Knuth's algorithm D -- each quotient limb is estimated from the top *
+ * limbs of the normalized operands and it's at most once too big      */
+static bool LISP$B_magDivKnuth (uint32_t * q, uint32_t * r,
+                                const uint32_t * u, int un,
+                                const uint32_t * v, int vn) {
+
+  int        i, j, s;
+  uint32_t * un_, * vn_;
+  uint64_t   qhat, rhat, p;
+  int64_t    t, k;
+
+  un_ = (uint32_t *) malloc ((un + 1) * sizeof (uint32_t));
+  vn_ = (uint32_t *) malloc (vn * sizeof (uint32_t));
+  if (un_ == NULL || vn_ == NULL) { free (un_); free (vn_); return false; }
+
+  /* Shift both so that the divisor's top bit is set */
+  s = LISP$B_clz (v [vn - 1]);
+  for (i = vn - 1; i > 0; i--)
+    vn_ [i] = (v [i] << s) | (s? (uint32_t) ((uint64_t) v [i - 1] >> (32 - s)) : 0);
+  vn_ [0] = v [0] << s;
+
+  un_ [un] = s? (uint32_t) ((uint64_t) u [un - 1] >> (32 - s)) : 0;
+  for (i = un - 1; i > 0; i--)
+    un_ [i] = (u [i] << s) | (s? (uint32_t) ((uint64_t) u [i - 1] >> (32 - s)) : 0);
+  un_ [0] = u [0] << s;
+
+  for (j = un - vn; j >= 0; j--) {
+    /* Estimate the quotient limb and correct it by the next limb */
+    p    = ((uint64_t) un_ [j + vn] << 32) | un_ [j + vn - 1];
+    qhat = p / vn_ [vn - 1];
+    rhat = p % vn_ [vn - 1];
+    while (qhat > 0xFFFFFFFFULL ||
+           qhat * vn_ [vn - 2] > ((rhat << 32) | un_ [j + vn - 2])) {
+      qhat--;
+      rhat += vn_ [vn - 1];
+      if (rhat > 0xFFFFFFFFULL) break;
+    }
+
+    /* Multiply and subtract */
+    k = 0;
+    for (i = 0; i < vn; i++) {
+      p = qhat * vn_ [i];
+      t = (int64_t) un_ [i + j] - k - (int64_t) (p & 0xFFFFFFFFULL);
+      un_ [i + j] = (uint32_t) t;
+      k = (int64_t) (p >> 32) - (t >> 32);
+    }
+    t = (int64_t) un_ [j + vn] - k;
+    un_ [j + vn] = (uint32_t) t;
+
+    /* The estimate was one too big -- add the divisor back */
+    q [j] = (uint32_t) qhat;
+    if (t < 0) {
+      q [j]--;
+      k = 0;
+      for (i = 0; i < vn; i++) {
+        t = (int64_t) un_ [i + j] + vn_ [i] + k;
+        un_ [i + j] = (uint32_t) t;
+        k = t >> 32;
+      }
+      un_ [j + vn] += (uint32_t) k;
+    }
+  }
+
+  /* Unnormalize the remainder */
+  for (i = 0; i < vn; i++)
+    r [i] = (un_ [i] >> s) |
+            (s? (uint32_t) ((uint64_t) un_ [i + 1] << (32 - s)) : 0);
+
+  free (un_); free (vn_);
+  return true;
+}
+
+
+/******************************************************
+ * Bignums
+ ******************************************************/
+
+static LISP$Bignum * LISP$B_alloc (int limbs) {
+
+  LISP$Bignum * b = (LISP$Bignum *) malloc (sizeof (LISP$Bignum));
+  if (b == NULL) return NULL;
+
+  b->negative = false;
+  b->length   = 0;
+  b->limbs    = (uint32_t *) calloc ((limbs > 0)? limbs : 1,
+                                     sizeof (uint32_t));
+  if (b->limbs == NULL) { free (b); return NULL; }
+
+  return b;
+}
+
+/* Set the length by the limbs and keep zero non-negative */
+static LISP$Bignum * LISP$B_normalize (LISP$Bignum * b, int limbs) {
+
+  if (b == NULL) return NULL;
+
+  b->length = LISP$B_magNormalize (b->limbs, limbs);
+  if (!b->length) b->negative = false;
+
+  return b;
+}
+
+LISP$Bignum * LISP$B_wrapInt (LISP$Bignum * b, uint32_t * limbs,
+                             int64_t num) {
+
+  uint64_t mag;
+
+  /* -INT64_MIN doesn't fit into int64_t, but it does into uint64_t */
+  mag = (num < 0)? (uint64_t) (-(num + 1)) + 1 : (uint64_t) num;
+  b->negative = (num < 0);
+  b->limbs    = limbs;
+  limbs [0]   = (uint32_t) mag;
+  limbs [1]   = (uint32_t) (mag >> 32);
+
+  return (LISP$B_normalize (b, LISP$B_INT_LIMBS));
+}
+
+LISP$Bignum * LISP$B_fromInt (int64_t num) {
+
+  LISP$Bignum * b = LISP$B_alloc (LISP$B_INT_LIMBS);
+  uint32_t *    limbs;
+
+  if (b == NULL) return NULL;
+
+  limbs = b->limbs;
+  return (LISP$B_wrapInt (b, limbs, num));
+}
+
+LISP$Bignum * LISP$B_fromLimbs (bool negative, const uint32_t * limbs,
+                                int length) {
+
+  LISP$Bignum * b = LISP$B_alloc (length);
+
+  if (b == NULL) return NULL;
+
+  memcpy (b->limbs, limbs, length * sizeof (uint32_t));
+  b->negative = negative;
+  return (LISP$B_normalize (b, length));
+}
+
+LISP$Bignum * LISP$B_fromString (const char * str) {
+
+  LISP$Bignum * b;
+  bool          negative = false;
+  int           i, n, digits, chunk;
+  uint32_t      mul, val;
+  uint64_t      t;
+
+  if (*str == '+' || *str == '-') negative = (*str++ == '-');
+  digits = strlen (str);
+
+  /* Each decimal digit is less than 4 bits */
+  b = LISP$B_alloc (digits / 9 + 2);
+  if (b == NULL) return NULL;
+
+  /* b = b * 10^k + (next k digits) -- the first chunk is shorter, *
+   * so that all the others have 9 digits                            */
+  chunk = (digits % LISP$B_BASE10DIG)? digits % LISP$B_BASE10DIG
+                                     : LISP$B_BASE10DIG;
+  for (n = 0; *str; chunk = LISP$B_BASE10DIG) {
+    for (val = 0, mul = 1; chunk-- > 0; str++, mul *= 10)
+      val = val * 10 + (*str - '0');
+
+    for (i = 0, t = val; i < n; i++) {
+      t += (uint64_t) b->limbs [i] * mul;
+      b->limbs [i] = (uint32_t) t; t >>= 32;
+    }
+    if (t) b->limbs [n++] = (uint32_t) t;
+  }
+
+  b->negative = negative;
+  return (LISP$B_normalize (b, n));
+}
+
+LISP$Bignum * LISP$B_copy (const LISP$Bignum * b) {
+
+  LISP$Bignum * c = LISP$B_alloc (b->length);
+  if (c == NULL) return NULL;
+
+  memcpy (c->limbs, b->limbs, b->length * sizeof (uint32_t));
+  c->length   = b->length;
+  c->negative = b->negative;
+
+  return c;
+}
+
+bool LISP$B_toInt (const LISP$Bignum * b, int64_t * res) {
+
+  uint64_t mag;
+
+  if (b->length > 2) return false;
+  mag = (b->length > 0)? b->limbs [0] : 0;
+  if (b->length > 1) mag |= (uint64_t) b->limbs [1] << 32;
+
+  if (b->negative) {
+    if (mag > (uint64_t) INT64_MAX + 1) return false;
+    *res = (mag == (uint64_t) INT64_MAX + 1)? INT64_MIN : -(int64_t) mag;
+  }
+  else {
+    if (mag > (uint64_t) INT64_MAX) return false;
+    *res = (int64_t) mag;
+  }
+
+  return true;
+}
+
+double LISP$B_toDouble (const LISP$Bignum * b) {
+
+  int    i;
+  double res = 0;
+
+  /* Three top limbs are more than the 53 bits of the mantissa */
+  for (i = b->length - 1; i >= 0 && i >= b->length - 3; i--)
+    res = res * 4294967296.0 + b->limbs [i];
+  if (i >= 0) res = ldexp (res, 32 * (i + 1));
+
+  return (b->negative? -res : res);
+}
+
+double LISP$B_log (const LISP$Bignum * b) {
+
+  int    i;
+  double top = 0;
+
+  if (!b->length) return (-HUGE_VAL);
+  if (b->negative) return (NAN);
+
+  /* log (top * 2^(32*i)) -- the top limbs alone don't overflow */
+  for (i = b->length - 1; i >= 0 && i >= b->length - 3; i--)
+    top = top * 4294967296.0 + b->limbs [i];
+
+  return (log (top) + 32.0 * (i + 1) * log (2.0));
+}
+
+LISP$Bignum * LISP$B_fromDouble (double num) {
+
+  LISP$Bignum * b;
+  uint64_t      mant;
+  int           exp, shift, limb;
+
+  if (!isfinite (num)) return NULL;
+  num = trunc (num);
+
+  /* num = mant * 2^(exp - 53), mant has up to 53 bits */
+  mant = (uint64_t) ldexp (fabs (frexp (num, &exp)), 53);
+  if (exp <= 53) return (LISP$B_fromInt ((int64_t) num));
+
+  shift = exp - 53; limb = shift / 32; shift %= 32;
+  b = LISP$B_alloc (limb + 3);
+  if (b == NULL) return NULL;
+
+  b->negative         = (num < 0);
+  b->limbs [limb]     = (uint32_t) (mant << shift);
+  b->limbs [limb + 1] = (uint32_t) ((mant << shift) >> 32);
+  b->limbs [limb + 2] = (shift)? (uint32_t) (mant >> (64 - shift)) : 0;
+
+  return (LISP$B_normalize (b, limb + 3));
+}
+
+char * LISP$B_toString (const LISP$Bignum * b) {
+
+  int        i, n, len, chunks = 0;
+  uint32_t * mag, * parts, rem;
+  char     * str, * s;
+
+  /* Split the number into base 10^9 parts from the lowest one, each   *
+   * of them is then printed as 9 digits, but the top one              */
+  mag   = (uint32_t *) malloc ((b->length + 1) * sizeof (uint32_t));
+  parts = (uint32_t *) malloc ((b->length * 10 / 9 + 2) * sizeof (uint32_t));
+  if (mag == NULL || parts == NULL) { free (mag); free (parts); return NULL; }
+
+  memcpy (mag, b->limbs, b->length * sizeof (uint32_t));
+  for (n = b->length; n > 0; n = LISP$B_magNormalize (mag, n)) {
+    rem = LISP$B_magDivLimb (mag, mag, n, LISP$B_BASE10);
+    parts [chunks++] = rem;
+  }
+  if (!chunks) parts [chunks++] = 0;
+
+  len = chunks * LISP$B_BASE10DIG + 2;
+  str = (char *) malloc (len);
+  if (str != NULL) {
+    s = str;
+    if (b->negative) *s++ = '-';
+    s += sprintf (s, "%u", parts [chunks - 1]);
+    for (i = chunks - 2; i >= 0; i--)
+      s += sprintf (s, "%09u", parts [i]);
+  }
+
+  free (mag); free (parts);
+  return str;
+}
+
+void LISP$B_free (LISP$Bignum * b) {
+
+  if (b == NULL) return;
+  free (b->limbs);
+  free (b);
+}
+
+/* x + (-1)^ynegative * |y| */
+static LISP$Bignum * LISP$B_addSigned (const LISP$Bignum * x,
+                                       const LISP$Bignum * y,
+                                       bool ynegative) {
+
+  LISP$Bignum * r;
+  int           n = ((x->length > y->length)? x->length : y->length) + 1;
+
+  r = LISP$B_alloc (n);
+  if (r == NULL) return NULL;
+
+  /* Same signs add magnitudes, different ones subtract the smaller */
+  if (x->negative == ynegative) {
+    r->negative = x->negative;
+    return (LISP$B_normalize (r, LISP$B_magAdd (r->limbs,
+                x->limbs, x->length, y->limbs, y->length)));
+  }
+
+  if (LISP$B_magCompare (x->limbs, x->length, y->limbs, y->length) >= 0) {
+    r->negative = x->negative;
+    return (LISP$B_normalize (r, LISP$B_magSub (r->limbs,
+                x->limbs, x->length, y->limbs, y->length)));
+  }
+
+  r->negative = ynegative;
+  return (LISP$B_normalize (r, LISP$B_magSub (r->limbs,
+              y->limbs, y->length, x->limbs, x->length)));
+}
+
+LISP$Bignum * LISP$B_add (const LISP$Bignum * x, const LISP$Bignum * y) {
+
+  return (LISP$B_addSigned (x, y, y->negative));
+}
+
+LISP$Bignum * LISP$B_sub (const LISP$Bignum * x, const LISP$Bignum * y) {
+
+  return (LISP$B_addSigned (x, y, !y->negative));
+}
+
+LISP$Bignum * LISP$B_mul (const LISP$Bignum * x, const LISP$Bignum * y) {
+
+  LISP$Bignum * r = LISP$B_alloc (x->length + y->length);
+  if (r == NULL) return NULL;
+
+  if (!LISP$B_magMul (r->limbs, x->limbs, x->length,
+                      y->limbs, y->length)) {
+    LISP$B_free (r);
+    return NULL;
+  }
+
+  r->negative = (x->negative != y->negative);
+  return (LISP$B_normalize (r, x->length + y->length));
+}
+
+bool LISP$B_divMod (const LISP$Bignum * x, const LISP$Bignum * y,
+                    LISP$Bignum ** quo, LISP$Bignum ** rem) {
+
+  LISP$Bignum * q, * r;
+  bool          ok = true;
+
+  if (!y->length) return false;
+
+  q = LISP$B_alloc (x->length);
+  r = LISP$B_alloc (y->length);
+  if (q == NULL || r == NULL) {
+    LISP$B_free (q); LISP$B_free (r);
+    return false;
+  }
+
+  if (LISP$B_magCompare (x->limbs, x->length, y->limbs, y->length) < 0)
+    memcpy (r->limbs, x->limbs, x->length * sizeof (uint32_t));
+  else if (y->length == 1)
+    r->limbs [0] = LISP$B_magDivLimb (q->limbs, x->limbs, x->length,
+                                      y->limbs [0]);
+  else
+    ok = LISP$B_magDivKnuth (q->limbs, r->limbs, x->limbs, x->length,
+                             y->limbs, y->length);
+
+  if (!ok) {
+    LISP$B_free (q); LISP$B_free (r);
+    return false;
+  }
+
+  q->negative = (x->negative != y->negative);
+  r->negative = x->negative;
+  LISP$B_normalize (q, x->length);
+  LISP$B_normalize (r, (x->length < y->length)? x->length : y->length);
+
+  if (quo != NULL) *quo = q; else LISP$B_free (q);
+  if (rem != NULL) *rem = r; else LISP$B_free (r);
+  return true;
+}
+
+int LISP$B_compare (const LISP$Bignum * x, const LISP$Bignum * y) {
+
+  int c;
+
+  if (x->negative != y->negative) return (x->negative? -1 : 1);
+
+  c = LISP$B_magCompare (x->limbs, x->length, y->limbs, y->length);
+  return (x->negative? -c : c);
+}
+
+unsigned int LISP$B_hash (const LISP$Bignum * b) {
+
+  int          i;
+  unsigned int h = b->negative? 0x811C9DC5 : 0x9E3779B9;
+
+  for (i = 0; i < b->length; i++)
+    h = (h ^ b->limbs [i]) * 0x01000193;
+
+  return h;
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
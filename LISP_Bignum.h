@@ -0,0 +1,63 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Bignum -- Arbitrary-precision integer arithmetic
+ */
+
+#ifndef _LISP_BIGNUM_H_
+#define _LISP_BIGNUM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Multiplication switches from schoolbook to Karatsuba at this size */
+#define LISP$B_KARATSUBA_LIMBS  32
+
+/* Number of limbs an int64_t takes */
+#define LISP$B_INT_LIMBS        2
+
+/* Integer as a sign and a magnitude; the magnitude is little-endian *
+ * in 32-bit limbs without leading zero limbs, so zero has length 0  */
+typedef struct {
+  bool       negative;
+  int        length;
+  uint32_t * limbs;
+} LISP$Bignum;
+
+/* Each function returning a bignum allocates a new one, or it returns *
+ * NULL if there's no memory; the arguments are never changed          */
+
+/* Conversions; $B_wrapInt () makes 'b' a view of 'num' in the caller's *
+ * 'limbs' array of LISP$B_INT_LIMBS, it must not be freed or resized   */
+LISP$Bignum * LISP$B_wrapInt (LISP$Bignum * b, uint32_t * limbs,
+                              int64_t num);
+LISP$Bignum * LISP$B_fromInt (int64_t num);
+LISP$Bignum * LISP$B_fromString (const char * str);  /* [+-]digits   */
+LISP$Bignum * LISP$B_fromLimbs (bool negative, const uint32_t * limbs,
+                                int length);
+LISP$Bignum * LISP$B_copy (const LISP$Bignum * b);
+bool          LISP$B_toInt (const LISP$Bignum * b, int64_t * res);
+double        LISP$B_toDouble (const LISP$Bignum * b);
+LISP$Bignum * LISP$B_fromDouble (double num);        /* Truncated    */
+double        LISP$B_log (const LISP$Bignum * b);    /* Natural log  */
+char *        LISP$B_toString (const LISP$Bignum * b);  /* malloc'd   */
+void          LISP$B_free (LISP$Bignum * b);
+
+/* Arithmetic */
+LISP$Bignum * LISP$B_add (const LISP$Bignum * x, const LISP$Bignum * y);
+LISP$Bignum * LISP$B_sub (const LISP$Bignum * x, const LISP$Bignum * y);
+LISP$Bignum * LISP$B_mul (const LISP$Bignum * x, const LISP$Bignum * y);
+
+/* Truncating division -- the quotient and the remainder (having the  *
+ * sign of 'x') are stored where 'quo' and 'rem' point unless they're *
+ * NULL; false is returned for zero 'y' or if there's no memory       */
+bool LISP$B_divMod (const LISP$Bignum * x, const LISP$Bignum * y,
+                    LISP$Bignum ** quo, LISP$Bignum ** rem);
+
+/* Comparison (-1, 0, 1) and a hash consistent with it */
+int          LISP$B_compare (const LISP$Bignum * x, const LISP$Bignum * y);
+unsigned int LISP$B_hash (const LISP$Bignum * b);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -6,11 +6,44 @@
  * Author:  tmr
  */
 
+#ifndef _VMS_
+#define _GNU_SOURCE                             /* pthread_getattr_np () */
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef _VMS_
+#include <sys/resource.h>
+#include <pthread.h>
+
+#define LISP$M_WORKERS  ((int) sysconf (_SC_NPROCESSORS_ONLN))
+#else
+/* No threads there -- the pool runs each task of PMAP and FUTURE as *
+ * it's submitted, so whatever they'd wait for is done by then and   *
+ * their locks have nothing to guard                                 */
+#define pthread_mutex_t             int
+#define pthread_cond_t              int
+#define pthread_mutex_init(m, a)    (*(m) = 0)
+#define pthread_mutex_destroy(m)    ((void) (m))
+#define pthread_mutex_lock(m)       ((void) (m))
+#define pthread_mutex_unlock(m)     ((void) (m))
+#define pthread_cond_init(c, a)     (*(c) = 0)
+#define pthread_cond_destroy(c)     ((void) (c))
+#define pthread_cond_signal(c)      ((void) (c))
+#define pthread_cond_broadcast(c)   ((void) (c))
+#define pthread_cond_wait(c, m)     ((void) (c))
+
+#define LISP$M_WORKERS  1
+#endif
 
 #ifdef _HAS_RDLN_
 #include <readline/readline.h>
@@ -18,49 +51,94 @@
 #endif
 
 #include "LISP_Core.h"
+#include "LISP_Kernels.h"
+#include "LISP_Number.h"
+#include "LISP_Dump.h"
+#include "LISP_Pool.h"
+#include "LISP_Actor.h"
 
 
 /******************************************************
  * LISP Machine control operations
  ******************************************************/
 
-LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output) {
+LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output,
+                            bool isQuiet) {
 
   int  i;
   char logFileName [256];
 
   LISP$MachIns * lmi = (LISP$MachIns *) malloc (sizeof (LISP$MachIns));
 
-  strlcpy (logFileName, name,   sizeof (logFileName));
-  strlcat (logFileName, ".log", sizeof (logFileName));
+  if (name != NULL) {
+    strlcpy (logFileName, name,   sizeof (logFileName));
+    strlcat (logFileName, ".log", sizeof (logFileName));
+  }
 
   lmi->isReady             = false;
   lmi->is2ShutDown         = false;
   lmi->mode                = Interactive;
-  lmi->logStream           = fopen (logFileName, "a");
+  lmi->isQuiet             = isQuiet;
+  lmi->isEchoed            = true;
+  lmi->errorCount          = 0;
+  lmi->pool                = NULL;
+  lmi->workers             = LISP$M_WORKERS;
+  lmi->isWorker            = false;
+  lmi->actor               = NULL;
+  lmi->hasFutures          = false;
+  lmi->logStream           = (name != NULL)? fopen (logFileName, "a") : NULL;
+  lmi->log                 = (lmi->logStream != NULL)?
+                               LISP$L_open (lmi->logStream) : NULL;
+  lmi->isLogOwned          = true;
+  lmi->messageStream       = (isQuiet)? stderr : stdout;
   lmi->inputStream         = NULL;
   lmi->outputStream        = NULL;
   (lmi->error).code        = 0;
   (lmi->error).name    [0] = LISP$S_EOS;
   (lmi->error).message [0] = LISP$S_EOS;
-  lmi->inputBuffer     [0] = LISP$S_EOS;
-#ifdef _HAS_RDLN_
-  lmi->readLineBuffer      = (char *) NULL;
-#endif
+  lmi->inputErrorLine  [0] = LISP$S_EOS;
   lmi->inputErrorPosition  = -1;
+  lmi->inputErrorLineNo    = 0;
+  lmi->reader              = &(lmi->stdReader);
+  LISP$R_openStream (lmi->reader, NULL);
+  lmi->rootTop             = 0;
+  lmi->optTrace            = LISP$M_NULLREF;
+  lmi->optLog              = LISP$M_NULLREF;
+  lmi->optGC               = LISP$M_NULLREF;
   LISP$M_setStreams (lmi, input, output);
 
   /* Print the initialization message, but not sooner than log is open! */
-  LISP$M_throwMessage (lmi, 'I', "STARTUP",
-      "Starting up %s... ", LISP$MACH_ID);
-
-  /* Only formally and just for now */
-  for (i = 0; i < LISP$MACH_NUMTABLEN; i++)
-    lmi->numIdx [i] = Free;
+  if (!lmi->isQuiet)
+    LISP$M_throwMessage (lmi, 'I', "STARTUP",
+        "Starting up %s... ", LISP$MACH_ID);
+
+  /* Pick numeric kernels for this CPU */
+  LISP$K_init ();
+
+  /* Allocate the initial tables -- they're grown by $M_allocNode () */
+  lmi->lstIdx  = NULL; lmi->lstTab = NULL; lmi->lstLen = 0;
+  lmi->atmIdx  = NULL; lmi->atmTab = NULL; lmi->atmLen = 0;
+  lmi->numIdx  = NULL; lmi->numTab = NULL; lmi->numLen = 0;
+  lmi->objIdx  = NULL; lmi->objTab = NULL; lmi->objLen = 0;
+  lmi->numHash = NULL; lmi->numHashLen = 0;
+  lmi->atmHash = NULL; lmi->atmHashLen = 0;
+  lmi->lstNext = lmi->atmNext = lmi->numNext = lmi->objNext = 0;
+  lmi->lstFree = lmi->atmFree = lmi->numFree = lmi->objFree = 0;
+  lmi->objBytes = 0;
+
+  if (!LISP$M_resizeTable (lmi, ListTab,   LISP$MACH_LSTTABLEN) ||
+      !LISP$M_resizeTable (lmi, AtomTab,   LISP$MACH_ATMTABLEN) ||
+      !LISP$M_resizeTable (lmi, NumberTab, LISP$MACH_NUMTABLEN) ||
+      !LISP$M_resizeTable (lmi, ObjectTab, LISP$MACH_OBJTABLEN)) {
+    LISP$M_throwMessage (lmi, 'F', "STARTUP",
+        "Unable to allocate LMI tables!");
+    exit (EXIT_FAILURE);
+  }
 
-  /* Init atom table */
-  for (i = 0; i < LISP$MACH_ATMTABLEN; i++)
-    lmi->atmIdx [i] = Free;
+  /* The root stack may grow as deep as the C stack lets the evaluator */
+  lmi->rootLen   = LISP$MACH_ROOTSTACKLEN;
+  lmi->rootMax   = LISP$M_getRootStackLimit ();
+  lmi->rootStack = (LISP$Ref *) malloc (lmi->rootLen * sizeof (LISP$Ref));
 
   /* Init 'NIL' atom */
   lmi->NIL = LISP$M_getCreateAtom (lmi, "NIL");
@@ -75,18 +153,30 @@ LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output) {
   (lmi->atmTab [LISP$M_getRefId (lmi->T)]).value = lmi->T;
   LISP$M_markMemNode (lmi, lmi->T, Prot, false);
 
-  static char * BuiltInFuns [] = {
+  static const char * const BuiltInFuns [] = {
     "CAR", "CDR", "CONS", "LIST", "BODY",
-    "+", "*", "-", "/", "%%", "<", ">", "=", "<=", ">=", "IS",
-    "AND", "OR", "READ", "READLN", "WRITE", "WRITELN",
+    "+", "*", "-", "/", "%%", "<", ">", "=", "<=", ">=", "IS", "NOT",
+    "READ", "READLN", "WRITE", "WRITELN",
     "ISATOM", "ISLIST", "ISNUMBER",
+    "APPEND", "REVERSE", "SORT", "MEMBER", "LENGTH", "NTH", "ASSOC",
+    "MAPCAR", "EQUAL",
+    "MAKE-HASH", "GETHASH", "PUTHASH", "REMHASH", "MAPHASH", "HASH-COUNT",
+    "MAKE-VECTOR", "VREF", "VSET", "VLENGTH", "LIST->VECTOR", "VECTOR->LIST",
+    "V+", "V-", "V*", "V/", "DOT", "VSUM", "VMIN", "VMAX",
+    "SQRT", "EXPT", "EXP", "LOG", "SIN", "COS", "ABS", "MIN", "MAX",
+    "FLOOR", "CEILING", "ROUND", "WRITE-TO-STRING",
+    "WRITE-BINARY", "READ-BINARY", "OPEN", "CLOSE",
+    "READ-LINES", "READ-FORMS", "MAP", "FILTER", "REDUCE", "NEXT",
+    "PMAP", "PREDUCE", "SPAWN", "SEND", "RECEIVE", "SELF",
+    "FORCE", "STREAM-CAR", "STREAM-CDR", "TOUCH",
     NULL
   };
 
-  static char * BuiltInSpecForms [] = {
-    "SETQ", "QUOTE", "EVAL", "COND", "LOAD",
+  static const char * const BuiltInSpecForms [] = {
+    "SETQ", "QUOTE", "EVAL", "COND", "LOAD", "AND", "OR",
+    "WHILE", "DO", "DOTIMES",
     "LAMBDA", "SPECIAL", "LET", "SHOW-MEM",
-    "ISDEFINED", "GETLPI",
+    "ISDEFINED", "GETLPI", "DELAY", "CONS-STREAM", "FUTURE",
     NULL
   };
 
@@ -94,7 +184,7 @@ LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output) {
 
   /* Load all built-in functions */
   for (i = 0; BuiltInFuns [i] != NULL; i++) {
-    atomRef = LISP$M_getCreateAtom (lmi, BuiltInFuns [i]);
+    atomRef = LISP$M_getCreateAtom (lmi, (char *) BuiltInFuns [i]);
     (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = BuiltInFun;
     (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = atomRef;
     LISP$M_markMemNode (lmi, atomRef, Prot, false);
@@ -102,7 +192,7 @@ LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output) {
 
   /* Load all built-in special forms */
   for (i = 0; BuiltInSpecForms [i] != NULL; i++) {
-    atomRef = LISP$M_getCreateAtom (lmi, BuiltInSpecForms [i]);
+    atomRef = LISP$M_getCreateAtom (lmi, (char *) BuiltInSpecForms [i]);
     (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = BuiltInSpecForm;
     (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = atomRef;
     LISP$M_markMemNode (lmi, atomRef, Prot, false);
@@ -121,35 +211,46 @@ LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output) {
   LISP$M_markMemNode (lmi, INF, Prot, false);
 
   /* Create NAN atom */
-  LISP$Ref NAN = LISP$M_getCreateNumber (lmi, LISP$NAN);
+  LISP$Ref NaN = LISP$M_getCreateNumber (lmi, LISP$NAN);
   atomRef = LISP$M_getCreateAtom (lmi, "NAN");
   (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = Variable;
-  (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = NAN;
+  (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = NaN;
   LISP$M_markMemNode (lmi, atomRef, Prot, false);
-  LISP$M_markMemNode (lmi, NAN, Prot, false);
+  LISP$M_markMemNode (lmi, NaN, Prot, false);
 
   /* Enable GC by default */
   atomRef = LISP$M_getCreateAtom (lmi, LISP$M_OPT_GC);
   (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = Variable;
   (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = lmi->T;
   LISP$M_markMemNode (lmi, atomRef, Used, false);
+  lmi->optGC = atomRef;
 
   /* Disable TRACE by default */
   atomRef = LISP$M_getCreateAtom (lmi, LISP$M_OPT_TRACE);
   (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = Variable;
   (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = lmi->NIL;
   LISP$M_markMemNode (lmi, atomRef, Used, false);
+  lmi->optTrace = atomRef;
 
-  /* Init list table */
-  for (i = 0; i < LISP$MACH_LSTTABLEN; i++)
-    lmi->lstIdx [i] = Free;
+  /* Disable LOG by default */
+  atomRef = LISP$M_getCreateAtom (lmi, LISP$M_OPT_LOG);
+  (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = Variable;
+  (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = lmi->NIL;
+  LISP$M_markMemNode (lmi, atomRef, Used, false);
+  lmi->optLog = atomRef;
 
-  /* Show memory status */
-  LISP$M_printMemoryDump (lmi, false);
+  /* Enable CACHE by default */
+  atomRef = LISP$M_getCreateAtom (lmi, LISP$M_OPT_CACHE);
+  (lmi->atmTab [LISP$M_getRefId (atomRef)]).type  = Variable;
+  (lmi->atmTab [LISP$M_getRefId (atomRef)]).value = lmi->T;
+  LISP$M_markMemNode (lmi, atomRef, Used, false);
 
-  /* Raise READY message */
-  LISP$M_throwMessage (lmi, 'I', "STARTUP",
-      "READY -- Happy LISPing!");
+  /* Show memory status and raise READY message */
+  if (!lmi->isQuiet) {
+    LISP$M_printMemoryDump (lmi, false);
+    LISP$M_throwMessage (lmi, 'I', "STARTUP",
+        "READY -- Happy LISPing!");
+  }
 
   lmi->isReady = true;
 
@@ -162,7 +263,11 @@ void LISP$M_setStreams (LISP$MachIns * lmi, FILE * input, FILE * output) {
   if (lmi->inputStream  != NULL) fflush (lmi->inputStream);
   if (lmi->outputStream != NULL) fflush (lmi->outputStream);
 
-  /* Set new streams */
+  /* Set new streams -- a new input one needs a new reader */
+  if (input != lmi->inputStream) {
+    LISP$R_close (&(lmi->stdReader));
+    LISP$R_openStream (&(lmi->stdReader), input);
+  }
   lmi->inputStream  = input;
   lmi->outputStream = output;
 
@@ -170,19 +275,214 @@ void LISP$M_setStreams (LISP$MachIns * lmi, FILE * input, FILE * output) {
   lmi->is2Process = true;
 }
 
+void LISP$M_setSinks (LISP$MachIns * lmi, FILE * messages, FILE * log) {
+
+  if (lmi->messageStream != NULL) fflush (lmi->messageStream);
+  lmi->messageStream = messages;
+
+  /* The log of its own is closed, the new one belongs to the caller */
+  LISP$L_close (lmi->log);
+  if (lmi->isLogOwned && lmi->logStream != NULL) fclose (lmi->logStream);
+  lmi->logStream  = log;
+  lmi->log        = (log != NULL)? LISP$L_open (log) : NULL;
+  lmi->isLogOwned = false;
+}
+
+static void * LISP$M_duplicate (const void * src, size_t size) {
+
+  void * res = malloc ((size > 0)? size : 1);
+
+  if (res != NULL) memcpy (res, src, size);
+  return res;
+}
+
+/* Copy the tables of 'src' into the ones of 'dst', which are as long, *
+ * and give the objects payloads of their own; if there's no memory,   *
+ * the objects not copied yet are left without any payload             */
+static bool LISP$M_copyHeap (LISP$MachIns * dst, LISP$MachIns * src) {
+
+  int i;
+
+  memcpy (dst->lstIdx, src->lstIdx, src->lstLen * sizeof (LISP$MemState));
+  memcpy (dst->atmIdx, src->atmIdx, src->atmLen * sizeof (LISP$MemState));
+  memcpy (dst->numIdx, src->numIdx, src->numLen * sizeof (LISP$MemState));
+  memcpy (dst->objIdx, src->objIdx, src->objLen * sizeof (LISP$MemState));
+  memcpy (dst->lstTab, src->lstTab, src->lstLen * sizeof (LISP$ListRecord));
+  memcpy (dst->atmTab, src->atmTab, src->atmLen * sizeof (LISP$AtomRecord));
+  memcpy (dst->numTab, src->numTab,
+          src->numLen * sizeof (LISP$NumberRecord));
+  memcpy (dst->objTab, src->objTab,
+          src->objLen * sizeof (LISP$ObjectRecord));
+  memcpy (dst->numHash, src->numHash, src->numHashLen * sizeof (int));
+  memcpy (dst->atmHash, src->atmHash, src->atmHashLen * sizeof (int));
+
+  for (i = 0; i < src->objLen; i++)
+    if (dst->objIdx [i] != Free && !LISP$M_cloneObject (&(dst->objTab [i]))) {
+      for (i++; i < src->objLen; i++)
+        memset (&((dst->objTab [i]).data), 0,
+                sizeof ((dst->objTab [i]).data));
+      return false;
+    }
+
+  return true;
+}
+
+LISP$MachIns * LISP$M_clone (LISP$MachIns * lmi, FILE * input, FILE * output) {
+
+  int i;
+  LISP$MachIns * res = (LISP$MachIns *) malloc (sizeof (LISP$MachIns));
+
+  if (res == NULL) return NULL;
+  memcpy (res, lmi, sizeof (LISP$MachIns));
+
+  /* The tables are copied as they are, references stay valid */
+  res->lstIdx    = malloc (lmi->lstLen * sizeof (LISP$MemState));
+  res->atmIdx    = malloc (lmi->atmLen * sizeof (LISP$MemState));
+  res->numIdx    = malloc (lmi->numLen * sizeof (LISP$MemState));
+  res->objIdx    = malloc (lmi->objLen * sizeof (LISP$MemState));
+  res->lstTab    = malloc (lmi->lstLen * sizeof (LISP$ListRecord));
+  res->atmTab    = malloc (lmi->atmLen * sizeof (LISP$AtomRecord));
+  res->numTab    = malloc (lmi->numLen * sizeof (LISP$NumberRecord));
+  res->objTab    = malloc (lmi->objLen * sizeof (LISP$ObjectRecord));
+  res->numHash   = malloc (lmi->numHashLen * sizeof (int));
+  res->atmHash   = malloc (lmi->atmHashLen * sizeof (int));
+  res->rootStack = (LISP$Ref *) malloc (lmi->rootLen * sizeof (LISP$Ref));
+
+  /* Out of memory -- the payloads copied so far are released */
+  if (res->lstIdx == NULL || res->atmIdx == NULL || res->numIdx == NULL ||
+      res->objIdx == NULL || res->lstTab == NULL || res->atmTab == NULL ||
+      res->numTab == NULL || res->objTab == NULL || res->numHash == NULL ||
+      res->atmHash == NULL || res->rootStack == NULL ||
+      !LISP$M_copyHeap (res, lmi)) {
+    if (res->objIdx != NULL && res->objTab != NULL)
+      for (i = 0; i < lmi->objLen; i++)
+        if (res->objIdx [i] != Free) LISP$M_freeObject (res, i);
+    free (res->lstIdx); free (res->lstTab);
+    free (res->atmIdx); free (res->atmTab);
+    free (res->numIdx); free (res->numTab);
+    free (res->objIdx); free (res->objTab);
+    free (res->numHash);
+    free (res->atmHash);
+    free (res->rootStack);
+    free (res);
+    return NULL;
+  }
+
+  res->rootTop             = 0;
+  res->rootMax             = LISP$M_getRootStackLimit ();
+  res->logStream           = NULL;
+  res->log                 = NULL;
+  res->isLogOwned          = true;
+  res->is2ShutDown         = false;
+  res->errorCount          = 0;
+  res->pool                = NULL;
+  res->isWorker            = false;
+  res->actor               = NULL;
+  (res->error).code        = 0;
+  res->inputErrorPosition  = -1;
+  res->reader              = &(res->stdReader);
+  res->inputStream         = NULL;
+  res->outputStream        = NULL;
+  LISP$R_openStream (res->reader, NULL);
+  LISP$M_setStreams (res, input, output);
+
+  return res;
+}
+
+/* Make the array at 'p' of 'length' items hold 'need' of them */
+static bool LISP$M_fitArray (void * p, int length, int need, size_t size) {
+
+  void * tmp;
+
+  if (need <= length) return true;
+  if ((tmp = realloc (*(void **) p, need * size)) == NULL) return false;
+  *(void **) p = tmp;
+  return true;
+}
+
+bool LISP$M_reset (LISP$MachIns * lmi, LISP$MachIns * template) {
+
+  int i;
+  LISP$MachIns own;
+
+  /* The tables grow as the template's ones have, they never shrink -- *
+   * the lengths stay the old ones till all of them fit                */
+  if (!LISP$M_fitArray (&(lmi->lstIdx), lmi->lstLen, template->lstLen,
+                        sizeof (LISP$MemState)) ||
+      !LISP$M_fitArray (&(lmi->atmIdx), lmi->atmLen, template->atmLen,
+                        sizeof (LISP$MemState)) ||
+      !LISP$M_fitArray (&(lmi->numIdx), lmi->numLen, template->numLen,
+                        sizeof (LISP$MemState)) ||
+      !LISP$M_fitArray (&(lmi->objIdx), lmi->objLen, template->objLen,
+                        sizeof (LISP$MemState)) ||
+      !LISP$M_fitArray (&(lmi->lstTab), lmi->lstLen, template->lstLen,
+                        sizeof (LISP$ListRecord)) ||
+      !LISP$M_fitArray (&(lmi->atmTab), lmi->atmLen, template->atmLen,
+                        sizeof (LISP$AtomRecord)) ||
+      !LISP$M_fitArray (&(lmi->numTab), lmi->numLen, template->numLen,
+                        sizeof (LISP$NumberRecord)) ||
+      !LISP$M_fitArray (&(lmi->objTab), lmi->objLen, template->objLen,
+                        sizeof (LISP$ObjectRecord)) ||
+      !LISP$M_fitArray (&(lmi->numHash), lmi->numHashLen,
+                        template->numHashLen, sizeof (int)) ||
+      !LISP$M_fitArray (&(lmi->atmHash), lmi->atmHashLen,
+                        template->atmHashLen, sizeof (int)))
+    return false;
+
+  for (i = 0; i < lmi->objLen; i++)
+    if (lmi->objIdx [i] != Free) LISP$M_freeObject (lmi, i);
+
+  /* All but the tables, the root stack and the streams is the template's */
+  memcpy (&own, lmi, sizeof (LISP$MachIns));
+  memcpy (lmi, template, sizeof (LISP$MachIns));
+
+  lmi->lstIdx        = own.lstIdx;     lmi->lstTab    = own.lstTab;
+  lmi->atmIdx        = own.atmIdx;     lmi->atmTab    = own.atmTab;
+  lmi->numIdx        = own.numIdx;     lmi->numTab    = own.numTab;
+  lmi->objIdx        = own.objIdx;     lmi->objTab    = own.objTab;
+  lmi->numHash       = own.numHash;    lmi->atmHash   = own.atmHash;
+  lmi->rootStack     = own.rootStack;  lmi->rootLen   = own.rootLen;
+  lmi->rootMax       = own.rootMax;    lmi->rootTop   = 0;
+  lmi->stdReader     = own.stdReader;  lmi->reader    = &(lmi->stdReader);
+  lmi->inputStream   = own.inputStream;
+  lmi->outputStream  = own.outputStream;
+  lmi->logStream     = own.logStream;
+  lmi->log           = own.log;
+  lmi->isLogOwned    = own.isLogOwned;
+  lmi->messageStream = own.messageStream;
+  lmi->isQuiet       = own.isQuiet;
+  lmi->isEchoed      = own.isEchoed;
+  lmi->pool          = own.pool;
+  lmi->workers       = own.workers;
+  lmi->isWorker      = own.isWorker;
+  lmi->actor         = own.actor;
+  lmi->is2ShutDown   = false;
+  lmi->is2Process    = true;
+  lmi->errorCount    = 0;
+  (lmi->error).code  = 0;
+  lmi->inputErrorPosition = -1;
+
+  return (LISP$M_copyHeap (lmi, template));
+}
+
 void LISP$M_destroy (LISP$MachIns * lmi) {
 
   int i;
   LISP$Ref ref = LISP$M_NULLREF;
 
-  LISP$M_throwMessage (lmi, 'I', "SHUTDWN", "Shutting down...");
+  if (!lmi->isQuiet)
+    LISP$M_throwMessage (lmi, 'I', "SHUTDWN", "Shutting down...");
 
   lmi->isReady = false;
-  fclose (lmi->logStream);
+
+  /* The workers' copies are on their own, they go first */
+  LISP$P_destroy (lmi->pool);
+  lmi->pool = NULL;
+  LISP$A_exit (lmi);
 
   /* Free remaining Used nodes and all internals */
   LISP$M_setRefType (ref, AtomTab);
-  for (i = 0; i < LISP$MACH_ATMTABLEN; i++) {
+  for (i = 0; i < lmi->atmLen; i++) {
     //if (lmi->atmIdx [i] == Used ||
     //    lmi->atmIdx [i] == Prot) {
     if (lmi->atmIdx [i] == Used) {
@@ -195,6 +495,15 @@ void LISP$M_destroy (LISP$MachIns * lmi) {
   }
   LISP$M_collectGarbage (lmi);
 
+  free (lmi->lstIdx); free (lmi->lstTab);
+  free (lmi->atmIdx); free (lmi->atmTab);
+  free (lmi->numIdx); free (lmi->numTab);
+  free (lmi->objIdx); free (lmi->objTab);
+  free (lmi->numHash);
+  free (lmi->atmHash);
+  free (lmi->rootStack);
+  LISP$R_close (&(lmi->stdReader));
+  LISP$M_setSinks (lmi, NULL, NULL);
   free (lmi);
 }
 
@@ -218,23 +527,42 @@ bool LISP$M_is2ShutDown (LISP$MachIns * lmi) {
 void LISP$M_throwMessage (LISP$MachIns * lmi, const char severity,
                           const char * name, const char * msg, ...) {
 
-  char buf [512];
+  char buf [LISP$L_RECORD_SIZE];
+  char * rec;
+  int len;
   va_list args;
-  va_start (args, msg);
 
-  char * fmt = "%sLISP-%c-%s, %s\n";
-  vsnprintf (buf, sizeof (buf), msg, args);
+  /* The option is checked through its cached atom, since this runs on *
+   * each atom lookup when the DEBUG_LMI is set; debug traces are only  *
+   * logged, whatever the option says                                   */
+  bool isLogged = (lmi->log != NULL) && (severity == 'D' ||
+      (lmi->isReady && lmi->optLog != LISP$M_NULLREF &&
+       (lmi->atmTab [LISP$M_getRefId (lmi->optLog)]).value == lmi->T));
+
+  /* A quiet LMI keeps its output just for the results, the notes of *
+   * what isn't echoed (the startup file) are just logged             */
+  bool isShown = (severity != 'D') && (lmi->messageStream != NULL) &&
+      (!lmi->isQuiet || lmi->isEchoed || severity != 'I');
+
+  if (!isLogged && !isShown) return;
+
+  /* The record is formatted right into the log ring, if it's logged */
+  rec = (isLogged)? LISP$L_reserve (lmi->log) : buf;
+  len = snprintf (rec, LISP$L_RECORD_SIZE, "%%LISP-%c-%s, ", severity, name);
+  if (len < LISP$L_RECORD_SIZE - 1) {
+    va_start (args, msg);
+    len += vsnprintf (rec + len, LISP$L_RECORD_SIZE - len, msg, args);
+    va_end (args);
+  }
+  if (len > LISP$L_RECORD_SIZE - 2) len = LISP$L_RECORD_SIZE - 2;
+  rec [len++] = '\n';
 
-  /* $M_isOptionEnabled () is based on $M_getCreateAtom () which calls, *
-   * this function when the DEBUG_LMI is set, so let's force logging    *
-   * to avoid infinite loops                                            */
-  #ifndef DEBUG_LMI
-  if (LISP$M_isOptionEnabled (lmi, LISP$M_OPT_LOG))
-  #endif
-    fprintf (lmi->logStream, fmt, "%", severity, name, buf);
+  if (isShown) {
+    if (!lmi->isQuiet) fputc ('\r', lmi->messageStream);
+    fwrite (rec, 1, len, lmi->messageStream);
+  }
 
-  fprintf (stdout, fmt, "\r%", severity, name, buf);
-  fflush (lmi->logStream);
+  if (isLogged) LISP$L_commit (lmi->log, len);
 }
 
 bool LISP$M_isError (LISP$MachIns * lmi) {
@@ -248,14 +576,20 @@ void LISP$M_reportError (LISP$MachIns * lmi) {
                        (lmi->error).name, (lmi->error).message);
 
   int i;
+  FILE * out = (lmi->isQuiet)? lmi->messageStream : lmi->outputStream;
   if ((lmi->error).code == LISP$_ERR$S_BADSYN) {
-    fprintf (lmi->outputStream, "%s\n", lmi->inputBuffer);
-    for (i = 0; i < lmi->inputErrorPosition - 1; i++) {
-      fprintf (lmi->outputStream, ".");
+    LISP$M_throwMessage (lmi, 'I', "ATLINE", "Line %ld:",
+                         lmi->inputErrorLineNo);
+    if (out != NULL) {
+      fprintf (out, "%s\n", lmi->inputErrorLine);
+      for (i = 0; i < lmi->inputErrorPosition - 1; i++) {
+        fprintf (out, ".");
+      }
+      fprintf (out, "^\n");
     }
-    fprintf (lmi->outputStream, "^\n");
     lmi->inputErrorPosition = -1;
   }
+  lmi->errorCount++;
 
   /* Error message passed, let's reset error status */
   (lmi->error).code = LISP$_ERR$S_OK;
@@ -279,26 +613,221 @@ void LISP$M_setError (LISP$MachIns * lmi, const int code,
   strlcpy ((lmi->error).message, buf, sizeof ((lmi->error).message));
 }
 
-int LISP$M_findFreeNode (LISP$MemState idx [], int length) {
+int LISP$M_findFreeNode (LISP$MemState idx [], int length, int * next) {
 
   int i;
 
-  for (i = 0; i < length; i++)
-    if (idx [i] == Free) return i;
+  /* Next-fit -- continue behind the node found last time, so that *
+   * allocations don't crawl over all the used nodes each time     */
+  for (i = *next; i < length; i++)
+    if (idx [i] == Free) { *next = i + 1; return i; }
+
+  for (i = 0; i < *next && i < length; i++)
+    if (idx [i] == Free) { *next = i + 1; return i; }
 
   return -1;
 }
 
+bool LISP$M_resizeTable (LISP$MachIns * lmi, LISP$TableType type,
+                         int length) {
+
+#define RESIZE_TABLE(type) \
+  do { \
+    LISP$MemState * idx = (LISP$MemState *) \
+      realloc (lmi->type##Idx, length * sizeof (LISP$MemState)); \
+    if (idx == NULL) return false; \
+    lmi->type##Idx = idx; \
+    void * tab = realloc (lmi->type##Tab, \
+                          length * sizeof (*(lmi->type##Tab))); \
+    if (tab == NULL) return false; \
+    lmi->type##Tab = tab; \
+    for (i = lmi->type##Len; i < length; i++) \
+      lmi->type##Idx [i] = Free; \
+    lmi->type##Next  = lmi->type##Len; \
+    lmi->type##Free += length - lmi->type##Len; \
+    lmi->type##Len   = length; \
+  } while (0)
+
+  int i;
+
+  switch (type) {
+    case ListTab:   RESIZE_TABLE (lst); return true;
+    case AtomTab:   RESIZE_TABLE (atm); break;
+    case ObjectTab: RESIZE_TABLE (obj); return true;
+    case NumberTab: RESIZE_TABLE (num); break;
+  }
+
+  return (LISP$M_rehash (lmi, type));
+
+#undef RESIZE_TABLE
+}
+
+bool LISP$M_rehash (LISP$MachIns * lmi, LISP$TableType type) {
+
+  bool            isAtom  = (type == AtomTab);
+  int **          hash    = isAtom? &(lmi->atmHash)    : &(lmi->numHash);
+  int *           hashLen = isAtom? &(lmi->atmHashLen) : &(lmi->numHashLen);
+  int             length  = isAtom? lmi->atmLen        : lmi->numLen;
+  LISP$MemState * idx     = isAtom? lmi->atmIdx        : lmi->numIdx;
+  int             i, h, len;
+  int *           tmp;
+
+  for (len = isAtom? LISP$MACH_ATMHASHLEN : LISP$MACH_NUMHASHLEN;
+       len < 2 * length; len *= 2);
+  if (len != *hashLen) {
+    tmp = (int *) realloc (*hash, len * sizeof (int));
+    if (tmp == NULL) return false;
+    *hash    = tmp;
+    *hashLen = len;
+  }
+
+  for (i = 0; i < len; i++)
+    (*hash) [i] = -1;
+
+  for (i = 0; i < length; i++) {
+    if (idx [i] == Free) continue;
+    for (h = (isAtom? (lmi->atmTab [i]).hash :
+                      LISP$M_hashNumber (lmi->numTab [i])) & (len - 1);
+         (*hash) [h] >= 0; h = (h + 1) & (len - 1));
+    (*hash) [h] = i;
+  }
+
+  return true;
+}
+
+bool LISP$M_growTable (LISP$MachIns * lmi, LISP$TableType type) {
+
+  int length = (type == ListTab)?   lmi->lstLen :
+               (type == AtomTab)?   lmi->atmLen :
+               (type == NumberTab)? lmi->numLen : lmi->objLen;
+
+  if (length >= LISP$MACH_TABMAXLEN) return false;
+
+  /* Sizes stay 2^n-1 like the initial ones */
+  length = 2 * length + 1;
+  if (length > LISP$MACH_TABMAXLEN) length = LISP$MACH_TABMAXLEN;
+
+  return (LISP$M_resizeTable (lmi, type, length));
+}
+
+bool LISP$M_reserveNodes (LISP$MachIns * lmi, LISP$TableType type,
+                          int count) {
+
+  int length = (type == ListTab)?   lmi->lstLen :
+               (type == AtomTab)?   lmi->atmLen :
+               (type == NumberTab)? lmi->numLen : lmi->objLen;
+  int free   = (type == ListTab)?   lmi->lstFree :
+               (type == AtomTab)?   lmi->atmFree :
+               (type == NumberTab)? lmi->numFree : lmi->objFree;
+  long long wanted = (long long) length + count - free;
+
+  if (count <= free) return true;
+  if (wanted > LISP$MACH_TABMAXLEN) return false;
+
+  /* Sizes stay 2^n-1 like the initial ones */
+  while (length < wanted) length = 2 * length + 1;
+  if (length > LISP$MACH_TABMAXLEN) length = LISP$MACH_TABMAXLEN;
+
+  return (LISP$M_resizeTable (lmi, type, length));
+}
+
+int LISP$M_allocNode (LISP$MachIns * lmi, LISP$TableType type) {
+
+  int i;
+
+  do {
+    switch (type) {
+      case ListTab:
+        i = LISP$M_findFreeNode (lmi->lstIdx, lmi->lstLen, &(lmi->lstNext));
+        break;
+      case AtomTab:
+        i = LISP$M_findFreeNode (lmi->atmIdx, lmi->atmLen, &(lmi->atmNext));
+        break;
+      case NumberTab:
+        i = LISP$M_findFreeNode (lmi->numIdx, lmi->numLen, &(lmi->numNext));
+        break;
+      default:
+        i = LISP$M_findFreeNode (lmi->objIdx, lmi->objLen, &(lmi->objNext));
+        break;
+    }
+  } while (i < 0 && LISP$M_growTable (lmi, type));
+
+  return i;
+}
+
+int LISP$M_getRootStackLimit (void) {
+
+#ifdef _VMS_
+  return (LISP$MACH_ROOTSTACKLEN);
+#else
+  struct rlimit rl;
+#ifdef __GLIBC__
+  pthread_attr_t attr;
+  size_t size;
+#endif
+
+  /* Each level of evaluation takes some C stack as well as some roots, *
+   * so don't let the roots outgrow what the C stack is able to hold    */
+  if (getrlimit (RLIMIT_STACK, &rl) != 0)
+    return (LISP$MACH_ROOTSTACKLEN);
+
+#ifdef __GLIBC__
+  /* A thread other than the main one has got a stack of a fixed size */
+  if (!pthread_getattr_np (pthread_self (), &attr)) {
+    if (!pthread_attr_getstacksize (&attr, &size) &&
+        (rl.rlim_cur == RLIM_INFINITY || size < rl.rlim_cur))
+      rl.rlim_cur = size;
+    pthread_attr_destroy (&attr);
+  }
+#endif
+  if (rl.rlim_cur == RLIM_INFINITY ||
+      rl.rlim_cur / LISP$MACH_ROOTSTACKBYTES > LISP$MACH_TABMAXLEN)
+    return (LISP$MACH_TABMAXLEN);
+  if (rl.rlim_cur / LISP$MACH_ROOTSTACKBYTES < LISP$MACH_ROOTSTACKLEN)
+    return (LISP$MACH_ROOTSTACKLEN);
+
+  return ((int) (rl.rlim_cur / LISP$MACH_ROOTSTACKBYTES));
+#endif
+}
+
+unsigned int LISP$M_hashNumber (LISP$NumberRecord num) {
+
+  unsigned long long bits = 0;
+
+  /* 0.0 and -0.0 are equal numbers, so they must be hashed equally */
+  if (num.isInt) bits = (unsigned long long) num.val.i;
+  else if (num.val.d != 0) memcpy (&bits, &(num.val.d), sizeof (bits));
+
+  bits ^= bits >> 33;
+  bits *= 0xFF51AFD7ED558CCDULL;
+  bits ^= bits >> 33;
+
+  return ((unsigned int) bits);
+}
+
+unsigned int LISP$M_hashAtomName (const char * name) {
+
+  unsigned int hash = 2166136261U;
+  int i;
+
+  /* FNV-1a */
+  for (i = 0; i < LISP$MACH_ATMNAMELEN - 1 && name [i] != LISP$S_EOS; i++)
+    hash = (hash ^ (unsigned char) name [i]) * 16777619U;
+
+  return hash;
+}
+
 LISP$Ref LISP$M_createList (LISP$MachIns * lmi) {
 
   LISP$Ref res = LISP$M_NULLREF;
-  int i = LISP$M_findFreeNode (lmi->lstIdx, LISP$MACH_LSTTABLEN);
+  int i = LISP$M_allocNode (lmi, ListTab);
 
   if (i >= 0) {
     /* Create a new list with both CAR and CDR values set to NIL */
     (lmi->lstTab [i]).car = lmi->NIL;
     (lmi->lstTab [i]).cdr = lmi->NIL;
     lmi->lstIdx [i]       = Temp;
+    lmi->lstFree--;
 
     /* Build value reference */
     LISP$M_setRef (res, i, ListTab);
@@ -313,28 +842,40 @@ LISP$Ref LISP$M_createList (LISP$MachIns * lmi) {
   return res;
 }
 
-LISP$Ref LISP$M_getCreateNumber (LISP$MachIns * lmi, double num) {
+LISP$Ref LISP$M_getCreateNumberRecord (LISP$MachIns * lmi,
+                                       LISP$NumberRecord num) {
 
   LISP$Ref res = LISP$M_NULLREF;
-  int i;
+  LISP$NumberRecord * rec;
+  int i, h;
 
   LISP$M_setRefType (res, NumberTab);
 
-  /* Find out if the atom has been already stored */
-  for (i = 0; i < LISP$MACH_NUMTABLEN; i++) {
-    if (lmi->numIdx [i] != Free &&
-        lmi->numTab [i] == num) {
+  /* Find out if the number has been already stored -- the lookup hash *
+   * holds all the non-free numbers and it's rebuilt by each GC        */
+  for (h = LISP$M_hashNumber (num) & (lmi->numHashLen - 1);
+       (i = lmi->numHash [h]) >= 0; h = (h + 1) & (lmi->numHashLen - 1)) {
+    rec = &(lmi->numTab [i]);
+    if (rec->isInt == num.isInt &&
+        (num.isInt? rec->val.i == num.val.i : rec->val.d == num.val.d)) {
       LISP$M_setRefId (res, i);
       return res;
     }
   }
 
   /* There's no number like this, so create a new one */
-  i = LISP$M_findFreeNode (lmi->numIdx, LISP$MACH_NUMTABLEN);
+  if (lmi->numFree == 0 && LISP$M_growTable (lmi, NumberTab)) {
+    /* The hash may have been rebuilt, so find the slot again */
+    for (h = LISP$M_hashNumber (num) & (lmi->numHashLen - 1);
+         lmi->numHash [h] >= 0; h = (h + 1) & (lmi->numHashLen - 1));
+  }
+  i = LISP$M_findFreeNode (lmi->numIdx, lmi->numLen, &(lmi->numNext));
 
   if (i >= 0) {
     /* Store number */
-    lmi->numIdx [i] = Temp;
+    lmi->numIdx [i]  = Temp;
+    lmi->numHash [h] = i;
+    lmi->numFree--;
     lmi->numTab [i] = num; LISP$M_setRefId (res, i);
     return res;
   }
@@ -345,154 +886,655 @@ LISP$Ref LISP$M_getCreateNumber (LISP$MachIns * lmi, double num) {
   return (LISP$M_NULLREF);
 }
 
-LISP$Ref LISP$M_getCreateAtom (LISP$MachIns * lmi, char * atomName) {
+LISP$Ref LISP$M_getCreateNumber (LISP$MachIns * lmi, double num) {
 
-  int i;
-  LISP$Ref res = LISP$M_NULLREF;
+  LISP$NumberRecord rec;
+  rec.isInt = false;
+  rec.val.d = num;
+  return (LISP$M_getCreateNumberRecord (lmi, rec));
+}
 
-  LISP$M_setRefType (res, AtomTab);
+LISP$Ref LISP$M_getCreateInteger (LISP$MachIns * lmi, int64_t num) {
 
-  #ifdef DEBUG_LMI
-  LISP$M_throwMessage (lmi, 'D', "DEBUG",
-      "AtomLookUp (%s)", atomName);
-  #endif
+  LISP$NumberRecord rec;
+  rec.isInt = true;
+  rec.val.i = num;
+  return (LISP$M_getCreateNumberRecord (lmi, rec));
+}
 
-  /* Find out if the atom has been already stored */
-  for (i = 0; i < LISP$MACH_ATMTABLEN; i++) {
-    if (lmi->atmIdx [i] != Free &&
-        (lmi->atmTab [i]).name != NULL &&
-        !strncmp ((lmi->atmTab [i]).name, atomName,
-                  sizeof ((lmi->atmTab [i]).name))) {
-      LISP$M_setRefId (res, i);
-      #ifdef DEBUG_LMI
-      LISP$M_throwMessage (lmi, 'D', "DEBUG",
-          "%s found on position: " LISP$ADDRFMT, atomName, i);
-      #endif
-      return res;
-    }
-  }
+double LISP$M_getNumber (LISP$MachIns * lmi, LISP$Ref ref) {
 
-  /* Find free space for a new atom */
-  i = LISP$M_findFreeNode (lmi->atmIdx, LISP$MACH_ATMTABLEN);
+  if (LISP$M_getRefType (ref) == ObjectTab)
+    return (LISP$B_toDouble ((lmi->objTab [LISP$M_getRefId (ref)]).
+                               data.bignum));
 
-  /* Nothing found, let's try to settle a new AtomRec */
-  if (i >= 0) {
-    LISP$M_setRefId (res, i); lmi->atmIdx [i] = Temp;
+  LISP$NumberRecord * rec = &(lmi->numTab [LISP$M_getRefId (ref)]);
+  return (rec->isInt? (double) rec->val.i : rec->val.d);
+}
 
-    strlcpy ((lmi->atmTab [i]).name, atomName,
-             sizeof ((lmi->atmTab [i]).name));
-    (lmi->atmTab [i]).type     = Undefined;
-    (lmi->atmTab [i]).value    = lmi->NIL;
-    (lmi->atmTab [i]).bindList = lmi->NIL;
-//    (lmi->atmTab [i]).propList = lmi->NIL;
+bool LISP$M_getInteger (LISP$MachIns * lmi, LISP$Ref ref, int64_t * res) {
 
-    #ifdef DEBUG_LMI
-    LISP$M_throwMessage (lmi, 'D', "DEBUG",
-        "%s created on position " LISP$ADDRFMT " (ref="
-        LISP$ADDRFMT ")", atomName, i, res);
-    #endif
+  /* Big integers never fit, they're created only when needed */
+  if (LISP$M_getRefType (ref) != NumberTab) return false;
 
-    return res;
+  LISP$NumberRecord * rec = &(lmi->numTab [LISP$M_getRefId (ref)]);
+
+  if (rec->isInt) { *res = rec->val.i; return true; }
+
+  /* 2^63 is the first double which doesn't fit, NaN fails as well */
+  if (!(rec->val.d >= -9223372036854775808.0 &&
+        rec->val.d <   9223372036854775808.0) ||
+      rec->val.d != (double) (int64_t) rec->val.d)
+    return false;
+
+  *res = (int64_t) rec->val.d;
+  return true;
+}
+
+LISP$Ref LISP$M_createBignum (LISP$MachIns * lmi, LISP$Bignum * num) {
+
+  LISP$Ref res;
+  int64_t  n;
+
+  if (num == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a big integer!");
+    return (LISP$M_NULLREF);
   }
 
-  /* Nothing created, table is full */
-  LISP$M_setError (lmi, LISP$_ERR$S_ATMFUL,
-      "ATMFUL", "Atom table is full!");
-  return (LISP$M_NULLREF);
+  /* Integers which fit are always kept in the number table */
+  if (LISP$B_toInt (num, &n)) {
+    LISP$B_free (num);
+    return (LISP$M_getCreateInteger (lmi, n));
+  }
+
+  res = LISP$M_createObject (lmi, BigInteger);
+  if (res == LISP$M_NULLREF) { LISP$B_free (num); return (res); }
+
+  (lmi->objTab [LISP$M_getRefId (res)]).data.bignum = num;
+  lmi->objBytes += sizeof (LISP$Bignum) + num->length * sizeof (uint32_t);
+
+  return res;
 }
 
-bool LISP$M_isOptionEnabled (LISP$MachIns * lmi, const char * option) {
+bool LISP$M_isBignum (LISP$MachIns * lmi, LISP$Ref ref) {
 
-  /* LMI is not initialized yet, so prevent all option lookups      */
-  if (!lmi->isReady) return false;
+  return (LISP$M_getRefType (ref) == ObjectTab &&
+          (lmi->objTab [LISP$M_getRefId (ref)]).type == BigInteger);
+}
 
-  LISP$Ref ref = LISP$M_getCreateAtom (lmi, (char *) option);
+bool LISP$M_isNumber (LISP$MachIns * lmi, LISP$Ref ref) {
 
-  /* Feature is enabled <=> the option symbol is set to T */
-  return ((lmi->atmTab [LISP$M_getRefId (ref)]).value == lmi->T);
+  return (LISP$M_getRefType (ref) == NumberTab ||
+          LISP$M_isBignum (lmi, ref));
 }
 
-bool LISP$M_isSpecialForm (LISP$AtomRecord atom) {
+bool LISP$M_isExact (LISP$MachIns * lmi, LISP$Ref ref) {
 
-  return (atom.type == BuiltInSpecForm ||
-          atom.type == UserDefSpecForm ||
-          atom.type == UnnamedSpecForm);
+  return ((LISP$M_getRefType (ref) == NumberTab &&
+           (lmi->numTab [LISP$M_getRefId (ref)]).isInt) ||
+          LISP$M_isBignum (lmi, ref));
 }
 
-bool LISP$M_isFunction (LISP$AtomRecord atom) {
+LISP$Bignum * LISP$M_getBignum (LISP$MachIns * lmi, LISP$Ref ref,
+                                LISP$Bignum * buf, uint32_t * limbs) {
 
-  return (atom.type == BuiltInFun ||
-          atom.type == UserDefFun ||
-          atom.type == UnnamedFun);
+  if (LISP$M_getRefType (ref) == ObjectTab)
+    return ((lmi->objTab [LISP$M_getRefId (ref)]).data.bignum);
+
+  return (LISP$B_wrapInt (buf, limbs,
+                          (lmi->numTab [LISP$M_getRefId (ref)]).val.i));
 }
 
-bool LISP$M_checkBuiltIn (LISP$MachIns * lmi, const char * name,
-                          LISP$AtomRecord builtIn,
-                          LISP$ListRecord argv, int argc,
-                          int argcMin, double argcMax) {
+LISP$Ref LISP$M_createString (LISP$MachIns * lmi, const char * chars,
+                              size_t length) {
 
-  int len1 = strlen (builtIn.name);
-  int len2 = strlen (name);
+  char          name [LISP$MACH_ATMNAMELEN];
+  LISP$String * str;
+  LISP$Ref      res;
 
-  /* XXX: just to prevent compiler warning -- could be used later... */
-  if (&argv != &argv) return false;
+  /* Short strings are atoms named by the quoted chars, as read */
+  if (length + 3 <= LISP$MACH_ATMNAMELEN) {
+    name [0] = '"';
+    memcpy (name + 1, chars, length);
+    name [length + 1] = '"';
+    name [length + 2] = LISP$S_EOS;
+    return (LISP$M_getCreateAtom (lmi, name));
+  }
 
-  /* Check the name */
-  if (!strncmp (builtIn.name, name, (len1 > len2)? len1 : len2)) {
-    /* Name is ok, check the argument vector */
-    if (!LISP$IS_NINF (argcMax) && argc < argcMin) {
-      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-                       "Too few (%d) arguments for %s!", argc, name);
-      return false;
-    }
-    else if (!LISP$IS_NINF (argcMax) &&
-             !LISP$IS_INF  (argcMax) && argc > argcMax) {
-      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-                       "Too much (%d) arguments for %s!", argc, name);
-      return false;
-    }
+  str = (LISP$String *) malloc (sizeof (LISP$String));
+  if (str == NULL || (str->chars = (char *) malloc (length + 1)) == NULL) {
+    free (str);
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a string!");
+    return (LISP$M_NULLREF);
   }
-  else return false;
+  memcpy (str->chars, chars, length);
+  str->chars [length] = LISP$S_EOS;
+  str->length = length;
 
-  return true;
+  res = LISP$M_createObject (lmi, LongString);
+  if (res == LISP$M_NULLREF) { free (str->chars); free (str); return (res); }
+
+  (lmi->objTab [LISP$M_getRefId (res)]).data.string = str;
+  lmi->objBytes += sizeof (LISP$String) + length + 1;
+
+  return res;
 }
 
-void LISP$M_markMemNode (LISP$MachIns * lmi, LISP$Ref ref,
-                         LISP$MemState mark, bool recurse) {
+bool LISP$M_isString (LISP$MachIns * lmi, LISP$Ref ref) {
 
-  #ifdef DEBUG_LMI
-  fprintf (lmi->outputStream, "TRACE of %s for: ",
-      (mark == Free)? "FREE" :
-        ((mark == Temp)? "TEMP" :
-           (mark == Used)? "USED" : "PROT"));
-  LISP$S_writeAction (lmi, ref, 0);
-  fprintf (lmi->outputStream, "\n");
-  #endif
+  if (ref == LISP$M_NULLREF) return false;
 
-  LISP$Ref tmp;
   switch (LISP$M_getRefType (ref)) {
     case AtomTab:
-      /* Do not change protected internal values nor already marked */
-      if (lmi->atmIdx [LISP$M_getRefId (ref)] == Prot) return;
+      return ((lmi->atmTab [LISP$M_getRefId (ref)]).name [0] == '"');
+    case ObjectTab:
+      return ((lmi->objTab [LISP$M_getRefId (ref)]).type == LongString);
+    default:
+      return false;
+  }
+}
 
-      lmi->atmIdx [LISP$M_getRefId (ref)] = mark;
-      tmp = (lmi->atmTab [LISP$M_getRefId (ref)]).value;
+const char * LISP$M_getString (LISP$MachIns * lmi, LISP$Ref ref,
+                               size_t * length) {
 
-      /* Skip self-referencing nodes */
-      if (recurse && ref != tmp)
-        LISP$M_markMemNode (lmi, tmp, mark, true);
+  LISP$String * str;
+  const char *  name;
 
-      /* It could be lambda or special, so let's touch its bindlist too */
-      tmp = (lmi->atmTab [LISP$M_getRefId (ref)]).bindList;
-      if (recurse && ref != tmp)
-        LISP$M_markMemNode (lmi, tmp, mark, true);
-      return;
+  if (LISP$M_getRefType (ref) == ObjectTab) {
+    str = (lmi->objTab [LISP$M_getRefId (ref)]).data.string;
+    *length = str->length;
+    return (str->chars);
+  }
 
-    case NumberTab:
-      lmi->numIdx [LISP$M_getRefId (ref)] = mark;
-      return;
+  name = (lmi->atmTab [LISP$M_getRefId (ref)]).name;
+  *length = strlen (name) - 2;
+  return (name + 1);
+}
 
-    case ListTab:
+char * LISP$M_copyString (LISP$MachIns * lmi, LISP$Ref ref,
+                          const char * name) {
+
+  const char * chars;
+  char *       res;
+  size_t       length;
+
+  if (!LISP$M_isString (lmi, ref)) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a string argument!", name);
+    return NULL;
+  }
+
+  chars = LISP$M_getString (lmi, ref, &length);
+  if ((res = (char *) malloc (length + 1)) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a string!");
+    return NULL;
+  }
+  memcpy (res, chars, length);
+  res [length] = LISP$S_EOS;
+
+  return res;
+}
+
+int LISP$M_compareExact (LISP$MachIns * lmi, LISP$Ref x, LISP$Ref y) {
+
+  LISP$Bignum   bx, by;
+  LISP$Bignum * b;
+  uint32_t      lx [LISP$B_INT_LIMBS], ly [LISP$B_INT_LIMBS];
+  double        d, t;
+  int           res;
+
+  if (!LISP$M_isExact (lmi, x)) return (-LISP$M_compareExact (lmi, y, x));
+
+  /* The double is compared by its integral part, then by the rest */
+  if (!LISP$M_isExact (lmi, y)) {
+    d = LISP$M_getNumber (lmi, y);
+    if (isinf (d)) return ((d > 0)? -1 : 1);
+
+    t = trunc (d);
+    if ((b = LISP$B_fromDouble (t)) == NULL) {
+      t = LISP$M_getNumber (lmi, x);
+      return ((t > d) - (t < d));
+    }
+    res = LISP$B_compare (LISP$M_getBignum (lmi, x, &bx, lx), b);
+    LISP$B_free (b);
+
+    if (res != 0 || d == t) return res;
+    return ((d > t)? -1 : 1);
+  }
+
+  return (LISP$B_compare (LISP$M_getBignum (lmi, x, &bx, lx),
+                          LISP$M_getBignum (lmi, y, &by, ly)));
+}
+
+LISP$Ref LISP$M_createObject (LISP$MachIns * lmi, LISP$ObjectType type) {
+
+  LISP$Ref res = LISP$M_NULLREF;
+  int i = LISP$M_allocNode (lmi, ObjectTab);
+
+  if (i < 0) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL,
+        "OBJFUL", "Object table is full!");
+    return (LISP$M_NULLREF);
+  }
+
+  (lmi->objTab [i]).type = type;
+  memset (&((lmi->objTab [i]).data), 0, sizeof ((lmi->objTab [i]).data));
+  lmi->objIdx [i] = Temp;
+  lmi->objFree--;
+
+  LISP$M_setRef (res, i, ObjectTab);
+  return res;
+}
+
+/* Result of FUTURE -- the worker packs the value ($D_pack), or keeps   *
+ * the error; each copy of the promise unpacks the value into its own  *
+ * heap when it's touched. It's freed by the last one holding it       */
+struct LISP$Future {
+  pthread_mutex_t  lock;                        /* Guards all below     */
+  pthread_cond_t   isDone;                      /* ... or is copied     */
+  LISP$MachIns *   lmi;                         /* Caller, the template */
+  LISP$Ref         expr;
+  bool             isCopied;                    /* Has it been reset?   */
+  bool             isResolved;
+  char *           data;
+  size_t           length;
+  LISP$Error       error;
+  int              refs;                        /* Promises + the task  */
+};
+
+static void LISP$M_holdFuture (LISP$Future * f) {
+
+  pthread_mutex_lock (&(f->lock));
+  f->refs++;
+  pthread_mutex_unlock (&(f->lock));
+}
+
+static void LISP$M_releaseFuture (LISP$Future * f) {
+
+  bool isLast;
+
+  pthread_mutex_lock (&(f->lock));
+  isLast = (--(f->refs) == 0);
+  pthread_mutex_unlock (&(f->lock));
+  if (!isLast) return;
+
+  pthread_cond_destroy (&(f->isDone));
+  pthread_mutex_destroy (&(f->lock));
+  free (f->data);
+  free (f);
+}
+
+void LISP$M_freeObject (LISP$MachIns * lmi, int id) {
+
+  switch ((lmi->objTab [id]).type) {
+    case HashTable:
+      LISP$M_hashDestroy ((lmi->objTab [id]).data.hash);
+      break;
+
+    case RefVector:
+    case DoubleVector:
+      if ((lmi->objTab [id]).data.vector == NULL) break;
+      free (((lmi->objTab [id]).data.vector)->items.refs);
+      free ((lmi->objTab [id]).data.vector);
+      break;
+
+    case BigInteger:
+      LISP$B_free ((lmi->objTab [id]).data.bignum);
+      break;
+
+    case LongString:
+      if ((lmi->objTab [id]).data.string == NULL) break;
+      free (((lmi->objTab [id]).data.string)->chars);
+      free ((lmi->objTab [id]).data.string);
+      break;
+
+    /* A stream nobody refers to is closed, its output is flushed */
+    case Stream:
+      if ((lmi->objTab [id]).data.stream == NULL) break;
+      LISP$M_closeStream ((lmi->objTab [id]).data.stream);
+      free (((lmi->objTab [id]).data.stream)->reader);
+      free (((lmi->objTab [id]).data.stream)->writer);
+      free (((lmi->objTab [id]).data.stream)->name);
+      free ((lmi->objTab [id]).data.stream);
+      break;
+
+    /* Its stream is an object of its own, it's closed when it's freed */
+    case Sequence:
+      free ((lmi->objTab [id]).data.sequence);
+      break;
+
+    case Promise:
+      if ((lmi->objTab [id]).data.promise == NULL) break;
+      if (((lmi->objTab [id]).data.promise)->future != NULL)
+        LISP$M_releaseFuture (((lmi->objTab [id]).data.promise)->future);
+      free ((lmi->objTab [id]).data.promise);
+      break;
+  }
+
+  memset (&((lmi->objTab [id]).data), 0, sizeof ((lmi->objTab [id]).data));
+}
+
+bool LISP$M_cloneObject (LISP$ObjectRecord * obj) {
+
+  LISP$Vector * v;
+  LISP$String * str;
+  LISP$Stream * st;
+  size_t        size;
+
+  switch (obj->type) {
+    case HashTable:
+      if (obj->data.hash == NULL) return true;
+      obj->data.hash = LISP$M_hashClone (obj->data.hash);
+      return (obj->data.hash != NULL);
+
+    case RefVector:
+    case DoubleVector:
+      if ((v = obj->data.vector) == NULL) return true;
+      size = v->length * ((obj->type == RefVector)?
+                          sizeof (LISP$Ref) : sizeof (double));
+      if ((obj->data.vector = LISP$M_duplicate (v, sizeof (*v))) == NULL)
+        return false;
+      if ((obj->data.vector->items.refs =
+             LISP$M_duplicate (v->items.refs, size)) == NULL) {
+        free (obj->data.vector);
+        obj->data.vector = NULL;
+        return false;
+      }
+      return true;
+
+    case BigInteger:
+      if (obj->data.bignum == NULL) return true;
+      obj->data.bignum = LISP$B_copy (obj->data.bignum);
+      return (obj->data.bignum != NULL);
+
+    case LongString:
+      if ((str = obj->data.string) == NULL) return true;
+      if ((obj->data.string = LISP$M_duplicate (str, sizeof (*str))) == NULL)
+        return false;
+      if ((obj->data.string->chars =
+             LISP$M_duplicate (str->chars, str->length + 1)) == NULL) {
+        free (obj->data.string);
+        obj->data.string = NULL;
+        return false;
+      }
+      return true;
+
+    /* A file can't be shared, so the copy is closed */
+    case Stream:
+      if ((st = obj->data.stream) == NULL) return true;
+      obj->data.stream = (LISP$Stream *) calloc (1, sizeof (LISP$Stream));
+      if (obj->data.stream == NULL) return false;
+      if ((obj->data.stream->name =
+             LISP$M_duplicate (st->name, strlen (st->name) + 1)) == NULL) {
+        free (obj->data.stream);
+        obj->data.stream = NULL;
+        return false;
+      }
+      return true;
+
+    case Sequence:
+      if (obj->data.sequence == NULL) return true;
+      obj->data.sequence = LISP$M_duplicate (obj->data.sequence,
+                                             sizeof (LISP$Sequence));
+      return (obj->data.sequence != NULL);
+
+    case Promise:
+      if (obj->data.promise == NULL) return true;
+      obj->data.promise = LISP$M_duplicate (obj->data.promise,
+                                            sizeof (LISP$Promise));
+      if (obj->data.promise == NULL) return false;
+      if ((obj->data.promise)->future != NULL)
+        LISP$M_holdFuture ((obj->data.promise)->future);
+      return true;
+  }
+
+  return true;
+}
+
+void LISP$M_markObject (LISP$MachIns * lmi, int id, LISP$MemState mark) {
+
+  int i;
+  LISP$HashEntry * e;
+  LISP$HashTable * h;
+  LISP$Vector *    v;
+  LISP$Sequence *  q;
+  LISP$Promise *   p;
+
+  switch ((lmi->objTab [id]).type) {
+    case HashTable:
+      h = (lmi->objTab [id]).data.hash;
+      if (h == NULL) return;
+
+      for (i = h->rehashPos; i < h->oldSize; i++)
+        for (e = h->oldBuckets [i]; e != NULL; e = e->next)
+          if (e->key != LISP$M_NULLREF) {
+            LISP$M_markMemNode (lmi, e->key,   mark, true);
+            LISP$M_markMemNode (lmi, e->value, mark, true);
+          }
+
+      for (i = 0; i < h->size; i++)
+        for (e = h->buckets [i]; e != NULL; e = e->next)
+          if (e->key != LISP$M_NULLREF) {
+            LISP$M_markMemNode (lmi, e->key,   mark, true);
+            LISP$M_markMemNode (lmi, e->value, mark, true);
+          }
+      return;
+
+    case RefVector:
+      v = (lmi->objTab [id]).data.vector;
+      if (v == NULL) return;
+
+      for (i = 0; i < v->length; i++)
+        LISP$M_markMemNode (lmi, v->items.refs [i], mark, true);
+      return;
+
+    case Sequence:
+      q = (lmi->objTab [id]).data.sequence;
+      if (q == NULL) return;
+
+      LISP$M_markMemNode (lmi, q->source, mark, true);
+      LISP$M_markMemNode (lmi, q->fun,    mark, true);
+      return;
+
+    /* A forced promise refers just to its value */
+    case Promise:
+      p = (lmi->objTab [id]).data.promise;
+      if (p == NULL) return;
+
+      LISP$M_markMemNode (lmi, p->expr,     mark, true);
+      LISP$M_markMemNode (lmi, p->bindings, mark, true);
+      LISP$M_markMemNode (lmi, p->value,    mark, true);
+      return;
+
+    /* Unboxed numbers, chars and files don't refer to anything */
+    case DoubleVector:
+    case BigInteger:
+    case LongString:
+    case Stream:
+      return;
+  }
+}
+
+LISP$Ref LISP$M_getCreateAtom (LISP$MachIns * lmi, char * atomName) {
+
+  int i, h;
+  unsigned int hash = LISP$M_hashAtomName (atomName);
+  LISP$Ref res = LISP$M_NULLREF;
+
+  LISP$M_setRefType (res, AtomTab);
+
+  #ifdef DEBUG_LMI
+  LISP$M_throwMessage (lmi, 'D', "DEBUG",
+      "AtomLookUp (%s)", atomName);
+  #endif
+
+  /* Find out if the atom has been already stored -- the lookup hash *
+   * holds all the non-free atoms and it's rebuilt by each GC; names  *
+   * are compared as they're stored, truncated                        */
+  for (h = hash & (lmi->atmHashLen - 1);
+       (i = lmi->atmHash [h]) >= 0; h = (h + 1) & (lmi->atmHashLen - 1)) {
+    if ((lmi->atmTab [i]).hash == hash &&
+        !strncmp ((lmi->atmTab [i]).name, atomName,
+                  sizeof ((lmi->atmTab [i]).name) - 1)) {
+      LISP$M_setRefId (res, i);
+      #ifdef DEBUG_LMI
+      LISP$M_throwMessage (lmi, 'D', "DEBUG",
+          "%s found on position: " LISP$ADDRFMT, atomName, i);
+      #endif
+      return res;
+    }
+  }
+
+  /* Find free space for a new atom */
+  i = LISP$M_allocNode (lmi, AtomTab);
+
+  /* Nothing found, let's try to settle a new AtomRec -- the hash may *
+   * have been rebuilt by growing the table, so find the slot again    */
+  if (i >= 0) {
+    LISP$M_setRefId (res, i); lmi->atmIdx [i] = Temp;
+    lmi->atmFree--;
+
+    for (h = hash & (lmi->atmHashLen - 1);
+         lmi->atmHash [h] >= 0; h = (h + 1) & (lmi->atmHashLen - 1));
+    lmi->atmHash [h] = i;
+
+    /* A longer name is truncated, as it's looked up */
+    strlcpy ((lmi->atmTab [i]).name, atomName,
+             sizeof ((lmi->atmTab [i]).name) - 1);
+    (lmi->atmTab [i]).name [sizeof ((lmi->atmTab [i]).name) - 1] =
+      LISP$S_EOS;
+    (lmi->atmTab [i]).hash     = hash;
+    (lmi->atmTab [i]).type     = Undefined;
+    (lmi->atmTab [i]).value    = lmi->NIL;
+    (lmi->atmTab [i]).bindList = lmi->NIL;
+//    (lmi->atmTab [i]).propList = lmi->NIL;
+
+    #ifdef DEBUG_LMI
+    LISP$M_throwMessage (lmi, 'D', "DEBUG",
+        "%s created on position " LISP$ADDRFMT " (ref="
+        LISP$ADDRFMT ")", atomName, i, res);
+    #endif
+
+    return res;
+  }
+
+  /* Nothing created, table is full */
+  LISP$M_setError (lmi, LISP$_ERR$S_ATMFUL,
+      "ATMFUL", "Atom table is full!");
+  return (LISP$M_NULLREF);
+}
+
+bool LISP$M_isOptionEnabled (LISP$MachIns * lmi, const char * option) {
+
+  /* LMI is not initialized yet, so prevent all option lookups      */
+  if (!lmi->isReady) return false;
+
+  /* Built-in options are looked up on each evaluation step, so their *
+   * atoms are cached in LMI; they're Used and never collected        */
+  LISP$Ref ref =
+    (!strcmp (option, LISP$M_OPT_TRACE))? lmi->optTrace :
+    (!strcmp (option, LISP$M_OPT_LOG))?   lmi->optLog   :
+    (!strcmp (option, LISP$M_OPT_GC))?    lmi->optGC    :
+      LISP$M_getCreateAtom (lmi, (char *) option);
+
+  /* Feature is enabled <=> the option symbol is set to T */
+  return ((lmi->atmTab [LISP$M_getRefId (ref)]).value == lmi->T);
+}
+
+bool LISP$M_isSpecialForm (LISP$AtomRecord atom) {
+
+  return (atom.type == BuiltInSpecForm ||
+          atom.type == UserDefSpecForm ||
+          atom.type == UnnamedSpecForm);
+}
+
+bool LISP$M_isFunction (LISP$AtomRecord atom) {
+
+  return (atom.type == BuiltInFun ||
+          atom.type == UserDefFun ||
+          atom.type == UnnamedFun);
+}
+
+bool LISP$M_checkBuiltIn (LISP$MachIns * lmi, const char * name,
+                          LISP$AtomRecord builtIn,
+                          LISP$ListRecord argv, int argc,
+                          int argcMin, double argcMax) {
+
+  /* XXX: just to prevent compiler warning -- could be used later... */
+  if (&argv != &argv) return false;
+
+  /* Check the name -- the first character rejects most of the built-ins *
+   * without a call, this is done for each of them on each application  */
+  if (builtIn.name [0] == name [0] && !strcmp (builtIn.name, name)) {
+    /* Name is ok, check the argument vector */
+    if (!LISP$IS_NINF (argcMax) && argc < argcMin) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+                       "Too few (%d) arguments for %s!", argc, name);
+      return false;
+    }
+    else if (!LISP$IS_NINF (argcMax) &&
+             !LISP$IS_INF  (argcMax) && argc > argcMax) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+                       "Too much (%d) arguments for %s!", argc, name);
+      return false;
+    }
+  }
+  else return false;
+
+  return true;
+}
+
+void LISP$M_markMemNode (LISP$MachIns * lmi, LISP$Ref ref,
+                         LISP$MemState mark, bool recurse) {
+
+  #ifdef DEBUG_LMI
+  LISP$Writer w;
+  LISP$W_openStream (&w, lmi->outputStream);
+  LISP$W_printf (&w, "TRACE of %s for: ",
+      (mark == Free)? "FREE" :
+        ((mark == Temp)? "TEMP" :
+           (mark == Used)? "USED" : "PROT"));
+  LISP$S_writeAction (lmi, &w, ref, 0);
+  LISP$W_putChar (&w, '\n');
+  LISP$W_close (&w);
+  #endif
+
+  LISP$Ref tmp;
+  switch (LISP$M_getRefType (ref)) {
+    case AtomTab:
+      /* Do not change protected internal values nor already marked */
+      if (lmi->atmIdx [LISP$M_getRefId (ref)] == Prot) return;
+
+      lmi->atmIdx [LISP$M_getRefId (ref)] = mark;
+      tmp = (lmi->atmTab [LISP$M_getRefId (ref)]).value;
+
+      /* Skip self-referencing nodes */
+      if (recurse && ref != tmp)
+        LISP$M_markMemNode (lmi, tmp, mark, true);
+
+      /* It could be lambda or special, so let's touch its bindlist too */
+      tmp = (lmi->atmTab [LISP$M_getRefId (ref)]).bindList;
+      if (recurse && ref != tmp)
+        LISP$M_markMemNode (lmi, tmp, mark, true);
+      return;
+
+    case NumberTab:
+      lmi->numIdx [LISP$M_getRefId (ref)] = mark;
+      return;
+
+    case ObjectTab:
+      /* Objects may hold each other in cycles, so walk each just once */
+      if (lmi->objIdx [LISP$M_getRefId (ref)] == Prot ||
+          lmi->objIdx [LISP$M_getRefId (ref)] == mark) return;
+
+      lmi->objIdx [LISP$M_getRefId (ref)] = mark;
+      if (recurse) LISP$M_markObject (lmi, LISP$M_getRefId (ref), mark);
+      return;
+
+    case ListTab:
       if (!recurse) break;
 
       /* XXX: This COULD skip something marked as Temp deeper in the list!! */
@@ -522,6 +1564,7 @@ bool LISP$M_checkMemNodeState (LISP$MachIns * lmi, LISP$Ref ref,
     case AtomTab:   return (lmi->atmIdx [LISP$M_getRefId (ref)] == mark);
     case NumberTab: return (lmi->numIdx [LISP$M_getRefId (ref)] == mark);
     case ListTab:   return (lmi->lstIdx [LISP$M_getRefId (ref)] == mark);
+    case ObjectTab: return (lmi->objIdx [LISP$M_getRefId (ref)] == mark);
     default:        return false;
   }
 }
@@ -534,28 +1577,104 @@ void LISP$M_collectGarbage (LISP$MachIns * lmi) {
   int i;
   LISP$Ref ref = LISP$M_NULLREF;
 
+  /* Lists, numbers and objects are garbage unless they're reachable,  *
+   * even if they were Used once -- this also makes the marking below  *
+   * complete since no Used list can hide a Temp one anymore           */
+  for (i = 0; i < lmi->lstLen; i++)
+    if (lmi->lstIdx [i] == Used) lmi->lstIdx [i] = Temp;
+  for (i = 0; i < lmi->numLen; i++)
+    if (lmi->numIdx [i] == Used) lmi->numIdx [i] = Temp;
+  for (i = 0; i < lmi->objLen; i++)
+    if (lmi->objIdx [i] == Used) lmi->objIdx [i] = Temp;
+
   /* Find all roots -- symbols marked as Used -- and mark their tree */
   LISP$M_setRefType (ref, AtomTab);
-  for (i = 0; i < LISP$MACH_ATMTABLEN; i++) {
+  for (i = 0; i < lmi->atmLen; i++) {
     if (lmi->atmIdx [i] == Used) {
       LISP$M_setRefId (ref, i);
       LISP$M_markMemNode (lmi, ref, Used, true);
     }
   }
 
+  /* Objects the evaluator is just working on are roots too */
+  for (i = 0; i < lmi->rootTop; i++)
+    if (lmi->rootStack [i] != LISP$M_NULLREF)
+      LISP$M_markMemNode (lmi, lmi->rootStack [i], Used, true);
+
   /* Mark all Temps as Free and discard their references to others */
-  for (i = 0; i < LISP$MACH_LSTTABLEN &&
-              i < LISP$MACH_LSTTABLEN &&
-              i < LISP$MACH_NUMTABLEN; i++) {
-    if (i < LISP$MACH_LSTTABLEN && lmi->lstIdx [i] == Temp)
-      lmi->lstIdx [i] = Free;
+  lmi->lstFree = lmi->atmFree = lmi->numFree = lmi->objFree = 0;
+  lmi->objBytes = 0;
+  for (i = 0; i < lmi->lstLen; i++) {
+    if (lmi->lstIdx [i] == Temp) lmi->lstIdx [i] = Free;
+    if (lmi->lstIdx [i] == Free) lmi->lstFree++;
+  }
+
+  for (i = 0; i < lmi->atmLen; i++) {
+    if (lmi->atmIdx [i] == Temp) lmi->atmIdx [i] = Free;
+    if (lmi->atmIdx [i] == Free) lmi->atmFree++;
+  }
+
+  /* Unreachable objects release their payload */
+  for (i = 0; i < lmi->objLen; i++) {
+    if (lmi->objIdx [i] == Temp) {
+      LISP$M_freeObject (lmi, i);
+      lmi->objIdx [i] = Free;
+    }
+    if (lmi->objIdx [i] == Free) lmi->objFree++;
+  }
+
+  for (i = 0; i < lmi->numLen; i++) {
+    if (lmi->numIdx [i] == Temp) lmi->numIdx [i] = Free;
+    if (lmi->numIdx [i] == Free) lmi->numFree++;
+  }
+
+  /* Rebuild the lookup hashes over the remaining atoms and numbers */
+  LISP$M_rehash (lmi, AtomTab);
+  LISP$M_rehash (lmi, NumberTab);
+}
+
+void LISP$M_pushRoot (LISP$MachIns * lmi, LISP$Ref ref) {
+
+  LISP$Ref * stack;
+  int length;
+
+  if (lmi->rootTop >= lmi->rootLen) {
+    length = (2 * lmi->rootLen < lmi->rootMax)? 2 * lmi->rootLen :
+                                                lmi->rootMax;
+    stack  = (lmi->rootTop < length)? (LISP$Ref *)
+      realloc (lmi->rootStack, length * sizeof (LISP$Ref)) : NULL;
 
-    if (i < LISP$MACH_ATMTABLEN && lmi->atmIdx [i] == Temp)
-      lmi->atmIdx [i] = Free;
+    if (stack == NULL) {
+      LISP$M_setError (lmi, LISP$_ERR$S_STKFUL, "STKFUL",
+          "Evaluation is nested too deep!");
+      return;
+    }
 
-    if (i < LISP$MACH_NUMTABLEN && lmi->numIdx [i] == Temp)
-      lmi->numIdx [i] = Free;
+    lmi->rootStack = stack;
+    lmi->rootLen   = length;
   }
+
+  lmi->rootStack [lmi->rootTop++] = ref;
+}
+
+void LISP$M_safePoint (LISP$MachIns * lmi) {
+
+  /* Collect when any of the tables is filled up over three quarters, *
+   * or when objects have taken a lot of memory outside the tables    */
+  if (lmi->lstFree >= lmi->lstLen / 4 &&
+      lmi->atmFree >= lmi->atmLen / 4 &&
+      lmi->numFree >= lmi->numLen / 4 &&
+      lmi->objFree >= lmi->objLen / 4 &&
+      lmi->objBytes <= LISP$MACH_OBJGCBYTES) return;
+
+  LISP$M_collectGarbage (lmi);
+
+  /* Tables which are still over half full are grown now, so that the *
+   * next collection doesn't come right after this one                */
+  if (lmi->lstFree < lmi->lstLen / 2) LISP$M_growTable (lmi, ListTab);
+  if (lmi->atmFree < lmi->atmLen / 2) LISP$M_growTable (lmi, AtomTab);
+  if (lmi->numFree < lmi->numLen / 2) LISP$M_growTable (lmi, NumberTab);
+  if (lmi->objFree < lmi->objLen / 2) LISP$M_growTable (lmi, ObjectTab);
 }
 
 void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full) {
@@ -566,7 +1685,8 @@ void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full) {
 
 #define GET_REF_STRING(ref) \
   (LISP$M_getRefType (ref) == AtomTab)? "ATM" : \
-    ((LISP$M_getRefType (ref) == ListTab)? "LST" : "NUM")
+    ((LISP$M_getRefType (ref) == ListTab)? "LST" : \
+      ((LISP$M_getRefType (ref) == NumberTab)? "NUM" : "OBJ"))
 
 #define UPDATE_COUNTER(type) \
   ((lmi->type##Idx [i] == Temp)? type##Temp++ : \
@@ -576,7 +1696,7 @@ void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full) {
   int i;
   int atmFree, atmUsed, atmTemp, atmProt;
   atmFree = atmUsed = atmTemp = atmProt = 0;
-  for (i = 0; i < LISP$MACH_ATMTABLEN; i++) {
+  for (i = 0; i < lmi->atmLen; i++) {
     if (full && lmi->atmIdx [i] != Free)
       LISP$M_throwMessage (lmi, 'I', "MEMDUMP", "ATM#" LISP$ADDRFMT
           " [STA:%s  NAM:%-10.10s  VAL:%s#" LISP$ADDRFMT "]",
@@ -589,7 +1709,7 @@ void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full) {
 
   int lstFree, lstUsed, lstTemp, lstProt;
   lstFree = lstUsed = lstTemp = lstProt = 0;
-  for (i = 0; i < LISP$MACH_LSTTABLEN; i++) {
+  for (i = 0; i < lmi->lstLen; i++) {
     if (full && lmi->lstIdx [i] != Free)
       LISP$M_throwMessage (lmi, 'I', "MEMDUMP", "LST#" LISP$ADDRFMT
           " [STA:%s  CAR:%s#" LISP$ADDRFMT "  CDR:%s#" LISP$ADDRFMT "]",
@@ -603,14 +1723,28 @@ void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full) {
 
   int numFree, numUsed, numTemp, numProt;
   numFree = numUsed = numTemp = numProt = 0;
-  for (i = 0; i < LISP$MACH_NUMTABLEN; i++) {
-    if (full && lmi->numIdx [i] != Free)
+  for (i = 0; i < lmi->numLen; i++) {
+    if (full && lmi->numIdx [i] != Free && (lmi->numTab [i]).isInt)
+      LISP$M_throwMessage (lmi, 'I', "MEMDUMP", "NUM#" LISP$ADDRFMT
+          " [STA:%s  INT:%26lld]", i, GET_STATUS_STRING (lmi->numIdx),
+          (long long) (lmi->numTab [i]).val.i);
+    else if (full && lmi->numIdx [i] != Free)
       LISP$M_throwMessage (lmi, 'I', "MEMDUMP", "NUM#" LISP$ADDRFMT
           " [STA:%s  VAL:%26e]", i, GET_STATUS_STRING (lmi->numIdx),
-          lmi->numTab [i]);
+          (lmi->numTab [i]).val.d);
     UPDATE_COUNTER (num);
   }
 
+  int objFree, objUsed, objTemp, objProt;
+  objFree = objUsed = objTemp = objProt = 0;
+  for (i = 0; i < lmi->objLen; i++) {
+    if (full && lmi->objIdx [i] != Free)
+      LISP$M_throwMessage (lmi, 'I', "MEMDUMP", "OBJ#" LISP$ADDRFMT
+          " [STA:%s  TYP:%d]", i, GET_STATUS_STRING (lmi->objIdx),
+          (lmi->objTab [i]).type);
+    UPDATE_COUNTER (obj);
+  }
+
   LISP$M_throwMessage (lmi, 'I', "MEMDUMP",
       "ATMTAB: Free %4d; Temp %4d; Used %4d; Prot %4d;",
       atmFree, atmTemp, atmUsed, atmProt);
@@ -623,6 +1757,10 @@ void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full) {
       "NUMTAB: Free %4d; Temp %4d; Used %4d; Prot %4d;",
       numFree, numTemp, numUsed, lstProt);
 
+  LISP$M_throwMessage (lmi, 'I', "MEMDUMP",
+      "OBJTAB: Free %4d; Temp %4d; Used %4d; Prot %4d;",
+      objFree, objTemp, objUsed, objProt);
+
 #undef UPDATE_COUNTER
 #undef GET_REF_STRING
 #undef GET_STATUS_STRING
@@ -664,9 +1802,9 @@ LISP$Ref LISP$M_builtInSETQ (LISP$MachIns * lmi, LISP$Ref args, int level) {
       (lmi->lstTab [LISP$M_getRefId (tmpx)]).car, level);
   if (tmpx == LISP$M_NULLREF) return (LISP$M_NULLREF);
 
-  /* Discard old value if any */
-  if ((lmi->atmTab [LISP$M_getRefId (tmp)]).type != Undefined)
-    LISP$M_markMemNode (lmi, tmp, Temp, true);
+  /* NOTE: the old value is not marked as Temp here anymore -- GC finds *
+   * it's unreachable itself, while marking would demote other atoms   *
+   * still Used and referenced from it                                 */
 
   /* Just copy a value/type/bindList if they're both atoms */
   if (LISP$M_getRefType (tmpx) == AtomTab &&
@@ -713,57 +1851,179 @@ LISP$Ref LISP$M_builtInCONS (LISP$MachIns * lmi, LISP$Ref args) {
 LISP$Ref LISP$M_builtInArithmetic (LISP$MachIns * lmi, LISP$Ref args,
                                    int argc, const char * oper) {
 
-  double comp = 0;
+  /* The result is computed exactly in 'icomp' while all arguments are *
+   * integers and nothing overflows, in 'bcomp' bignum after the first *
+   * overflow and in 'comp' double since the first inexact step        */
+  int64_t icomp = 0, n = 0, r;
+  double  comp = 0, x;
+  bool isInt = true, ovf, inexact;
   bool compInProgress = false;
+  LISP$Bignum * bcomp = NULL, * bres, * brem, * y, by;
+  uint32_t      byLimbs [LISP$B_INT_LIMBS];
   LISP$Ref tmp  = args;
   LISP$Ref tmpx = LISP$M_NULLREF;
   while (tmp != lmi->NIL) {
     tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
-    if (LISP$M_getRefType (tmpx) != NumberTab) {
+    if (!LISP$M_isNumber (lmi, tmpx)) {
       LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
           "%s works only with numeric arguments!", oper);
+      LISP$B_free (bcomp);
       return (LISP$M_NULLREF);
     }
 
-    switch (oper [0]) {
-      case '+':
-        comp += lmi->numTab [LISP$M_getRefId (tmpx)];
-        break;
-
-      case '-':
-        if (compInProgress || argc == 1)
-          comp -= lmi->numTab [LISP$M_getRefId (tmpx)];
-        else
-          comp  = lmi->numTab [LISP$M_getRefId (tmpx)];
-        break;
+    if (oper [0] == '%') {
+      /* Integral doubles are accepted as well */
+      if (LISP$M_getInteger (lmi, tmpx, &n))
+        y = LISP$B_wrapInt (&by, byLimbs, n);
+      else if (LISP$M_isBignum (lmi, tmpx))
+        y = LISP$M_getBignum (lmi, tmpx, &by, byLimbs);
+      else {
+        LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+            "Modulo gets only integer arguments!");
+        LISP$B_free (bcomp);
+        return (LISP$M_NULLREF);
+      }
 
-      case '*':
-        if (!compInProgress) comp = 1;
-          comp *= lmi->numTab [LISP$M_getRefId (tmpx)];
-        break;
+      if (compInProgress && !y->length) {
+        LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+            "Zero division!");
+        LISP$B_free (bcomp);
+        return (LISP$M_NULLREF);
+      }
 
-      case '/':
-        if (compInProgress) {
-          if (!lmi->numTab [LISP$M_getRefId (tmpx)]) {
-            LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-                "Zero division!");
-            return (LISP$M_NULLREF);
-          }
-          comp /= lmi->numTab [LISP$M_getRefId (tmpx)];
+      if (bcomp == NULL && !LISP$M_isBignum (lmi, tmpx)) {
+        if (!compInProgress) icomp = n;
+        else icomp = (n == -1)? 0 : icomp % n;
+      }
+      else {
+        bres = NULL;
+        if (!compInProgress) bres = LISP$B_copy (y);
+        else if (bcomp != NULL || (bcomp = LISP$B_fromInt (icomp)) != NULL)
+          LISP$B_divMod (bcomp, y, NULL, &bres);
+        if (bres == NULL) break;
+        LISP$B_free (bcomp); bcomp = bres;
+      }
+    }
+
+    else {
+      /* Integer fast path, an overflow moves it on to bignums */
+      if (isInt && bcomp == NULL &&
+          LISP$M_getRefType (tmpx) == NumberTab &&
+          (lmi->numTab [LISP$M_getRefId (tmpx)]).isInt) {
+        n = (lmi->numTab [LISP$M_getRefId (tmpx)]).val.i;
+        r = n; ovf = inexact = false;
+        switch (oper [0]) {
+          case '+':
+            ovf = LISP$ADD_OVERFLOW (icomp, n, &r);
+            break;
+
+          case '-':
+            if (compInProgress || argc == 1)
+              ovf = LISP$SUB_OVERFLOW (icomp, n, &r);
+            break;
+
+          case '*':
+            if (compInProgress) ovf = LISP$MUL_OVERFLOW (icomp, n, &r);
+            break;
+
+          /* Only an exact quotient stays integer */
+          case '/':
+            if (compInProgress) {
+              if (!n) {
+                LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+                    "Zero division!");
+                return (LISP$M_NULLREF);
+              }
+              if (n == -1) ovf = (icomp == INT64_MIN);
+              else inexact = (icomp % n != 0);
+              if (!ovf && !inexact) r = icomp / n;
+            }
+            break;
         }
-        else comp = lmi->numTab [LISP$M_getRefId (tmpx)];
-        break;
 
-      case '%':
-        if (((double) ((int) lmi->numTab [LISP$M_getRefId (tmpx)]))
-            != lmi->numTab [LISP$M_getRefId (tmpx)]) {
-          LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-              "Modulo gets only integer arguments!");
+        if (!ovf && !inexact) {
+          icomp = r;
+          compInProgress = true;
+          tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+          continue;
+        }
+        if (ovf && (bcomp = LISP$B_fromInt (icomp)) == NULL) break;
+      }
+
+      /* A big integer joins the exact computation as well */
+      else if (isInt && bcomp == NULL && LISP$M_isBignum (lmi, tmpx) &&
+               (bcomp = LISP$B_fromInt (icomp)) == NULL) break;
+
+      /* Bignum path, an inexact quotient moves it on to doubles */
+      if (bcomp != NULL && LISP$M_isExact (lmi, tmpx)) {
+        y = LISP$M_getBignum (lmi, tmpx, &by, byLimbs);
+        bres = brem = NULL;
+
+        if (!compInProgress)
+          bres = (oper [0] == '-' && argc == 1)?
+                   LISP$B_sub (bcomp, y) : LISP$B_copy (y);
+        else switch (oper [0]) {
+          case '+': bres = LISP$B_add (bcomp, y); break;
+          case '-': bres = LISP$B_sub (bcomp, y); break;
+          case '*': bres = LISP$B_mul (bcomp, y); break;
+          case '/':
+            if (!y->length) {
+              LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+                  "Zero division!");
+              LISP$B_free (bcomp);
+              return (LISP$M_NULLREF);
+            }
+            if (!LISP$B_divMod (bcomp, y, &bres, &brem)) bres = NULL;
+            break;
         }
-        if (compInProgress)
-          comp = ((int) comp) % ((int) lmi->numTab [LISP$M_getRefId (tmpx)]);
-        else comp = lmi->numTab [LISP$M_getRefId (tmpx)];
-        break;
+        if (bres == NULL) break;
+
+        if (brem == NULL || !brem->length) {
+          LISP$B_free (bcomp); bcomp = bres;
+          LISP$B_free (brem);
+          compInProgress = true;
+          tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+          continue;
+        }
+        LISP$B_free (bres); LISP$B_free (brem);
+      }
+
+      if (isInt) {
+        comp  = (bcomp != NULL)? LISP$B_toDouble (bcomp) : (double) icomp;
+        isInt = false;
+        LISP$B_free (bcomp); bcomp = NULL;
+      }
+      x = LISP$M_getNumber (lmi, tmpx);
+
+      switch (oper [0]) {
+        case '+':
+          comp += x;
+          break;
+
+        case '-':
+          if (compInProgress || argc == 1)
+            comp -= x;
+          else
+            comp  = x;
+          break;
+
+        case '*':
+          if (!compInProgress) comp = 1;
+            comp *= x;
+          break;
+
+        case '/':
+          if (compInProgress) {
+            if (!x) {
+              LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+                  "Zero division!");
+              return (LISP$M_NULLREF);
+            }
+            comp /= x;
+          }
+          else comp = x;
+          break;
+      }
     }
 
     /* Keep information that we've something computed yet */
@@ -772,265 +2032,3089 @@ LISP$Ref LISP$M_builtInArithmetic (LISP$MachIns * lmi, LISP$Ref args,
     /* Move to next argument */
     tmp  = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
   }
-  return (LISP$M_getCreateNumber (lmi, comp));
+
+  /* The loop is left early only if a bignum cannot be allocated */
+  if (tmp != lmi->NIL) {
+    LISP$B_free (bcomp);
+    return (LISP$M_createBignum (lmi, NULL));
+  }
+
+  if (bcomp != NULL) return (LISP$M_createBignum (lmi, bcomp));
+  return (isInt? LISP$M_getCreateInteger (lmi, icomp) :
+                 LISP$M_getCreateNumber (lmi, comp));
 }
 
-LISP$Ref LISP$M_builtInIS (LISP$MachIns * lmi, LISP$Ref args) {
+bool LISP$M_checkNumberArgs (LISP$MachIns * lmi, LISP$Ref args,
+                             const char * name) {
 
-  /* XXX: doesn't work for numbers, why?! */
-  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
-  LISP$Ref tmp  = list.cdr;
+  for (; args != lmi->NIL; args = (lmi->lstTab [LISP$M_getRefId (args)]).cdr)
+    if (!LISP$M_isNumber (lmi, (lmi->lstTab [LISP$M_getRefId (args)]).car)) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "%s works only with numeric arguments!", name);
+      return false;
+    }
 
-  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  return true;
+}
 
-  return ((list.car == tmp)? lmi->T : lmi->NIL);
+LISP$Ref LISP$M_createIntegral (LISP$MachIns * lmi, double num,
+                                const char * name) {
+
+  if (!isfinite (num)) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a finite number!", name);
+    return (LISP$M_NULLREF);
+  }
+
+  /* 2^63 is the first double which doesn't fit */
+  if (num >= -9223372036854775808.0 && num < 9223372036854775808.0)
+    return (LISP$M_getCreateInteger (lmi, (int64_t) num));
+
+  return (LISP$M_createBignum (lmi, LISP$B_fromDouble (num)));
 }
 
-LISP$Ref LISP$M_builtInCOND (LISP$MachIns * lmi, LISP$Ref args, int level) {
+LISP$Ref LISP$M_builtInMATH (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             const char * name) {
 
-  LISP$Ref tmp  = args;
-  LISP$Ref tmpx = LISP$M_NULLREF;
-  LISP$ListRecord list;
+  LISP$Ref x = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref y;
+  double   v;
 
-  while (tmp != lmi->NIL) {
-    tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
-    list = lmi->lstTab [LISP$M_getRefId (tmpx)];
-    if (LISP$S_evalAction (lmi, list.car, level) != lmi->NIL) {
-      tmp = LISP$S_evalAction (lmi,
-          (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car, level);
-      return (tmp);
+  if (!LISP$M_checkNumberArgs (lmi, args, name)) return (LISP$M_NULLREF);
+  v = LISP$M_getNumber (lmi, x);
+
+  switch (name [0]) {
+    case 'S':
+      v = (name [1] == 'Q')? sqrt (v) : sin (v);
+      break;
+
+    case 'C':
+      v = cos (v);
+      break;
+
+    case 'E':
+      v = exp (v);
+      break;
+
+    /* LOG, optionally to the base of the second argument; big integers *
+     * have their logarithm even if they don't fit into a double         */
+    default:
+      if (LISP$M_isBignum (lmi, x))
+        v = LISP$B_log ((lmi->objTab [LISP$M_getRefId (x)]).data.bignum);
+      else v = log (v);
+
+      if (argc > 1) {
+        y = (lmi->lstTab [LISP$M_getRefId (
+              (lmi->lstTab [LISP$M_getRefId (args)]).cdr)]).car;
+        v /= LISP$M_isBignum (lmi, y)?
+               LISP$B_log ((lmi->objTab [LISP$M_getRefId (y)]).data.bignum) :
+               log (LISP$M_getNumber (lmi, y));
+      }
+      break;
+  }
+
+  return (LISP$M_getCreateNumber (lmi, v));
+}
+
+LISP$Ref LISP$M_builtInEXPT (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref      base  = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref      power = (lmi->lstTab [LISP$M_getRefId (
+                          (lmi->lstTab [LISP$M_getRefId (args)]).cdr)]).car;
+  LISP$Bignum * bb, * br, * tmp, bw;
+  uint32_t      bwLimbs [LISP$B_INT_LIMBS];
+  int64_t       b, p, r = 1;
+
+  if (!LISP$M_checkNumberArgs (lmi, args, "EXPT")) return (LISP$M_NULLREF);
+
+  /* Only an integer to a non-negative integer power stays exact */
+  if (!LISP$M_isExact (lmi, base) ||
+      LISP$M_getRefType (power) != NumberTab ||
+      !(lmi->numTab [LISP$M_getRefId (power)]).isInt ||
+      (p = (lmi->numTab [LISP$M_getRefId (power)]).val.i) < 0)
+    return (LISP$M_getCreateNumber (lmi, pow (LISP$M_getNumber (lmi, base),
+                                              LISP$M_getNumber (lmi, power))));
+
+  /* Exponentiation by squaring -- in 64 bits while nothing overflows, *
+   * then once again from the beginning with bignums                    */
+  if (LISP$M_getRefType (base) == NumberTab) {
+    b = (lmi->numTab [LISP$M_getRefId (base)]).val.i;
+    for (;;) {
+      if ((p & 1) && LISP$MUL_OVERFLOW (r, b, &r)) break;
+      if (!(p >>= 1)) return (LISP$M_getCreateInteger (lmi, r));
+      if (LISP$MUL_OVERFLOW (b, b, &b)) break;
     }
-    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    p = (lmi->numTab [LISP$M_getRefId (power)]).val.i;
   }
 
-  LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-      "No COND's argument where to fall!");
-  return (LISP$M_NULLREF);
+  br = LISP$B_fromInt (1);
+  bb = LISP$B_copy (LISP$M_getBignum (lmi, base, &bw, bwLimbs));
+  if (br == NULL || bb == NULL) { LISP$B_free (br); br = NULL; }
+
+  while (br != NULL) {
+    if (p & 1) { tmp = LISP$B_mul (br, bb); LISP$B_free (br); br = tmp; }
+    if (br == NULL || !(p >>= 1)) break;
+
+    tmp = LISP$B_mul (bb, bb); LISP$B_free (bb); bb = tmp;
+    if (bb == NULL) { LISP$B_free (br); br = NULL; }
+  }
+
+  LISP$B_free (bb);
+  return (LISP$M_createBignum (lmi, br));
 }
 
-LISP$Ref LISP$M_builtInLOAD (LISP$MachIns * lmi, LISP$Ref args, int level) {
+LISP$Ref LISP$M_builtInROUND (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                              const char * name) {
+
+  LISP$Ref      x = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref      y = x;
+  LISP$Bignum * bx, * by, * bq, * br, * tmp, wx, wy, wone, ar, ad;
+  uint32_t      lx [LISP$B_INT_LIMBS], ly [LISP$B_INT_LIMBS];
+  uint32_t      lone [LISP$B_INT_LIMBS];
+  int64_t       a, d, q, r;
+  uint64_t      ur, ud;
+  double        v;
+  int           dir = 0;
+
+  if (!LISP$M_checkNumberArgs (lmi, args, name)) return (LISP$M_NULLREF);
+  if (argc > 1)
+    y = (lmi->lstTab [LISP$M_getRefId (
+          (lmi->lstTab [LISP$M_getRefId (args)]).cdr)]).car;
+
+  /* Inexact numbers are rounded as doubles, halves away from zero */
+  if (!LISP$M_isExact (lmi, x) || !LISP$M_isExact (lmi, y)) {
+    v = LISP$M_getNumber (lmi, x);
+    if (argc > 1) {
+      if (!LISP$M_getNumber (lmi, y)) {
+        LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+            "Zero division!");
+        return (LISP$M_NULLREF);
+      }
+      v /= LISP$M_getNumber (lmi, y);
+    }
 
-  LISP$Ref tmp =
-    LISP$S_evalAction (lmi, (lmi->lstTab [LISP$M_getRefId (args)]).car, level);
+    v = (name [0] == 'F')? floor (v) : (name [0] == 'C')? ceil (v) : round (v);
+    return (LISP$M_createIntegral (lmi, v, name));
+  }
 
-  if (LISP$M_getRefType (tmp) != AtomTab ||
-      (lmi->atmTab [LISP$M_getRefId (tmp)]).name [0] != '"') {
-    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-        "LOAD gets just one string argument!");
+  /* An integer is rounded already */
+  if (argc == 1) return (x);
+
+  by = LISP$M_getBignum (lmi, y, &wy, ly);
+  if (!by->length) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS", "Zero division!");
     return (LISP$M_NULLREF);
   }
 
-  LISP$AtomRecord atom = lmi->atmTab [LISP$M_getRefId (tmp)];
-  atom.name [strlen (atom.name) -1] = LISP$S_EOS;
+  /* Exact quotient -- the truncated one is moved by the remainder */
+  if (LISP$M_getRefType (x) == NumberTab &&
+      LISP$M_getRefType (y) == NumberTab) {
+    a = (lmi->numTab [LISP$M_getRefId (x)]).val.i;
+    d = (lmi->numTab [LISP$M_getRefId (y)]).val.i;
 
-  return (LISP$S_loadFile (lmi, atom.name + 1)? lmi->T : lmi->NIL);
-}
+    if (a != INT64_MIN || d != -1) {
+      q = a / d; r = a % d;
+      ur = (r < 0)? -(uint64_t) r : (uint64_t) r;
+      ud = (d < 0)? -(uint64_t) d : (uint64_t) d;
 
-LISP$Ref LISP$M_builtInSHOWMEM (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+      if (r && name [0] == 'F' && (r < 0) != (d < 0)) q--;
+      else if (r && name [0] == 'C' && (r < 0) == (d < 0)) q++;
+      else if (r && name [0] == 'R' && ur >= ud - ur)
+        q += ((r < 0) != (d < 0))? -1 : 1;
 
-  int len = 0;
-  LISP$Ref tmp = LISP$M_NULLREF;
-  LISP$AtomRecord atom;
+      return (LISP$M_getCreateInteger (lmi, q));
+    }
+  }
 
-  if (argc) {
-    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-    atom = lmi->atmTab [LISP$M_getRefId (tmp)];
-    len = strlen (atom.name);
-    if (strncmp (atom.name, "FULL", (len > 4)? len : 4)) {
-      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-          "SHOW-MEM gets only one optional argument: FULL");
-      return (LISP$M_NULLREF);
+  bx = LISP$M_getBignum (lmi, x, &wx, lx);
+  if (!LISP$B_divMod (bx, by, &bq, &br))
+    return (LISP$M_createBignum (lmi, NULL));
+
+  if (br->length) {
+    if (name [0] == 'F' && br->negative != by->negative) dir = -1;
+    else if (name [0] == 'C' && br->negative == by->negative) dir = 1;
+    else if (name [0] == 'R') {
+      /* Compare magnitudes of the doubled remainder and the divisor */
+      ar = *br; ar.negative = false;
+      ad = *by; ad.negative = false;
+      tmp = LISP$B_add (&ar, &ar);
+      if (tmp != NULL && LISP$B_compare (tmp, &ad) >= 0)
+        dir = (br->negative != by->negative)? -1 : 1;
+      LISP$B_free (tmp);
     }
-    else LISP$M_printMemoryDump (lmi, true);
   }
-  else LISP$M_printMemoryDump (lmi, false);
 
-  return (lmi->T);
+  if (dir) {
+    tmp = LISP$B_add (bq, LISP$B_wrapInt (&wone, lone, dir));
+    LISP$B_free (bq); bq = tmp;
+  }
+
+  LISP$B_free (br);
+  return (LISP$M_createBignum (lmi, bq));
 }
 
-LISP$Ref LISP$M_builtInGETLPI (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+LISP$Ref LISP$M_builtInMINMAX (LISP$MachIns * lmi, LISP$Ref args,
+                               const char * name) {
+
+  LISP$Ref res = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref x;
+  bool     isMin = (name [1] == 'I');
+
+  if (!LISP$M_checkNumberArgs (lmi, args, name)) return (LISP$M_NULLREF);
+
+  /* The argument itself is returned, so it keeps its exactness */
+  for (args = (lmi->lstTab [LISP$M_getRefId (args)]).cdr; args != lmi->NIL;
+       args = (lmi->lstTab [LISP$M_getRefId (args)]).cdr) {
+    x = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+    if (isMin? LISP$M_compareNumbers (lmi, x, res, <) :
+               LISP$M_compareNumbers (lmi, x, res, >))
+      res = x;
+  }
+
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInABS (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref            x = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$NumberRecord * rec;
+  LISP$Bignum *       b;
+
+  if (!LISP$M_checkNumberArgs (lmi, args, "ABS")) return (LISP$M_NULLREF);
+
+  if (LISP$M_isBignum (lmi, x)) {
+    if (!((lmi->objTab [LISP$M_getRefId (x)]).data.bignum)->negative)
+      return (x);
+    b = LISP$B_copy ((lmi->objTab [LISP$M_getRefId (x)]).data.bignum);
+    if (b != NULL) b->negative = false;
+    return (LISP$M_createBignum (lmi, b));
+  }
+
+  rec = &(lmi->numTab [LISP$M_getRefId (x)]);
+  if (!rec->isInt) return (LISP$M_getCreateNumber (lmi, fabs (rec->val.d)));
+  if (rec->val.i >= 0) return (x);
+
+  /* -INT64_MIN is the only one which doesn't fit */
+  if (rec->val.i != INT64_MIN)
+    return (LISP$M_getCreateInteger (lmi, -rec->val.i));
+
+  b = LISP$B_fromInt (INT64_MIN);
+  if (b != NULL) b->negative = false;
+  return (LISP$M_createBignum (lmi, b));
+}
+
+LISP$Ref LISP$M_builtInWRITETOSTRING (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Writer w;
+  LISP$Ref    res = LISP$M_NULLREF;
+
+  LISP$W_openString (&w);
+  LISP$S_writeAction (lmi, &w, (lmi->lstTab [LISP$M_getRefId (args)]).car,
+                      false);
+
+  if (w.isFailed)
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a string!");
+  else if (!LISP$M_isError (lmi))
+    res = LISP$M_createString (lmi, w.buffer, w.length);
+
+  LISP$W_close (&w);
+  return res;
+}
+
+LISP$Ref LISP$M_builtInWRITEBINARY (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  char *          fileName;
+  bool            res;
 
+  fileName = LISP$M_copyString (lmi,
+      (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car, "WRITE-BINARY");
+  if (fileName == NULL) return (LISP$M_NULLREF);
+
+  res = LISP$D_write (lmi, list.car, fileName);
+  free (fileName);
+
+  return (res? lmi->T : LISP$M_NULLREF);
+}
+
+LISP$Ref LISP$M_builtInREADBINARY (LISP$MachIns * lmi, LISP$Ref args) {
+
+  char *   fileName;
   LISP$Ref res;
-  LISP$Ref tmp = LISP$M_NULLREF;
-  LISP$AtomRecord atom;
 
-  if (argc) {
-    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-    atom = lmi->atmTab [LISP$M_getRefId (tmp)];
-    int i = 0, cnt = 0, len = strlen (atom.name);
+  fileName = LISP$M_copyString (lmi,
+      (lmi->lstTab [LISP$M_getRefId (args)]).car, "READ-BINARY");
+  if (fileName == NULL) return (LISP$M_NULLREF);
 
-    if (!strncmp (atom.name, "MODE", (len > 4)? len : 4)) {
-      if (lmi->mode == Interactive)
-        res = LISP$M_getCreateAtom (lmi, "INTERACTIVE");
-      else
-        res = LISP$M_getCreateAtom (lmi, "BATCH");
-    }
+  res = LISP$D_read (lmi, fileName);
+  free (fileName);
 
-    else if (!strncmp (atom.name, "LISTS_USED", (len > 10)? len : 10)) {
-      for (i = 0, cnt = 0; i < LISP$MACH_LSTTABLEN; i++)
-        if (lmi->lstIdx [i] != Free) cnt++;
-      res = LISP$M_getCreateNumber (lmi, cnt);
-    }
+  return res;
+}
 
-    else if (!strncmp (atom.name, "ATOMS_USED", (len > 10)? len : 10)) {
-      for (i = 0, cnt = 0; i < LISP$MACH_ATMTABLEN; i++)
-        if (lmi->atmIdx [i] != Free) cnt++;
-      res = LISP$M_getCreateNumber (lmi, cnt);
-    }
+LISP$Stream * LISP$M_getStream (LISP$MachIns * lmi, LISP$Ref ref,
+                                bool isOutput, const char * name) {
 
-    else if (!strncmp (atom.name, "NUMBERS_USED", (len > 12)? len : 12)) {
-      for (i = 0, cnt = 0; i < LISP$MACH_NUMTABLEN; i++)
-        if (lmi->numIdx [i] != Free) cnt++;
-      res = LISP$M_getCreateNumber (lmi, cnt);
-    }
+  LISP$Stream * s = NULL;
 
-    else if (!strncmp (atom.name, "MAXLISTS", (len > 8)? len : 8))
-      { res = LISP$M_getCreateNumber (lmi, LISP$MACH_LSTTABLEN); }
+  if (LISP$M_getRefType (ref) == ObjectTab &&
+      (lmi->objTab [LISP$M_getRefId (ref)]).type == Stream)
+    s = (lmi->objTab [LISP$M_getRefId (ref)]).data.stream;
 
-    else if (!strncmp (atom.name, "MAXATOMS", (len > 8)? len : 8))
-      { res = LISP$M_getCreateNumber (lmi, LISP$MACH_ATMTABLEN); }
+  if (s == NULL || s->file == NULL ||
+      (isOutput? (void *) s->writer : (void *) s->reader) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs an open %s stream!", name, isOutput? "output" : "input");
+    return NULL;
+  }
 
-    else if (!strncmp (atom.name, "MAXNUMBERS", (len > 10)? len : 10))
-      { res = LISP$M_getCreateNumber (lmi, LISP$MACH_NUMTABLEN); }
+  return s;
+}
 
-    else {
+bool LISP$M_closeStream (LISP$Stream * s) {
+
+  bool res = true;
+
+  if (s->file == NULL) return true;
+
+  if (s->writer != NULL) res = LISP$W_close (s->writer);
+  if (s->reader != NULL) LISP$R_close (s->reader);
+  res = (!fclose (s->file) && res);
+  s->file = NULL;
+
+  return res;
+}
+
+LISP$Ref LISP$M_createStream (LISP$MachIns * lmi, char * fileName,
+                              const char * mode) {
+
+  LISP$Stream * s;
+  LISP$Ref      res;
+
+  s = (LISP$Stream *) calloc (1, sizeof (LISP$Stream));
+  if (s != NULL && *mode == 'r')
+    s->reader = (LISP$Reader *) malloc (sizeof (LISP$Reader));
+  else if (s != NULL)
+    s->writer = (LISP$Writer *) malloc (sizeof (LISP$Writer));
+
+  if (s == NULL || (s->reader == NULL && s->writer == NULL)) {
+    free (s);
+    free (fileName);
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a stream!");
+    return (LISP$M_NULLREF);
+  }
+
+  s->name = fileName;
+  if ((s->file = fopen (fileName, mode)) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_NAOFIL, "NAOFIL",
+        "unable to open file %s", fileName);
+    free (s->reader); free (s->writer); free (s->name); free (s);
+    return (LISP$M_NULLREF);
+  }
+
+  /* A regular file is mapped, so records are read right from it */
+  if (s->writer != NULL) LISP$W_openStream (s->writer, s->file);
+  else if (!LISP$R_openMapped (s->reader, s->file))
+    LISP$R_openStream (s->reader, s->file);
+
+  res = LISP$M_createObject (lmi, Stream);
+  if (res == LISP$M_NULLREF) {
+    LISP$M_closeStream (s);
+    free (s->reader); free (s->writer); free (s->name); free (s);
+    return (LISP$M_NULLREF);
+  }
+
+  (lmi->objTab [LISP$M_getRefId (res)]).data.stream = s;
+  lmi->objBytes += sizeof (LISP$Stream) + ((s->writer != NULL)?
+                   sizeof (LISP$Writer) : LISP$R_BLOCK_SIZE);
+  return res;
+}
+
+LISP$Ref LISP$M_builtInOPEN (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  LISP$Ref        dir;
+  const char *    mode = "r";
+  char *          fileName;
+
+  /* Files are opened for INPUT unless it's said otherwise */
+  if (argc > 1) {
+    dir = (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car;
+    if (dir == LISP$M_getCreateAtom (lmi, "OUTPUT")) mode = "w";
+    else if (dir == LISP$M_getCreateAtom (lmi, "APPEND")) mode = "a";
+    else if (dir != LISP$M_getCreateAtom (lmi, "INPUT")) {
       LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-          "Invalid argument!");
-      res = lmi->NIL;
+          "OPEN opens a file for INPUT, OUTPUT or APPEND!");
+      return (LISP$M_NULLREF);
     }
   }
-  else {
-    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-        "GETLPI needs an argument!");
-    res = lmi->NIL;
-  }
 
-  return (res);
+  fileName = LISP$M_copyString (lmi, list.car, "OPEN");
+  if (fileName == NULL) return (LISP$M_NULLREF);
+
+  return (LISP$M_createStream (lmi, fileName, mode));
 }
 
-LISP$Ref LISP$M_builtInLET (LISP$MachIns * lmi, LISP$Ref args, int level) {
+LISP$Ref LISP$M_builtInCLOSE (LISP$MachIns * lmi, LISP$Ref args) {
 
-  LISP$Ref tmp;
-  LISP$Ref tmpx;
-  LISP$Ref tmpy;
-  LISP$Ref res = lmi->NIL;
+  LISP$Ref      ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Stream * s;
 
-  /* Process list of bindings */
-  tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-  if (LISP$M_getRefType (tmp) != ListTab) {
+  /* Closing a closed stream is fine */
+  if (LISP$M_getRefType (ref) != ObjectTab ||
+      (lmi->objTab [LISP$M_getRefId (ref)]).type != Stream) {
     LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-        "LET's first argument must be a list bindings!");
+        "CLOSE needs a stream!");
     return (LISP$M_NULLREF);
   }
-  while (tmp != lmi->NIL) {
-    /* Get actual bind pair */
-    tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
 
-    if (LISP$M_getRefType (tmpx) != ListTab) {
-      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-          "Invalid binding!");
-      res = LISP$M_NULLREF; break;
+  s = (lmi->objTab [LISP$M_getRefId (ref)]).data.stream;
+  if (!LISP$M_closeStream (s)) {
+    LISP$M_setError (lmi, LISP$_ERR$S_NAOFIL, "NAOFIL",
+        "unable to write file %s", s->name);
+    return (LISP$M_NULLREF);
+  }
+
+  return (lmi->T);
+}
+
+LISP$Ref LISP$M_readLine (LISP$MachIns * lmi, LISP$Reader * r,
+                          LISP$Ref eof) {
+
+  LISP$Span span;
+  size_t    length = 0;
+  int       c;
+
+  /* The line stays in the reader's buffer until the string is made */
+  if ((c = LISP$R_getChar (r)) == EOF) return eof;
+
+  LISP$R_mark (r);
+  for (; c != '\n' && c != EOF; c = LISP$R_getChar (r)) length++;
+
+  span = LISP$R_getSpan (r, length);
+  if (span.length > 0 && span.text [span.length - 1] == '\r') span.length--;
+
+  return (LISP$M_createString (lmi, span.text, span.length));
+}
+
+LISP$Ref LISP$M_readStream (LISP$MachIns * lmi, LISP$Reader * r,
+                            bool isLine) {
+
+  LISP$Reader * origReader  = lmi->reader;
+  LISP$Mode     origMode    = lmi->mode;
+  bool          wasShutDown = lmi->is2ShutDown;
+  LISP$Ref      res;
+  int           level;
+
+  /* A line typed in is asked for just when it's needed */
+  lmi->reader = r;
+  if (r != &(lmi->stdReader)) lmi->mode = Batch;
+
+  if (isLine) {
+    if (LISP$R_isEmpty (r)) LISP$S_makePrompt (lmi, false, true);
+    res = LISP$M_readLine (lmi, r, LISP$M_NULLREF);
+  }
+
+  /* A stray ')' reads as nothing, so the next form is read then */
+  else do {
+    level = 0;
+    res = LISP$S_readAction (lmi, &level);
+  } while (res == LISP$M_NULLREF && !LISP$M_isError (lmi) &&
+           LISP$M_is2Process (lmi));
+
+  /* The end of input ends just the reading, not the session */
+  if ((lmi->error).code >= 0) lmi->is2ShutDown = wasShutDown;
+  lmi->is2Process = true;
+  lmi->reader     = origReader;
+  lmi->mode       = origMode;
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInREAD (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             const char * name) {
+
+  LISP$ListRecord list;
+  LISP$Reader *   r   = &(lmi->stdReader);
+  LISP$Ref        eof = lmi->NIL, res;
+  LISP$Stream *   s;
+
+  /* No stream, or NIL, is the standard input */
+  if (argc > 0) {
+    list = lmi->lstTab [LISP$M_getRefId (args)];
+    if (list.car != lmi->NIL) {
+      if ((s = LISP$M_getStream (lmi, list.car, false, name)) == NULL)
+        return (LISP$M_NULLREF);
+      r = s->reader;
     }
+    if (argc > 1) eof = (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car;
+  }
 
-    /* Get the rest of list -- a value terminated by NIL */
-    tmpy = (lmi->lstTab [LISP$M_getRefId (tmpx)]).cdr;
+  res = LISP$M_readStream (lmi, r, !strcmp (name, "READLN"));
+  if (res == LISP$M_NULLREF && !LISP$M_isError (lmi)) res = eof;
 
-    /* Get atom to be bound to */
-    tmpx = (lmi->lstTab [LISP$M_getRefId (tmpx)]).car;
+  return res;
+}
 
-    /* Get value without it's NIL termination */
-    tmpy = LISP$S_evalAction (lmi,
-        (lmi->lstTab [LISP$M_getRefId (tmpy)]).car, level);
+LISP$Ref LISP$M_builtInWRITE (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                              const char * name) {
 
-    /* Bind them together */
-    LISP$M_bind (lmi, tmpx, tmpy);
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  LISP$Writer     std, * w = &std;
+  LISP$Stream *   s = NULL;
+  const char *    chars;
+  size_t          length;
+  bool            isLine = !strcmp (name, "WRITELN");
+
+  /* No stream, or NIL, is the standard output */
+  if (argc > 1 &&
+      (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car != lmi->NIL) {
+    s = LISP$M_getStream (lmi,
+          (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car, true, name);
+    if (s == NULL) return (LISP$M_NULLREF);
+    w = s->writer;
+  }
+  else LISP$W_openStream (&std, lmi->outputStream);
+
+  /* WRITE is read back by READ, WRITELN of a string by READLN */
+  if (isLine && LISP$M_isString (lmi, list.car)) {
+    chars = LISP$M_getString (lmi, list.car, &length);
+    LISP$W_putString (w, chars, length);
+  }
+  else LISP$S_writeAction (lmi, w, list.car, false);
+  if (isLine) LISP$W_putChar (w, '\n');
+
+  if (s == NULL) LISP$W_close (&std);
+  if (w->isFailed) {
+    LISP$M_setError (lmi, LISP$_ERR$S_NAOFIL, "NAOFIL",
+        "unable to write file %s", (s != NULL)? s->name : "SYS$OUTPUT");
+    return (LISP$M_NULLREF);
+  }
+
+  return (list.car);
+}
+
+static bool LISP$M_isPromise (LISP$MachIns * lmi, LISP$Ref ref) {
+
+  return (ref != LISP$M_NULLREF && LISP$M_getRefType (ref) == ObjectTab &&
+          (lmi->objTab [LISP$M_getRefId (ref)]).type == Promise);
+}
+
+/* Add the variables of 'expr' bound just now to 'bindings', each once */
+static void LISP$M_captureBindings (LISP$MachIns * lmi, LISP$Ref expr,
+                                    LISP$Ref * bindings) {
+
+  LISP$Ref tmp;
+
+  while (LISP$M_getRefType (expr) == ListTab) {
+    LISP$M_captureBindings (lmi,
+        (lmi->lstTab [LISP$M_getRefId (expr)]).car, bindings);
+    expr = (lmi->lstTab [LISP$M_getRefId (expr)]).cdr;
+  }
+
+  /* Global variables are looked up when it's forced, as usual */
+  if (LISP$M_getRefType (expr) != AtomTab ||
+      (lmi->atmTab [LISP$M_getRefId (expr)]).type != Variable ||
+      (lmi->atmTab [LISP$M_getRefId (expr)]).bindList == lmi->NIL)
+    return;
+
+  for (tmp = *bindings; tmp != lmi->NIL;
+       tmp = (lmi->lstTab [LISP$M_getRefId (
+                (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr)]).cdr)
+    if ((lmi->lstTab [LISP$M_getRefId (tmp)]).car == expr) return;
+
+  LISP$M_listPush (lmi, bindings,
+                   (lmi->atmTab [LISP$M_getRefId (expr)]).value);
+  LISP$M_listPush (lmi, bindings, expr);
+}
+
+LISP$Ref LISP$M_createPromise (LISP$MachIns * lmi, LISP$Ref expr) {
+
+  LISP$Promise * p;
+  LISP$Ref       res;
+
+  p = (LISP$Promise *) malloc (sizeof (LISP$Promise));
+  if (p == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a promise!");
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_createObject (lmi, Promise);
+  if (res == LISP$M_NULLREF) {
+    free (p);
+    return (LISP$M_NULLREF);
+  }
+
+  p->expr     = expr;
+  p->bindings = lmi->NIL;
+  p->value    = lmi->NIL;
+  p->isForced = false;
+  p->isFuture = false;
+  p->future   = NULL;
+  (lmi->objTab [LISP$M_getRefId (res)]).data.promise = p;
+  lmi->objBytes += sizeof (LISP$Promise);
+
+  LISP$M_captureBindings (lmi, expr, &(p->bindings));
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+/* Wait for the worker of a future and bring its value here; an error *
+ * of the worker is the error of each touch                           */
+static LISP$Ref LISP$M_touchFuture (LISP$MachIns * lmi, LISP$Promise * p) {
+
+  LISP$Future * f = p->future;
+  LISP$Ref      res;
+
+  pthread_mutex_lock (&(f->lock));
+  while (!f->isResolved) pthread_cond_wait (&(f->isDone), &(f->lock));
+  pthread_mutex_unlock (&(f->lock));
+
+  /* Nothing changes once it's resolved */
+  if ((f->error).code != 0) {
+    LISP$M_setError (lmi, (f->error).code, (f->error).name, "%s",
+                     (f->error).message);
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$D_unpack (lmi, f->data, f->length, "TOUCH");
+  if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+
+  p->value    = res;
+  p->isForced = true;
+  p->future   = NULL;
+  LISP$M_releaseFuture (f);
+
+  return res;
+}
+
+static bool LISP$M_isFuture (LISP$MachIns * lmi, LISP$Ref ref) {
+
+  return (LISP$M_isPromise (lmi, ref) &&
+          ((lmi->objTab [LISP$M_getRefId (ref)]).data.promise)->future
+            != NULL);
+}
+
+LISP$Ref LISP$M_touch (LISP$MachIns * lmi, LISP$Ref ref) {
+
+  LISP$Promise * p;
+
+  if (!lmi->hasFutures || !LISP$M_isPromise (lmi, ref)) return ref;
+
+  p = (lmi->objTab [LISP$M_getRefId (ref)]).data.promise;
+  if (p->isForced) return (p->value);
+  return ((p->future != NULL)? LISP$M_touchFuture (lmi, p) : ref);
+}
+
+LISP$Ref LISP$M_force (LISP$MachIns * lmi, LISP$Ref ref, int level) {
+
+  LISP$Promise * p;
+  LISP$Ref       tmp, res;
+
+  if (!LISP$M_isPromise (lmi, ref)) return ref;
+
+  /* The promise is referred to by the caller, so it can't be freed */
+  p = (lmi->objTab [LISP$M_getRefId (ref)]).data.promise;
+  if (p->isForced) return (p->value);
+  if (p->future != NULL) return (LISP$M_touchFuture (lmi, p));
+
+  for (tmp = p->bindings; tmp != lmi->NIL; tmp =
+         (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr) {
+    res = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    LISP$M_bind (lmi, res, (lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+  }
+
+  res = LISP$S_evalAction (lmi, p->expr, level);
+
+  for (tmp = p->bindings; tmp != lmi->NIL; tmp =
+         (lmi->lstTab [LISP$M_getRefId (
+            (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr)]).cdr)
+    LISP$M_unBind (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+
+  /* A promise forced again by its own expression keeps the first value */
+  if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+  if (!p->isForced) {
+    p->value    = res;
+    p->isForced = true;
+    p->expr     = p->bindings = lmi->NIL;
+  }
+
+  return (p->value);
+}
+
+LISP$Ref LISP$M_builtInDELAY (LISP$MachIns * lmi, LISP$Ref args) {
+
+  return (LISP$M_createPromise (lmi,
+            (lmi->lstTab [LISP$M_getRefId (args)]).car));
+}
+
+LISP$Ref LISP$M_builtInCONSSTREAM (LISP$MachIns * lmi, LISP$Ref args,
+                                   int level) {
+
+  LISP$Ref head, tail, res;
+
+  head = LISP$S_evalAction (lmi,
+           (lmi->lstTab [LISP$M_getRefId (args)]).car, level);
+  if (head == LISP$M_NULLREF) return (LISP$M_NULLREF);
+
+  /* (HEAD . PROMISE) -- nothing is collected until it's returned */
+  tail = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  tail = LISP$M_createPromise (lmi,
+           (lmi->lstTab [LISP$M_getRefId (tail)]).car);
+  if (tail == LISP$M_NULLREF) return (LISP$M_NULLREF);
+
+  res = LISP$M_createList (lmi);
+  if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+  (lmi->lstTab [LISP$M_getRefId (res)]).car = head;
+  (lmi->lstTab [LISP$M_getRefId (res)]).cdr = tail;
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInFORCE (LISP$MachIns * lmi, LISP$Ref args, int level,
+                              const char * name) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+
+  if (!strcmp (name, "FORCE") || !strcmp (name, "TOUCH"))
+    return (LISP$M_force (lmi, ref, level));
+
+  if (LISP$M_getRefType (ref) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a stream!", name);
+    return (LISP$M_NULLREF);
+  }
+
+  if (!strcmp (name, "STREAM-CAR"))
+    return ((lmi->lstTab [LISP$M_getRefId (ref)]).car);
+
+  return (LISP$M_force (lmi, (lmi->lstTab [LISP$M_getRefId (ref)]).cdr,
+                        level));
+}
+
+LISP$Ref LISP$M_createSequence (LISP$MachIns * lmi, LISP$SequenceKind kind,
+                                LISP$Ref source, LISP$Ref fun) {
+
+  LISP$Sequence * q;
+  LISP$Ref        res;
+
+  q = (LISP$Sequence *) calloc (1, sizeof (LISP$Sequence));
+  if (q == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for a sequence!");
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_createObject (lmi, Sequence);
+  if (res == LISP$M_NULLREF) {
+    free (q);
+    return (LISP$M_NULLREF);
+  }
+
+  q->kind   = kind;
+  q->source = source;
+  q->fun    = fun;
+  (lmi->objTab [LISP$M_getRefId (res)]).data.sequence = q;
+  lmi->objBytes += sizeof (LISP$Sequence);
+  return res;
+}
+
+static LISP$Sequence * LISP$M_getSequence (LISP$MachIns * lmi,
+                                           LISP$Ref ref) {
+
+  if (LISP$M_getRefType (ref) != ObjectTab ||
+      (lmi->objTab [LISP$M_getRefId (ref)]).type != Sequence)
+    return NULL;
+
+  return ((lmi->objTab [LISP$M_getRefId (ref)]).data.sequence);
+}
+
+LISP$Ref LISP$M_nextItem (LISP$MachIns * lmi, LISP$Ref * cursor, int level) {
+
+  LISP$Sequence * q;
+  LISP$Stream *   s;
+  LISP$Ref        res = LISP$M_NULLREF, item, fargs, test;
+  int             roots = lmi->rootTop;
+
+  if (LISP$M_getRefType (*cursor) == ListTab) {
+    res     = (lmi->lstTab [LISP$M_getRefId (*cursor)]).car;
+    *cursor = (lmi->lstTab [LISP$M_getRefId (*cursor)]).cdr;
+    if (!LISP$M_isPromise (lmi, *cursor)) return res;
+
+    /* The item is kept safe from GC while the rest is being computed */
+    LISP$M_pushRoot (lmi, res);
+    *cursor = LISP$M_force (lmi, *cursor, level);
+    lmi->rootTop = roots;
+    if (*cursor == LISP$M_NULLREF) *cursor = lmi->NIL;
+    return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+  }
+
+  /* The sequence is referred to by the caller, so it can't be freed */
+  q = LISP$M_getSequence (lmi, *cursor);
+  if (q == NULL || q->isDone) return (LISP$M_NULLREF);
+
+  switch (q->kind) {
+    case Lines:
+    case Forms:
+      if (q->source == lmi->NIL)
+        res = LISP$M_readStream (lmi, &(lmi->stdReader), q->kind == Lines);
+      else {
+        s = (lmi->objTab [LISP$M_getRefId (q->source)]).data.stream;
+        if (s->file != NULL)
+          res = LISP$M_readStream (lmi, s->reader, q->kind == Lines);
+        if (res == LISP$M_NULLREF && q->isOwner) LISP$M_closeStream (s);
+      }
+      break;
+
+    case Mapped:
+      item = LISP$M_nextItem (lmi, &(q->source), level);
+      if (item == LISP$M_NULLREF) break;
+
+      fargs = lmi->NIL;
+      LISP$M_listPush (lmi, &fargs, item);
+      if (!LISP$M_isError (lmi))
+        res = LISP$S_apply (lmi, q->fun, fargs, level);
+      break;
+
+    /* The item is kept safe from GC while it's being tested */
+    case Filtered:
+      while ((item = LISP$M_nextItem (lmi, &(q->source), level))
+             != LISP$M_NULLREF) {
+        LISP$M_pushRoot (lmi, item);
+        fargs = lmi->NIL;
+        LISP$M_listPush (lmi, &fargs, item);
+        if (LISP$M_isError (lmi)) break;
+
+        test = LISP$S_apply (lmi, q->fun, fargs, level);
+        lmi->rootTop = roots;
+        if (test == LISP$M_NULLREF) break;
+        if (test != lmi->NIL) {
+          res = item;
+          break;
+        }
+      }
+      break;
+  }
+
+  if (res == LISP$M_NULLREF && !LISP$M_isError (lmi)) q->isDone = true;
+  lmi->rootTop = roots;
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+LISP$Ref LISP$M_builtInREADLINES (LISP$MachIns * lmi, LISP$Ref args,
+                                  const char * name) {
+
+  LISP$Ref source = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref res;
+  bool     isOwner = false;
+  char *   fileName;
+
+  /* A file name is opened just for the sequence, NIL is the terminal */
+  if (LISP$M_isString (lmi, source) && source != lmi->NIL) {
+    fileName = LISP$M_copyString (lmi, source, name);
+    if (fileName == NULL) return (LISP$M_NULLREF);
+
+    source = LISP$M_createStream (lmi, fileName, "r");
+    if (source == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    isOwner = true;
+  }
+  else if (source != lmi->NIL &&
+           LISP$M_getStream (lmi, source, false, name) == NULL)
+    return (LISP$M_NULLREF);
+
+  res = LISP$M_createSequence (lmi,
+          strcmp (name, "READ-LINES")? Forms : Lines, source, lmi->NIL);
+  if (res != LISP$M_NULLREF)
+    ((lmi->objTab [LISP$M_getRefId (res)]).data.sequence)->isOwner = isOwner;
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInMAP (LISP$MachIns * lmi, LISP$Ref args, int level,
+                            const char * name) {
+
+  LISP$Ref fun    = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref cursor = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref res    = lmi->NIL;
+  LISP$Ref last   = LISP$M_NULLREF;
+  LISP$Ref item, fargs, tmp, cell;
+  bool     isMap  = !strcmp (name, "MAP");
+
+  cursor = (lmi->lstTab [LISP$M_getRefId (cursor)]).car;
+
+  /* A sequence or a stream is mapped or filtered lazily, by a sequence */
+  if (LISP$M_getSequence (lmi, cursor) != NULL ||
+      (LISP$M_getRefType (cursor) == ListTab && LISP$M_isPromise (lmi,
+         (lmi->lstTab [LISP$M_getRefId (cursor)]).cdr)))
+    return (LISP$M_createSequence (lmi, isMap? Mapped : Filtered,
+                                   cursor, fun));
+
+  if (cursor != lmi->NIL && LISP$M_getRefType (cursor) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a list or a sequence!", name);
+    return (LISP$M_NULLREF);
+  }
+
+  /* A list gives a list, it's collected as MAPCAR does */
+  while ((item = LISP$M_nextItem (lmi, &cursor, level)) != LISP$M_NULLREF) {
+    fargs = lmi->NIL;
+    LISP$M_listPush (lmi, &fargs, item);
+    if (LISP$M_isError (lmi)) break;
+
+    tmp = LISP$S_apply (lmi, fun, fargs, level);
+    if (tmp == LISP$M_NULLREF) break;
+    if (!isMap && tmp == lmi->NIL) continue;
+
+    cell = LISP$M_createList (lmi);
+    if (cell == LISP$M_NULLREF) break;
+    (lmi->lstTab [LISP$M_getRefId (cell)]).car = isMap? tmp : item;
+
+    if (last == LISP$M_NULLREF) LISP$M_pushRoot (lmi, res = cell);
+    else (lmi->lstTab [LISP$M_getRefId (last)]).cdr = cell;
+    last = cell;
+  }
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+LISP$Ref LISP$M_builtInREDUCE (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  LISP$Ref fun    = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref tmp    = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref acc    = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  LISP$Ref cursor, item, fargs;
+  int      roots  = lmi->rootTop;
+
+  tmp    = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  cursor = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+  if (cursor != lmi->NIL && LISP$M_getRefType (cursor) != ListTab &&
+      LISP$M_getSequence (lmi, cursor) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "REDUCE needs a list or a sequence!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* (FUN ACC ITEM) for each item; just the accumulator is kept safe *
+   * from GC, the items consumed are garbage right away              */
+  while ((item = LISP$M_nextItem (lmi, &cursor, level)) != LISP$M_NULLREF) {
+    fargs = lmi->NIL;
+    LISP$M_listPush (lmi, &fargs, item);
+    LISP$M_listPush (lmi, &fargs, acc);
+    if (LISP$M_isError (lmi)) break;
+
+    acc = LISP$S_apply (lmi, fun, fargs, level);
+    if (acc == LISP$M_NULLREF) break;
+
+    lmi->rootTop = roots;
+    LISP$M_pushRoot (lmi, acc);
+  }
+  lmi->rootTop = roots;
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : acc);
+}
+
+/* The workers of PMAP and FUTURE are started by the first call */
+static bool LISP$M_startPool (LISP$MachIns * lmi, const char * name) {
+
+  if (lmi->pool == NULL &&
+      (lmi->pool = LISP$P_create (lmi, lmi->workers, false)) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "%s can't start its workers!", name);
+    return false;
+  }
+  return true;
+}
+
+/* A call of PMAP or PREDUCE shared by its chunks */
+typedef struct {
+  LISP$MachIns *    lmi;                        /* Caller, the template */
+  LISP$Ref          args;                       /* (FUN ...) as called  */
+  LISP$Ref          fun;
+  bool              isReduce;
+  pthread_mutex_t   lock;                       /* Guards all below     */
+  pthread_cond_t    isDone;
+  int               pending;                    /* Chunks not done yet  */
+  LISP$MachIns **   copies;                     /* Workers reset for it */
+  int               copyCount;
+} LISP$M_Parallel;
+
+/* A run of the list items done by one task, with its packed result */
+typedef struct {
+  LISP$M_Parallel * call;
+  LISP$Ref          first;
+  int               count;
+  char *            data;
+  size_t            length;
+  LISP$Error        error;
+} LISP$M_Chunk;
+
+/* Task of a worker -- map the items of the chunk or reduce them. The   *
+ * worker is made a copy of the caller by its first chunk of the call, *
+ * so the items and the function are there under the same references  *
+ * and everything they refer to (DEFUNs, globals) too; the arguments   *
+ * of the call stay rooted there for the chunks which follow           */
+static void LISP$M_runChunk (LISP$MachIns * lmi, void * arg) {
+
+  LISP$M_Chunk *    chunk = (LISP$M_Chunk *) arg;
+  LISP$M_Parallel * call  = chunk->call;
+  LISP$Ref          cursor = chunk->first;
+  LISP$Ref          res = lmi->NIL, last = LISP$M_NULLREF;
+  LISP$Ref          item, fargs, tmp, cell;
+  bool              isCopy = false;
+  int               i, roots;
+
+  pthread_mutex_lock (&(call->lock));
+  for (i = 0; i < call->copyCount && !isCopy; i++)
+    isCopy = (call->copies [i] == lmi);
+  pthread_mutex_unlock (&(call->lock));
+
+  (lmi->error).code = 0;
+  if (!isCopy) {
+    if (LISP$M_reset (lmi, call->lmi)) {
+      LISP$M_pushRoot (lmi, call->args);
+      LISP$M_setStreams (lmi, NULL, (call->lmi)->outputStream);
+      pthread_mutex_lock (&(call->lock));
+      call->copies [call->copyCount++] = lmi;
+      pthread_mutex_unlock (&(call->lock));
+    }
+    else LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+                          "No memory for %s!",
+                          call->isReduce? "PREDUCE" : "PMAP");
+  }
+  roots = lmi->rootTop;
+
+  /* PREDUCE starts by the first item, the caller folds its initial *
+   * value over the results of the chunks                            */
+  if (call->isReduce && !LISP$M_isError (lmi)) {
+    res    = LISP$M_touch (lmi, (lmi->lstTab [LISP$M_getRefId (cursor)]).car);
+    cursor = (lmi->lstTab [LISP$M_getRefId (cursor)]).cdr;
+    LISP$M_pushRoot (lmi, res);
+  }
+
+  for (i = call->isReduce? 1 : 0;
+       i < chunk->count && !LISP$M_isError (lmi); i++) {
+    item   = (lmi->lstTab [LISP$M_getRefId (cursor)]).car;
+    cursor = (lmi->lstTab [LISP$M_getRefId (cursor)]).cdr;
+
+    fargs = lmi->NIL;
+    LISP$M_listPush (lmi, &fargs, item);
+    if (call->isReduce) LISP$M_listPush (lmi, &fargs, res);
+    if (LISP$M_isError (lmi)) break;
+
+    /* A future can't be packed, its value can */
+    tmp = LISP$M_touch (lmi, LISP$S_apply (lmi, call->fun, fargs, 0));
+    if (tmp == LISP$M_NULLREF) break;
+
+    if (call->isReduce) {
+      lmi->rootTop = roots;
+      LISP$M_pushRoot (lmi, res = tmp);
+      continue;
+    }
+
+    cell = LISP$M_createList (lmi);
+    if (cell == LISP$M_NULLREF) break;
+    (lmi->lstTab [LISP$M_getRefId (cell)]).car = tmp;
+
+    if (last == LISP$M_NULLREF) LISP$M_pushRoot (lmi, res = cell);
+    else (lmi->lstTab [LISP$M_getRefId (last)]).cdr = cell;
+    last = cell;
+  }
+
+  if (!LISP$M_isError (lmi))
+    chunk->data = LISP$D_pack (lmi, res, &(chunk->length),
+                               call->isReduce? "PREDUCE" : "PMAP");
+  chunk->error      = lmi->error;
+  (lmi->error).code = 0;
+  lmi->is2ShutDown  = false;
+  lmi->rootTop      = roots;
+
+  pthread_mutex_lock (&(call->lock));
+  if (--(call->pending) == 0) pthread_cond_signal (&(call->isDone));
+  pthread_mutex_unlock (&(call->lock));
+}
+
+LISP$Ref LISP$M_builtInPMAP (LISP$MachIns * lmi, LISP$Ref args, int level,
+                             const char * name) {
+
+  LISP$M_Parallel call;
+  LISP$M_Chunk *  chunks;
+  LISP$Ref        list, cursor, tmp, fargs;
+  LISP$Ref        acc  = lmi->NIL;
+  LISP$Ref        res  = lmi->NIL, last = LISP$M_NULLREF;
+  int             roots = lmi->rootTop;
+  int             i, j, length, count;
+
+  memset (&call, 0, sizeof (call));
+  call.lmi      = lmi;
+  call.args     = args;
+  call.fun      = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  call.isReduce = !strcmp (name, "PREDUCE");
+
+  list = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  if (call.isReduce) {
+    acc  = (lmi->lstTab [LISP$M_getRefId (list)]).car;
+    list = (lmi->lstTab [LISP$M_getRefId (list)]).cdr;
+  }
+  list = (lmi->lstTab [LISP$M_getRefId (list)]).car;
+
+  /* Just a proper list of a few items is worth the workers; anything *
+   * else, or a call made by a worker, is done as MAP or REDUCE does  */
+  for (length = 0, cursor = list;
+       cursor != lmi->NIL && LISP$M_getRefType (cursor) == ListTab;
+       cursor = (lmi->lstTab [LISP$M_getRefId (cursor)]).cdr)
+    length++;
+
+  if (cursor != lmi->NIL || length < 2 || lmi->isWorker || lmi->workers < 2)
+    return (call.isReduce? LISP$M_builtInREDUCE (lmi, args, level)
+                         : LISP$M_builtInMAP (lmi, args, level, "MAP"));
+
+  if (!LISP$M_startPool (lmi, name)) return (LISP$M_NULLREF);
+
+  /* More chunks than workers, so that the ones done first take more */
+  count  = (length < 4 * lmi->workers)? length : 4 * lmi->workers;
+  chunks = (LISP$M_Chunk *) calloc (count, sizeof (LISP$M_Chunk));
+  call.copies = (LISP$MachIns **) calloc (lmi->workers,
+                                          sizeof (LISP$MachIns *));
+  if (chunks == NULL || call.copies == NULL) {
+    free (chunks);
+    free (call.copies);
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", name);
+    return (LISP$M_NULLREF);
+  }
+
+  pthread_mutex_init (&(call.lock), NULL);
+  pthread_cond_init (&(call.isDone), NULL);
+
+  /* The caller's heap is read by the workers, it waits for all of them */
+  for (i = 0, cursor = list; i < count; i++) {
+    chunks [i].call  = &call;
+    chunks [i].first = cursor;
+    chunks [i].count = length / count + (i < length % count);
+    for (j = 0; j < chunks [i].count; j++)
+      cursor = (lmi->lstTab [LISP$M_getRefId (cursor)]).cdr;
+
+    pthread_mutex_lock (&(call.lock));
+    call.pending++;
+    pthread_mutex_unlock (&(call.lock));
+    if (!LISP$P_submit (lmi->pool, LISP$M_runChunk, &(chunks [i]))) {
+      call.pending--;
+      (chunks [i].error).code = LISP$_ERR$S_OBJFUL;
+      strlcpy ((chunks [i].error).name, "OBJFUL",
+               sizeof ((chunks [i].error).name));
+      snprintf ((chunks [i].error).message,
+                sizeof ((chunks [i].error).message),
+                "No memory for %s!", name);
+    }
+  }
+
+  pthread_mutex_lock (&(call.lock));
+  while (call.pending > 0)
+    pthread_cond_wait (&(call.isDone), &(call.lock));
+  pthread_mutex_unlock (&(call.lock));
+
+  /* The results are brought in the order of the chunks, the first *
+   * error found wins                                              */
+  if (call.isReduce) LISP$M_pushRoot (lmi, acc);
+  for (i = 0; i < count; i++) {
+    if ((chunks [i].error).code != 0)
+      LISP$M_setError (lmi, (chunks [i].error).code,
+                       (chunks [i].error).name, "%s",
+                       (chunks [i].error).message);
+    if (LISP$M_isError (lmi)) break;
+
+    tmp = LISP$D_unpack (lmi, chunks [i].data, chunks [i].length, name);
+    if (tmp == LISP$M_NULLREF) break;
+
+    if (call.isReduce) {
+      fargs = lmi->NIL;
+      LISP$M_listPush (lmi, &fargs, tmp);
+      LISP$M_listPush (lmi, &fargs, acc);
+      if (LISP$M_isError (lmi)) break;
+
+      acc = LISP$S_apply (lmi, call.fun, fargs, level);
+      if (acc == LISP$M_NULLREF) break;
+
+      lmi->rootTop = roots;
+      LISP$M_pushRoot (lmi, acc);
+      continue;
+    }
+
+    if (last == LISP$M_NULLREF) LISP$M_pushRoot (lmi, res = tmp);
+    else (lmi->lstTab [LISP$M_getRefId (last)]).cdr = tmp;
+    for (last = tmp; (lmi->lstTab [LISP$M_getRefId (last)]).cdr != lmi->NIL;
+         last = (lmi->lstTab [LISP$M_getRefId (last)]).cdr);
+  }
+  lmi->rootTop = roots;
+  if (call.isReduce) res = acc;
+
+  for (i = 0; i < count; i++) free (chunks [i].data);
+  free (chunks);
+  free (call.copies);
+  pthread_cond_destroy (&(call.isDone));
+  pthread_mutex_destroy (&(call.lock));
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+/* Task of a worker -- evaluate the expression of a future. The worker *
+ * is made a copy of the caller, which waits for it, so the expression *
+ * sees everything the caller would see at the point of FUTURE         */
+static void LISP$M_runFuture (LISP$MachIns * lmi, void * arg) {
+
+  LISP$Future * f   = (LISP$Future *) arg;
+  LISP$Ref      res = LISP$M_NULLREF;
+  char *        data = NULL;
+  size_t        length = 0;
+
+  (lmi->error).code = 0;
+  if (LISP$M_reset (lmi, f->lmi)) {
+    LISP$M_pushRoot (lmi, f->expr);
+    LISP$M_setStreams (lmi, NULL, (f->lmi)->outputStream);
+  }
+  else LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+                        "No memory for FUTURE!");
+
+  pthread_mutex_lock (&(f->lock));
+  f->isCopied = true;
+  pthread_cond_broadcast (&(f->isDone));
+  pthread_mutex_unlock (&(f->lock));
+
+  if (!LISP$M_isError (lmi)) res = LISP$S_evalAction (lmi, f->expr, 0);
+  if (res == LISP$M_NULLREF && !LISP$M_isError (lmi)) res = lmi->NIL;
+
+  /* A future can't be packed, its value can */
+  if (res != LISP$M_NULLREF && LISP$M_isFuture (lmi, res))
+    res = LISP$M_touch (lmi, res);
+  if (res != LISP$M_NULLREF) {
+    LISP$M_pushRoot (lmi, res);
+    data = LISP$D_pack (lmi, res, &length, "FUTURE");
+  }
+
+  pthread_mutex_lock (&(f->lock));
+  f->data       = data;
+  f->length     = length;
+  f->error      = lmi->error;
+  f->isResolved = true;
+  pthread_cond_broadcast (&(f->isDone));
+  pthread_mutex_unlock (&(f->lock));
+
+  (lmi->error).code = 0;
+  lmi->is2ShutDown  = false;
+  lmi->rootTop      = 0;
+  LISP$M_releaseFuture (f);
+}
+
+LISP$Ref LISP$M_builtInFUTURE (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  LISP$Ref       expr = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref       res;
+  LISP$Promise * p;
+  LISP$Future *  f;
+
+  /* Without a worker to take it right away, it's evaluated here -- a  *
+   * queued one could wait for a worker which waits for it, and a      *
+   * worker's future would have to wait for the others                 */
+  if (lmi->isWorker || lmi->workers < 2 ||
+      (lmi->pool != NULL && LISP$P_idle (lmi->pool) <= 0))
+    return (LISP$S_evalAction (lmi, expr, level));
+
+  if (!LISP$M_startPool (lmi, "FUTURE")) return (LISP$M_NULLREF);
+
+  p = (LISP$Promise *) malloc (sizeof (LISP$Promise));
+  f = (LISP$Future *) calloc (1, sizeof (LISP$Future));
+  if (p == NULL || f == NULL ||
+      (res = LISP$M_createObject (lmi, Promise)) == LISP$M_NULLREF) {
+    free (p);
+    free (f);
+    if (!LISP$M_isError (lmi))
+      LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+          "No memory for FUTURE!");
+    return (LISP$M_NULLREF);
+  }
+
+  pthread_mutex_init (&(f->lock), NULL);
+  pthread_cond_init (&(f->isDone), NULL);
+  f->lmi  = lmi;
+  f->expr = expr;
+  f->refs = 2;
+
+  p->expr     = p->bindings = p->value = lmi->NIL;
+  p->isForced = false;
+  p->isFuture = true;
+  p->future   = f;
+  (lmi->objTab [LISP$M_getRefId (res)]).data.promise = p;
+  lmi->objBytes  += sizeof (LISP$Promise);
+  lmi->hasFutures = true;
+
+  if (!LISP$P_submit (lmi->pool, LISP$M_runFuture, f)) {
+    f->refs--;
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for FUTURE!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* The caller's heap is read by the worker, it waits for the copy */
+  pthread_mutex_lock (&(f->lock));
+  while (!f->isCopied) pthread_cond_wait (&(f->isDone), &(f->lock));
+  pthread_mutex_unlock (&(f->lock));
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInSPAWN (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  long            id   = LISP$A_spawn (lmi, list.car, list.cdr);
+
+  return ((id < 0)? LISP$M_NULLREF : LISP$M_getCreateInteger (lmi, id));
+}
+
+LISP$Ref LISP$M_builtInSELF (LISP$MachIns * lmi) {
+
+  long id = LISP$A_self (lmi);
+
+  return ((id < 0)? LISP$M_NULLREF : LISP$M_getCreateInteger (lmi, id));
+}
+
+LISP$Ref LISP$M_builtInSEND (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  LISP$Ref        message = (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car;
+  bool            isId = LISP$M_isNumber (lmi, list.car);
+  double          id = isId? LISP$M_getNumber (lmi, list.car) : 0;
+
+  if (!isId || id != (long) id) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "SEND needs an actor id!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* NIL tells the actor is gone, the message is dropped then */
+  if (LISP$A_send (lmi, (long) id, message)) return (lmi->T);
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInRECEIVE (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  double          timeout = -1;
+  LISP$Ref        res;
+
+  /* No timeout, or NIL, waits as long as it takes */
+  if (argc > 0 && list.car != lmi->NIL) {
+    if (!LISP$M_isNumber (lmi, list.car) ||
+        (timeout = LISP$M_getNumber (lmi, list.car)) < 0) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "RECEIVE needs a timeout of zero or more seconds!");
+      return (LISP$M_NULLREF);
+    }
+  }
+
+  res = LISP$A_receive (lmi, timeout);
+  if (res == LISP$M_NULLREF && !LISP$M_isError (lmi))
+    res = (argc > 1)? (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car
+                    : lmi->NIL;
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInNEXT (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             int level) {
+
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  LISP$Ref        cursor = list.car, res;
+
+  if (LISP$M_getSequence (lmi, cursor) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "NEXT needs a sequence!");
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_nextItem (lmi, &cursor, level);
+  if (res == LISP$M_NULLREF && !LISP$M_isError (lmi))
+    res = (argc > 1)? (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car
+                    : lmi->NIL;
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInIS (LISP$MachIns * lmi, LISP$Ref args) {
+
+  /* XXX: doesn't work for numbers, why?! */
+  LISP$ListRecord list = lmi->lstTab [LISP$M_getRefId (args)];
+  LISP$Ref tmp  = list.cdr;
+
+  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+  return ((list.car == tmp)? lmi->T : lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInCOND (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  LISP$Ref tmp  = args;
+  LISP$Ref tmpx = LISP$M_NULLREF;
+  LISP$ListRecord list;
+
+  while (tmp != lmi->NIL) {
+    tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    list = lmi->lstTab [LISP$M_getRefId (tmpx)];
+    if (LISP$M_touch (lmi, LISP$S_evalAction (lmi, list.car, level))
+          != lmi->NIL) {
+      tmp = LISP$S_evalAction (lmi,
+          (lmi->lstTab [LISP$M_getRefId (list.cdr)]).car, level);
+      return (tmp);
+    }
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+      "No COND's argument where to fall!");
+  return (LISP$M_NULLREF);
+}
+
+LISP$Ref LISP$M_builtInANDOR (LISP$MachIns * lmi, LISP$Ref args,
+                              int level, bool isAnd) {
+
+  LISP$Ref tmp = args;
+  LISP$Ref res = isAnd? lmi->T : lmi->NIL;
+
+  /* Evaluate arguments from left to right up to the first one which *
+   * decides the result -- NIL for AND, anything else for OR         */
+  while (tmp != lmi->NIL) {
+    res = LISP$M_touch (lmi, LISP$S_evalAction (lmi,
+        (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level));
+    if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    if ((res == lmi->NIL) == isAnd) return (res);
+
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInNOT (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  return (ref == lmi->NIL)? lmi->T : lmi->NIL;
+}
+
+LISP$Ref LISP$M_builtInLOAD (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  LISP$Ref tmp =
+    LISP$S_evalAction (lmi, (lmi->lstTab [LISP$M_getRefId (args)]).car, level);
+  char *   fileName;
+  bool     res;
+
+  /* The name is copied -- the string may be collected while loading */
+  if (LISP$M_isError (lmi) ||
+      (fileName = LISP$M_copyString (lmi, tmp, "LOAD")) == NULL)
+    return (LISP$M_NULLREF);
+
+  res = LISP$S_loadFile (lmi, fileName);
+  free (fileName);
+
+  return (res? lmi->T : lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInSHOWMEM (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+
+  int len = 0;
+  LISP$Ref tmp = LISP$M_NULLREF;
+  LISP$AtomRecord atom;
+
+  if (argc) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+    atom = lmi->atmTab [LISP$M_getRefId (tmp)];
+    len = strlen (atom.name);
+    if (strncmp (atom.name, "FULL", (len > 4)? len : 4)) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "SHOW-MEM gets only one optional argument: FULL");
+      return (LISP$M_NULLREF);
+    }
+    else LISP$M_printMemoryDump (lmi, true);
+  }
+  else LISP$M_printMemoryDump (lmi, false);
+
+  return (lmi->T);
+}
+
+LISP$Ref LISP$M_builtInGETLPI (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+
+  LISP$Ref res;
+  LISP$Ref tmp = LISP$M_NULLREF;
+  LISP$AtomRecord atom;
+
+  if (argc) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+    atom = lmi->atmTab [LISP$M_getRefId (tmp)];
+    int i = 0, cnt = 0, len = strlen (atom.name);
+
+    if (!strncmp (atom.name, "MODE", (len > 4)? len : 4)) {
+      if (lmi->mode == Interactive)
+        res = LISP$M_getCreateAtom (lmi, "INTERACTIVE");
+      else
+        res = LISP$M_getCreateAtom (lmi, "BATCH");
+    }
+
+    else if (!strncmp (atom.name, "LISTS_USED", (len > 10)? len : 10)) {
+      for (i = 0, cnt = 0; i < lmi->lstLen; i++)
+        if (lmi->lstIdx [i] != Free) cnt++;
+      res = LISP$M_getCreateInteger (lmi, cnt);
+    }
+
+    else if (!strncmp (atom.name, "ATOMS_USED", (len > 10)? len : 10)) {
+      for (i = 0, cnt = 0; i < lmi->atmLen; i++)
+        if (lmi->atmIdx [i] != Free) cnt++;
+      res = LISP$M_getCreateInteger (lmi, cnt);
+    }
+
+    else if (!strncmp (atom.name, "NUMBERS_USED", (len > 12)? len : 12)) {
+      for (i = 0, cnt = 0; i < lmi->numLen; i++)
+        if (lmi->numIdx [i] != Free) cnt++;
+      res = LISP$M_getCreateInteger (lmi, cnt);
+    }
+
+    else if (!strncmp (atom.name, "OBJECTS_USED", (len > 12)? len : 12)) {
+      for (i = 0, cnt = 0; i < lmi->objLen; i++)
+        if (lmi->objIdx [i] != Free) cnt++;
+      res = LISP$M_getCreateInteger (lmi, cnt);
+    }
+
+    else if (!strncmp (atom.name, "MAXLISTS", (len > 8)? len : 8))
+      { res = LISP$M_getCreateInteger (lmi, lmi->lstLen); }
+
+    else if (!strncmp (atom.name, "MAXATOMS", (len > 8)? len : 8))
+      { res = LISP$M_getCreateInteger (lmi, lmi->atmLen); }
+
+    else if (!strncmp (atom.name, "MAXNUMBERS", (len > 10)? len : 10))
+      { res = LISP$M_getCreateInteger (lmi, lmi->numLen); }
+
+    else if (!strncmp (atom.name, "MAXOBJECTS", (len > 10)? len : 10))
+      { res = LISP$M_getCreateInteger (lmi, lmi->objLen); }
+
+    else if (!strncmp (atom.name, "SIMD", (len > 4)? len : 4))
+      { res = LISP$M_getCreateAtom (lmi, (char *) LISP$K_tab.isa); }
+
+    else if (!strncmp (atom.name, "CPUTIM", (len > 6)? len : 6))
+      { res = LISP$M_getCreateNumber (lmi,
+                  (double) clock () / CLOCKS_PER_SEC); }
+
+    else {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "Invalid argument!");
+      res = lmi->NIL;
+    }
+  }
+  else {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "GETLPI needs an argument!");
+    res = lmi->NIL;
+  }
+
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInLET (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  LISP$Ref tmp;
+  LISP$Ref tmpx;
+  LISP$Ref tmpy;
+  LISP$Ref res = lmi->NIL;
+
+  /* Process list of bindings */
+  tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  if (LISP$M_getRefType (tmp) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "LET's first argument must be a list bindings!");
+    return (LISP$M_NULLREF);
+  }
+  while (tmp != lmi->NIL) {
+    /* Get actual bind pair */
+    tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+    if (LISP$M_getRefType (tmpx) != ListTab) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "Invalid binding!");
+      res = LISP$M_NULLREF; break;
+    }
+
+    /* Get the rest of list -- a value terminated by NIL */
+    tmpy = (lmi->lstTab [LISP$M_getRefId (tmpx)]).cdr;
+
+    /* Get atom to be bound to */
+    tmpx = (lmi->lstTab [LISP$M_getRefId (tmpx)]).car;
+
+    /* Get value without it's NIL termination */
+    tmpy = LISP$S_evalAction (lmi,
+        (lmi->lstTab [LISP$M_getRefId (tmpy)]).car, level);
+
+    /* Bind them together */
+    LISP$M_bind (lmi, tmpx, tmpy);
+
+    /* Move to a next argument */
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  /* Process body */
+  if (res != LISP$M_NULLREF) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+    while (tmp != lmi->NIL) {
+      res = LISP$S_evalAction (lmi,
+          (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level);
+
+      /* Move to a next argument */
+      tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    }
+  }
+
+  /* Unbind values */
+  tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  while (tmp != lmi->NIL) {
+    /* Get actual bind pair */
+    tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+    /* Here we probably got bind error, so *
+     * there's nothing more to be unbound  */
+    if (LISP$M_getRefType (tmpx) != ListTab) break;
+
+    /* Get atom to be unbound */
+    tmpx = (lmi->lstTab [LISP$M_getRefId (tmpx)]).car;
+
+    /* Unbind it */
+    LISP$M_unBind (lmi, tmpx);
+
+    /* Move to a next argument */
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInISDEFINED (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  return ((lmi->atmTab [LISP$M_getRefId (ref)]).type != Undefined)?
+    lmi->T : lmi->NIL;
+}
+
+LISP$Ref LISP$M_builtInISATOM (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  return (LISP$M_getRefType (ref) != ListTab)? lmi->T : lmi->NIL;
+}
+
+LISP$Ref LISP$M_builtInISLIST (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  return (LISP$M_getRefType (ref) == ListTab)? lmi->T : lmi->NIL;
+}
+
+LISP$Ref LISP$M_builtInISNUMBER (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  return (LISP$M_isNumber (lmi, ref))? lmi->T : lmi->NIL;
+}
+
+LISP$Ref LISP$M_builtInBODY (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+
+  if ((lmi->atmTab [LISP$M_getRefId (ref)]).type != UserDefFun      &&
+      (lmi->atmTab [LISP$M_getRefId (ref)]).type != UserDefSpecForm &&
+      (lmi->atmTab [LISP$M_getRefId (ref)]).type != UnnamedFun      &&
+      (lmi->atmTab [LISP$M_getRefId (ref)]).type != UnnamedSpecForm) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "Only user defined lambda/special is a valid argument for BODY!");
+    return (LISP$M_NULLREF);
+  }
+
+  return ((lmi->atmTab [LISP$M_getRefId (ref)]).value);
+}
+
+LISP$Ref LISP$M_builtInWHILE (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  LISP$Ref test = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref body = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref tmp;
+
+  /* Iterate right here -- no recursion, no binding, and the garbage *
+   * of finished iterations is collected on the way                  */
+  while (!LISP$M_isError (lmi)) {
+    tmp = LISP$M_touch (lmi, LISP$S_evalAction (lmi, test, level));
+    if (tmp == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    if (tmp == lmi->NIL) return (lmi->NIL);
+
+    for (tmp = body; tmp != lmi->NIL;
+         tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr)
+      if (LISP$S_evalAction (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car,
+                             level) == LISP$M_NULLREF)
+        return (LISP$M_NULLREF);
+
+    LISP$M_safePoint (lmi);
+  }
+
+  return (LISP$M_NULLREF);
+}
+
+LISP$Ref LISP$M_builtInDOTIMES (LISP$MachIns * lmi, LISP$Ref args,
+                                int level) {
+
+  int64_t  i;
+  double   count;
+  LISP$NumberRecord countRec;
+  LISP$Ref spec = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref body = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref var, tmp, res = lmi->NIL;
+
+  /* (DOTIMES (VAR COUNT [RESULT]) BODY...) */
+  if (LISP$M_getRefType (spec) != ListTab ||
+      LISP$M_getRefType (var = (lmi->lstTab [LISP$M_getRefId (spec)]).car)
+        != AtomTab ||
+      LISP$M_getRefType (tmp = (lmi->lstTab [LISP$M_getRefId (spec)]).cdr)
+        != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "DOTIMES's first argument must be (VAR COUNT [RESULT])!");
+    return (LISP$M_NULLREF);
+  }
+
+  tmp = LISP$S_evalAction (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car,
+                           level);
+  if (tmp == LISP$M_NULLREF) return (LISP$M_NULLREF);
+  if (LISP$M_getRefType (tmp) != NumberTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "DOTIMES's count must be a number!");
+    return (LISP$M_NULLREF);
+  }
+  countRec = lmi->numTab [LISP$M_getRefId (tmp)];
+  count    = LISP$M_getNumber (lmi, tmp);
+
+  /* Bind the counter once, then only its value is changed */
+  LISP$M_bind (lmi, var, LISP$M_getCreateInteger (lmi, 0));
+  if (LISP$M_isError (lmi)) return (LISP$M_NULLREF);
+
+  for (i = 0; i < count && res != LISP$M_NULLREF; i++) {
+    (lmi->atmTab [LISP$M_getRefId (var)]).value =
+      LISP$M_getCreateInteger (lmi, i);
+
+    for (tmp = body; tmp != lmi->NIL && res != LISP$M_NULLREF;
+         tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr)
+      res = LISP$S_evalAction (lmi,
+          (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level);
+
+    LISP$M_safePoint (lmi);
+  }
+
+  /* Evaluate the result form with VAR set to COUNT */
+  if (res != LISP$M_NULLREF) {
+    res = lmi->NIL;
+    tmp = (lmi->lstTab [LISP$M_getRefId (spec)]).cdr;
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    if (tmp != lmi->NIL) {
+      (lmi->atmTab [LISP$M_getRefId (var)]).value =
+        (count > 0)? LISP$M_getCreateNumberRecord (lmi, countRec) :
+                     LISP$M_getCreateInteger (lmi, 0);
+      res = LISP$S_evalAction (lmi,
+          (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level);
+    }
+  }
+
+  LISP$M_unBind (lmi, var);
+
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInDO (LISP$MachIns * lmi, LISP$Ref args, int level) {
+
+  int        i, n;
+  LISP$Ref   vars = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref   tmp  = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref   end  = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  LISP$Ref   body = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  LISP$Ref   spec, res = lmi->NIL;
+  LISP$Ref * steps;
+  int        roots;
+
+  /* (DO ((VAR INIT [STEP])...) (END-TEST [RESULT...]) BODY...) */
+  if ((vars != lmi->NIL && LISP$M_getRefType (vars) != ListTab) ||
+      LISP$M_getRefType (end) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "DO needs a list of (VAR INIT [STEP]) and (END-TEST [RESULT...])!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* Bind variables one by one like LET does */
+  for (n = 0, tmp = vars; tmp != lmi->NIL && res != LISP$M_NULLREF; n++) {
+    spec = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    if (LISP$M_getRefType (spec) != ListTab ||
+        LISP$M_getRefType ((lmi->lstTab [LISP$M_getRefId (spec)]).car)
+          != AtomTab) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "Invalid DO binding!");
+      res = LISP$M_NULLREF; break;
+    }
+
+    res = (lmi->lstTab [LISP$M_getRefId (spec)]).cdr;
+    res = (res == lmi->NIL)? lmi->NIL : LISP$S_evalAction (lmi,
+              (lmi->lstTab [LISP$M_getRefId (res)]).car, level);
+    if (res == LISP$M_NULLREF) break;
+
+    LISP$M_bind (lmi, (lmi->lstTab [LISP$M_getRefId (spec)]).car, res);
+    if (LISP$M_isError (lmi)) { res = LISP$M_NULLREF; break; }
+
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  /* New values of all the variables are computed first and assigned *
+   * then, they're kept on the root stack in the meantime            */
+  steps = (LISP$Ref *) malloc ((n + 1) * sizeof (LISP$Ref));
+  roots = lmi->rootTop;
+
+  /* The variables are unbound below all the same */
+  if (steps == NULL && res != LISP$M_NULLREF) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for DO!");
+    res = LISP$M_NULLREF;
+  }
+
+  while (res != LISP$M_NULLREF) {
+    /* Test for the end and evaluate results */
+    res = LISP$S_evalAction (lmi, (lmi->lstTab [LISP$M_getRefId (end)]).car,
+                             level);
+    if (res == LISP$M_NULLREF) break;
+    if (res != lmi->NIL) {
+      res = lmi->NIL;
+      for (tmp = (lmi->lstTab [LISP$M_getRefId (end)]).cdr;
+           tmp != lmi->NIL && res != LISP$M_NULLREF;
+           tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr)
+        res = LISP$S_evalAction (lmi,
+            (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level);
+      break;
+    }
+
+    /* Body */
+    for (tmp = body; tmp != lmi->NIL && res != LISP$M_NULLREF;
+         tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr)
+      res = LISP$S_evalAction (lmi,
+          (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level);
+    if (res == LISP$M_NULLREF) break;
+
+    /* Steps */
+    for (i = 0, tmp = vars; i < n && res != LISP$M_NULLREF; i++) {
+      spec = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+      spec = (lmi->lstTab [LISP$M_getRefId (spec)]).cdr;
+      steps [i] = LISP$M_NULLREF;
+      if (spec != lmi->NIL &&
+          (spec = (lmi->lstTab [LISP$M_getRefId (spec)]).cdr) != lmi->NIL) {
+        res = steps [i] = LISP$S_evalAction (lmi,
+            (lmi->lstTab [LISP$M_getRefId (spec)]).car, level);
+        LISP$M_pushRoot (lmi, steps [i]);
+      }
+      tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    }
+    if (res == LISP$M_NULLREF) break;
+
+    for (i = 0, tmp = vars; i < n; i++) {
+      spec = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+      if (steps [i] != LISP$M_NULLREF)
+        (lmi->atmTab [LISP$M_getRefId (
+           (lmi->lstTab [LISP$M_getRefId (spec)]).car)]).value = steps [i];
+      tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    }
+    lmi->rootTop = roots;
+
+    LISP$M_safePoint (lmi);
+  }
+
+  free (steps);
+  lmi->rootTop = roots;
+
+  /* Unbind all the variables bound successfully */
+  for (i = 0, tmp = vars; i < n; i++) {
+    spec = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    LISP$M_unBind (lmi, (lmi->lstTab [LISP$M_getRefId (spec)]).car);
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  return (res);
+}
+
+LISP$Ref LISP$M_listAppend (LISP$MachIns * lmi, LISP$Ref x, LISP$Ref y) {
+
+  LISP$Ref res  = LISP$M_NULLREF;
+  LISP$Ref last = LISP$M_NULLREF;
+  LISP$Ref cell = LISP$M_NULLREF;
+  LISP$Ref tmp  = x;
+
+  if (x == lmi->NIL) return (y);
+
+  /* Copy the spine of 'x' -- its items are shared, not copied */
+  while (LISP$M_getRefType (tmp) == ListTab) {
+    cell = LISP$M_createList (lmi);
+    if (cell == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    (lmi->lstTab [LISP$M_getRefId (cell)]).car =
+      (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+    if (last == LISP$M_NULLREF) res = cell;
+    else (lmi->lstTab [LISP$M_getRefId (last)]).cdr = cell;
+    last = cell;
+
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  /* An atom (or the tail of a dotted pair) is appended as an item, *
+   * so (APPEND 'A '(B)) is (A B) as it was in startup.lisp         */
+  if (tmp != lmi->NIL) {
+    cell = LISP$M_createList (lmi);
+    if (cell == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    (lmi->lstTab [LISP$M_getRefId (cell)]).car = tmp;
+
+    if (last == LISP$M_NULLREF) res = cell;
+    else (lmi->lstTab [LISP$M_getRefId (last)]).cdr = cell;
+    last = cell;
+  }
+
+  (lmi->lstTab [LISP$M_getRefId (last)]).cdr = y;
+
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInAPPEND (LISP$MachIns * lmi, LISP$Ref args, int argc) {
+
+  int        i;
+  LISP$Ref   res = lmi->NIL;
+  LISP$Ref   tmp = args;
+  LISP$Ref * argv;
+
+  if (argc <= 0) return (lmi->NIL);
+
+  /* Lists are appended from the right, so collect them first */
+  argv = (LISP$Ref *) malloc (argc * sizeof (LISP$Ref));
+  if (argv == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for APPEND!");
+    return (LISP$M_NULLREF);
+  }
+  for (i = 0; i < argc; i++) {
+    argv [i] = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    tmp      = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  res = argv [argc - 1];
+  for (i = argc - 2; i >= 0 && res != LISP$M_NULLREF; i--)
+    res = LISP$M_listAppend (lmi, argv [i], res);
+
+  free (argv);
+  return (res);
+}
+
+LISP$Ref LISP$M_builtInREVERSE (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref res = lmi->NIL;
+  LISP$Ref tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+
+  /* Atoms are reversed to themselves */
+  if (LISP$M_getRefType (tmp) != ListTab) return (tmp);
+
+  while (LISP$M_getRefType (tmp) == ListTab) {
+    LISP$M_listPush (lmi, &res, (lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+    if (LISP$M_isError (lmi)) return (LISP$M_NULLREF);
+
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  /* Tail of a dotted pair becomes the first item */
+  if (tmp != lmi->NIL) LISP$M_listPush (lmi, &res, tmp);
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+int LISP$M_sortLess (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref pair,
+                     LISP$Ref x, LISP$Ref y, int level) {
+
+  LISP$Ref res;
+
+  /* Default ordering -- numbers ascending */
+  if (fun == LISP$M_NULLREF) {
+    if (!LISP$M_isNumber (lmi, x) || !LISP$M_isNumber (lmi, y)) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "SORT without a predicate works only with numbers!");
+      return (-1);
+    }
+    return (LISP$M_compareNumbers (lmi, x, y, <));
+  }
+
+  /* User predicate -- the argument list is reused for each call */
+  (lmi->lstTab [LISP$M_getRefId (pair)]).car = x;
+  (lmi->lstTab [LISP$M_getRefId (
+     (lmi->lstTab [LISP$M_getRefId (pair)]).cdr)]).car = y;
+
+  res = LISP$S_apply (lmi, fun, pair, level);
+  if (res == LISP$M_NULLREF) return (-1);
+
+  return (res != lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInSORT (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             int level) {
+
+  int        i, j, k, n, lo, mid, hi, width, less;
+  LISP$Ref   res  = lmi->NIL;
+  LISP$Ref   fun  = LISP$M_NULLREF;
+  LISP$Ref   pair = LISP$M_NULLREF;
+  LISP$Ref   cell;
+  LISP$Ref   tmp  = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref * items;
+  LISP$Ref * buf;
+  LISP$Ref * swp;
+
+  if (tmp == lmi->NIL) return (lmi->NIL);
+  if (LISP$M_getRefType (tmp) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "SORT's first argument must be a list!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* Optional predicate called as (PREDICATE X Y), true if X < Y */
+  if (argc > 1) {
+    fun = (lmi->lstTab [LISP$M_getRefId (
+            (lmi->lstTab [LISP$M_getRefId (args)]).cdr)]).car;
+    pair = LISP$M_createList (lmi);
+    if (pair == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    LISP$M_pushRoot (lmi, pair);
+    cell = LISP$M_createList (lmi);
+    if (cell == LISP$M_NULLREF) return (LISP$M_NULLREF);
+    (lmi->lstTab [LISP$M_getRefId (pair)]).cdr = cell;
+  }
+
+  for (n = 0; LISP$M_getRefType (tmp) == ListTab; n++)
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+
+  items = (LISP$Ref *) malloc (2 * n * sizeof (LISP$Ref));
+  if (items == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for SORT!");
+    return (LISP$M_NULLREF);
+  }
+  buf   = items + n;
+
+  tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  for (i = 0; i < n; i++) {
+    items [i] = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    tmp       = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  /* Bottom-up merge sort; the right item is taken only if it's *
+   * strictly less than the left one, so the sort is stable     */
+  less = 0;
+  for (width = 1; width < n && less >= 0; width *= 2) {
+    for (lo = 0; lo < n && less >= 0; lo += 2 * width) {
+      mid = (lo + width < n)? lo + width : n;
+      hi  = (lo + 2 * width < n)? lo + 2 * width : n;
+
+      for (i = lo, j = mid, k = lo; k < hi; k++) {
+        if (i < mid && j < hi) {
+          less = LISP$M_sortLess (lmi, fun, pair, items [j], items [i],
+                                  level);
+          if (less < 0) break;
+          buf [k] = less? items [j++] : items [i++];
+        }
+        else buf [k] = (i < mid)? items [i++] : items [j++];
+      }
+    }
+    swp = items; items = buf; buf = swp;
+  }
+
+  /* Build a new list from the sorted vector */
+  for (i = n - 1; i >= 0 && less >= 0 && !LISP$M_isError (lmi); i--)
+    LISP$M_listPush (lmi, &res, items [i]);
+
+  free ((items < buf)? items : buf);
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+LISP$Ref LISP$M_builtInMEMBER (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref item = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref tmp  = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+
+  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  if (tmp != lmi->NIL && LISP$M_getRefType (tmp) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "MEMBER's second argument must be a list!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* Items are compared by reference, as IS does */
+  while (LISP$M_getRefType (tmp) == ListTab) {
+    if ((lmi->lstTab [LISP$M_getRefId (tmp)]).car == item) return (lmi->T);
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  return (lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInLENGTH (LISP$MachIns * lmi, LISP$Ref args) {
+
+  int      len = 0;
+  LISP$Ref tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+
+  if (tmp != lmi->NIL && LISP$M_getRefType (tmp) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "LENGTH's argument must be a list!");
+    return (LISP$M_NULLREF);
+  }
+
+  while (LISP$M_getRefType (tmp) == ListTab) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    len++;
+  }
+
+  return (LISP$M_getCreateInteger (lmi, len));
+}
+
+LISP$Ref LISP$M_builtInNTH (LISP$MachIns * lmi, LISP$Ref args) {
+
+  int64_t  n;
+  LISP$Ref idx = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+
+  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  if (LISP$M_getRefType (idx) != NumberTab ||
+      !LISP$M_getInteger (lmi, idx, &n) || n < 0) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "NTH's first argument must be a non-negative integer!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* Items are counted from zero, NIL is returned past the end */
+  while (LISP$M_getRefType (tmp) == ListTab && n-- > 0)
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+
+  if (LISP$M_getRefType (tmp) != ListTab) return (lmi->NIL);
+
+  return ((lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+}
+
+LISP$Ref LISP$M_builtInASSOC (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref key = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref pair;
+
+  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+  /* Return the first pair whose CAR IS the key; non-pairs are skipped */
+  while (LISP$M_getRefType (tmp) == ListTab) {
+    pair = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    if (LISP$M_getRefType (pair) == ListTab &&
+        (lmi->lstTab [LISP$M_getRefId (pair)]).car == key)
+      return (pair);
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  return (lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInMAPCAR (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                               int level) {
+
+  int        i;
+  LISP$Ref   fun   = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref   tmp   = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref   res   = lmi->NIL;
+  LISP$Ref   last  = LISP$M_NULLREF;
+  LISP$Ref   cell  = LISP$M_NULLREF;
+  LISP$Ref   fargs = lmi->NIL;
+  LISP$Ref * lists;
+
+  /* Cursors to all the lists walked in parallel */
+  lists = (LISP$Ref *) malloc ((argc - 1) * sizeof (LISP$Ref));
+  if (lists == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for MAPCAR!");
+    return (LISP$M_NULLREF);
+  }
+  for (i = 0; i < argc - 1; i++) {
+    lists [i] = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    tmp       = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  }
+
+  while (!LISP$M_isError (lmi)) {
+    /* Stop at the end of the shortest list */
+    for (i = 0; i < argc - 1; i++)
+      if (LISP$M_getRefType (lists [i]) != ListTab) break;
+    if (i < argc - 1) break;
+
+    /* Fresh argument list for each call, since LIST returns it */
+    fargs = lmi->NIL;
+    for (i = argc - 2; i >= 0; i--) {
+      LISP$M_listPush (lmi, &fargs,
+          (lmi->lstTab [LISP$M_getRefId (lists [i])]).car);
+      lists [i] = (lmi->lstTab [LISP$M_getRefId (lists [i])]).cdr;
+    }
+    if (LISP$M_isError (lmi)) break;
+
+    tmp = LISP$S_apply (lmi, fun, fargs, level);
+    if (tmp == LISP$M_NULLREF) break;
+
+    /* Collect the result */
+    cell = LISP$M_createList (lmi);
+    if (cell == LISP$M_NULLREF) break;
+    (lmi->lstTab [LISP$M_getRefId (cell)]).car = tmp;
+
+    /* The result is kept safe from GC while calling 'fun' next time */
+    if (last == LISP$M_NULLREF) LISP$M_pushRoot (lmi, res = cell);
+    else (lmi->lstTab [LISP$M_getRefId (last)]).cdr = cell;
+    last = cell;
+  }
+
+  free (lists);
+
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
+}
+
+bool LISP$M_isEqual (LISP$MachIns * lmi, LISP$Ref x, LISP$Ref y) {
+
+  LISP$String * xs, * ys;
+
+  while (x != y) {
+    /* Big integers are separate objects, so they're compared by value */
+    if (LISP$M_isBignum (lmi, x) && LISP$M_isBignum (lmi, y))
+      return (!LISP$M_compareExact (lmi, x, y));
+
+    /* So are long strings -- short ones are unique atoms */
+    if (LISP$M_getRefType (x) == ObjectTab &&
+        LISP$M_getRefType (y) == ObjectTab &&
+        (lmi->objTab [LISP$M_getRefId (x)]).type == LongString &&
+        (lmi->objTab [LISP$M_getRefId (y)]).type == LongString) {
+      xs = (lmi->objTab [LISP$M_getRefId (x)]).data.string;
+      ys = (lmi->objTab [LISP$M_getRefId (y)]).data.string;
+      return (xs->length == ys->length &&
+              !memcmp (xs->chars, ys->chars, xs->length));
+    }
+
+    if (LISP$M_getRefType (x) != ListTab ||
+        LISP$M_getRefType (y) != ListTab) return false;
+
+    if (!LISP$M_isEqual (lmi, (lmi->lstTab [LISP$M_getRefId (x)]).car,
+                              (lmi->lstTab [LISP$M_getRefId (y)]).car))
+      return false;
+
+    x = (lmi->lstTab [LISP$M_getRefId (x)]).cdr;
+    y = (lmi->lstTab [LISP$M_getRefId (y)]).cdr;
+  }
+
+  return true;
+}
+
+unsigned int LISP$M_hashRef (LISP$MachIns * lmi, LISP$Ref ref,
+                             bool isEqual, int depth) {
+
+  int           n;
+  unsigned int  h = (unsigned int) ref;
+  LISP$String * str;
+
+  /* Lists are hashed by contents for EQUAL, but only up to some depth *
+   * and length, so that huge keys don't cost more than comparing them */
+  if (isEqual && LISP$M_getRefType (ref) == ListTab) {
+    h = 0x9E3779B9;
+    for (n = 0; LISP$M_getRefType (ref) == ListTab && n < 16; n++) {
+      h = (h ^ ((depth < 4)? LISP$M_hashRef (lmi,
+                  (lmi->lstTab [LISP$M_getRefId (ref)]).car, true, depth + 1)
+                : 0)) * 0x01000193;
+      ref = (lmi->lstTab [LISP$M_getRefId (ref)]).cdr;
+    }
+    if (LISP$M_getRefType (ref) != ListTab) h ^= (unsigned int) ref;
+  }
+  else if (isEqual && LISP$M_isBignum (lmi, ref))
+    h = LISP$B_hash ((lmi->objTab [LISP$M_getRefId (ref)]).data.bignum);
+  else if (isEqual && LISP$M_getRefType (ref) == ObjectTab &&
+           (lmi->objTab [LISP$M_getRefId (ref)]).type == LongString) {
+    str = (lmi->objTab [LISP$M_getRefId (ref)]).data.string;
+    h = 0x811C9DC5;
+    for (n = 0; (size_t) n < str->length; n++)
+      h = (h ^ (unsigned char) str->chars [n]) * 0x01000193;
+  }
+
+  /* Final mix -- references are mostly small sequential integers */
+  h ^= h >> 16; h *= 0x85EBCA6B;
+  h ^= h >> 13; h *= 0xC2B2AE35;
+  h ^= h >> 16;
+
+  return h;
+}
+
+LISP$HashTable * LISP$M_hashCreate (bool isEqual) {
+
+  LISP$HashTable * h = (LISP$HashTable *) malloc (sizeof (LISP$HashTable));
+  if (h == NULL) return NULL;
+
+  h->isEqual    = isEqual;
+  h->count      = 0;
+  h->size       = LISP$MACH_HASHINITLEN;
+  h->buckets    = (LISP$HashEntry **)
+                    calloc (h->size, sizeof (LISP$HashEntry *));
+  h->oldSize    = 0;
+  h->oldBuckets = NULL;
+  h->rehashPos  = 0;
+  h->iterating  = 0;
+
+  if (h->buckets == NULL) { free (h); return NULL; }
+
+  return h;
+}
+
+static bool LISP$M_hashCloneChain (LISP$HashEntry * e, LISP$HashEntry ** to) {
+
+  for (; e != NULL; e = e->next, to = &((*to)->next)) {
+    if ((*to = (LISP$HashEntry *) malloc (sizeof (LISP$HashEntry))) == NULL)
+      return false;
+    **to = *e;
+    (*to)->next = NULL;
+  }
+
+  return true;
+}
+
+LISP$HashTable * LISP$M_hashClone (const LISP$HashTable * h) {
+
+  int i;
+  bool isDone = true;
+  LISP$HashTable * c = (LISP$HashTable *) malloc (sizeof (LISP$HashTable));
+  if (c == NULL) return NULL;
+
+  /* Even the buckets being moved are kept as they are */
+  *c = *h;
+  c->buckets    = (LISP$HashEntry **)
+                    calloc (h->size, sizeof (LISP$HashEntry *));
+  c->oldBuckets = (h->oldBuckets == NULL)? NULL : (LISP$HashEntry **)
+                    calloc (h->oldSize, sizeof (LISP$HashEntry *));
+
+  if (c->buckets == NULL || (h->oldBuckets != NULL && c->oldBuckets == NULL))
+    isDone = false;
+
+  for (i = h->rehashPos; isDone && i < h->oldSize; i++)
+    isDone = LISP$M_hashCloneChain (h->oldBuckets [i], &(c->oldBuckets [i]));
+  for (i = 0; isDone && i < h->size; i++)
+    isDone = LISP$M_hashCloneChain (h->buckets [i], &(c->buckets [i]));
+
+  if (!isDone) {
+    if (c->buckets == NULL) c->size = 0;
+    if (c->oldBuckets == NULL) c->oldSize = 0;
+    LISP$M_hashDestroy (c);
+    return NULL;
+  }
+
+  return c;
+}
+
+void LISP$M_hashDestroy (LISP$HashTable * h) {
+
+  int i;
+  LISP$HashEntry * e;
+  LISP$HashEntry * next;
+
+  if (h == NULL) return;
+
+  for (i = h->rehashPos; i < h->oldSize; i++)
+    for (e = h->oldBuckets [i]; e != NULL; e = next)
+      { next = e->next; free (e); }
+
+  for (i = 0; i < h->size; i++)
+    for (e = h->buckets [i]; e != NULL; e = next)
+      { next = e->next; free (e); }
+
+  free (h->oldBuckets);
+  free (h->buckets);
+  free (h);
+}
+
+void LISP$M_hashRehashStep (LISP$HashTable * h, int n) {
+
+  LISP$HashEntry * e;
+  LISP$HashEntry * next;
+  unsigned int     i;
+
+  /* Entries mustn't move between buckets under MAPHASH's hands */
+  if (h->iterating) return;
+
+  while (h->oldBuckets != NULL && n-- > 0) {
+    for (e = h->oldBuckets [h->rehashPos]; e != NULL; e = next) {
+      next = e->next;
+      i = e->hash & (h->size - 1);
+      e->next = h->buckets [i];
+      h->buckets [i] = e;
+    }
+    h->oldBuckets [h->rehashPos++] = NULL;
+
+    if (h->rehashPos >= h->oldSize) {
+      free (h->oldBuckets);
+      h->oldBuckets = NULL;
+      h->oldSize = h->rehashPos = 0;
+    }
+  }
+}
+
+LISP$HashEntry ** LISP$M_hashLookup (LISP$MachIns * lmi, LISP$HashTable * h,
+                                     LISP$Ref key, unsigned int hash) {
+
+  int i;
+  LISP$HashEntry ** e;
+
+  /* Buckets not moved yet are still looked up in the old array */
+  if (h->oldBuckets != NULL &&
+      (i = hash & (h->oldSize - 1)) >= h->rehashPos)
+    e = &(h->oldBuckets [i]);
+  else
+    e = &(h->buckets [hash & (h->size - 1)]);
+
+  /* Returns the link to the entry found, or to the chain's end */
+  for (; *e != NULL; e = &((*e)->next))
+    if ((*e)->key != LISP$M_NULLREF && (*e)->hash == hash &&
+        ((*e)->key == key ||
+         (h->isEqual && LISP$M_isEqual (lmi, (*e)->key, key))))
+      break;
+
+  return e;
+}
+
+bool LISP$M_hashPut (LISP$MachIns * lmi, LISP$HashTable * h,
+                     LISP$Ref key, LISP$Ref value) {
+
+  unsigned int      hash = LISP$M_hashRef (lmi, key, h->isEqual, 0);
+  LISP$HashEntry ** e;
+  LISP$HashEntry ** buckets;
+
+  LISP$M_hashRehashStep (h, 2);
+
+  e = LISP$M_hashLookup (lmi, h, key, hash);
+  if (*e != NULL) { (*e)->value = value; return true; }
+
+  *e = (LISP$HashEntry *) malloc (sizeof (LISP$HashEntry));
+  if (*e == NULL) return false;
+  (*e)->key   = key;
+  (*e)->value = value;
+  (*e)->hash  = hash;
+  (*e)->next  = NULL;
+  h->count++;
+
+  /* Grow twice when the load reaches one; the old buckets are moved *
+   * by the next operations, two at a time, which is enough to finish *
+   * before the table is full again                                    */
+  if (h->oldBuckets == NULL && !h->iterating && h->count > h->size) {
+    buckets = (LISP$HashEntry **)
+                calloc (2 * h->size, sizeof (LISP$HashEntry *));
+    if (buckets == NULL) return true;
+
+    h->oldBuckets = h->buckets;
+    h->oldSize    = h->size;
+    h->rehashPos  = 0;
+    h->buckets    = buckets;
+    h->size      *= 2;
+  }
+
+  return true;
+}
+
+bool LISP$M_hashRemove (LISP$MachIns * lmi, LISP$HashTable * h,
+                        LISP$Ref key) {
+
+  LISP$HashEntry ** e;
+  LISP$HashEntry *  tmp;
+
+  LISP$M_hashRehashStep (h, 2);
+
+  e = LISP$M_hashLookup (lmi, h, key,
+                         LISP$M_hashRef (lmi, key, h->isEqual, 0));
+  if (*e == NULL) return false;
+
+  h->count--;
+
+  /* MAPHASH keeps walking the chain, so the entry is just cleared *
+   * and purged when the iteration is over                         */
+  if (h->iterating) {
+    (*e)->key = (*e)->value = LISP$M_NULLREF;
+    return true;
+  }
+
+  tmp = *e;
+  *e  = tmp->next;
+  free (tmp);
+
+  return true;
+}
+
+void LISP$M_hashPurge (LISP$HashTable * h) {
+
+  int i;
+  LISP$HashEntry ** e;
+  LISP$HashEntry *  tmp;
+
+  for (i = 0; i < h->oldSize + h->size; i++) {
+    if (i < h->oldSize && i < h->rehashPos) continue;
+
+    e = (i < h->oldSize)? &(h->oldBuckets [i]) :
+                          &(h->buckets [i - h->oldSize]);
+    while (*e != NULL) {
+      if ((*e)->key == LISP$M_NULLREF) {
+        tmp = *e; *e = tmp->next; free (tmp);
+      }
+      else e = &((*e)->next);
+    }
+  }
+}
+
+LISP$HashTable * LISP$M_getHashTable (LISP$MachIns * lmi, LISP$Ref ref,
+                                      const char * name) {
+
+  if (LISP$M_getRefType (ref) != ObjectTab ||
+      (lmi->objTab [LISP$M_getRefId (ref)]).type != HashTable) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a hash table!", name);
+    return NULL;
+  }
+
+  return ((lmi->objTab [LISP$M_getRefId (ref)]).data.hash);
+}
+
+LISP$Ref LISP$M_builtInEQUAL (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref x = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref y = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+
+  y = (lmi->lstTab [LISP$M_getRefId (y)]).car;
+
+  return (LISP$M_isEqual (lmi, x, y)? lmi->T : lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInMAKEHASH (LISP$MachIns * lmi, LISP$Ref args,
+                                 int argc) {
+
+  bool             isEqual = true;
+  LISP$Ref         tmp;
+  LISP$Ref         res;
+  LISP$HashTable * h;
+  char *           name;
+
+  /* (MAKE-HASH ['EQ | 'EQUAL]) -- EQ compares keys like IS does */
+  if (argc) {
+    tmp  = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+    name = (LISP$M_getRefType (tmp) == AtomTab)?
+             (lmi->atmTab [LISP$M_getRefId (tmp)]).name : "";
+    if (!strcmp (name, "EQ") || !strcmp (name, "IS")) isEqual = false;
+    else if (strcmp (name, "EQUAL")) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "MAKE-HASH's test must be EQ or EQUAL!");
+      return (LISP$M_NULLREF);
+    }
+  }
+
+  if ((h = LISP$M_hashCreate (isEqual)) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "Unable to allocate a hash table!");
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_createObject (lmi, HashTable);
+  if (res == LISP$M_NULLREF) {
+    LISP$M_hashDestroy (h);
+    return (LISP$M_NULLREF);
+  }
+
+  (lmi->objTab [LISP$M_getRefId (res)]).data.hash = h;
+  return res;
+}
+
+LISP$Ref LISP$M_builtInGETHASH (LISP$MachIns * lmi, LISP$Ref args,
+                                int argc) {
+
+  LISP$Ref          key = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref          tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$HashTable *  h;
+  LISP$HashEntry ** e;
+
+  h = LISP$M_getHashTable (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car,
+                           "GETHASH");
+  if (h == NULL) return (LISP$M_NULLREF);
+
+  LISP$M_hashRehashStep (h, 2);
+  e = LISP$M_hashLookup (lmi, h, key,
+                         LISP$M_hashRef (lmi, key, h->isEqual, 0));
+  if (*e != NULL) return ((*e)->value);
+
+  /* (GETHASH KEY TABLE [DEFAULT]) */
+  if (argc > 2) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    return ((lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+  }
+
+  return (lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInPUTHASH (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref         key   = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref         tmp   = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref         value = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  LISP$HashTable * h;
+
+  /* (PUTHASH KEY VALUE TABLE) */
+  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  h = LISP$M_getHashTable (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car,
+                           "PUTHASH");
+  if (h == NULL) return (LISP$M_NULLREF);
+
+  if (!LISP$M_hashPut (lmi, h, key, value)) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "Out of memory for a hash table entry!");
+    return (LISP$M_NULLREF);
+  }
+
+  return value;
+}
+
+LISP$Ref LISP$M_builtInREMHASH (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Ref         key = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref         tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$HashTable * h;
+
+  h = LISP$M_getHashTable (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car,
+                           "REMHASH");
+  if (h == NULL) return (LISP$M_NULLREF);
+
+  return (LISP$M_hashRemove (lmi, h, key)? lmi->T : lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInMAPHASH (LISP$MachIns * lmi, LISP$Ref args,
+                                int level) {
+
+  int              i;
+  LISP$Ref         fun   = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref         tmp   = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref         res   = lmi->NIL;
+  LISP$Ref         fargs;
+  LISP$HashTable * h;
+  LISP$HashEntry * e;
+
+  h = LISP$M_getHashTable (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car,
+                           "MAPHASH");
+  if (h == NULL) return (LISP$M_NULLREF);
+
+  /* Call (FUN KEY VALUE) for each entry; the table doesn't move its    *
+   * entries meanwhile, the removed ones are only cleared and new ones *
+   * may or may not be visited                                         */
+  h->iterating++;
+  for (i = h->rehashPos; i < h->oldSize + h->size && res != LISP$M_NULLREF;
+       i++) {
+    if (i < h->oldSize && i < h->rehashPos) continue;
+
+    e = (i < h->oldSize)? h->oldBuckets [i] : h->buckets [i - h->oldSize];
+    for (; e != NULL && res != LISP$M_NULLREF; e = e->next) {
+      if (e->key == LISP$M_NULLREF) continue;
+
+      fargs = lmi->NIL;
+      LISP$M_listPush (lmi, &fargs, e->value);
+      LISP$M_listPush (lmi, &fargs, e->key);
+      if (LISP$M_isError (lmi)) { res = LISP$M_NULLREF; break; }
+
+      res = LISP$S_apply (lmi, fun, fargs, level);
+    }
+  }
+  if (--(h->iterating) == 0) LISP$M_hashPurge (h);
+
+  return ((res == LISP$M_NULLREF)? LISP$M_NULLREF : lmi->NIL);
+}
+
+LISP$Ref LISP$M_builtInHASHCOUNT (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$HashTable * h = LISP$M_getHashTable (lmi,
+                         (lmi->lstTab [LISP$M_getRefId (args)]).car,
+                         "HASH-COUNT");
+  if (h == NULL) return (LISP$M_NULLREF);
+
+  return (LISP$M_getCreateInteger (lmi, h->count));
+}
+
+LISP$Ref LISP$M_createVector (LISP$MachIns * lmi, LISP$ObjectType type,
+                              int length) {
+
+  LISP$Vector * v;
+  LISP$Ref      res;
+
+  if (length < 0) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "Vector length must be a non-negative integer!");
+    return (LISP$M_NULLREF);
+  }
+
+  v = (LISP$Vector *) malloc (sizeof (LISP$Vector));
+  if (v != NULL) {
+    v->length = length;
+    v->items.refs = (type == RefVector)?
+      (LISP$Ref *) malloc ((length + 1) * sizeof (LISP$Ref)) :
+      (LISP$Ref *) malloc ((length + 1) * sizeof (double));
+    if (v->items.refs == NULL) { free (v); v = NULL; }
+  }
+
+  if (v == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "Unable to allocate a vector of %d items!", length);
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_createObject (lmi, type);
+  if (res == LISP$M_NULLREF) {
+    free (v->items.refs); free (v);
+    return (LISP$M_NULLREF);
+  }
+
+  (lmi->objTab [LISP$M_getRefId (res)]).data.vector = v;
+  lmi->objBytes += (length + 1) * sizeof (double);
+  return res;
+}
+
+LISP$Vector * LISP$M_getVector (LISP$MachIns * lmi, LISP$Ref ref,
+                                const char * name) {
+
+  if (LISP$M_getRefType (ref) != ObjectTab ||
+      ((lmi->objTab [LISP$M_getRefId (ref)]).type != RefVector &&
+       (lmi->objTab [LISP$M_getRefId (ref)]).type != DoubleVector)) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a vector!", name);
+    return NULL;
+  }
+
+  return ((lmi->objTab [LISP$M_getRefId (ref)]).data.vector);
+}
+
+int LISP$M_getVectorIndex (LISP$MachIns * lmi, LISP$Vector * v,
+                           LISP$Ref ref, const char * name) {
+
+  int64_t i;
+
+  if (LISP$M_getRefType (ref) != NumberTab ||
+      !LISP$M_getInteger (lmi, ref, &i) || i < 0 || i >= v->length) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s's index is out of the vector bounds!", name);
+    return (-1);
+  }
+
+  return ((int) i);
+}
+
+LISP$Ref LISP$M_builtInMAKEVECTOR (LISP$MachIns * lmi, LISP$Ref args,
+                                   int argc) {
+
+  int             i;
+  double          n;
+  LISP$Ref        len  = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref        tmp  = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref        init = LISP$M_NULLREF;
+  LISP$Ref        res;
+  LISP$ObjectType type = RefVector;
+  LISP$Vector *   v;
+
+  /* (MAKE-VECTOR LENGTH [INIT] [DOUBLE]) */
+  if (argc > 1) init = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  if (argc > 2) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    if (LISP$M_getRefType (tmp) != AtomTab ||
+        strcmp ((lmi->atmTab [LISP$M_getRefId (tmp)]).name, "DOUBLE")) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "MAKE-VECTOR's third argument can be only DOUBLE!");
+      return (LISP$M_NULLREF);
+    }
+    type = DoubleVector;
+  }
+
+  n = (LISP$M_getRefType (len) == NumberTab)?
+        LISP$M_getNumber (lmi, len) : 0.5;
+
+  if (n != (int) n) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "MAKE-VECTOR's length must be an integer!");
+    return (LISP$M_NULLREF);
+  }
+
+  if (type == DoubleVector && init != LISP$M_NULLREF &&
+      !LISP$M_isNumber (lmi, init)) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "DOUBLE vector can be initialized only by a number!");
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_createVector (lmi, type, (int) n);
+  if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+  v = (lmi->objTab [LISP$M_getRefId (res)]).data.vector;
+
+  if (type == RefVector) {
+    if (init == LISP$M_NULLREF) init = lmi->NIL;
+    for (i = 0; i < v->length; i++) v->items.refs [i] = init;
+  }
+  else {
+    n = (init == LISP$M_NULLREF)? 0 : LISP$M_getNumber (lmi, init);
+    for (i = 0; i < v->length; i++) v->items.nums [i] = n;
+  }
+
+  return res;
+}
+
+LISP$Ref LISP$M_builtInVREF (LISP$MachIns * lmi, LISP$Ref args) {
+
+  int           i;
+  LISP$Ref      vec = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref      tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Vector * v   = LISP$M_getVector (lmi, vec, "VREF");
+
+  if (v == NULL) return (LISP$M_NULLREF);
+
+  i = LISP$M_getVectorIndex (lmi, v,
+        (lmi->lstTab [LISP$M_getRefId (tmp)]).car, "VREF");
+  if (i < 0) return (LISP$M_NULLREF);
+
+  /* Unboxed numbers get their number table record just now */
+  if ((lmi->objTab [LISP$M_getRefId (vec)]).type == DoubleVector)
+    return (LISP$M_getCreateNumber (lmi, v->items.nums [i]));
+
+  return (v->items.refs [i]);
+}
+
+LISP$Ref LISP$M_builtInVSET (LISP$MachIns * lmi, LISP$Ref args) {
+
+  int           i;
+  LISP$Ref      vec = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref      tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref      val;
+  LISP$Vector * v   = LISP$M_getVector (lmi, vec, "VSET");
+
+  if (v == NULL) return (LISP$M_NULLREF);
+
+  /* (VSET VECTOR INDEX VALUE) */
+  i = LISP$M_getVectorIndex (lmi, v,
+        (lmi->lstTab [LISP$M_getRefId (tmp)]).car, "VSET");
+  if (i < 0) return (LISP$M_NULLREF);
+
+  tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  val = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+
+  if ((lmi->objTab [LISP$M_getRefId (vec)]).type == DoubleVector) {
+    if (!LISP$M_isNumber (lmi, val)) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "Only numbers can be stored into a DOUBLE vector!");
+      return (LISP$M_NULLREF);
+    }
+    v->items.nums [i] = LISP$M_getNumber (lmi, val);
+  }
+  else v->items.refs [i] = val;
+
+  return (val);
+}
+
+LISP$Ref LISP$M_builtInVLENGTH (LISP$MachIns * lmi, LISP$Ref args) {
+
+  LISP$Vector * v = LISP$M_getVector (lmi,
+                      (lmi->lstTab [LISP$M_getRefId (args)]).car, "VLENGTH");
+  if (v == NULL) return (LISP$M_NULLREF);
+
+  return (LISP$M_getCreateInteger (lmi, v->length));
+}
+
+LISP$Ref LISP$M_builtInLISTTOVECTOR (LISP$MachIns * lmi, LISP$Ref args,
+                                     int argc) {
+
+  int             i, n;
+  LISP$Ref        list = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref        tmp;
+  LISP$Ref        res;
+  LISP$ObjectType type = RefVector;
+  LISP$Vector *   v;
+
+  /* (LIST->VECTOR LIST [DOUBLE]) */
+  if (argc > 1) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    if (LISP$M_getRefType (tmp) != AtomTab ||
+        strcmp ((lmi->atmTab [LISP$M_getRefId (tmp)]).name, "DOUBLE")) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "LIST->VECTOR's second argument can be only DOUBLE!");
+      return (LISP$M_NULLREF);
+    }
+    type = DoubleVector;
+  }
 
-    /* Move to a next argument */
-    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  if (list != lmi->NIL && LISP$M_getRefType (list) != ListTab) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "LIST->VECTOR's argument must be a list!");
+    return (LISP$M_NULLREF);
   }
 
-  /* Process body */
-  if (res != LISP$M_NULLREF) {
-    tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
-    while (tmp != lmi->NIL) {
-      res = LISP$S_evalAction (lmi,
-          (lmi->lstTab [LISP$M_getRefId (tmp)]).car, level);
+  for (n = 0, tmp = list; LISP$M_getRefType (tmp) == ListTab; n++)
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
 
-      /* Move to a next argument */
-      tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+  res = LISP$M_createVector (lmi, type, n);
+  if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+  v = (lmi->objTab [LISP$M_getRefId (res)]).data.vector;
+
+  for (i = 0, tmp = list; i < n; i++) {
+    if (type == RefVector)
+      v->items.refs [i] = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+    else if (LISP$M_isNumber (lmi,
+               (lmi->lstTab [LISP$M_getRefId (tmp)]).car))
+      v->items.nums [i] = LISP$M_getNumber (lmi,
+                            (lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+    else {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "Only numbers can be stored into a DOUBLE vector!");
+      return (LISP$M_NULLREF);
     }
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
   }
 
-  /* Unbind values */
-  tmp = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-  while (tmp != lmi->NIL) {
-    /* Get actual bind pair */
-    tmpx = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+  return res;
+}
 
-    /* Here we probably got bind error, so *
-     * there's nothing more to be unbound  */
-    if (LISP$M_getRefType (tmpx) != ListTab) break;
+LISP$Ref LISP$M_builtInVECTORTOLIST (LISP$MachIns * lmi, LISP$Ref args) {
 
-    /* Get atom to be unbound */
-    tmpx = (lmi->lstTab [LISP$M_getRefId (tmpx)]).car;
+  int           i;
+  LISP$Ref      vec = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref      res = lmi->NIL;
+  LISP$Vector * v   = LISP$M_getVector (lmi, vec, "VECTOR->LIST");
 
-    /* Unbind it */
-    LISP$M_unBind (lmi, tmpx);
+  if (v == NULL) return (LISP$M_NULLREF);
 
-    /* Move to a next argument */
-    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
-  }
+  /* Numbers of a DOUBLE vector get their number table records here */
+  for (i = v->length - 1; i >= 0 && !LISP$M_isError (lmi); i--)
+    LISP$M_listPush (lmi, &res,
+        ((lmi->objTab [LISP$M_getRefId (vec)]).type == RefVector)?
+          v->items.refs [i] : LISP$M_getCreateNumber (lmi, v->items.nums [i]));
 
-  return (res);
+  return (LISP$M_isError (lmi)? LISP$M_NULLREF : res);
 }
 
-LISP$Ref LISP$M_builtInISDEFINED (LISP$MachIns * lmi, LISP$Ref args) {
+LISP$Vector * LISP$M_getDoubleVector (LISP$MachIns * lmi, LISP$Ref ref,
+                                      const char * name) {
 
-  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-  return ((lmi->atmTab [LISP$M_getRefId (ref)]).type != Undefined)?
-    lmi->T : lmi->NIL;
+  if (LISP$M_getRefType (ref) != ObjectTab ||
+      (lmi->objTab [LISP$M_getRefId (ref)]).type != DoubleVector) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs a DOUBLE vector!", name);
+    return NULL;
+  }
+
+  return ((lmi->objTab [LISP$M_getRefId (ref)]).data.vector);
 }
 
-LISP$Ref LISP$M_builtInISATOM (LISP$MachIns * lmi, LISP$Ref args) {
+LISP$Ref LISP$M_builtInVARITH (LISP$MachIns * lmi, LISP$Ref args,
+                               const char * oper) {
 
-  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-  return (LISP$M_getRefType (ref) != ListTab)? lmi->T : lmi->NIL;
-}
+  LISP$Ref        x   = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref        y   = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref        res;
+  LISP$Vector *   vx  = NULL;
+  LISP$Vector *   vy  = NULL;
+  LISP$Vector *   v;
+  LISP$KernelOper op;
 
-LISP$Ref LISP$M_builtInISLIST (LISP$MachIns * lmi, LISP$Ref args) {
+  y = (lmi->lstTab [LISP$M_getRefId (y)]).car;
 
-  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-  return (LISP$M_getRefType (ref) == ListTab)? lmi->T : lmi->NIL;
-}
+  switch (oper [1]) {
+    case '+': op = KernelAdd; break;
+    case '-': op = KernelSub; break;
+    case '*': op = KernelMul; break;
+    default:  op = KernelDiv; break;
+  }
 
-LISP$Ref LISP$M_builtInISNUMBER (LISP$MachIns * lmi, LISP$Ref args) {
+  /* A number on either side is broadcast to all the items */
+  if (!LISP$M_isNumber (lmi, x) &&
+      (vx = LISP$M_getDoubleVector (lmi, x, oper)) == NULL)
+    return (LISP$M_NULLREF);
+  if (!LISP$M_isNumber (lmi, y) &&
+      (vy = LISP$M_getDoubleVector (lmi, y, oper)) == NULL)
+    return (LISP$M_NULLREF);
 
-  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
-  return (LISP$M_getRefType (ref) == NumberTab)? lmi->T : lmi->NIL;
+  if (vx == NULL && vy == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs at least one DOUBLE vector!", oper);
+    return (LISP$M_NULLREF);
+  }
+
+  if (vx != NULL && vy != NULL && vx->length != vy->length) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "%s needs vectors of the same length!", oper);
+    return (LISP$M_NULLREF);
+  }
+
+  res = LISP$M_createVector (lmi, DoubleVector,
+                             (vx != NULL)? vx->length : vy->length);
+  if (res == LISP$M_NULLREF) return (LISP$M_NULLREF);
+  v = (lmi->objTab [LISP$M_getRefId (res)]).data.vector;
+
+  if (vx != NULL && vy != NULL)
+    LISP$K_tab.map (op, v->items.nums, vx->items.nums, vy->items.nums,
+                    0, false, v->length);
+  else if (vx != NULL)
+    LISP$K_tab.map (op, v->items.nums, vx->items.nums, NULL,
+                    LISP$M_getNumber (lmi, y), false, v->length);
+  else
+    LISP$K_tab.map (op, v->items.nums, vy->items.nums, NULL,
+                    LISP$M_getNumber (lmi, x), true, v->length);
+
+  return res;
 }
 
-LISP$Ref LISP$M_builtInBODY (LISP$MachIns * lmi, LISP$Ref args) {
+LISP$Ref LISP$M_builtInDOT (LISP$MachIns * lmi, LISP$Ref args) {
 
-  LISP$Ref ref = (lmi->lstTab [LISP$M_getRefId (args)]).car;
+  LISP$Ref      tmp = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Vector * vx;
+  LISP$Vector * vy;
 
-  if ((lmi->atmTab [LISP$M_getRefId (ref)]).type != UserDefFun      &&
-      (lmi->atmTab [LISP$M_getRefId (ref)]).type != UserDefSpecForm &&
-      (lmi->atmTab [LISP$M_getRefId (ref)]).type != UnnamedFun      &&
-      (lmi->atmTab [LISP$M_getRefId (ref)]).type != UnnamedSpecForm) {
+  vx = LISP$M_getDoubleVector (lmi,
+         (lmi->lstTab [LISP$M_getRefId (args)]).car, "DOT");
+  if (vx == NULL) return (LISP$M_NULLREF);
+  vy = LISP$M_getDoubleVector (lmi,
+         (lmi->lstTab [LISP$M_getRefId (tmp)]).car, "DOT");
+  if (vy == NULL) return (LISP$M_NULLREF);
+
+  if (vx->length != vy->length) {
     LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-        "Only user defined lambda/special is a valid argument for BODY!");
+        "DOT needs vectors of the same length!");
     return (LISP$M_NULLREF);
   }
 
-  return ((lmi->atmTab [LISP$M_getRefId (ref)]).value);
+  return (LISP$M_getCreateNumber (lmi,
+            LISP$K_tab.dot (vx->items.nums, vy->items.nums, vx->length)));
+}
+
+LISP$Ref LISP$M_builtInVREDUCE (LISP$MachIns * lmi, LISP$Ref args,
+                                const char * oper) {
+
+  LISP$Vector * v = LISP$M_getDoubleVector (lmi,
+                      (lmi->lstTab [LISP$M_getRefId (args)]).car, oper);
+  if (v == NULL) return (LISP$M_NULLREF);
+
+  /* VSUM, VMIN or VMAX -- an empty vector gives 0, INF or -INF */
+  return (LISP$M_getCreateNumber (lmi,
+    (oper [2] == 'U')? LISP$K_tab.sum (v->items.nums, v->length) :
+    (oper [2] == 'I')? LISP$K_tab.min (v->items.nums, v->length) :
+                       LISP$K_tab.max (v->items.nums, v->length)));
 }
 
 LISP$Ref LISP$M_builtInLAMBDASPECIAL (LISP$MachIns * lmi, LISP$Ref args,
                                         bool isLambda) {
 
-  LISP$Ref tmp  = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
+  LISP$Ref tmp  = LISP$M_NULLREF;
   LISP$Ref tmpx = (lmi->lstTab [LISP$M_getRefId (args)]).car;
   LISP$AtomRecord atom;
+  int i;
 
   if (LISP$M_getRefType (tmpx) != ListTab) {
     LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
@@ -1039,11 +5123,21 @@ LISP$Ref LISP$M_builtInLAMBDASPECIAL (LISP$MachIns * lmi, LISP$Ref args,
     return (LISP$M_NULLREF);
   }
 
-  /* XXX: this should be really UNNAMED!! */
-  tmp = LISP$M_getCreateAtom (lmi, isLambda?
-            "...UnNamedLambda..." : "...UnNamedSpecial...");
-  atom = lmi->atmTab [LISP$M_getRefId (tmp)];
+  /* Each one gets an atom of its own, so lambdas evaluated within one *
+   * form -- e.g. the arguments of REDUCE and MAP -- don't overwrite    *
+   * each other; it's never looked up by its name                      */
+  if ((i = LISP$M_allocNode (lmi, AtomTab)) < 0) {
+    LISP$M_setError (lmi, LISP$_ERR$S_ATMFUL,
+        "ATMFUL", "Atom table is full!");
+    return (LISP$M_NULLREF);
+  }
+  LISP$M_setRefType (tmp, AtomTab);
+  LISP$M_setRefId (tmp, i); lmi->atmIdx [i] = Temp;
+  lmi->atmFree--;
 
+  strlcpy (atom.name, isLambda? "...UnNamedLambda..." :
+           "...UnNamedSpecial...", sizeof (atom.name));
+  atom.hash     = LISP$M_hashAtomName (atom.name);
   atom.type     = isLambda? UserDefFun : UserDefSpecForm; /* UnnamedFun */
   atom.bindList = (lmi->lstTab [LISP$M_getRefId (args)]).car;
   tmpx          = (lmi->lstTab [LISP$M_getRefId (args)]).cdr;
@@ -1058,6 +5152,7 @@ void LISP$M_listPush (LISP$MachIns * lmi, LISP$Ref * list, LISP$Ref item) {
 
   /* Create a new list */
   LISP$Ref res = LISP$M_createList (lmi);
+  if (res == LISP$M_NULLREF) return;
 
   /* Push there a new value and the old list */
   (lmi->lstTab [LISP$M_getRefId (res)]).car = item;
@@ -1119,20 +5214,14 @@ void LISP$M_unBind (LISP$MachIns * lmi, LISP$Ref atm) {
  * S-Expression processing
  ******************************************************/
 
-bool LISP$S_buildToken (LISP$MachIns * lmi, char ** token,
-                        int i, char c, bool isCaseSensitive) {
-
-  char * tok = *token;
-
-  if (i >= LISP$S_TOKEN_SIZE) {
-    LISP$M_setError (lmi, LISP$_ERR$S_LONGTOK,
-        "LONGTOK", "Too long token!");
-    return false;
-  }
+void LISP$S_setErrorPosition (LISP$MachIns * lmi) {
 
-  tok [i] = isCaseSensitive? c : toupper (c);
+  /* Keep the first one only -- the rest of the S-expr is discarded */
+  if (lmi->inputErrorPosition >= 0) return;
 
-  return true;
+  lmi->inputErrorLineNo   = (lmi->reader)->line;
+  lmi->inputErrorPosition = LISP$R_getLine (lmi->reader,
+      lmi->inputErrorLine, sizeof (lmi->inputErrorLine));
 }
 
 bool LISP$S_isValidAtomNameChar (char c, int i) {
@@ -1140,7 +5229,7 @@ bool LISP$S_isValidAtomNameChar (char c, int i) {
   if (!i && isdigit (c)) return false;
   if (isalnum (c))       return true;
 
-  static char set [] = {
+  static const char set [] = {
     '!', '#', '$', '%', '&', '*', '+', ',', '-',
     '/', ':', '<', '=', '>', '?', '@', '^', '_',
     '{', '|', '}', '~', LISP$S_EOS
@@ -1158,68 +5247,46 @@ void LISP$S_makePrompt (LISP$MachIns * lmi, bool primary, bool is2ReadLine) {
   is2ReadLine = is2ReadLine;
   if (lmi->mode == Interactive) {
 #ifdef _HAS_RDLN_
-    if (lmi->readLineBuffer != NULL && (int) strlen (lmi->readLineBuffer) > lmi->inputReadPosition) {
-      int remains = strlen (lmi->readLineBuffer) -lmi->inputReadPosition +1;
-      char * tmp = (char *) malloc (remains * sizeof (char));
-      strlcpy (tmp, lmi->readLineBuffer +lmi->inputReadPosition, remains);
-      free (lmi->readLineBuffer);
-      lmi->readLineBuffer = tmp;
-      lmi->inputReadPosition = 0;
-    }
-    else if (is2ReadLine) {
-      lmi->inputReadPosition = 0;
-      if (lmi->readLineBuffer) { free (lmi->readLineBuffer); lmi->readLineBuffer = (char *) NULL; }
-      lmi->readLineBuffer = (char *) readline (primary? LISP$PROMPT : LISP$PROMPT_ALT);
-      if (lmi->readLineBuffer && *(lmi->readLineBuffer)) add_history (lmi->readLineBuffer);
-
-      if (lmi->readLineBuffer != NULL) {
-        int len = strlen (lmi->readLineBuffer) +1;
-        char * tmp = (char *) malloc (len * sizeof (char));
-        snprintf (tmp, len, "%s\n", lmi->readLineBuffer);
-        free (lmi->readLineBuffer);
-        lmi->readLineBuffer = tmp;
+    /* The reader is fed by lines, ask for a new one when it's consumed */
+    if (LISP$S_isReadLine (lmi)) {
+      if (is2ReadLine && LISP$R_isEmpty (lmi->reader) &&
+          !(lmi->reader)->isEOF) {
+        char * line =
+          (char *) readline (primary? LISP$PROMPT : LISP$PROMPT_ALT);
+
+        if (line == NULL) (lmi->reader)->isEOF = true;
+        else {
+          if (*line) add_history (line);
+          if (!LISP$R_append (lmi->reader, line, strlen (line)) ||
+              !LISP$R_append (lmi->reader, "\n", 1))
+            (lmi->reader)->isEOF = true;
+          free (line);
+        }
       }
+      return;
     }
-#else
+#endif
     fprintf (lmi->outputStream, "\r%s",
         (primary? LISP$PROMPT : LISP$PROMPT_ALT));
-#endif
   }
 }
 
 char LISP$S_getChar (LISP$MachIns * lmi) {
 
-  char c;
-
 #ifdef _HAS_RDLN_
-  if (lmi->mode == Interactive)
-    if (lmi->readLineBuffer == NULL) c = EOF;
-    else if (lmi->readLineBuffer [lmi->inputReadPosition] == LISP$S_EOS) c = LISP$S_EOL;
-    else
-      c = ((int) strlen (lmi->readLineBuffer) < lmi->inputReadPosition)?
-        LISP$S_EOL : lmi->readLineBuffer [lmi->inputReadPosition];
-  else
+  /* A consumed line reads as an endless end of line, until the next *
+   * one is asked for                                                 */
+  if (LISP$S_isReadLine (lmi) && LISP$R_isEmpty (lmi->reader))
+    return (((lmi->reader)->isEOF)? EOF : LISP$S_EOL);
 #endif
-    c = fgetc (lmi->inputStream);
-
-  lmi->inputReadPosition++;
 
-  bool isSpace = isspace (c);
-  int  len = lmi->inputReadPosition; //strlen (lmi->inputBuffer);
-  char tmp = isSpace? ' ' : c;
-  if (!isSpace || (isSpace &&
-      lmi->inputBuffer [len - 1] != ' '))
-    snprintf (lmi->inputBuffer, sizeof (lmi->inputBuffer),
-        "%s%c", lmi->inputBuffer, tmp);
-
-  return c;
+  return (LISP$R_getChar (lmi->reader));
 }
 
-char LISP$S_getToken (LISP$MachIns * lmi, char ** token, bool * isNumeric) {
+char LISP$S_getToken (LISP$MachIns * lmi, LISP$Span * token,
+                      bool * isNumeric) {
 
-  int i = 0;
-  char * tok = *token;
-  char prevChar = ' ';
+  size_t i = 0;
   char currentChar = ' ';
   bool hasFloatingPoint = false; *isNumeric = false;
 
@@ -1229,40 +5296,46 @@ char LISP$S_getToken (LISP$MachIns * lmi, char ** token, bool * isNumeric) {
     currentChar = LISP$S_getChar (lmi);
   }
 
+  /* The token begins here, it's settled by $S_createToken () */
+  LISP$R_mark (lmi->reader);
+
   /* Current token is a number */
   if (currentChar == '+' || currentChar == '-' || isdigit (currentChar)) {
-    LISP$S_buildToken (lmi, &tok, i++, currentChar, false);
     if (isdigit (currentChar)) *isNumeric = true;
-    currentChar = LISP$S_getChar (lmi);
+    i++; currentChar = LISP$S_getChar (lmi);
 
     while (isdigit (currentChar) || currentChar == LISP$S_FLPDLM) {
       /* Mark token as a number right here, because '+' or '-'   *
        * could be a built-in functions!                          */
       *isNumeric = true;
 
-      if (currentChar == LISP$S_FLPDLM) {
-        if (!hasFloatingPoint) {
-          /* Add the floating point to the current number token      *
-           * NOTE: LISP$S_FLPDLM that could be ',' -> encoded as '.' */
-          if (!LISP$S_buildToken (lmi, &tok, i++, '.', false)) break;
-          hasFloatingPoint = true;
-        }
-
-        /* There is floating point already read, throw error! */
-        else {
-          LISP$M_setError (lmi, LISP$_ERR$S_BADSYN, "BADSYN",
-              "Syntax error, second floating point?!");
-          /* Set error position if there was no problem before */
-          if (lmi->inputErrorPosition < 0)
-            lmi->inputErrorPosition = lmi->inputReadPosition; //strlen (lmi->inputBuffer);
-          /* No break -- we want to discard entire expression */
-        }
+      /* There is floating point already read, throw error! */
+      if (currentChar == LISP$S_FLPDLM && hasFloatingPoint) {
+        LISP$M_setError (lmi, LISP$_ERR$S_BADSYN, "BADSYN",
+            "Syntax error, second floating point?!");
+        /* Set error position if there was no problem before */
+        LISP$S_setErrorPosition (lmi);
+        /* No break -- we want to discard entire expression */
       }
+      if (currentChar == LISP$S_FLPDLM) hasFloatingPoint = true;
 
-      /* Add more of digits */
-      else if (!LISP$S_buildToken (lmi, &tok, i++, currentChar, false)) break;
+      i++; currentChar = LISP$S_getChar (lmi);
+    }
 
-      currentChar = LISP$S_getChar (lmi);
+    /* Exponent -- 'e' or 'E', an optional sign and at least one digit */
+    if (*isNumeric && (currentChar == 'e' || currentChar == 'E')) {
+      i++; currentChar = LISP$S_getChar (lmi);
+      if (currentChar == '+' || currentChar == '-') {
+        i++; currentChar = LISP$S_getChar (lmi);
+      }
+      if (!isdigit (currentChar)) {
+        LISP$M_setError (lmi, LISP$_ERR$S_BADSYN, "BADSYN",
+            "Syntax error, exponent without digits!");
+        LISP$S_setErrorPosition (lmi);
+      }
+      while (isdigit (currentChar)) {
+        i++; currentChar = LISP$S_getChar (lmi);
+      }
     }
   }
 
@@ -1270,37 +5343,28 @@ char LISP$S_getToken (LISP$MachIns * lmi, char ** token, bool * isNumeric) {
    * character of this atom's name is digit, because digits are collected *
    * in previous test                                                     */
   else if (LISP$S_isValidAtomNameChar (currentChar, i)) {
-    LISP$S_buildToken (lmi, &tok, i++, currentChar, false);
-    prevChar = currentChar;
-    currentChar = LISP$S_getChar (lmi);
+    i++; currentChar = LISP$S_getChar (lmi);
     while (LISP$S_isValidAtomNameChar (currentChar, i)) {
-      if (prevChar == '%') /* Store % twice -- it's formatting char */
-        LISP$S_buildToken (lmi, &tok, i++, prevChar, false);
-      if (!LISP$S_buildToken (lmi, &tok, i++, currentChar, false)) break;
-      prevChar = currentChar;
-      currentChar = LISP$S_getChar (lmi);
+      i++; currentChar = LISP$S_getChar (lmi);
     }
-    if (prevChar == '%') /* Store % twice -- it's formatting char */
-      LISP$S_buildToken (lmi, &tok, i++, prevChar, false);
   }
 
-  /* Is's a string */
+  /* Is's a string -- read it entirely, including both the quotes */
   else if (currentChar == '"') {
-    LISP$S_buildToken (lmi, &tok, i++, currentChar, true);
-    prevChar = currentChar;
-    currentChar = LISP$S_getChar (lmi);
-
-    /* Read entire string */
-    prevChar = ' ';
-    while (prevChar != '"') {
-      LISP$S_buildToken (lmi, &tok, i++, currentChar, true);
-      prevChar    = currentChar;
-      currentChar = LISP$S_getChar (lmi);
+    do {
+      i++; currentChar = LISP$S_getChar (lmi);
+      if (currentChar == LISP$S_EOL) LISP$S_makePrompt (lmi, false, true);
+    } while (currentChar != '"' && currentChar != EOF);
+
+    if (currentChar == EOF) {
+      LISP$M_setError (lmi, LISP$_ERR$S_BADSYN, "BADSYN",
+          "Syntax error, unterminated string!");
+      LISP$S_setErrorPosition (lmi);
     }
+    else { i++; currentChar = LISP$S_getChar (lmi); }
   }
 
-  LISP$S_buildToken (lmi, &tok, i, LISP$S_EOS, false);
-  **token = *tok;
+  *token = LISP$R_getSpan (lmi->reader, i);
 
   if (currentChar == LISP$S_EOL)
     LISP$S_makePrompt (lmi, lmi->sexprEnd, false);
@@ -1308,35 +5372,113 @@ char LISP$S_getToken (LISP$MachIns * lmi, char ** token, bool * isNumeric) {
   return currentChar;
 }
 
+LISP$Ref LISP$S_createToken (LISP$MachIns * lmi, const LISP$Span * token,
+                             bool isNumeric) {
+
+  size_t   i, j;
+  char *   buf = lmi->token;
+  bool     isString = (token->length && token->text [0] == '"');
+
+  /* Numbers are parsed right in the reader's buffer */
+  if (isNumeric) return (LISP$S_createNumber (lmi, token));
+
+  /* Strings have no length limit either, they're settled without quotes */
+  if (isString && token->length >= 2 &&
+      token->text [token->length - 1] == '"')
+    return (LISP$M_createString (lmi, token->text + 1, token->length - 2));
+
+  for (i = j = 0; i < token->length; i++) {
+    if (j >= sizeof (lmi->token) - 2) {
+      LISP$M_setError (lmi, LISP$_ERR$S_LONGTOK,
+          "LONGTOK", "Too long token!");
+      return (LISP$M_NULLREF);
+    }
+
+    if (isString)
+      buf [j++] = token->text [i];
+    else {
+      buf [j++] = toupper (token->text [i]);
+      /* Store % twice -- it's formatting char */
+      if (token->text [i] == '%') buf [j++] = '%';
+    }
+  }
+  buf [j] = LISP$S_EOS;
+
+  return (LISP$M_getCreateAtom (lmi, buf));
+}
+
+LISP$Ref LISP$S_createNumber (LISP$MachIns * lmi, const LISP$Span * token) {
+
+  int64_t  integer;
+  double   real;
+  char *   buf;
+  LISP$Ref res;
+
+  switch (LISP$N_parse (token->text, token->length, LISP$S_FLPDLM,
+                        &integer, &real)) {
+    case IntNumber:
+      return (LISP$M_getCreateInteger (lmi, integer));
+
+    case RealNumber:
+      return (LISP$M_getCreateNumber (lmi, real));
+
+    /* Long integers are big ones, they have no length limit */
+    case BigNumber:
+      buf = (token->length < sizeof (lmi->token))?
+              lmi->token : (char *) malloc (token->length + 1);
+      if (buf == NULL) return (LISP$M_createBignum (lmi, NULL));
+
+      memcpy (buf, token->text, token->length);
+      buf [token->length] = LISP$S_EOS;
+      res = LISP$M_createBignum (lmi, LISP$B_fromString (buf));
+
+      if (buf != lmi->token) free (buf);
+      return res;
+
+    /* The error has been reported by $S_getToken () already */
+    default:
+      if (!LISP$M_isError (lmi)) {
+        LISP$M_setError (lmi, LISP$_ERR$S_BADSYN, "BADSYN",
+            "Syntax error, bad number!");
+        LISP$S_setErrorPosition (lmi);
+      }
+      return (LISP$M_NULLREF);
+  }
+}
+
 LISP$Ref LISP$S_readAction (LISP$MachIns * lmi, int * level) {
 
   lmi->sexprEnd = (!*level);
   #ifdef DEBUG_PARSER
   LISP$M_throwMessage (lmi, 'D', "DEBUG", "#%d READ BEGIN", *level);
   #endif
-  LISP$Ref res; LISP$Ref tmp; LISP$Ref swp;
-  res = tmp = swp = LISP$M_NULLREF;
-  bool isNumeric; char * token; int currentLevel = *level;
-  token = (char *) malloc (LISP$S_TOKEN_SIZE * sizeof (char));
+  LISP$Ref res; LISP$Ref tmp; LISP$Ref swp; LISP$Ref tmpx;
+  res = tmp = swp = tmpx = LISP$M_NULLREF;
+  bool isNumeric; LISP$Span token; int currentLevel = *level;
   char end = LISP$S_getToken (lmi, &token, &isNumeric);
 
   #ifdef DEBUG_PARSER
   LISP$M_throwMessage (lmi, 'D', "DEBUG",
-      "level=%d; end=%c; token=%s;", *level, end, token);
+      "level=%d; end=%c; token=%.*s;", *level, end,
+      (int) token.length, token.text);
   #endif
 
   /* Something is to be commented out -- read line up to its end */
   while (end == LISP$S_COMMENT) {
-    while (end != LISP$S_EOL && end != LISP$S_EOS)
+    while (end != LISP$S_EOL && end != LISP$S_EOS && end != EOF)
       end = LISP$S_getChar (lmi);
 
     end = LISP$S_getToken (lmi, &token, &isNumeric);
   }
 
+  /* The input may end just after a token -- it's read still, the next *
+   * read gets to the EOF then                                         */
+  if (end == EOF && token.length && LISP$M_is2Process (lmi))
+    return (LISP$S_createToken (lmi, &token, isNumeric));
+
   /* ^D read, so disallow any processing */
   if (end == EOF || !LISP$M_is2Process (lmi)) {
     LISP$M_setProcessed (lmi);
-    free (token);
     return (LISP$M_NULLREF);
   }
 
@@ -1344,9 +5486,10 @@ LISP$Ref LISP$S_readAction (LISP$MachIns * lmi, int * level) {
   if (end == '\'') {
     res =  LISP$M_createList (lmi);
     (lmi->lstTab [LISP$M_getRefId (res)]).car = lmi->QUOTE;
-    (lmi->lstTab [LISP$M_getRefId (res)]).cdr = LISP$M_createList (lmi);
-    tmp = (lmi->lstTab [LISP$M_getRefId (res)]).cdr;
-    (lmi->lstTab [LISP$M_getRefId (tmp)]).car = LISP$S_readAction (lmi, level);
+    tmp = LISP$M_createList (lmi);
+    (lmi->lstTab [LISP$M_getRefId (res)]).cdr = tmp;
+    swp = LISP$S_readAction (lmi, level);
+    (lmi->lstTab [LISP$M_getRefId (tmp)]).car = swp;
     (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr = lmi->NIL;
   }
 
@@ -1373,8 +5516,8 @@ LISP$Ref LISP$S_readAction (LISP$MachIns * lmi, int * level) {
 
     (lmi->lstTab [LISP$M_getRefId (tmp)]).car = swp;
 
-    /* Collect all objects in this list */
-    while (*level != currentLevel) {
+    /* Collect all objects in this list, unless the input ends */
+    while (*level != currentLevel && LISP$M_is2Process (lmi)) {
       /* Read next object */
       swp = LISP$S_readAction (lmi, level);
 
@@ -1382,11 +5525,13 @@ LISP$Ref LISP$S_readAction (LISP$MachIns * lmi, int * level) {
         (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr = lmi->NIL;
 
       else {
-        /* Create a new sublist where to save next values */
-        (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr = LISP$M_createList (lmi);
+        /* Create a new sublist where to save next values -- the tables *
+         * may move while allocating, so it's stored in two steps       */
+        tmpx = LISP$M_createList (lmi);
+        (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr = tmpx;
 
         /* Set the current list to a new one */
-        tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+        tmp = tmpx;
 
         /* Fill it's CAR */
         (lmi->lstTab [LISP$M_getRefId (tmp)]).car = swp;
@@ -1405,16 +5550,13 @@ LISP$Ref LISP$S_readAction (LISP$MachIns * lmi, int * level) {
       LISP$M_setError (lmi, LISP$_ERR$S_BADSYN,
           "BADSYN", "Bad syntax, unexpected parenthesis!");
       /* Set error position if there was no problem before */
-      if (lmi->inputErrorPosition < 0)
-        lmi->inputErrorPosition = lmi->inputReadPosition; //strlen (lmi->inputBuffer);
+      LISP$S_setErrorPosition (lmi);
       res = LISP$M_NULLREF;
     }
 
     /* There's something before closing parenthesis */
-    else if (!isspace (token [0]) && token [0] != LISP$S_EOS)
-      res = isNumeric?
-        LISP$M_getCreateNumber (lmi, strtod (token, NULL)) :
-        LISP$M_getCreateAtom (lmi, token);
+    else if (token.length)
+      res = LISP$S_createToken (lmi, &token, isNumeric);
 
     /* NIL token, just only closing parenthesis.. */
     /* We return NULLREF, to recognize that this is a NIL enclosing the
@@ -1429,18 +5571,12 @@ LISP$Ref LISP$S_readAction (LISP$MachIns * lmi, int * level) {
       LISP$M_setError (lmi, LISP$_ERR$S_BADSYN,
           "BADSYN", "Bad syntax!");
       /* Set error position if there was no problem before */
-      if (lmi->inputErrorPosition < 0)
-        lmi->inputErrorPosition = lmi->inputReadPosition; //strlen (lmi->inputBuffer);
+      LISP$S_setErrorPosition (lmi);
       res = LISP$M_NULLREF;
     }
-    else {
-      res = isNumeric?
-        LISP$M_getCreateNumber (lmi, strtod (token, NULL)) :
-        LISP$M_getCreateAtom (lmi, token);
-    }
+    else res = LISP$S_createToken (lmi, &token, isNumeric);
   }
 
-  free (token);
   return res;
 }
 
@@ -1448,10 +5584,7 @@ LISP$Ref LISP$S_read (LISP$MachIns * lmi) {
 
   int level = 0;
 
-  if (lmi->inputBuffer [strlen (lmi->inputBuffer)] == LISP$S_EOS)
-    LISP$S_makePrompt (lmi, true, true);
-
-  lmi->inputBuffer [0] = LISP$S_EOS;
+  LISP$S_makePrompt (lmi, true, true);
 
   return (LISP$S_readAction (lmi, &level));
 }
@@ -1462,21 +5595,25 @@ void LISP$S_trace (LISP$MachIns * lmi, LISP$Ref res, int level) {
   if (!LISP$M_isOptionEnabled (lmi, LISP$M_OPT_TRACE)) return;
 
   int i;
-  fprintf (lmi->outputStream, "Trace ==");
+  LISP$Writer w;
+  LISP$W_openStream (&w, lmi->outputStream);
+  LISP$W_putString (&w, "Trace ==", 8);
 
   for (i = 0; i < level; i++)
-    fprintf (lmi->outputStream, "==");
+    LISP$W_putString (&w, "==", 2);
 
-  fprintf (lmi->outputStream, "> ");
+  LISP$W_putString (&w, "> ", 2);
 
-  if (res == LISP$M_NULLREF) fprintf (lmi->outputStream, "LISP$M_NULLREF");
-  else             LISP$S_writeAction (lmi, res, false);
+  if (res == LISP$M_NULLREF) LISP$W_putString (&w, "LISP$M_NULLREF", 14);
+  else             LISP$S_writeAction (lmi, &w, res, false);
 
-  fprintf (lmi->outputStream, "\n");
+  LISP$W_putChar (&w, '\n');
+  LISP$W_close (&w);
 }
 
 #define RETURN_TRACE(x) \
-  { res = (x); LISP$S_trace (lmi, res, level); return (res); }
+  { res = (x); lmi->rootTop = roots; \
+    LISP$S_trace (lmi, res, level); return (res); }
 
 LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
                               int level) {
@@ -1492,6 +5629,7 @@ LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
   LISP$Ref        res    = lmi->NIL; /* Result for RETURN macro     */
   LISP$AtomRecord atom;              /* Shared 'atom' helper var.   */
   LISP$ListRecord list;              /* Shared 'list' helper var.   */
+  int             roots  = lmi->rootTop; /* GC roots to be kept     */
 
   /* Error while reading S-Expression, nothing to evaluate */
   if (LISP$M_isError (lmi) || read == LISP$M_NULLREF)
@@ -1525,6 +5663,7 @@ LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
       }
 
     case NumberTab:
+    case ObjectTab:
       RETURN_TRACE (read);
 
     case ListTab:
@@ -1533,12 +5672,16 @@ LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
       /* NIL-list -- '()' */
       if (list.car == lmi->NIL && list.cdr == lmi->NIL)
         RETURN_TRACE (lmi->NIL);
+
+      /* Keep the form and everything built for it safe from GC */
+      LISP$M_pushRoot (lmi, read);
   
       action = list.car;
       /* For unnamed lambdas and specials */
       if (LISP$M_getRefType (action) == ListTab) {
         action = LISP$S_evalAction (lmi, action, level);
         if (action == LISP$M_NULLREF) RETURN_TRACE (LISP$M_NULLREF);
+        LISP$M_pushRoot (lmi, action);
       }
 
       if (LISP$M_getRefType (action) != AtomTab) {
@@ -1571,6 +5714,8 @@ LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
         /* Create new evaluated args list */
         if (args != lmi->NIL) {
           eargs = LISP$M_createList (lmi);
+          if (eargs == LISP$M_NULLREF) RETURN_TRACE (LISP$M_NULLREF);
+          LISP$M_pushRoot (lmi, eargs);
           tmp   = eargs;
         }
         else eargs = lmi->NIL;
@@ -1592,8 +5737,9 @@ LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
           if (args == lmi->NIL) break;
 
           /* Create a new list entry */
-          (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr = LISP$M_createList (lmi);
-          tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+          tmpx = LISP$M_createList (lmi);
+          (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr = tmpx;
+          tmp = tmpx;
         }
       }
       else {
@@ -1602,194 +5748,519 @@ LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
         RETURN_TRACE (LISP$M_NULLREF);
       }
 
-      list = lmi->lstTab [LISP$M_getRefId (eargs)];
-
-      /* It's a built-in */
-      if (atom.type == BuiltInFun || atom.type == BuiltInSpecForm) {
-
-        if (LISP$M_checkBuiltIn (lmi, "CAR", atom, list, eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInCAR (lmi, eargs)); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "CDR", atom, list, eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInCDR (lmi, eargs)); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "LIST", atom,
-                 list, eargc, 0, LISP$INF))
-          { RETURN_TRACE (eargs); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "QUOTE", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE ((lmi->lstTab [LISP$M_getRefId (eargs)]).car); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "SETQ", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
-          { RETURN_TRACE (LISP$M_builtInSETQ (lmi, eargs, level)); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "CONS", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
-          { RETURN_TRACE (LISP$M_builtInCONS (lmi, eargs)); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "+", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
-                 LISP$M_checkBuiltIn (lmi, "-", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
-                 LISP$M_checkBuiltIn (lmi, "*", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
-                 LISP$M_checkBuiltIn (lmi, "/", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, LISP$INF) ||
-                 LISP$M_checkBuiltIn (lmi, "%%", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
-          { RETURN_TRACE (LISP$M_builtInArithmetic (lmi, eargs, eargc,
-                                                    atom.name)); }
-
-        else if (LISP$M_checkBuiltIn (lmi, "IS", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
-          { RETURN_TRACE (LISP$M_builtInIS (lmi, eargs)); }
-
-        #define COMPARE(op) \
-          list = lmi->lstTab [LISP$M_getRefId (eargs)]; \
-          tmp  = list.cdr; \
-          tmp  = (lmi->lstTab [LISP$M_getRefId (tmp)]).car; \
-          if (LISP$M_getRefType (list.car) != NumberTab || \
-              LISP$M_getRefType (tmp) != NumberTab) { \
-            LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS", \
-                "%s works only with numeric arguments!", atom.name); \
-            RETURN_TRACE (LISP$M_NULLREF); \
-          } \
-          \
-          RETURN_TRACE ((lmi->numTab [LISP$M_getRefId (list.car)] op\
-                   lmi->numTab [LISP$M_getRefId (tmp)])? lmi->T : lmi->NIL);
-
-        else if (LISP$M_checkBuiltIn (lmi, "=", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)],
-                   eargc, 2, 2)) { COMPARE(==) }
-        else if (LISP$M_checkBuiltIn (lmi, ">", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)],
-                   eargc, 2, 2)) { COMPARE(>)  }
-        else if (LISP$M_checkBuiltIn (lmi, ">=", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)],
-                   eargc, 2, 2)) { COMPARE(>=) }
-        else if (LISP$M_checkBuiltIn (lmi, "<", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)],
-                   eargc, 2, 2)) { COMPARE(<)  }
-        else if (LISP$M_checkBuiltIn (lmi, "<=", atom,
-                   lmi->lstTab [LISP$M_getRefId (eargs)],
-                   eargc, 2, 2)) { COMPARE(<=) }
-        #undef COMPARE
-
-        else if (LISP$M_checkBuiltIn (lmi, "EVAL", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1)) {
-          tmp = LISP$S_evalAction (lmi,
-              (lmi->lstTab [LISP$M_getRefId (eargs)]).car, level);
-          RETURN_TRACE (LISP$S_evalAction (lmi, tmp, level));
-        }
+      res = LISP$S_applyAction (lmi, action, eargs, eargc, level);
+      lmi->rootTop = roots;
+      return (res);
+  }
+
+  /* Just for compiler, to be happy ;-) */
+  RETURN_TRACE (LISP$M_NULLREF);
+}
 
-        else if (LISP$M_checkBuiltIn (lmi, "COND", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF))
-          { RETURN_TRACE (LISP$M_builtInCOND (lmi, eargs, level)); }
+LISP$Ref LISP$S_applyAction (LISP$MachIns * lmi, LISP$Ref action,
+                             LISP$Ref eargs, int eargc, int level) {
 
-        else if (LISP$M_checkBuiltIn (lmi, "LOAD", atom,
-                lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInLOAD (lmi, eargs, level)); }
+  LISP$Ref        tmp    = lmi->NIL; /* Temporary reference         */
+  LISP$Ref        tmpx   = lmi->NIL; /* Temporary reference         */
+  LISP$Ref        res    = lmi->NIL; /* Result for RETURN macro     */
+  LISP$AtomRecord atom;              /* Applied action's atom       */
+  LISP$ListRecord list;              /* Shared 'list' helper var.   */
+  int             roots  = lmi->rootTop; /* GC roots to be kept     */
+
+  /* Each application is a safe point, so that garbage is collected  *
+   * in deep recursion as well as in loops -- the action and its      *
+   * arguments are rooted by the caller                               */
+  LISP$M_safePoint (lmi);
+
+  atom = lmi->atmTab [LISP$M_getRefId (action)];
+
+  /* Once there are futures, a built-in function gets their values --  *
+   * it waits for them; LIST and CONS just keep them as they are        */
+  if (lmi->hasFutures && atom.type == BuiltInFun &&
+      strcmp (atom.name, "LIST") && strcmp (atom.name, "CONS"))
+    for (tmp = eargs; tmp != lmi->NIL && LISP$M_getRefType (tmp) == ListTab;
+         tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr) {
+      tmpx = LISP$M_touch (lmi, (lmi->lstTab [LISP$M_getRefId (tmp)]).car);
+      if (tmpx == LISP$M_NULLREF) { RETURN_TRACE (LISP$M_NULLREF); }
+      (lmi->lstTab [LISP$M_getRefId (tmp)]).car = tmpx;
+    }
 
-        else if (LISP$M_checkBuiltIn (lmi, "SHOW-MEM", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 1))
-          { RETURN_TRACE (LISP$M_builtInSHOWMEM (lmi, eargs, eargc)); }
+  list = lmi->lstTab [LISP$M_getRefId (eargs)];
+
+  /* It's a built-in */
+  if (atom.type == BuiltInFun || atom.type == BuiltInSpecForm) {
+
+    if (LISP$M_checkBuiltIn (lmi, "CAR", atom, list, eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInCAR (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "CDR", atom, list, eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInCDR (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "LIST", atom,
+             list, eargc, 0, LISP$INF))
+      { RETURN_TRACE (eargs); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "QUOTE", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE ((lmi->lstTab [LISP$M_getRefId (eargs)]).car); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "AND", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInANDOR (lmi, eargs, level, true)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "OR", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInANDOR (lmi, eargs, level, false)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "WHILE", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInWHILE (lmi, eargs, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "DOTIMES", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInDOTIMES (lmi, eargs, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "DO", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInDO (lmi, eargs, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "NOT", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInNOT (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "SETQ", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInSETQ (lmi, eargs, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "CONS", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInCONS (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "+", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
+             LISP$M_checkBuiltIn (lmi, "-", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
+             LISP$M_checkBuiltIn (lmi, "*", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
+             LISP$M_checkBuiltIn (lmi, "/", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, LISP$INF) ||
+             LISP$M_checkBuiltIn (lmi, "%%", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInArithmetic (lmi, eargs, eargc,
+                                                atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "IS", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInIS (lmi, eargs)); }
+
+    #define COMPARE(op) \
+      list = lmi->lstTab [LISP$M_getRefId (eargs)]; \
+      tmp  = list.cdr; \
+      tmp  = (lmi->lstTab [LISP$M_getRefId (tmp)]).car; \
+      if (!LISP$M_isNumber (lmi, list.car) || \
+          !LISP$M_isNumber (lmi, tmp)) { \
+        LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS", \
+            "%s works only with numeric arguments!", atom.name); \
+        RETURN_TRACE (LISP$M_NULLREF); \
+      } \
+      \
+      RETURN_TRACE (LISP$M_compareNumbers (lmi, list.car, tmp, op)? \
+                    lmi->T : lmi->NIL);
+
+    else if (LISP$M_checkBuiltIn (lmi, "=", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)],
+               eargc, 2, 2)) { COMPARE(==) }
+    else if (LISP$M_checkBuiltIn (lmi, ">", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)],
+               eargc, 2, 2)) { COMPARE(>)  }
+    else if (LISP$M_checkBuiltIn (lmi, ">=", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)],
+               eargc, 2, 2)) { COMPARE(>=) }
+    else if (LISP$M_checkBuiltIn (lmi, "<", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)],
+               eargc, 2, 2)) { COMPARE(<)  }
+    else if (LISP$M_checkBuiltIn (lmi, "<=", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)],
+               eargc, 2, 2)) { COMPARE(<=) }
+    #undef COMPARE
+
+    else if (LISP$M_checkBuiltIn (lmi, "EVAL", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1)) {
+      tmp = LISP$S_evalAction (lmi,
+          (lmi->lstTab [LISP$M_getRefId (eargs)]).car, level);
+      RETURN_TRACE (LISP$S_evalAction (lmi, tmp, level));
+    }
 
-        else if (LISP$M_checkBuiltIn (lmi, "GETLPI", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 1))
-          { RETURN_TRACE (LISP$M_builtInGETLPI (lmi, eargs, eargc)); }
+    else if (LISP$M_checkBuiltIn (lmi, "COND", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInCOND (lmi, eargs, level)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "LET", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, LISP$INF))
-          { RETURN_TRACE (LISP$M_builtInLET (lmi, eargs, level)); }
+    else if (LISP$M_checkBuiltIn (lmi, "LOAD", atom,
+            lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInLOAD (lmi, eargs, level)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "LAMBDA", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
-          { RETURN_TRACE (LISP$M_builtInLAMBDASPECIAL (lmi, eargs, true)); }
+    else if (LISP$M_checkBuiltIn (lmi, "SHOW-MEM", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 1))
+      { RETURN_TRACE (LISP$M_builtInSHOWMEM (lmi, eargs, eargc)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "SPECIAL", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
-          { RETURN_TRACE (LISP$M_builtInLAMBDASPECIAL (lmi, eargs, false)); }
+    else if (LISP$M_checkBuiltIn (lmi, "GETLPI", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 1))
+      { RETURN_TRACE (LISP$M_builtInGETLPI (lmi, eargs, eargc)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "ISDEFINED", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInISDEFINED (lmi, eargs)); }
+    else if (LISP$M_checkBuiltIn (lmi, "LET", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInLET (lmi, eargs, level)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "ISATOM", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInISATOM (lmi, eargs)); }
+    else if (LISP$M_checkBuiltIn (lmi, "DELAY", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInDELAY (lmi, eargs)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "ISNUMBER", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInISNUMBER (lmi, eargs)); }
+    else if (LISP$M_checkBuiltIn (lmi, "FUTURE", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInFUTURE (lmi, eargs, level)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "ISLIST", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInISLIST (lmi, eargs)); }
+    else if (LISP$M_checkBuiltIn (lmi, "CONS-STREAM", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInCONSSTREAM (lmi, eargs, level)); }
 
-        else if (LISP$M_checkBuiltIn (lmi, "BODY", atom,
-                 lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
-          { RETURN_TRACE (LISP$M_builtInBODY (lmi, eargs)); }
+    else if (LISP$M_checkBuiltIn (lmi, "LAMBDA", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInLAMBDASPECIAL (lmi, eargs, true)); }
 
-        else {
-          LISP$M_setError (lmi, LISP$_ERR$S_NOTIMP, "NOTIMP",
-              "%s is not implemented built-in!", atom.name);
-          RETURN_TRACE (LISP$M_NULLREF);
-        }
-      }
+    else if (LISP$M_checkBuiltIn (lmi, "SPECIAL", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInLAMBDASPECIAL (lmi, eargs, false)); }
 
-      /* It's user defined */
-      else {
-        /* Bind arguments */
-        tmp  = atom.bindList;
-        tmpx = eargs;
-        while (tmp != lmi->NIL) {
-          /* XXX: check it is always atom!! */
-          /* Bind it */
-          LISP$Ref beg = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
-          if (beg == lmi->NIL) break;
-          LISP$M_bind (lmi, beg,
-              (lmi->lstTab [LISP$M_getRefId (tmpx)]).car);
-
-          /* Move to the next atom/value to be bound together */
-          tmp  = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
-          tmpx = (lmi->lstTab [LISP$M_getRefId (tmpx)]).cdr;
-          eargc--;
-        }
-        (lmi->atmTab [LISP$M_getRefId (action)]) = atom;
+    else if (LISP$M_checkBuiltIn (lmi, "ISDEFINED", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInISDEFINED (lmi, eargs)); }
 
-        /* Invalid argument count */
-        if (eargc) {
-          LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
-              "Too %s arguments!", (eargc > 0)? "much" : "few");
-          res = LISP$M_NULLREF;
-        }
+    else if (LISP$M_checkBuiltIn (lmi, "ISATOM", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInISATOM (lmi, eargs)); }
 
-        /* Evaluate */
-        else res = LISP$S_evalAction (lmi, atom.value, level);
+    else if (LISP$M_checkBuiltIn (lmi, "ISNUMBER", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInISNUMBER (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "ISLIST", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInISLIST (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "BODY", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInBODY (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "APPEND", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInAPPEND (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "REVERSE", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInREVERSE (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "SORT", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2))
+      { RETURN_TRACE (LISP$M_builtInSORT (lmi, eargs, eargc, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MEMBER", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInMEMBER (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "LENGTH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInLENGTH (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "NTH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInNTH (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "ASSOC", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInASSOC (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MAPCAR", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInMAPCAR (lmi, eargs, eargc, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "EQUAL", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInEQUAL (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MAKE-HASH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 1))
+      { RETURN_TRACE (LISP$M_builtInMAKEHASH (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "GETHASH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 3))
+      { RETURN_TRACE (LISP$M_builtInGETHASH (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "PUTHASH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 3, 3))
+      { RETURN_TRACE (LISP$M_builtInPUTHASH (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "REMHASH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInREMHASH (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MAPHASH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInMAPHASH (lmi, eargs, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "HASH-COUNT", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInHASHCOUNT (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MAKE-VECTOR", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 3))
+      { RETURN_TRACE (LISP$M_builtInMAKEVECTOR (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "VREF", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInVREF (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "VSET", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 3, 3))
+      { RETURN_TRACE (LISP$M_builtInVSET (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "VLENGTH", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInVLENGTH (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "LIST->VECTOR", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2))
+      { RETURN_TRACE (LISP$M_builtInLISTTOVECTOR (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "VECTOR->LIST", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInVECTORTOLIST (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "V+", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2) ||
+             LISP$M_checkBuiltIn (lmi, "V-", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2) ||
+             LISP$M_checkBuiltIn (lmi, "V*", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2) ||
+             LISP$M_checkBuiltIn (lmi, "V/", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInVARITH (lmi, eargs, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "DOT", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInDOT (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "VSUM", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "VMIN", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "VMAX", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInVREDUCE (lmi, eargs, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "SQRT", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "EXP", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "LOG", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2) ||
+             LISP$M_checkBuiltIn (lmi, "SIN", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "COS", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInMATH (lmi, eargs, eargc, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "EXPT", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInEXPT (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "FLOOR", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2) ||
+             LISP$M_checkBuiltIn (lmi, "CEILING", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2) ||
+             LISP$M_checkBuiltIn (lmi, "ROUND", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2))
+      { RETURN_TRACE (LISP$M_builtInROUND (lmi, eargs, eargc, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MIN", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF) ||
+             LISP$M_checkBuiltIn (lmi, "MAX", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInMINMAX (lmi, eargs, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "ABS", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInABS (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "WRITE-TO-STRING", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInWRITETOSTRING (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "WRITE-BINARY", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInWRITEBINARY (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "READ-BINARY", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInREADBINARY (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "OPEN", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2))
+      { RETURN_TRACE (LISP$M_builtInOPEN (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "CLOSE", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInCLOSE (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "READ", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 2) ||
+             LISP$M_checkBuiltIn (lmi, "READLN", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 2))
+      { RETURN_TRACE (LISP$M_builtInREAD (lmi, eargs, eargc, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "WRITE", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2) ||
+             LISP$M_checkBuiltIn (lmi, "WRITELN", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2))
+      { RETURN_TRACE (LISP$M_builtInWRITE (lmi, eargs, eargc, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "READ-LINES", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "READ-FORMS", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInREADLINES (lmi, eargs, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "MAP", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2) ||
+             LISP$M_checkBuiltIn (lmi, "FILTER", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInMAP (lmi, eargs, level, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "REDUCE", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 3, 3))
+      { RETURN_TRACE (LISP$M_builtInREDUCE (lmi, eargs, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "PMAP", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2) ||
+             LISP$M_checkBuiltIn (lmi, "PREDUCE", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 3, 3))
+      { RETURN_TRACE (LISP$M_builtInPMAP (lmi, eargs, level, atom.name)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "SPAWN", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, LISP$INF))
+      { RETURN_TRACE (LISP$M_builtInSPAWN (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "SEND", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 2, 2))
+      { RETURN_TRACE (LISP$M_builtInSEND (lmi, eargs)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "RECEIVE", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 2))
+      { RETURN_TRACE (LISP$M_builtInRECEIVE (lmi, eargs, eargc)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "SELF", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 0, 0))
+      { RETURN_TRACE (LISP$M_builtInSELF (lmi)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "NEXT", atom,
+             lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 2))
+      { RETURN_TRACE (LISP$M_builtInNEXT (lmi, eargs, eargc, level)); }
+
+    else if (LISP$M_checkBuiltIn (lmi, "FORCE", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "STREAM-CAR", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "STREAM-CDR", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1) ||
+             LISP$M_checkBuiltIn (lmi, "TOUCH", atom,
+               lmi->lstTab [LISP$M_getRefId (eargs)], eargc, 1, 1))
+      { RETURN_TRACE (LISP$M_builtInFORCE (lmi, eargs, level, atom.name)); }
 
-        /* UnBind aguments */
-        tmp  = atom.bindList;
-        while (tmp != lmi->NIL) {
-          LISP$Ref beg = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
-          if (beg == lmi->NIL) break;
+    else {
+      LISP$M_setError (lmi, LISP$_ERR$S_NOTIMP, "NOTIMP",
+          "%s is not implemented built-in!", atom.name);
+      RETURN_TRACE (LISP$M_NULLREF);
+    }
+  }
 
-          /* UnBind it */
-          LISP$M_unBind (lmi, beg);
+  /* It's user defined */
+  else {
+    /* Bind arguments */
+    tmp  = atom.bindList;
+    tmpx = eargs;
+    while (tmp != lmi->NIL) {
+      /* XXX: check it is always atom!! */
+      /* Bind it */
+      LISP$Ref beg = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+      if (beg == lmi->NIL) break;
+      LISP$M_bind (lmi, beg,
+          (lmi->lstTab [LISP$M_getRefId (tmpx)]).car);
+
+      /* Move to the next atom/value to be bound together */
+      tmp  = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+      tmpx = (lmi->lstTab [LISP$M_getRefId (tmpx)]).cdr;
+      eargc--;
+    }
+    (lmi->atmTab [LISP$M_getRefId (action)]) = atom;
 
-          /* Move to the next atom to be unbound */
-          tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
-        }
-        (lmi->atmTab [LISP$M_getRefId (action)]) = atom;
+    /* Invalid argument count */
+    if (eargc) {
+      LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+          "Too %s arguments!", (eargc > 0)? "much" : "few");
+      res = LISP$M_NULLREF;
+    }
 
-        RETURN_TRACE (res);
-      }
+    /* Evaluate */
+    else res = LISP$S_evalAction (lmi, atom.value, level);
+
+    /* UnBind aguments */
+    tmp  = atom.bindList;
+    while (tmp != lmi->NIL) {
+      LISP$Ref beg = (lmi->lstTab [LISP$M_getRefId (tmp)]).car;
+      if (beg == lmi->NIL) break;
+
+      /* UnBind it */
+      LISP$M_unBind (lmi, beg);
+
+      /* Move to the next atom to be unbound */
+      tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    }
+    (lmi->atmTab [LISP$M_getRefId (action)]) = atom;
+
+    RETURN_TRACE (res);
   }
 
   /* Just for compiler, to be happy ;-) */
   RETURN_TRACE (LISP$M_NULLREF);
 }
+
+LISP$Ref LISP$S_apply (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref eargs,
+                       int level) {
+
+  int      eargc = 0;
+  int      roots = lmi->rootTop;
+  LISP$Ref tmp   = eargs;
+  LISP$Ref res;
+
+  if (LISP$M_getRefType (fun) != AtomTab ||
+      !LISP$M_isFunction (lmi->atmTab [LISP$M_getRefId (fun)])) {
+    LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+        "Applied object is not a function!");
+    return (LISP$M_NULLREF);
+  }
+
+  /* Arguments are already evaluated -- only count them */
+  while (tmp != lmi->NIL) {
+    tmp = (lmi->lstTab [LISP$M_getRefId (tmp)]).cdr;
+    eargc++;
+  }
+
+  /* Callers build the arguments just for this application */
+  LISP$M_pushRoot (lmi, eargs);
+  res = LISP$S_applyAction (lmi, fun, eargs, eargc, level);
+  lmi->rootTop = roots;
+
+  return (res);
+}
 #undef RETURN_TRACE
 
 LISP$Ref LISP$S_eval (LISP$MachIns * lmi, LISP$Ref read) {
@@ -1825,49 +6296,125 @@ char * LISP$S_getFormatAtomType (LISP$AtomType type) {
   }
 }
 
-void LISP$S_writeAction (LISP$MachIns * lmi, LISP$Ref evaluated,
-                         bool isTopLevel) {
+void LISP$S_writeAction (LISP$MachIns * lmi, LISP$Writer * w,
+                         LISP$Ref evaluated, bool isTopLevel) {
 
   LISP$ListRecord list;
   LISP$ListRecord tmpList;
   LISP$AtomRecord atom;
+  LISP$ObjectRecord obj;
+  LISP$NumberRecord * num;
+  char * str;
+  int i;
   switch (LISP$M_getRefType (evaluated)) {
     case AtomTab:
       atom = lmi->atmTab [LISP$M_getRefId (evaluated)];
       if (isTopLevel && atom.type != Variable && atom.type != Undefined) {
-        fprintf (lmi->outputStream,
+        LISP$W_printf (w,
             "{%s \'%s\', the ATM#" LISP$ADDRFMT "}",
             LISP$S_getFormatAtomType (atom.type),
             atom.name, LISP$M_getRefId (evaluated));
       }
       else {
-        fprintf (lmi->outputStream, "%s",
-            (lmi->atmTab [LISP$M_getRefId (evaluated)]).name);
+        str = (lmi->atmTab [LISP$M_getRefId (evaluated)]).name;
+        LISP$W_putString (w, str, strlen (str));
       }
       break;
     case NumberTab:
-      fprintf (lmi->outputStream, "%-g",
-          lmi->numTab [LISP$M_getRefId (evaluated)]);
+      num = &(lmi->numTab [LISP$M_getRefId (evaluated)]);
+      if (num->isInt) LISP$W_putInteger (w, num->val.i);
+      else            LISP$W_putDouble (w, num->val.d);
       break;
     case ListTab:
       list = lmi->lstTab [LISP$M_getRefId (evaluated)];
 
-      fprintf (lmi->outputStream, "%c", LISP$S_PAR_OPEN);
-      LISP$S_writeAction (lmi, list.car, false);
+      LISP$W_putChar (w, LISP$S_PAR_OPEN);
+      LISP$S_writeAction (lmi, w, list.car, false);
 
       tmpList = list;
       while (LISP$M_getRefType (tmpList.cdr) == ListTab) {
-        fprintf (lmi->outputStream, " ");
+        LISP$W_putChar (w, ' ');
 
         tmpList = lmi->lstTab [LISP$M_getRefId (tmpList.cdr)];
-        LISP$S_writeAction (lmi, tmpList.car, false);
+        LISP$S_writeAction (lmi, w, tmpList.car, false);
       }
 
       if (tmpList.cdr != lmi->NIL) {
-        fprintf (lmi->outputStream, " . ");
-        LISP$S_writeAction (lmi, tmpList.cdr, false);
+        LISP$W_putString (w, " . ", 3);
+        LISP$S_writeAction (lmi, w, tmpList.cdr, false);
+      }
+      LISP$W_putChar (w, LISP$S_PAR_CLOSE);
+      break;
+    case ObjectTab:
+      obj = lmi->objTab [LISP$M_getRefId (evaluated)];
+      switch (obj.type) {
+        case HashTable:
+          LISP$W_printf (w,
+              "{HASH-TABLE %s %d, the OBJ#" LISP$ADDRFMT "}",
+              (obj.data.hash)->isEqual? "EQUAL" : "EQ",
+              (obj.data.hash)->count, LISP$M_getRefId (evaluated));
+          break;
+
+        case RefVector:
+        case DoubleVector:
+          LISP$W_putChar (w, '#');
+          LISP$W_putChar (w, LISP$S_PAR_OPEN);
+          for (i = 0; i < (obj.data.vector)->length; i++) {
+            if (i) LISP$W_putChar (w, ' ');
+            if (obj.type == RefVector)
+              LISP$S_writeAction (lmi, w, (obj.data.vector)->items.refs [i],
+                                  false);
+            else
+              LISP$W_putDouble (w, (obj.data.vector)->items.nums [i]);
+          }
+          LISP$W_putChar (w, LISP$S_PAR_CLOSE);
+          break;
+
+        case BigInteger:
+          str = LISP$B_toString (obj.data.bignum);
+          if (str == NULL) {
+            LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+                "No memory for a big integer!");
+            break;
+          }
+          LISP$W_putString (w, str, strlen (str));
+          free (str);
+          break;
+
+        case LongString:
+          LISP$W_putChar (w, '"');
+          LISP$W_putString (w, (obj.data.string)->chars,
+                            (obj.data.string)->length);
+          LISP$W_putChar (w, '"');
+          break;
+
+        case Stream:
+          LISP$W_printf (w, "{STREAM %s \"%s\", the OBJ#" LISP$ADDRFMT "}",
+              ((obj.data.stream)->file == NULL)?   "CLOSED" :
+              ((obj.data.stream)->reader != NULL)? "INPUT"  : "OUTPUT",
+              (obj.data.stream)->name, LISP$M_getRefId (evaluated));
+          break;
+
+        case Sequence:
+          LISP$W_printf (w, "{SEQUENCE %s, the OBJ#" LISP$ADDRFMT "}",
+              ((obj.data.sequence)->isDone)?        "DONE"   :
+              ((obj.data.sequence)->kind == Lines)? "LINES"  :
+              ((obj.data.sequence)->kind == Forms)? "FORMS"  :
+              ((obj.data.sequence)->kind == Mapped)? "MAP"   : "FILTER",
+              LISP$M_getRefId (evaluated));
+          break;
+
+        /* The value isn't printed, it may be a stream of the promises */
+        case Promise:
+          if ((obj.data.promise)->isFuture)
+            LISP$W_printf (w, "{FUTURE %s, the OBJ#" LISP$ADDRFMT "}",
+                ((obj.data.promise)->isForced)? "TOUCHED" : "PENDING",
+                LISP$M_getRefId (evaluated));
+          else LISP$W_printf (w, "{PROMISE %s, the OBJ#" LISP$ADDRFMT "}",
+              ((obj.data.promise)->isForced)? "FORCED" : "DELAYED",
+              LISP$M_getRefId (evaluated));
+          break;
       }
-      fprintf (lmi->outputStream, "%c", LISP$S_PAR_CLOSE);
       break;
   }
 }
@@ -1875,6 +6422,8 @@ void LISP$S_writeAction (LISP$MachIns * lmi, LISP$Ref evaluated,
 void LISP$S_write (LISP$MachIns * lmi,
                    LISP$Ref evaluated) {
 
+  LISP$Writer w;
+
   /* Report error if there was something wrong  *
    * while parsing or evaluating                */
   if (LISP$M_isError (lmi)) {
@@ -1883,8 +6432,10 @@ void LISP$S_write (LISP$MachIns * lmi,
 
   /* We are going to quit, so LISP$M_NULLREF evaluator result is OK */
   else if (LISP$M_is2ShutDown (lmi)) {
-    fprintf (lmi->outputStream, "\n");
-    LISP$M_throwMessage (lmi, 'I', "QUIT", "Bye.");
+    if (!lmi->isQuiet) {
+      fprintf (lmi->outputStream, "\n");
+      LISP$M_throwMessage (lmi, 'I', "QUIT", "Bye.");
+    }
   }
 
   /* Nothing evaluated */
@@ -1896,25 +6447,42 @@ void LISP$S_write (LISP$MachIns * lmi,
     #endif
   }
 
-  /* Print the result */
-  else {
-    fprintf (lmi->outputStream, "\r" LISP$PROMPT_RES);
-    LISP$S_writeAction (lmi, evaluated, true);
-    fprintf (lmi->outputStream, "\n");
+  /* Print the result -- it's buffered, so a huge list costs just *
+   * a few writes                                                   */
+  else if (lmi->isEchoed) {
+    LISP$W_openStream (&w, lmi->outputStream);
+    if (!lmi->isQuiet)
+      LISP$W_putString (&w, "\r" LISP$PROMPT_RES,
+                        sizeof ("\r" LISP$PROMPT_RES) - 1);
+    LISP$S_writeAction (lmi, &w, evaluated, true);
+    LISP$W_putChar (&w, '\n');
+    LISP$W_close (&w);
+
+    /* A tool piping the forms in waits for each result */
+    if (lmi->isQuiet && (lmi->reader)->isLineWise)
+      fflush (lmi->outputStream);
   }
 
-  /* Collect garbage */
-  LISP$M_collectGarbage (lmi);
+  /* Collect garbage -- a batch does it just when the tables fill up, *
+   * a full collection after each of many small forms would take most  *
+   * of the time                                                       */
+  if (lmi->isQuiet) LISP$M_safePoint (lmi);
+  else LISP$M_collectGarbage (lmi);
 }
 
 bool LISP$S_loadFile (LISP$MachIns * lmi, char * fileName) {
 
   if (fileName == NULL) return false;
 
-  FILE * origInStream  = lmi->inputStream;
-  FILE * origOutStream = lmi->outputStream;
+  LISP$Reader * origReader = lmi->reader;
+  LISP$Reader   fileReader;
+  LISP$D_Cache * cache = NULL, * newCache = NULL;
+  LISP$D_Stamp  stamp;
+  struct stat   st;
   FILE * in; LISP$Ref res;
   LISP$Mode origMode = lmi->mode;
+  char * cacheName;
+  bool isComplete = true;
 
   in = fopen (fileName, "r");
   if (in == NULL) {
@@ -1927,22 +6495,64 @@ bool LISP$S_loadFile (LISP$MachIns * lmi, char * fileName) {
   /* Switch mode to BATCH */
   lmi->mode = Batch;
 
-  /* Set current file as input stream */
-  LISP$M_setStreams (lmi, in, origOutStream);
+  /* Read the file by its own reader -- the original one may have read *
+   * ahead already; a regular file is mapped, anything else streamed    */
+  if (!LISP$R_openMapped (&fileReader, in))
+    LISP$R_openStream (&fileReader, in);
+  lmi->reader     = &fileReader;
+  lmi->is2Process = true;
 
-  /* Read code from there */
-  res = LISP$S_read (lmi);
-  res = LISP$S_eval (lmi, res);
+  /* The forms of a mapped file are read from its cache if it's valid, *
+   * otherwise they're written into a new one as they're read          */
+  if (fileReader.isMapped && !fstat (fileno (in), &st) &&
+      LISP$M_isOptionEnabled (lmi, LISP$M_OPT_CACHE) &&
+      (cacheName = (char *) malloc (strlen (fileName) +
+                                    sizeof (LISP$D_CACHE_SUFFIX))) != NULL) {
+    sprintf (cacheName, "%s%s", fileName, LISP$D_CACHE_SUFFIX);
+#ifdef _VMS_
+    stamp.mtime = (int64_t) st.st_mtime * 1000000000;
+#else
+    stamp.mtime = (int64_t) st.st_mtim.tv_sec * 1000000000 +
+                  st.st_mtim.tv_nsec;
+#endif
+    stamp.size  = (uint64_t) fileReader.length;
 
-  while (LISP$M_is2Process (lmi)) {
-    LISP$S_write (lmi, res);
-    res = LISP$S_read (lmi);
-    res = LISP$S_eval (lmi, res);
+    cache = LISP$D_openCache (lmi, cacheName, &stamp, fileReader.buffer);
+    if (cache == NULL) {
+      stamp.hash = LISP$D_hashText (fileReader.buffer, fileReader.length);
+      newCache = LISP$D_createCache (lmi, cacheName, &stamp);
+    }
+    free (cacheName);
   }
+
+  /* Read code from there -- the end of the cache is the end of file */
+  do {
+    if (cache != NULL) {
+      res = LISP$D_readForm (cache);
+      if (res == LISP$M_NULLREF && !LISP$M_isError (lmi))
+        LISP$M_setProcessed (lmi);
+    }
+    else {
+      res = LISP$S_read (lmi);
+      if (LISP$M_isError (lmi)) isComplete = false;
+      else if (newCache != NULL && res != LISP$M_NULLREF)
+        LISP$D_writeForm (newCache, res);
+    }
+
+    res = LISP$S_eval (lmi, res);
+    if (LISP$M_is2Process (lmi)) LISP$S_write (lmi, res);
+  } while (LISP$M_is2Process (lmi));
+
+  /* A new cache is kept if the file was read up to its end, without *
+   * any syntax error                                                 */
+  LISP$D_closeCache (cache, true);
+  LISP$D_closeCache (newCache, isComplete && fileReader.isEOF);
+  LISP$R_close (&fileReader);
   fclose (in);
 
-  /* Restore original I/O streams */
-  LISP$M_setStreams (lmi, origInStream, origOutStream);
+  /* Restore original reader */
+  lmi->reader     = origReader;
+  lmi->is2Process = true;
 
   /* Restore mode */
   lmi->mode = origMode;
@@ -1956,4 +6566,59 @@ bool LISP$S_loadFile (LISP$MachIns * lmi, char * fileName) {
   return true;
 }
 
+/* Read, evaluate and write all the forms of 'r' in the batch mode */
+static bool LISP$S_loadReader (LISP$MachIns * lmi, LISP$Reader * r) {
+
+  LISP$Reader * origReader = lmi->reader;
+  LISP$Mode     origMode   = lmi->mode;
+  long          errors     = lmi->errorCount;
+  LISP$Ref      res;
+
+  lmi->mode       = Batch;
+  lmi->reader     = r;
+  lmi->is2Process = true;
+
+  do {
+    res = LISP$S_read (lmi);
+    res = LISP$S_eval (lmi, res);
+    if (LISP$M_is2Process (lmi)) LISP$S_write (lmi, res);
+  } while (LISP$M_is2Process (lmi));
+
+  lmi->reader     = origReader;
+  lmi->is2Process = true;
+  lmi->mode       = origMode;
+
+  /* The form read at the end may have failed too */
+  if (LISP$M_isError (lmi)) LISP$M_reportError (lmi);
+
+  return (lmi->errorCount == errors);
+}
+
+bool LISP$S_loadText (LISP$MachIns * lmi, const char * text, size_t length) {
+
+  LISP$Reader r;
+  bool        res;
+
+  LISP$R_openText (&r, text, length);
+  res = LISP$S_loadReader (lmi, &r);
+
+  /* The text isn't owned, so closing just resets the reader */
+  LISP$R_close (&r);
+  return res;
+}
+
+bool LISP$S_loadStream (LISP$MachIns * lmi, FILE * stream) {
+
+  LISP$Reader r;
+  bool        res;
+
+  /* A pipe is read by lines, so a tool can wait for each result */
+  if (!LISP$R_openMapped (&r, stream))
+    LISP$R_openStream (&r, stream);
+  res = LISP$S_loadReader (lmi, &r);
+  LISP$R_close (&r);
+
+  return res;
+}
+
 // vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -12,6 +12,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "LISP_Bignum.h"
+#include "LISP_Reader.h"
+#include "LISP_Writer.h"
+#include "LISP_Log.h"
 
 #define  LISP$MACH_ID   "LISP Machine V1.0 $Rev: 76 $"
 
@@ -31,10 +38,27 @@
  * LISP Definitions
  ******************************************************/
 
-/* List, atom and number table size */
+/* Initial list, atom and number table sizes -- each table is doubled *
+ * when it's full, up to the maximal size a reference can address     */
 #define LISP$MACH_LSTTABLEN     0x17FF
 #define LISP$MACH_ATMTABLEN     0x17FF
 #define LISP$MACH_NUMTABLEN     0x17FF
+#define LISP$MACH_TABMAXLEN     0x1FFFFFFF
+
+/* Initial heap object table size and initial hash table size (2^n) */
+#define LISP$MACH_OBJTABLEN     0x3FF
+#define LISP$MACH_HASHINITLEN   8
+
+/* Bytes of object payloads allocated since the last GC to start a new one */
+#define LISP$MACH_OBJGCBYTES    0x2000000
+
+/* Evaluator's GC root stack size and initial number lookup hash size *
+ * (2^n); the root stack grows up to one root per ROOTSTACKBYTES of C  *
+ * stack, so that too deep recursion is stopped before it crashes      */
+#define LISP$MACH_ROOTSTACKLEN   0x3FFF
+#define LISP$MACH_ROOTSTACKBYTES 192
+#define LISP$MACH_NUMHASHLEN     0x4000
+#define LISP$MACH_ATMHASHLEN     0x4000
 
 /* Maximal atom name size */
 #define LISP$MACH_ATMNAMELEN      64
@@ -46,6 +70,24 @@
 #define LISP$IS_NINF(x)  (LISP$IS_INF (-(x)))          /* Is -Inf?   */
 #define LISP$NAN         (0.0 / 0.0)                   /* Not a Num. */
 
+/* Exact integer arithmetic; each returns true if the result overflows */
+#ifdef __GNUC__
+#define LISP$ADD_OVERFLOW(a,b,r) __builtin_add_overflow (a, b, r)
+#define LISP$SUB_OVERFLOW(a,b,r) __builtin_sub_overflow (a, b, r)
+#define LISP$MUL_OVERFLOW(a,b,r) __builtin_mul_overflow (a, b, r)
+#else
+#define LISP$ADD_OVERFLOW(a,b,r) \
+  (((b) > 0)? ((a) > INT64_MAX - (b)) : ((a) < INT64_MIN - (b)))? \
+  true : (*(r) = (a) + (b), false))
+#define LISP$SUB_OVERFLOW(a,b,r) \
+  (((b) < 0)? ((a) > INT64_MAX + (b)) : ((a) < INT64_MIN + (b)))? \
+  true : (*(r) = (a) - (b), false))
+#define LISP$MUL_OVERFLOW(a,b,r) \
+  ((((double) (a)) * ((double) (b)) >= 9.2e18 || \
+    ((double) (a)) * ((double) (b)) <= -9.2e18)? \
+  true : (*(r) = (a) * (b), false))          /* Conservative near 2^63 */
+#endif
+
 /* Macros for manipulating with references */
 #define LISP$M_NULLREF               -1
 #define LISP$M_setRef(ref,id,type)   ((ref) = (((id) << 2) | (type)))
@@ -56,6 +98,21 @@
 #define LISP$M_setRefId(ref,id)      (LISP$M_setRef ((ref), id, \
                                         LISP$M_getRefType (ref)))
 
+/* Compare numbers 'x' and 'y' by 'op' -- exactly if any of them is an *
+ * integer; a NaN is unordered, so it's compared as a double            */
+#define LISP$M_compareNumbers(lmi,x,y,op) \
+  ((LISP$M_getRefType (x) == NumberTab && \
+    LISP$M_getRefType (y) == NumberTab && \
+    (lmi)->numTab [LISP$M_getRefId (x)].isInt && \
+    (lmi)->numTab [LISP$M_getRefId (y)].isInt)? \
+   ((lmi)->numTab [LISP$M_getRefId (x)].val.i op \
+    (lmi)->numTab [LISP$M_getRefId (y)].val.i) : \
+   ((LISP$M_isExact (lmi, x) || LISP$M_isExact (lmi, y)) && \
+    !isnan (LISP$M_getNumber (lmi, x)) && \
+    !isnan (LISP$M_getNumber (lmi, y)))? \
+   (LISP$M_compareExact (lmi, x, y) op 0) : \
+   (LISP$M_getNumber (lmi, x) op LISP$M_getNumber (lmi, y)))
+
 /* Error name and message maximal lengths */
 #define LISP$ERROR_NAMLEN         32
 #define LISP$ERROR_MSGLEN        256
@@ -69,9 +126,12 @@
 #define LISP$_ERR$S_NOTIMP         5 /* E: Not implemented yet       */
 #define LISP$_ERR$S_UNDEF          6 /* E: Atom is not defined       */
 #define LISP$_ERR$S_NAOFIL         6 /*  : Unable to open file       */
+#define LISP$_ERR$S_STKFUL         7 /* E: Too deep evaluation       */
+#define LISP$_ERR$S_BADDAT         8 /* E: Damaged binary data       */
 #define LISP$_ERR$S_ATMFUL        -1 /* C: Atom table is full        */
 #define LISP$_ERR$S_LSTFUL        -2 /* C: List table is full        */
 #define LISP$_ERR$S_NUMFUL        -3 /* C: Number table is full      */
+#define LISP$_ERR$S_OBJFUL        -4 /* C: Object table is full      */
 
 /* S-Expression helpers */
 /* NOTE: The first LISP used M-expressions, so if you like them,
@@ -89,6 +149,7 @@
 #define LISP$M_OPT_TRACE "LISP$TRACE" /* Trace when evaluating    */
 #define LISP$M_OPT_LOG   "LISP$LOG"   /* Log messages into a file */
 #define LISP$M_OPT_GC    "LISP$GC"    /* Collect garbage          */
+#define LISP$M_OPT_CACHE "LISP$CACHE" /* Cache LOADed files       */
 
 /* Misc */
 #define LISP$ADDRFMT         "0x%04X" /* Something like '%p'       */
@@ -109,7 +170,7 @@ typedef struct {
 } LISP$Error;
 
 /* Table type enumeration */
-typedef enum { ListTab, AtomTab, NumberTab } LISP$TableType;
+typedef enum { ListTab, AtomTab, NumberTab, ObjectTab } LISP$TableType;
 
 /* Reference to each LISP object in memory               */
 /* Note: LISP$Ref was a structure in original design,    *
@@ -139,12 +200,120 @@ typedef enum {
 /* Atom table record */
 typedef struct {
   char          name [LISP$MACH_ATMNAMELEN];
+  unsigned int  hash;     /* $M_hashAtomName (name)  */
   LISP$AtomType type;     /* Type of this AtomRecord */
   LISP$Ref value;    /* Link to list or number value */
   LISP$Ref bindList; /* Bind     list                */
 //  void *        propList; /* Property list                */
 } LISP$AtomRecord;
 
+/* Number table record -- an exact integer or a floating-point number */
+typedef struct {
+  bool      isInt;
+  union {
+    int64_t i;          /* Integer */
+    double  d;          /* Double  */
+  } val;
+} LISP$NumberRecord;
+
+/* Heap object type enumeration */
+typedef enum {
+  HashTable, RefVector, DoubleVector, BigInteger, LongString, Stream,
+  Sequence, Promise
+} LISP$ObjectType;
+
+/* String too long for an atom name -- it's kept without the quotes */
+typedef struct {
+  size_t length;
+  char * chars;         /* Terminated by '\0' */
+} LISP$String;
+
+/* File opened by OPEN -- it's read by a reader or written by a writer, *
+ * both keep their own buffers; 'file' is NULL once it's closed         */
+typedef struct {
+  FILE *        file;
+  char *        name;
+  LISP$Reader * reader;   /* Input, or NULL  */
+  LISP$Writer * writer;   /* Output, or NULL */
+} LISP$Stream;
+
+/* Lazy sequence -- its items are made just when they're consumed, one *
+ * by one, so nothing but the item being consumed is kept in memory     */
+typedef enum { Lines, Forms, Mapped, Filtered } LISP$SequenceKind;
+
+typedef struct {
+  LISP$SequenceKind kind;
+  LISP$Ref          source;   /* Stream (NIL is the standard input) of  *
+                               * Lines and Forms, sequence of the rest  */
+  LISP$Ref          fun;      /* Mapped or filtered by                  */
+  bool              isOwner;  /* Close the stream at the end?           */
+  bool              isDone;   /* The end has been reached               */
+} LISP$Sequence;
+
+/* Result of FUTURE, shared by the worker computing it and by all the *
+ * copies of its promise -- see LISP_Core.c                            */
+typedef struct LISP$Future LISP$Future;
+
+/* Promise of DELAY -- the expression is evaluated by the first FORCE, *
+ * its value is kept then and the expression with the bindings are     *
+ * dropped; the bindings are the values of the variables of the        *
+ * expression bound by a LAMBDA or LET when it was delayed, as a list   *
+ * (ATOM VALUE ATOM VALUE ...), since they'd be gone when it's forced.  *
+ * A promise of FUTURE has no expression, its value is brought from    *
+ * the 'future' by the first TOUCH, which waits for it                 */
+typedef struct {
+  LISP$Ref      expr;
+  LISP$Ref      bindings;
+  LISP$Ref      value;
+  bool          isForced;
+  bool          isFuture;
+  LISP$Future * future;                         /* Till it's touched    */
+} LISP$Promise;
+
+/* Vector -- a contiguous array of references or of unboxed numbers */
+typedef struct {
+  int          length;
+  union {
+    LISP$Ref * refs;    /* RefVector    */
+    double *   nums;    /* DoubleVector */
+  } items;
+} LISP$Vector;
+
+/* Hash table entry -- entries of the same bucket are chained */
+typedef struct LISP$HashEntry {
+  LISP$Ref                key;      /* NULLREF if removed while iterating */
+  LISP$Ref                value;
+  unsigned int            hash;     /* Cached hash of the key   */
+  struct LISP$HashEntry * next;
+} LISP$HashEntry;
+
+/* Hash table -- it grows incrementally: while 'oldBuckets' is set, *
+ * each operation moves a few of them to the new 'buckets' array    */
+typedef struct {
+  bool              isEqual;    /* EQUAL or EQ key test        */
+  int               count;      /* Number of live entries      */
+  int               size;       /* Number of buckets (2^n)     */
+  LISP$HashEntry ** buckets;
+  int               oldSize;    /* Buckets being moved         */
+  LISP$HashEntry ** oldBuckets;
+  int               rehashPos;  /* Next old bucket to be moved */
+  int               iterating;  /* MAPHASH nesting level       */
+} LISP$HashTable;
+
+/* Object table record -- the payload is allocated on the C heap */
+typedef struct {
+  LISP$ObjectType    type;
+  union {
+    LISP$HashTable * hash;
+    LISP$Vector *    vector;
+    LISP$Bignum *    bignum;
+    LISP$String *    string;
+    LISP$Stream *    stream;
+    LISP$Sequence *  sequence;
+    LISP$Promise *   promise;
+  } data;
+} LISP$ObjectRecord;
+
 typedef enum { Interactive, Batch } LISP$Mode;
 
 /* State of memory node -- used by GC and lst/num/atm lookup/alloc funs *
@@ -156,19 +325,28 @@ typedef enum { Interactive, Batch } LISP$Mode;
  *   Prot ... protected node for internal use                           */
 typedef enum { Free, Used, Temp, Prot } LISP$MemState;
 
+/* Workers of PMAP and PREDUCE, see LISP_Pool */
+struct LISP$Pool;
+
+/* Mailbox of SEND and RECEIVE, see LISP_Actor */
+struct LISP$Actor;
+
 /* LISP Machine Instance (LMI) */
 typedef struct {
   LISP$Error      error;                        /* LMI error indicator  */
 
   FILE *          logStream;                    /* Log file stream      */
+  LISP$Log *      log;                          /* ... and its writer   */
+  bool            isLogOwned;                   /* Close it by destroy? */
+  FILE *          messageStream;                /* %LISP-* messages     */
   FILE *          inputStream;                  /* S-expr input stream  */
   FILE *          outputStream;                 /* S-expr output stream */
-#ifdef _HAS_RDLN_
-  char *          readLineBuffer;               /* ReadLine's inp. buf. */
-#endif
-  char            inputBuffer [LISP$MACH_INPMAXLEN]; /* Recently read   */
-  int             inputReadPosition;            /* Current getChar pos. */
+  LISP$Reader     stdReader;                    /* Reader of inputStream*/
+  LISP$Reader *   reader;                       /* Current input        */
+  char            token [LISP$S_TOKEN_SIZE];    /* Settled token        */
+  char            inputErrorLine [LISP$MACH_INPMAXLEN]; /* Bad input    */
   int             inputErrorPosition;           /* Incorrect input pos. */
+  long            inputErrorLineNo;             /* ... and its line     */
 
   bool            isReady;                      /* Is initialized?      */
   bool            is2ShutDown;                  /* Is LMI to be halted? */
@@ -176,14 +354,54 @@ typedef struct {
   bool            sexprEnd;                     /* S-expr read "lock"   */
 
   LISP$Mode       mode;                         /* Mode of processing   */
-
-  LISP$MemState   lstIdx [LISP$MACH_LSTTABLEN]; /* Used lists   index   */
-  LISP$MemState   atmIdx [LISP$MACH_ATMTABLEN]; /* Used atom    index   */
-  LISP$MemState   numIdx [LISP$MACH_NUMTABLEN]; /* Used numbers index   */
-
-  LISP$ListRecord lstTab [LISP$MACH_LSTTABLEN]; /* List table           */
-  LISP$AtomRecord atmTab [LISP$MACH_ATMTABLEN]; /* Atom table           */
-  double          numTab [LISP$MACH_NUMTABLEN]; /* Number table         */
+  bool            isQuiet;                      /* Results only?        */
+  bool            isEchoed;                     /* Print the results?   */
+  long            errorCount;                   /* Errors reported      */
+
+  struct LISP$Pool *  pool;                     /* PMAP workers, lazily */
+  int             workers;                      /* ... how many of them */
+  bool            isWorker;                     /* Is it one of them?   */
+  struct LISP$Actor * actor;                    /* Mailbox, lazily      */
+  bool            hasFutures;                   /* Touch the arguments? */
+
+  LISP$MemState * lstIdx;                       /* Used lists   index   */
+  LISP$MemState * atmIdx;                       /* Used atom    index   */
+  LISP$MemState * numIdx;                       /* Used numbers index   */
+  LISP$MemState * objIdx;                       /* Used objects index   */
+
+  LISP$ListRecord *   lstTab;                   /* List table           */
+  LISP$AtomRecord *   atmTab;                   /* Atom table           */
+  LISP$NumberRecord * numTab;                   /* Number table         */
+  LISP$ObjectRecord * objTab;                   /* Object table         */
+
+  int             lstLen;                       /* Current table sizes  */
+  int             atmLen;
+  int             numLen;
+  int             objLen;
+
+  int             lstNext;                      /* Next-fit alloc hints */
+  int             atmNext;
+  int             numNext;
+  int             objNext;
+  int             lstFree;                      /* Free nodes counters  */
+  int             atmFree;
+  int             numFree;
+  int             objFree;
+  size_t          objBytes;                     /* Allocated since GC   */
+
+  int *           numHash;                      /* Number lookup hash   */
+  int             numHashLen;
+  int *           atmHash;                      /* Atom lookup hash     */
+  int             atmHashLen;
+
+  LISP$Ref *      rootStack;                    /* Eval's GC roots      */
+  int             rootTop;                      /* Root stack pointer   */
+  int             rootLen;                      /* Allocated and the    */
+  int             rootMax;                      /* maximal size         */
+
+  LISP$Ref        optTrace;                     /* Option atoms cache   */
+  LISP$Ref        optLog;
+  LISP$Ref        optGC;
 
   LISP$Ref        QUOTE;                        /* QUOTE reference      */
   LISP$Ref        NIL;                          /* NIL   reference      */
@@ -196,11 +414,35 @@ typedef struct {
  * LISP Machine control operations
  ******************************************************/
 
-/* Initialize a new LMI */
-LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output);
+/* Initialize a new LMI; a quiet one prints just the results, without *
+ * the prompts, the decorations and the banners, and its messages go   *
+ * to stderr -- for scripts and pipes. The log is NAME.log, none for a *
+ * NULL name. All the state is kept in the LMI, so each thread may run *
+ * an LMI of its own, created on that thread; just one of them may     *
+ * read the terminal (stdin) interactively, through libreadline         */
+LISP$MachIns * LISP$M_init (char * name, FILE * input, FILE * output,
+                            bool isQuiet);
 
 void LISP$M_setStreams (LISP$MachIns * lmi, FILE * input, FILE * output);
 
+/* A new LMI with a copy of the whole heap of 'lmi' -- its atoms, lists, *
+ * numbers and objects have the same references there; streams are      *
+ * copied closed, no log is opened. It's cheaper than loading the same  *
+ * files again, so a warmed-up LMI may be a template of many workers;   *
+ * like $M_init, it's to be called by the thread which runs the copy,   *
+ * and 'lmi' mustn't change meanwhile. NULL if there's no memory         */
+LISP$MachIns * LISP$M_clone (LISP$MachIns * lmi, FILE * input, FILE * output);
+
+/* Make 'lmi' a copy of 'template' again, keeping its streams and its *
+ * pool -- it's faster than a new copy, since the tables are reused    *
+ * (they're grown if the template's ones have); false if there's no    *
+ * memory (the LMI is to be destroyed then)                            */
+bool LISP$M_reset (LISP$MachIns * lmi, LISP$MachIns * template);
+
+/* Redirect the messages and the log of LMI (either may be NULL to drop *
+ * them); the streams are not closed by the LMI                         */
+void LISP$M_setSinks (LISP$MachIns * lmi, FILE * messages, FILE * log);
+
 /* Destroy specified LMI */
 void LISP$M_destroy (LISP$MachIns * lmi);
 
@@ -227,14 +469,109 @@ void LISP$M_reportError (LISP$MachIns * lmi);
 void LISP$M_setError (LISP$MachIns * lmi, const int code,
                       const char * name, const char * msg, ...);
 
-/* Find a first free node in the specified storage table */
-int LISP$M_findFreeNode (LISP$MemState idx [], int length);
+/* Find a free node in the specified storage table, starting at 'next' *
+ * position which is then moved behind the node found                  */
+int LISP$M_findFreeNode (LISP$MemState idx [], int length, int * next);
+
+/* Resize the 'type' storage table to 'length' nodes (only growing is *
+ * supported); false is returned if there's no memory                  */
+bool LISP$M_resizeTable (LISP$MachIns * lmi, LISP$TableType type,
+                         int length);
+
+/* Double the size of the 'type' storage table; false if it cannot grow */
+bool LISP$M_growTable (LISP$MachIns * lmi, LISP$TableType type);
+
+/* Make sure there are 'count' free nodes in the 'type' table -- it's *
+ * grown at once before a bulk allocation; false if it cannot grow    */
+bool LISP$M_reserveNodes (LISP$MachIns * lmi, LISP$TableType type,
+                          int count);
+
+/* Find a free node in the 'type' table, growing the table if it's full; *
+ * the node is still Free, -1 is returned if there's no memory           */
+int LISP$M_allocNode (LISP$MachIns * lmi, LISP$TableType type);
+
+/* Maximal depth of the root stack for the C stack of the thread */
+int LISP$M_getRootStackLimit (void);
+
+/* Hash of a number value, the number lookup table takes its low bits */
+unsigned int LISP$M_hashNumber (LISP$NumberRecord num);
+
+/* Hash of an atom name as it's stored -- truncated to fit the record */
+unsigned int LISP$M_hashAtomName (const char * name);
+
+/* Rebuild the lookup hash of the number or atom table over its non-free *
+ * nodes; it's resized to be at most half full                          */
+bool LISP$M_rehash (LISP$MachIns * lmi, LISP$TableType type);
 
 /* Allocate a new item in the list area */
 LISP$Ref LISP$M_createList (LISP$MachIns * lmi);
 
-/* Settle a new number record in the number table */
+/* Settle a new number record in the number table; 2 and 2.0 are *
+ * different records, both are equal to each other by =           */
+LISP$Ref LISP$M_getCreateNumberRecord (LISP$MachIns * lmi,
+                                       LISP$NumberRecord num);
 LISP$Ref LISP$M_getCreateNumber (LISP$MachIns * lmi, double num);
+LISP$Ref LISP$M_getCreateInteger (LISP$MachIns * lmi, int64_t num);
+
+/* Value of the number 'ref' as a double */
+double LISP$M_getNumber (LISP$MachIns * lmi, LISP$Ref ref);
+
+/* Get the number 'ref' as an integer to 'res'; integral doubles are *
+ * accepted too, false is returned if the number isn't an integer   *
+ * or if it doesn't fit into 64 bits                                 */
+bool LISP$M_getInteger (LISP$MachIns * lmi, LISP$Ref ref, int64_t * res);
+
+/* Settle an integer of any size -- the 'num' is taken over, it's kept *
+ * as a BigInteger object only if it doesn't fit into a number record  */
+LISP$Ref LISP$M_createBignum (LISP$MachIns * lmi, LISP$Bignum * num);
+
+/* Numbers are number records and BigInteger objects; exact ones are *
+ * the integers of both kinds                                         */
+bool LISP$M_isNumber (LISP$MachIns * lmi, LISP$Ref ref);
+bool LISP$M_isBignum (LISP$MachIns * lmi, LISP$Ref ref);
+bool LISP$M_isExact (LISP$MachIns * lmi, LISP$Ref ref);
+
+/* Exact number 'ref' as a bignum -- a 64-bit integer is wrapped into *
+ * the caller's 'buf' and 'limbs', so the result is never to be freed */
+LISP$Bignum * LISP$M_getBignum (LISP$MachIns * lmi, LISP$Ref ref,
+                                LISP$Bignum * buf, uint32_t * limbs);
+
+/* Compare numbers 'x' and 'y', at least one of them exact and none a *
+ * NaN -- returns -1, 0 or 1; a double is compared by its exact value  */
+int LISP$M_compareExact (LISP$MachIns * lmi, LISP$Ref x, LISP$Ref y);
+
+/* Settle a string of 'length' 'chars' (without the quotes) -- it's an *
+ * atom named by the quoted chars if it fits, a LongString otherwise    */
+LISP$Ref LISP$M_createString (LISP$MachIns * lmi, const char * chars,
+                              size_t length);
+
+/* Strings are the quoted atoms and LongString objects */
+bool LISP$M_isString (LISP$MachIns * lmi, LISP$Ref ref);
+
+/* Chars of the string 'ref' without the quotes and their 'length'; *
+ * they aren't terminated by '\0' if 'ref' is an atom               */
+const char * LISP$M_getString (LISP$MachIns * lmi, LISP$Ref ref,
+                               size_t * length);
+
+/* A malloc'd copy of the string 'ref' terminated by '\0' (e.g. a file *
+ * name for fopen); NULL is returned and the error is set if 'ref'     *
+ * isn't a string -- 'name' is the built-in it's reported for          */
+char * LISP$M_copyString (LISP$MachIns * lmi, LISP$Ref ref,
+                          const char * name);
+
+/* Allocate a new heap object of the 'type'; the caller fills its data */
+LISP$Ref LISP$M_createObject (LISP$MachIns * lmi, LISP$ObjectType type);
+
+/* Release the payload of an object found to be garbage */
+void LISP$M_freeObject (LISP$MachIns * lmi, int id);
+
+/* Give 'obj', a copy of an object record, a payload of its own; a stream *
+ * is copied closed. False is returned if there's no memory, the record   *
+ * is left without any payload then                                       */
+bool LISP$M_cloneObject (LISP$ObjectRecord * obj);
+
+/* Mark all the references held by an object */
+void LISP$M_markObject (LISP$MachIns * lmi, int id, LISP$MemState mark);
 
 /* Lookup for specified atom or create a new one */
 LISP$Ref LISP$M_getCreateAtom (LISP$MachIns * lmi, char * atomName);
@@ -266,6 +603,14 @@ bool LISP$M_checkMemNodeState (LISP$MachIns * lmi, LISP$Ref ref,
 /* Collect and free previously marked garbage */
 void LISP$M_collectGarbage (LISP$MachIns * lmi);
 
+/* Protect a reference being worked on by evaluator from GC; roots are *
+ * dropped by resetting 'rootTop' to the value saved before the push   */
+void LISP$M_pushRoot (LISP$MachIns * lmi, LISP$Ref ref);
+
+/* Collect garbage in the middle of evaluation if the storage is low;  *
+ * everything alive must be reachable from atoms or the root stack     */
+void LISP$M_safePoint (LISP$MachIns * lmi);
+
 /* Print dump of all memory storages */
 void LISP$M_printMemoryDump (LISP$MachIns * lmi, bool full);
 
@@ -280,6 +625,9 @@ LISP$Ref LISP$M_builtInArithmetic (LISP$MachIns * lmi, LISP$Ref args,
 LISP$Ref LISP$M_builtInIS (LISP$MachIns * lmi, LISP$Ref args);
 LISP$Ref LISP$M_builtInCOND (LISP$MachIns * lmi, LISP$Ref args,
                                int level);
+LISP$Ref LISP$M_builtInANDOR (LISP$MachIns * lmi, LISP$Ref args,
+                              int level, bool isAnd);
+LISP$Ref LISP$M_builtInNOT (LISP$MachIns * lmi, LISP$Ref args);
 LISP$Ref LISP$M_builtInLOAD (LISP$MachIns * lmi, LISP$Ref args,
                                int level);
 LISP$Ref LISP$M_builtInSHOWMEM (LISP$MachIns * lmi, LISP$Ref args,
@@ -292,6 +640,179 @@ LISP$Ref LISP$M_builtInISATOM (LISP$MachIns * lmi, LISP$Ref args);
 LISP$Ref LISP$M_builtInISLIST (LISP$MachIns * lmi, LISP$Ref args);
 LISP$Ref LISP$M_builtInLAMBDASPECIAL (LISP$MachIns * lmi, LISP$Ref args,
                                         bool isLambda);
+LISP$Ref LISP$M_builtInWHILE (LISP$MachIns * lmi, LISP$Ref args, int level);
+LISP$Ref LISP$M_builtInDOTIMES (LISP$MachIns * lmi, LISP$Ref args,
+                                int level);
+LISP$Ref LISP$M_builtInDO (LISP$MachIns * lmi, LISP$Ref args, int level);
+LISP$Ref LISP$M_builtInAPPEND (LISP$MachIns * lmi, LISP$Ref args, int argc);
+LISP$Ref LISP$M_builtInREVERSE (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInSORT (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             int level);
+LISP$Ref LISP$M_builtInMEMBER (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInLENGTH (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInNTH (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInASSOC (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInMAPCAR (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                               int level);
+
+LISP$Ref LISP$M_builtInEQUAL (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInMAKEHASH (LISP$MachIns * lmi, LISP$Ref args, int argc);
+LISP$Ref LISP$M_builtInGETHASH (LISP$MachIns * lmi, LISP$Ref args, int argc);
+LISP$Ref LISP$M_builtInPUTHASH (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInREMHASH (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInMAPHASH (LISP$MachIns * lmi, LISP$Ref args, int level);
+LISP$Ref LISP$M_builtInHASHCOUNT (LISP$MachIns * lmi, LISP$Ref args);
+
+LISP$Ref LISP$M_builtInMAKEVECTOR (LISP$MachIns * lmi, LISP$Ref args,
+                                   int argc);
+LISP$Ref LISP$M_builtInVREF (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInVSET (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInVLENGTH (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInLISTTOVECTOR (LISP$MachIns * lmi, LISP$Ref args,
+                                     int argc);
+LISP$Ref LISP$M_builtInVECTORTOLIST (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInVARITH (LISP$MachIns * lmi, LISP$Ref args,
+                               const char * oper);
+LISP$Ref LISP$M_builtInDOT (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInVREDUCE (LISP$MachIns * lmi, LISP$Ref args,
+                                const char * oper);
+
+LISP$Ref LISP$M_builtInMATH (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             const char * name);
+LISP$Ref LISP$M_builtInEXPT (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInROUND (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                              const char * name);
+LISP$Ref LISP$M_builtInMINMAX (LISP$MachIns * lmi, LISP$Ref args,
+                               const char * name);
+LISP$Ref LISP$M_builtInABS (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInWRITETOSTRING (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInWRITEBINARY (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInREADBINARY (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInOPEN (LISP$MachIns * lmi, LISP$Ref args, int argc);
+LISP$Ref LISP$M_builtInCLOSE (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInREAD (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             const char * name);
+LISP$Ref LISP$M_builtInWRITE (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                              const char * name);
+LISP$Ref LISP$M_builtInREADLINES (LISP$MachIns * lmi, LISP$Ref args,
+                                  const char * name);
+LISP$Ref LISP$M_builtInMAP (LISP$MachIns * lmi, LISP$Ref args, int level,
+                            const char * name);
+LISP$Ref LISP$M_builtInREDUCE (LISP$MachIns * lmi, LISP$Ref args, int level);
+LISP$Ref LISP$M_builtInPMAP (LISP$MachIns * lmi, LISP$Ref args, int level,
+                             const char * name);
+LISP$Ref LISP$M_builtInSPAWN (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInSELF (LISP$MachIns * lmi);
+LISP$Ref LISP$M_builtInSEND (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInRECEIVE (LISP$MachIns * lmi, LISP$Ref args, int argc);
+LISP$Ref LISP$M_builtInNEXT (LISP$MachIns * lmi, LISP$Ref args, int argc,
+                             int level);
+LISP$Ref LISP$M_builtInDELAY (LISP$MachIns * lmi, LISP$Ref args);
+LISP$Ref LISP$M_builtInFUTURE (LISP$MachIns * lmi, LISP$Ref args, int level);
+LISP$Ref LISP$M_builtInCONSSTREAM (LISP$MachIns * lmi, LISP$Ref args,
+                                   int level);
+LISP$Ref LISP$M_builtInFORCE (LISP$MachIns * lmi, LISP$Ref args, int level,
+                              const char * name);
+
+/* The open stream 'ref' for input, or for output if 'isOutput'; NULL is *
+ * returned and the error is set otherwise -- 'name' is the built-in     */
+LISP$Stream * LISP$M_getStream (LISP$MachIns * lmi, LISP$Ref ref,
+                                bool isOutput, const char * name);
+
+/* Open the file 'fileName' by fopen ()'s 'mode' as a stream object; *
+ * the name is taken over, it's freed even if it fails               */
+LISP$Ref LISP$M_createStream (LISP$MachIns * lmi, char * fileName,
+                              const char * mode);
+
+/* Read a line of 'r' into a string without the end of line, or return *
+ * 'eof' at the end of input                                           */
+LISP$Ref LISP$M_readLine (LISP$MachIns * lmi, LISP$Reader * r,
+                          LISP$Ref eof);
+
+/* Read a form, or a line if 'isLine', of 'r' -- the standard reader or *
+ * the one of a stream; LISP$M_NULLREF is returned at the end of input, *
+ * and the error is set just if something has failed                    */
+LISP$Ref LISP$M_readStream (LISP$MachIns * lmi, LISP$Reader * r,
+                            bool isLine);
+
+/* Flush and close a stream, it stays as a closed one; false is returned *
+ * if the buffered output couldn't be written                            */
+bool LISP$M_closeStream (LISP$Stream * s);
+
+/* The next item of 'cursor' -- a list, it's moved to its CDR then (a  *
+ * promise there is forced, so it's a stream of CONS-STREAM), or a      *
+ * sequence; LISP$M_NULLREF is returned at its end, and the error is    *
+ * set just if something has failed                                     */
+LISP$Ref LISP$M_nextItem (LISP$MachIns * lmi, LISP$Ref * cursor, int level);
+
+/* Make a promise of 'expr' -- it's evaluated by $M_force () later */
+LISP$Ref LISP$M_createPromise (LISP$MachIns * lmi, LISP$Ref expr);
+
+/* The value of a promise, it's evaluated just the first time (or      *
+ * waited for, if it's a future); anything else is its own value       */
+LISP$Ref LISP$M_force (LISP$MachIns * lmi, LISP$Ref ref, int level);
+
+/* The value of a future, waited for if it's not there yet; anything   *
+ * else (a DELAY's promise too) is returned as it is                   */
+LISP$Ref LISP$M_touch (LISP$MachIns * lmi, LISP$Ref ref);
+
+/* Structural equality -- lists are compared item by item, big integers *
+ * and long strings by value, anything else by reference since atoms    *
+ * and numbers are unique in their tables                               */
+bool LISP$M_isEqual (LISP$MachIns * lmi, LISP$Ref x, LISP$Ref y);
+
+/* Hash of a reference consistent with IS ('isEqual' false) or EQUAL */
+unsigned int LISP$M_hashRef (LISP$MachIns * lmi, LISP$Ref ref,
+                             bool isEqual, int depth);
+
+/* Hash table operations */
+LISP$HashTable * LISP$M_hashCreate (bool isEqual);
+LISP$HashTable * LISP$M_hashClone (const LISP$HashTable * h);
+void LISP$M_hashDestroy (LISP$HashTable * h);
+void LISP$M_hashRehashStep (LISP$HashTable * h, int n);
+LISP$HashEntry ** LISP$M_hashLookup (LISP$MachIns * lmi, LISP$HashTable * h,
+                                     LISP$Ref key, unsigned int hash);
+bool LISP$M_hashPut (LISP$MachIns * lmi, LISP$HashTable * h,
+                     LISP$Ref key, LISP$Ref value);
+bool LISP$M_hashRemove (LISP$MachIns * lmi, LISP$HashTable * h,
+                        LISP$Ref key);
+void LISP$M_hashPurge (LISP$HashTable * h);
+
+/* Create a vector object of 'length' items of the 'type' kind */
+LISP$Ref LISP$M_createVector (LISP$MachIns * lmi, LISP$ObjectType type,
+                              int length);
+
+/* Get vector from a built-in's argument or set an error */
+LISP$Vector * LISP$M_getVector (LISP$MachIns * lmi, LISP$Ref ref,
+                                const char * name);
+
+/* Get DOUBLE vector from a built-in's argument or set an error */
+LISP$Vector * LISP$M_getDoubleVector (LISP$MachIns * lmi, LISP$Ref ref,
+                                      const char * name);
+
+/* Get vector index from a built-in's argument; -1 and error if invalid */
+int LISP$M_getVectorIndex (LISP$MachIns * lmi, LISP$Vector * v,
+                           LISP$Ref ref, const char * name);
+
+/* Check that all the arguments of the 'name' built-in are numbers */
+bool LISP$M_checkNumberArgs (LISP$MachIns * lmi, LISP$Ref args,
+                             const char * name);
+
+/* Settle a rounded double as an exact integer of any size; Inf and NaN *
+ * are errors of the 'name' built-in                                    */
+LISP$Ref LISP$M_createIntegral (LISP$MachIns * lmi, double num,
+                                const char * name);
+
+/* Get hash table from a built-in's argument or set an error */
+LISP$HashTable * LISP$M_getHashTable (LISP$MachIns * lmi, LISP$Ref ref,
+                                      const char * name);
+
+/* Copy spine of list 'x' in front of 'y' -- a helper for APPEND */
+LISP$Ref LISP$M_listAppend (LISP$MachIns * lmi, LISP$Ref x, LISP$Ref y);
+
+/* SORT's ordering: 1 if 'x' goes before 'y', 0 if not, -1 on error */
+int LISP$M_sortLess (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref pair,
+                     LISP$Ref x, LISP$Ref y, int level);
 
 /* Stack operations on list -- useful for example for binding values */
 void LISP$M_listPush (LISP$MachIns * lmi, LISP$Ref* list, LISP$Ref item);
@@ -306,12 +827,17 @@ void LISP$M_unBind (LISP$MachIns * lmi, LISP$Ref atm);
  * S-Expression processing
  ******************************************************/
 
-/* fgetc wrapper with history feature similar to libreadline */
+/* Is the current input read by libreadline? Its state is global, so *
+ * just an interactive LMI reading stdin uses it                      */
+#define LISP$S_isReadLine(lmi) \
+  ((lmi)->mode == Interactive && (lmi)->inputStream == stdin)
+
+/* Next char of the current reader; lines typed in are taken from *
+ * libreadline by $S_makePrompt                                     */
 char LISP$S_getChar (LISP$MachIns * lmi);
 
-/* Append char 'c' into the 'token' buffer ans optionally upcase it */
-bool LISP$S_buildToken (LISP$MachIns * lmi, char ** token,
-                        int i, char c, bool isCaseSensitive);
+/* Remember where the first syntax error of an S-expr is */
+void LISP$S_setErrorPosition (LISP$MachIns * lmi);
 
 /* Check if the char 'c' is allowed to be part of atom's name */
 bool LISP$S_isValidAtomNameChar (char c, int i);
@@ -319,9 +845,19 @@ bool LISP$S_isValidAtomNameChar (char c, int i);
 /* Print a fine prompt */
 void LISP$S_makePrompt (LISP$MachIns * lmi, bool primary, bool is2ReadLine);
 
-/* Read token from an input stream and store it into the 'token' buffer; *
- * if the token is a number, set 'isNumeric' to 'true'                   */
-char LISP$S_getToken (LISP$MachIns * lmi, char ** token, bool * isNumeric);
+/* Read token from the current reader -- it's a span of the reader's  *
+ * buffer; if the token is a number, set 'isNumeric' to 'true'         */
+char LISP$S_getToken (LISP$MachIns * lmi, LISP$Span * token,
+                      bool * isNumeric);
+
+/* Settle a token as a number or an atom; atom names are upcased, %    *
+ * doubled, in the 'token' buffer of LMI -- strings keep their case    */
+LISP$Ref LISP$S_createToken (LISP$MachIns * lmi, const LISP$Span * token,
+                             bool isNumeric);
+
+/* Settle a numeric token -- it's an exact integer unless it has the *
+ * floating point or an exponent; integers over 64 bits are big ones  */
+LISP$Ref LISP$S_createNumber (LISP$MachIns * lmi, const LISP$Span * token);
 
 /* Helper function for evaluation process tracing */
 void LISP$S_trace (LISP$MachIns * lmi, LISP$Ref res, int level);
@@ -340,20 +876,38 @@ LISP$Ref LISP$S_eval (LISP$MachIns * lmi,
 LISP$Ref LISP$S_evalAction (LISP$MachIns * lmi, LISP$Ref read,
                               int level);
 
+/* Apply an action (built-in or user defined) on the argument list *
+ * prepared by $S_evalAction -- evaluated for functions, as they are *
+ * for special forms                                                 */
+LISP$Ref LISP$S_applyAction (LISP$MachIns * lmi, LISP$Ref action,
+                             LISP$Ref eargs, int eargc, int level);
+
+/* Apply function 'fun' on a list of already evaluated arguments */
+LISP$Ref LISP$S_apply (LISP$MachIns * lmi, LISP$Ref fun, LISP$Ref eargs,
+                       int level);
+
 /* Write evaluated result to the 'output' stream */
 void LISP$S_write (LISP$MachIns * lmi,
                    LISP$Ref evaluated);
 
-/* $S_write's internal action */
-void LISP$S_writeAction (LISP$MachIns * lmi, LISP$Ref evaluated,
-                         bool isTopLevel);
+/* $S_write's internal action -- print 'evaluated' by the writer 'w' */
+void LISP$S_writeAction (LISP$MachIns * lmi, LISP$Writer * w,
+                         LISP$Ref evaluated, bool isTopLevel);
 
 /* Get human readable string for $AtomType argument 'type' */
 char * LISP$S_getFormatAtomType (LISP$AtomType type);
 
-/* Load a script file and returns boolean success */
+/* Load a script file and returns boolean success; the forms of a  *
+ * regular file are cached in the file with LISP$D_CACHE_SUFFIX     *
+ * appended to its name, unless the LISP$CACHE option is disabled   */
 bool LISP$S_loadFile (LISP$MachIns * lmi, char * fileName);
 
+/* Evaluate all the forms of 'text', or of 'stream' (it's mapped if it's *
+ * a regular file), as a script -- not cached; false is returned if any *
+ * of them has failed                                                    */
+bool LISP$S_loadText (LISP$MachIns * lmi, const char * text, size_t length);
+bool LISP$S_loadStream (LISP$MachIns * lmi, FILE * stream);
+
 #endif
 
 // vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
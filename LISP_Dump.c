@@ -0,0 +1,890 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Dump -- Binary dump of S-expressions
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef _VMS_
+#include <stdatomic.h>
+#endif
+
+#include "LISP_Dump.h"
+
+/* Initial size of the list of items read */
+#define LISP$D_INDEX_SIZE   1024
+
+/* Caches written by this process so far -- makes their temporary names */
+#ifdef _VMS_
+static unsigned long LISP$D_cacheSerial = 0;    /* No threads there     */
+#define atomic_fetch_add(n, k)  ((*(n) += (k)) - (k))
+#else
+static atomic_ulong LISP$D_cacheSerial = 0;
+#endif
+
+/* State of $D_write () */
+typedef struct {
+  LISP$MachIns * lmi;
+  const char *   name;        /* Built-in writing, for the messages    */
+  LISP$Writer    w;
+  int *          ids [4];     /* Index+1 of each node written, or 0    */
+  int            lengths [4]; /* ... allocated for the tables          */
+  int            base;        /* Items of the forms before this one    */
+  int            count;       /* Items written so far                  */
+  uint32_t       nodes [4];   /* ... of them per table                 */
+  bool           isFailed;
+} LISP$D_Output;
+
+/* State of $D_read () */
+typedef struct {
+  LISP$MachIns *        lmi;
+  const char *          name;       /* Built-in reading, for messages  */
+  const char *          fileName;
+  const unsigned char * p;    /* Next byte                             */
+  const unsigned char * end;
+  LISP$Ref *            items;      /* Items read so far               */
+  int                   count;
+  int                   size;
+  bool                  isFailed;
+} LISP$D_Input;
+
+struct LISP$D_Cache {
+  LISP$MachIns * lmi;
+  char *         name;
+  char *         tmpName;     /* Written under this name, or read      */
+  FILE *         stream;
+  LISP$Reader    r;
+  LISP$D_Input   in;
+  LISP$D_Output  out;
+};
+
+
+/******************************************************
+ * Output
+ ******************************************************/
+
+static void LISP$D_putVarint (LISP$Writer * w, uint64_t n) {
+
+  char buf [10];
+  int  i = 0;
+
+  while (n >= 0x80) { buf [i++] = (char) (n | 0x80); n >>= 7; }
+  buf [i++] = (char) n;
+
+  LISP$W_putString (w, buf, i);
+}
+
+static void LISP$D_putDouble (LISP$Writer * w, double num) {
+
+  char     buf [8];
+  uint64_t bits;
+  int      i;
+
+  memcpy (&bits, &num, sizeof (bits));
+  for (i = 0; i < 8; i++, bits >>= 8) buf [i] = (char) bits;
+
+  LISP$W_putString (w, buf, 8);
+}
+
+/* Index of 'ref' if it's been written already (in this form of a  *
+ * cache); otherwise it's given the next index and -1 is returned --  *
+ * nothing is allocated while writing, so the nodes are indexed right *
+ * by their ids                                                       */
+static int LISP$D_lookup (LISP$D_Output * out, LISP$Ref ref) {
+
+  int * id = &(out->ids [LISP$M_getRefType (ref)][LISP$M_getRefId (ref)]);
+
+  if (*id > out->base) return (*id - 1 - out->base);
+
+  *id = ++(out->count);
+  out->nodes [LISP$M_getRefType (ref)]++;
+  return -1;
+}
+
+/* Grow the index for the tables as they are now */
+static bool LISP$D_fitIndex (LISP$D_Output * out) {
+
+  int   lengths [4];
+  int * tmp;
+  int   i;
+
+  lengths [ListTab]   = (out->lmi)->lstLen;
+  lengths [AtomTab]   = (out->lmi)->atmLen;
+  lengths [NumberTab] = (out->lmi)->numLen;
+  lengths [ObjectTab] = (out->lmi)->objLen;
+
+  for (i = 0; i < 4; i++) {
+    if (lengths [i] <= out->lengths [i]) continue;
+
+    tmp = (int *) realloc (out->ids [i], lengths [i] * sizeof (int));
+    if (tmp == NULL) return false;
+
+    memset (tmp + out->lengths [i], 0,
+            (lengths [i] - out->lengths [i]) * sizeof (int));
+    out->ids [i]     = tmp;
+    out->lengths [i] = lengths [i];
+  }
+
+  return true;
+}
+
+static void LISP$D_writeItem (LISP$D_Output * out, LISP$Ref ref) {
+
+  LISP$MachIns *      lmi = out->lmi;
+  LISP$Writer *       w   = &(out->w);
+  LISP$NumberRecord * num;
+  LISP$ObjectRecord * obj;
+  LISP$Ref            node, tail;
+  const char *        name;
+  uint32_t            limb;
+  char                buf [4];
+  size_t              length;
+  int                 i, j, n;
+
+  if (out->isFailed) return;
+
+  if (ref == lmi->NIL) {
+    LISP$W_putChar (w, LISP$D_TAG_NIL);
+    return;
+  }
+
+  if ((i = LISP$D_lookup (out, ref)) >= 0) {
+    LISP$W_putChar (w, LISP$D_TAG_REF);
+    LISP$D_putVarint (w, i);
+    return;
+  }
+
+  switch (LISP$M_getRefType (ref)) {
+    /* The nodes of the list are indexed at once, up to the first one *
+     * written already, then their CARs go -- iteratively, so a long  *
+     * list doesn't take any stack                                    */
+    case ListTab:
+      for (n = 1, tail = (lmi->lstTab [LISP$M_getRefId (ref)]).cdr;
+           LISP$M_getRefType (tail) == ListTab &&
+           LISP$D_lookup (out, tail) < 0; n++)
+        tail = (lmi->lstTab [LISP$M_getRefId (tail)]).cdr;
+
+      LISP$W_putChar (w, LISP$D_TAG_LIST);
+      LISP$D_putVarint (w, n);
+
+      for (i = 0, node = ref; i < n; i++) {
+        LISP$D_writeItem (out, (lmi->lstTab [LISP$M_getRefId (node)]).car);
+        node = (lmi->lstTab [LISP$M_getRefId (node)]).cdr;
+      }
+      LISP$D_writeItem (out, tail);
+      return;
+
+    case AtomTab:
+      name   = (lmi->atmTab [LISP$M_getRefId (ref)]).name;
+      length = strlen (name);
+      if (name [0] == '"') {
+        LISP$W_putChar (w, LISP$D_TAG_STRING);
+        LISP$D_putVarint (w, length - 2);
+        LISP$W_putString (w, name + 1, length - 2);
+      }
+      else {
+        LISP$W_putChar (w, LISP$D_TAG_SYMBOL);
+        LISP$D_putVarint (w, length);
+        LISP$W_putString (w, name, length);
+      }
+      return;
+
+    case NumberTab:
+      num = &(lmi->numTab [LISP$M_getRefId (ref)]);
+      if (num->isInt) {
+        LISP$W_putChar (w, LISP$D_TAG_INTEGER);
+        LISP$D_putVarint (w, ((uint64_t) num->val.i << 1) ^
+                             (uint64_t) (num->val.i >> 63));
+      }
+      else {
+        LISP$W_putChar (w, LISP$D_TAG_DOUBLE);
+        LISP$D_putDouble (w, num->val.d);
+      }
+      return;
+
+    case ObjectTab:
+      obj = &(lmi->objTab [LISP$M_getRefId (ref)]);
+      switch (obj->type) {
+        case LongString:
+          LISP$W_putChar (w, LISP$D_TAG_STRING);
+          LISP$D_putVarint (w, (obj->data.string)->length);
+          LISP$W_putString (w, (obj->data.string)->chars,
+                            (obj->data.string)->length);
+          return;
+
+        case BigInteger:
+          LISP$W_putChar (w, LISP$D_TAG_BIGNUM);
+          LISP$W_putChar (w, (obj->data.bignum)->negative);
+          LISP$D_putVarint (w, (obj->data.bignum)->length);
+          for (i = 0; i < (obj->data.bignum)->length; i++) {
+            limb = (obj->data.bignum)->limbs [i];
+            for (j = 0; j < 4; j++, limb >>= 8) buf [j] = (char) limb;
+            LISP$W_putString (w, buf, 4);
+          }
+          return;
+
+        case RefVector:
+          LISP$W_putChar (w, LISP$D_TAG_VECTOR);
+          LISP$D_putVarint (w, (obj->data.vector)->length);
+          for (i = 0; i < (obj->data.vector)->length; i++)
+            LISP$D_writeItem (out, (obj->data.vector)->items.refs [i]);
+          return;
+
+        case DoubleVector:
+          LISP$W_putChar (w, LISP$D_TAG_DVECTOR);
+          LISP$D_putVarint (w, (obj->data.vector)->length);
+          for (i = 0; i < (obj->data.vector)->length; i++)
+            LISP$D_putDouble (w, (obj->data.vector)->items.nums [i]);
+          return;
+
+        case HashTable:
+          LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+              "%s can't write hash tables!", out->name);
+          out->isFailed = true;
+          return;
+
+        case Stream:
+        case Sequence:
+        case Promise:
+          LISP$M_setError (lmi, LISP$_ERR$S_IVARGS, "IVARGS",
+              "%s can't write streams, sequences nor promises!", out->name);
+          out->isFailed = true;
+          return;
+      }
+  }
+}
+
+/* Write the 'header' (blank yet) and 'ref' into 'stream', and make the *
+ * 'header' to be written over the blank one then; false is returned and *
+ * the error is set if it fails -- the stream is left open              */
+static bool LISP$D_writeStream (LISP$MachIns * lmi, LISP$Ref ref,
+                                FILE * stream, const char * name,
+                                unsigned char * header) {
+
+  LISP$D_Output * out;
+  bool            res;
+  int             i, j;
+
+  /* The writer holds a whole block, so it's not put on the stack */
+  out = (LISP$D_Output *) calloc (1, sizeof (LISP$D_Output));
+  if (out != NULL) { out->lmi = lmi; out->name = name; }
+  if (out == NULL || !LISP$D_fitIndex (out)) {
+    if (out != NULL)
+      for (i = 0; i < 4; i++) free (out->ids [i]);
+    free (out);
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", name);
+    return false;
+  }
+
+  /* The counts are known at the end, they're filled in then */
+  memset (header, 0, LISP$D_HEADER_SIZE);
+  LISP$W_openStream (&(out->w), stream);
+  LISP$W_putString (&(out->w), (char *) header, LISP$D_HEADER_SIZE);
+  LISP$D_writeItem (out, ref);
+  res = (LISP$W_close (&(out->w)) && !out->isFailed);
+
+  if (res) {
+    memcpy (header, LISP$D_MAGIC, LISP$D_MAGIC_SIZE);
+    for (i = 0; i < 4; i++)
+      for (j = 0; j < 4; j++)
+        header [LISP$D_MAGIC_SIZE + 4 * i + j] =
+          (unsigned char) (out->nodes [i] >> (8 * j));
+  }
+  else if (!out->isFailed)
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", name);
+
+  for (i = 0; i < 4; i++) free (out->ids [i]);
+  free (out);
+  return res;
+}
+
+bool LISP$D_write (LISP$MachIns * lmi, LISP$Ref ref, const char * fileName) {
+
+  FILE *          stream;
+  unsigned char   header [LISP$D_HEADER_SIZE];
+  bool            res;
+
+  if ((stream = fopen (fileName, "wb")) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_NAOFIL, "NAOFIL",
+        "unable to open file %s", fileName);
+    return false;
+  }
+
+  res = LISP$D_writeStream (lmi, ref, stream, "WRITE-BINARY", header);
+  if (res)
+    res = (!fseek (stream, 0, SEEK_SET) &&
+           fwrite (header, 1, sizeof (header), stream) == sizeof (header));
+  res = (!fclose (stream) && res);
+
+  if (!res && !LISP$M_isError (lmi))
+    LISP$M_setError (lmi, LISP$_ERR$S_NAOFIL, "NAOFIL",
+        "unable to write file %s", fileName);
+
+  return res;
+}
+
+char * LISP$D_pack (LISP$MachIns * lmi, LISP$Ref ref, size_t * length,
+                    const char * name) {
+
+  FILE *        stream;
+  char *        data = NULL;
+  unsigned char header [LISP$D_HEADER_SIZE];
+  bool          res;
+
+  if ((stream = open_memstream (&data, length)) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", name);
+    return NULL;
+  }
+
+  /* The header is put right into the buffer, it's complete once closed */
+  res = LISP$D_writeStream (lmi, ref, stream, name, header);
+  res = (!fclose (stream) && res && *length >= sizeof (header));
+  if (!res) {
+    if (!LISP$M_isError (lmi))
+      LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+          "No memory for %s!", name);
+    free (data);
+    return NULL;
+  }
+
+  memcpy (data, header, sizeof (header));
+  return data;
+}
+
+
+/******************************************************
+ * Input
+ ******************************************************/
+
+static void LISP$D_setDamaged (LISP$D_Input * in) {
+
+  if (!in->isFailed && !LISP$M_isError (in->lmi))
+    LISP$M_setError (in->lmi, LISP$_ERR$S_BADDAT, "BADDAT",
+        (in->fileName != NULL)? "Damaged binary file %s!" :
+                                "Damaged data for %s!",
+        (in->fileName != NULL)? in->fileName : in->name);
+  in->isFailed = true;
+}
+
+/* Are there 'n' items of 'size' bytes left? */
+static bool LISP$D_hasBytes (LISP$D_Input * in, uint64_t n, size_t size) {
+
+  if (n <= (uint64_t) (in->end - in->p) / size) return true;
+
+  LISP$D_setDamaged (in);
+  return false;
+}
+
+static uint64_t LISP$D_getVarint (LISP$D_Input * in) {
+
+  uint64_t n = 0;
+  int      shift;
+
+  for (shift = 0; in->p < in->end && shift < 64; shift += 7) {
+    n |= (uint64_t) (*(in->p) & 0x7F) << shift;
+    if (!(*(in->p++) & 0x80)) return n;
+  }
+
+  LISP$D_setDamaged (in);
+  return 0;
+}
+
+static double LISP$D_getDouble (LISP$D_Input * in) {
+
+  uint64_t bits = 0;
+  double   num;
+  int      i;
+
+  for (i = 0; i < 8; i++) bits |= (uint64_t) *(in->p++) << (8 * i);
+  memcpy (&num, &bits, sizeof (num));
+
+  return num;
+}
+
+/* Remember the item just read under the next index */
+static void LISP$D_addItem (LISP$D_Input * in, LISP$Ref ref) {
+
+  LISP$Ref * tmp;
+
+  if (in->count == in->size) {
+    tmp = (LISP$Ref *) realloc (in->items, 2 * in->size * sizeof (LISP$Ref));
+    if (tmp == NULL) {
+      LISP$M_setError (in->lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+          "No memory for %s!", in->name);
+      in->isFailed = true;
+      return;
+    }
+    in->items = tmp;
+    in->size *= 2;
+  }
+
+  in->items [in->count++] = ref;
+}
+
+static LISP$Ref LISP$D_readItem (LISP$D_Input * in) {
+
+  LISP$MachIns * lmi = in->lmi;
+  LISP$Ref       res = LISP$M_NULLREF, item;
+  LISP$Vector *  v;
+  uint32_t *     limbs;
+  uint64_t       n, u;
+  char           name [LISP$MACH_ATMNAMELEN];
+  bool           negative;
+  int            base, i, j;
+
+  if (in->isFailed || !LISP$D_hasBytes (in, 1, 1)) return (LISP$M_NULLREF);
+
+  switch (*(in->p++)) {
+    case LISP$D_TAG_NIL:
+      return (lmi->NIL);
+
+    case LISP$D_TAG_REF:
+      n = LISP$D_getVarint (in);
+      if (n >= (uint64_t) in->count) {
+        LISP$D_setDamaged (in);
+        return (LISP$M_NULLREF);
+      }
+      return (in->items [n]);
+
+    /* All the nodes are allocated at once and chained, then their CARs *
+     * are read -- the list table may move meanwhile, so the nodes are  *
+     * always found by their references                                 */
+    case LISP$D_TAG_LIST:
+      n = LISP$D_getVarint (in);
+      if (!n || !LISP$D_hasBytes (in, n, 1)) {
+        LISP$D_setDamaged (in);
+        return (LISP$M_NULLREF);
+      }
+
+      LISP$M_reserveNodes (lmi, ListTab, (int) n);
+      for (base = in->count, i = 0; (uint64_t) i < n; i++) {
+        if ((item = LISP$M_createList (lmi)) == LISP$M_NULLREF) {
+          in->isFailed = true;
+          return (LISP$M_NULLREF);
+        }
+        if (i)
+          (lmi->lstTab [LISP$M_getRefId (in->items [in->count - 1])]).cdr =
+            item;
+        LISP$D_addItem (in, item);
+        if (in->isFailed) return (LISP$M_NULLREF);
+      }
+
+      for (i = 0; (uint64_t) i < n; i++) {
+        if ((item = LISP$D_readItem (in)) == LISP$M_NULLREF)
+          return (LISP$M_NULLREF);
+        (lmi->lstTab [LISP$M_getRefId (in->items [base + i])]).car = item;
+      }
+
+      if ((item = LISP$D_readItem (in)) == LISP$M_NULLREF)
+        return (LISP$M_NULLREF);
+      (lmi->lstTab [LISP$M_getRefId (in->items [base + n - 1])]).cdr = item;
+
+      return (in->items [base]);
+
+    /* Names are truncated as if they were read */
+    case LISP$D_TAG_SYMBOL:
+      n = LISP$D_getVarint (in);
+      if (!LISP$D_hasBytes (in, n, 1)) return (LISP$M_NULLREF);
+      i = (n < sizeof (name))? (int) n : (int) sizeof (name) - 1;
+      memcpy (name, in->p, i);
+      name [i] = LISP$S_EOS;
+      in->p += n;
+      res = LISP$M_getCreateAtom (lmi, name);
+      break;
+
+    case LISP$D_TAG_STRING:
+      n = LISP$D_getVarint (in);
+      if (!LISP$D_hasBytes (in, n, 1)) return (LISP$M_NULLREF);
+      res = LISP$M_createString (lmi, (const char *) in->p, n);
+      in->p += n;
+      break;
+
+    case LISP$D_TAG_INTEGER:
+      u = LISP$D_getVarint (in);
+      res = LISP$M_getCreateInteger (lmi, (int64_t) (u >> 1) ^
+                                          -(int64_t) (u & 1));
+      break;
+
+    case LISP$D_TAG_DOUBLE:
+      if (!LISP$D_hasBytes (in, 1, 8)) return (LISP$M_NULLREF);
+      res = LISP$M_getCreateNumber (lmi, LISP$D_getDouble (in));
+      break;
+
+    case LISP$D_TAG_BIGNUM:
+      if (!LISP$D_hasBytes (in, 1, 1)) return (LISP$M_NULLREF);
+      negative = (*(in->p++) != 0);
+      n = LISP$D_getVarint (in);
+      if (!LISP$D_hasBytes (in, n, 4)) return (LISP$M_NULLREF);
+
+      limbs = (uint32_t *) malloc ((n + 1) * sizeof (uint32_t));
+      if (limbs == NULL) {
+        res = LISP$M_createBignum (lmi, NULL);
+        break;
+      }
+      for (i = 0; (uint64_t) i < n; i++)
+        for (limbs [i] = 0, j = 0; j < 4; j++)
+          limbs [i] |= (uint32_t) *(in->p++) << (8 * j);
+
+      res = LISP$M_createBignum (lmi, LISP$B_fromLimbs (negative, limbs, n));
+      free (limbs);
+      break;
+
+    /* A vector is remembered before its items, they may refer to it */
+    case LISP$D_TAG_VECTOR:
+      n = LISP$D_getVarint (in);
+      if (!LISP$D_hasBytes (in, n, 1)) return (LISP$M_NULLREF);
+      if ((res = LISP$M_createVector (lmi, RefVector, (int) n)) ==
+          LISP$M_NULLREF) break;
+
+      v = (lmi->objTab [LISP$M_getRefId (res)]).data.vector;
+      for (i = 0; i < v->length; i++) v->items.refs [i] = lmi->NIL;
+      LISP$D_addItem (in, res);
+
+      for (i = 0; (uint64_t) i < n; i++) {
+        if ((item = LISP$D_readItem (in)) == LISP$M_NULLREF)
+          return (LISP$M_NULLREF);
+        v->items.refs [i] = item;
+      }
+      return res;
+
+    case LISP$D_TAG_DVECTOR:
+      n = LISP$D_getVarint (in);
+      if (!LISP$D_hasBytes (in, n, 8)) return (LISP$M_NULLREF);
+      if ((res = LISP$M_createVector (lmi, DoubleVector, (int) n)) ==
+          LISP$M_NULLREF) break;
+
+      v = (lmi->objTab [LISP$M_getRefId (res)]).data.vector;
+      for (i = 0; (uint64_t) i < n; i++)
+        v->items.nums [i] = LISP$D_getDouble (in);
+      break;
+
+    default:
+      LISP$D_setDamaged (in);
+      return (LISP$M_NULLREF);
+  }
+
+  if (res == LISP$M_NULLREF) in->isFailed = true;
+  else LISP$D_addItem (in, res);
+
+  return res;
+}
+
+/* Read an object out of the 'length' bytes at 'data' */
+static LISP$Ref LISP$D_readBuffer (LISP$MachIns * lmi, const char * data,
+                                   size_t length, const char * name,
+                                   const char * fileName) {
+
+  LISP$D_Input  in;
+  LISP$Ref      res;
+  uint32_t      count;
+  int           i, j;
+
+  memset (&in, 0, sizeof (in));
+  in.lmi      = lmi;
+  in.name     = name;
+  in.fileName = fileName;
+  in.p        = (const unsigned char *) data;
+  in.end      = in.p + length;
+  in.size     = LISP$D_INDEX_SIZE;
+  in.items    = (LISP$Ref *) malloc (in.size * sizeof (LISP$Ref));
+
+  if (in.items == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+        "No memory for %s!", name);
+    in.isFailed = true;
+  }
+  else if (length < LISP$D_HEADER_SIZE ||
+           memcmp (data, LISP$D_MAGIC, LISP$D_MAGIC_SIZE))
+    LISP$D_setDamaged (&in);
+
+  /* Grow the tables for everything at once -- a damaged count can't *
+   * make them grow more than the file size allows                   */
+  else {
+    for (i = 0; i < 4; i++) {
+      for (count = 0, j = 0; j < 4; j++)
+        count |= (uint32_t) in.p [LISP$D_MAGIC_SIZE + 4 * i + j] << (8 * j);
+      if (count <= length && count <= LISP$MACH_TABMAXLEN)
+        LISP$M_reserveNodes (lmi, (LISP$TableType) i, (int) count);
+    }
+    in.p += LISP$D_HEADER_SIZE;
+  }
+
+  res = LISP$D_readItem (&in);
+  if (!in.isFailed && in.p != in.end) LISP$D_setDamaged (&in);
+
+  free (in.items);
+  return (in.isFailed? LISP$M_NULLREF : res);
+}
+
+LISP$Ref LISP$D_read (LISP$MachIns * lmi, const char * fileName) {
+
+  LISP$Reader   r;
+  FILE *        stream;
+  LISP$Ref      res;
+  char          block [LISP$R_BLOCK_SIZE / 8];
+  size_t        got;
+
+  if ((stream = fopen (fileName, "rb")) == NULL) {
+    LISP$M_setError (lmi, LISP$_ERR$S_NAOFIL, "NAOFIL",
+        "unable to open file %s", fileName);
+    return (LISP$M_NULLREF);
+  }
+
+  /* A regular file is mapped, anything else is read into a buffer */
+  if (!LISP$R_openMapped (&r, stream)) {
+    LISP$R_openText (&r, NULL, 0);
+    while ((got = fread (block, 1, sizeof (block), stream)) > 0)
+      if (!LISP$R_append (&r, block, got)) {
+        LISP$R_close (&r);
+        fclose (stream);
+        LISP$M_setError (lmi, LISP$_ERR$S_OBJFUL, "OBJFUL",
+            "No memory for READ-BINARY!");
+        return (LISP$M_NULLREF);
+      }
+  }
+
+  res = LISP$D_readBuffer (lmi, r.buffer, r.length, "READ-BINARY", fileName);
+
+  LISP$R_close (&r);
+  fclose (stream);
+
+  return res;
+}
+
+LISP$Ref LISP$D_unpack (LISP$MachIns * lmi, const char * data, size_t length,
+                        const char * name) {
+
+  return (LISP$D_readBuffer (lmi, data, length, name, NULL));
+}
+
+
+
+/******************************************************
+ * Caches of LOADed files
+ ******************************************************/
+
+static void LISP$D_putWord (unsigned char * buf, uint64_t n) {
+
+  int i;
+
+  for (i = 0; i < 8; i++, n >>= 8) buf [i] = (unsigned char) n;
+}
+
+static uint64_t LISP$D_getWord (const unsigned char * buf) {
+
+  uint64_t n = 0;
+  int      i;
+
+  for (i = 0; i < 8; i++) n |= (uint64_t) buf [i] << (8 * i);
+  return n;
+}
+
+/* The mtime stored for 'stamp' -- a source changed just a while ago *
+ * may change again within its mtime granularity, so its cache gets  *
+ * no mtime and it's checked by the hash until the source is older   */
+static uint64_t LISP$D_getStoredMtime (const LISP$D_Stamp * stamp) {
+
+  if ((int64_t) time (NULL) - stamp->mtime / 1000000000 < 2)
+    return ((uint64_t) -1);
+
+  return ((uint64_t) stamp->mtime);
+}
+
+uint64_t LISP$D_hashText (const char * text, size_t length) {
+
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ length, k;
+  size_t   i;
+
+  /* Eight chars at a time, it's done on each LOAD of a touched file */
+  for (i = 0; i + 8 <= length; i += 8) {
+    memcpy (&k, text + i, 8);
+    h = (h ^ k) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 32;
+  }
+
+  k = 0;
+  memcpy (&k, text + i, length - i);
+  h = (h ^ k) * 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 29;
+
+  return h;
+}
+
+LISP$D_Cache * LISP$D_openCache (LISP$MachIns * lmi, const char * cacheName,
+                                 const LISP$D_Stamp * stamp,
+                                 const char * text) {
+
+  LISP$D_Cache *        c;
+  const unsigned char * header;
+  unsigned char         mtime [8];
+  FILE *                stream;
+  bool                  isValid;
+
+  c = (LISP$D_Cache *) calloc (1, sizeof (LISP$D_Cache));
+  if (c == NULL) return NULL;
+
+  /* Only a regular file is expected here, so it's mapped or nothing */
+  if ((c->stream = fopen (cacheName, "rb")) == NULL ||
+      !LISP$R_openMapped (&(c->r), c->stream)) {
+    if (c->stream != NULL) fclose (c->stream);
+    free (c);
+    return NULL;
+  }
+
+  header  = (const unsigned char *) (c->r).buffer;
+  isValid = ((c->r).length >= LISP$D_CACHE_HEADER_SIZE &&
+             !memcmp (header, LISP$D_CACHE_MAGIC, LISP$D_MAGIC_SIZE) &&
+             LISP$D_getWord (header + LISP$D_MAGIC_SIZE + 24) ==
+               (c->r).length - LISP$D_CACHE_HEADER_SIZE &&
+             LISP$D_getWord (header + LISP$D_MAGIC_SIZE + 8) == stamp->size);
+
+  /* The same size but another mtime is checked by the hash -- the *
+   * source may have been just touched or copied; if it's the same, *
+   * the new mtime is stored, so that it's not hashed next time     */
+  if (isValid &&
+      LISP$D_getWord (header + LISP$D_MAGIC_SIZE) != (uint64_t) stamp->mtime) {
+    isValid = (LISP$D_getWord (header + LISP$D_MAGIC_SIZE + 16) ==
+               LISP$D_hashText (text, stamp->size));
+
+    if (isValid && (stream = fopen (cacheName, "r+b")) != NULL) {
+      LISP$D_putWord (mtime, LISP$D_getStoredMtime (stamp));
+      if (!fseek (stream, LISP$D_MAGIC_SIZE, SEEK_SET))
+        fwrite (mtime, 1, sizeof (mtime), stream);
+      fclose (stream);
+    }
+  }
+
+  (c->in).size  = LISP$D_INDEX_SIZE;
+  (c->in).items = (LISP$Ref *) malloc ((c->in).size * sizeof (LISP$Ref));
+
+  if (!isValid || (c->in).items == NULL) {
+    free ((c->in).items);
+    LISP$R_close (&(c->r));
+    fclose (c->stream);
+    free (c);
+    return NULL;
+  }
+
+  c->lmi = lmi;
+  (c->in).lmi      = lmi;
+  (c->in).name     = "LOAD";
+  (c->in).fileName = cacheName;
+  (c->in).p        = header + LISP$D_CACHE_HEADER_SIZE;
+  (c->in).end      = header + (c->r).length;
+  return c;
+}
+
+LISP$Ref LISP$D_readForm (LISP$D_Cache * c) {
+
+  LISP$Ref res;
+
+  if ((c->in).isFailed || (c->in).p == (c->in).end)
+    return (LISP$M_NULLREF);
+
+  /* Items of the forms before are collected already */
+  (c->in).count = 0;
+  res = LISP$D_readItem (&(c->in));
+
+  return ((c->in).isFailed? LISP$M_NULLREF : res);
+}
+
+LISP$D_Cache * LISP$D_createCache (LISP$MachIns * lmi, const char * cacheName,
+                                   const LISP$D_Stamp * stamp) {
+
+  LISP$D_Cache * c;
+  unsigned char  header [LISP$D_CACHE_HEADER_SIZE];
+
+  c = (LISP$D_Cache *) calloc (1, sizeof (LISP$D_Cache));
+  if (c != NULL) {
+    c->name    = (char *) malloc (strlen (cacheName) + 1);
+    c->tmpName = (char *) malloc (strlen (cacheName) + 32);
+  }
+  if (c == NULL || c->name == NULL || c->tmpName == NULL) {
+    if (c != NULL) { free (c->name); free (c->tmpName); }
+    free (c);
+    return NULL;
+  }
+
+  /* LMIs of one process may write the same cache at once */
+  strcpy (c->name, cacheName);
+  sprintf (c->tmpName, "%s-%ld-%lu", cacheName, (long) getpid (),
+           atomic_fetch_add (&LISP$D_cacheSerial, 1));
+
+  if ((c->stream = fopen (c->tmpName, "wb")) == NULL) {
+    free (c->name); free (c->tmpName); free (c);
+    return NULL;
+  }
+
+  /* The length of the forms is known at the end, it's filled in then */
+  memcpy (header, LISP$D_CACHE_MAGIC, LISP$D_MAGIC_SIZE);
+  LISP$D_putWord (header + LISP$D_MAGIC_SIZE, LISP$D_getStoredMtime (stamp));
+  LISP$D_putWord (header + LISP$D_MAGIC_SIZE + 8, stamp->size);
+  LISP$D_putWord (header + LISP$D_MAGIC_SIZE + 16, stamp->hash);
+  LISP$D_putWord (header + LISP$D_MAGIC_SIZE + 24, 0);
+
+  c->lmi = lmi;
+  (c->out).lmi  = lmi;
+  (c->out).name = "LOAD";
+  LISP$W_openStream (&((c->out).w), c->stream);
+  LISP$W_putString (&((c->out).w), (char *) header, sizeof (header));
+
+  return c;
+}
+
+void LISP$D_writeForm (LISP$D_Cache * c, LISP$Ref form) {
+
+  if ((c->out).isFailed) return;
+
+  /* The tables may have grown since the last form */
+  if (!LISP$D_fitIndex (&(c->out))) {
+    (c->out).isFailed = true;
+    return;
+  }
+
+  (c->out).base = (c->out).count;
+  LISP$D_writeItem (&(c->out), form);
+}
+
+void LISP$D_closeCache (LISP$D_Cache * c, bool isComplete) {
+
+  unsigned char length [8];
+  long          size;
+  int           i;
+
+  if (c == NULL) return;
+
+  /* A cache read */
+  if (c->tmpName == NULL) {
+    free ((c->in).items);
+    LISP$R_close (&(c->r));
+    fclose (c->stream);
+    free (c);
+    return;
+  }
+
+  isComplete = (LISP$W_close (&((c->out).w)) && !(c->out).isFailed &&
+                isComplete && (size = ftell (c->stream)) >= 0);
+  if (isComplete) {
+    LISP$D_putWord (length, (uint64_t) size - LISP$D_CACHE_HEADER_SIZE);
+    isComplete = (!fseek (c->stream, LISP$D_MAGIC_SIZE + 24, SEEK_SET) &&
+                  fwrite (length, 1, sizeof (length), c->stream) ==
+                  sizeof (length));
+  }
+  isComplete = (!fclose (c->stream) && isComplete &&
+                !rename (c->tmpName, c->name));
+
+  if (!isComplete) remove (c->tmpName);
+
+  for (i = 0; i < 4; i++) free ((c->out).ids [i]);
+  free (c->name); free (c->tmpName); free (c);
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
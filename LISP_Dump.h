@@ -0,0 +1,115 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Dump -- Binary dump of S-expressions
+ */
+
+#ifndef _LISP_DUMP_H_
+#define _LISP_DUMP_H_
+
+#include "LISP_Core.h"
+
+/* The file begins by the magic and by four 32-bit little-endian counts *
+ * of the nodes written into each table ({ ListTab, AtomTab, NumberTab, *
+ * ObjectTab }); the object follows, each item as a tag byte:           *
+ *   NIL                                                                *
+ *   LIST n      n list nodes, their n CARs and the CDR of the last one *
+ *   SYMBOL n    n chars of the atom name as it's stored (upcased)      *
+ *   STRING n    n chars without the quotes                             *
+ *   INTEGER i   zigzag-encoded 64-bit integer                          *
+ *   DOUBLE      8 bytes of the IEEE double, little-endian              *
+ *   BIGNUM s n  sign byte and n 32-bit limbs, the least significant    *
+ *               first                                                  *
+ *   VECTOR n    n items                                                *
+ *   DVECTOR n   n doubles                                              *
+ *   REF i       the i-th item written so far (NILs aren't counted, a   *
+ *               LIST counts all its n nodes at once, before its CARs)  *
+ * where n and i are unsigned LEB128 varints. Items are written just    *
+ * once, so shared and even circular structures come back as they were */
+#define LISP$D_MAGIC       "LISPDMP1"
+#define LISP$D_MAGIC_SIZE  8
+#define LISP$D_HEADER_SIZE (LISP$D_MAGIC_SIZE + 4 * 4)
+
+#define LISP$D_TAG_NIL       0
+#define LISP$D_TAG_LIST      1
+#define LISP$D_TAG_SYMBOL    2
+#define LISP$D_TAG_STRING    3
+#define LISP$D_TAG_INTEGER   4
+#define LISP$D_TAG_DOUBLE    5
+#define LISP$D_TAG_BIGNUM    6
+#define LISP$D_TAG_VECTOR    7
+#define LISP$D_TAG_DVECTOR   8
+#define LISP$D_TAG_REF       9
+
+/* A cache of a source file (file.lisp -> file.lispc) has its own magic *
+ * and four 64-bit little-endian numbers -- the mtime (in ns, or -1),   *
+ * size and $D_hashText () of the source, and the number of bytes which *
+ * follow; then the forms go one by one, as they were read, each one    *
+ * referring just to its own items, so that it can be evaluated before  *
+ * the next one is read                                                 */
+#define LISP$D_CACHE_MAGIC       "LISPDMC1"
+#define LISP$D_CACHE_HEADER_SIZE (LISP$D_MAGIC_SIZE + 4 * 8)
+#define LISP$D_CACHE_SUFFIX      "c"
+
+/* What a cache is made from */
+typedef struct {
+  int64_t  mtime;                               /* Of the source, in ns */
+  uint64_t size;
+  uint64_t hash;                                /* $D_hashText () of it */
+} LISP$D_Stamp;
+
+/* A cache being read or written */
+typedef struct LISP$D_Cache LISP$D_Cache;
+
+/* Write 'ref' into the file 'fileName'; false is returned and the     *
+ * error is set if it can't be written (hash tables, streams, lazy    *
+ * sequences and promises can't)                                       */
+bool LISP$D_write (LISP$MachIns * lmi, LISP$Ref ref, const char * fileName);
+
+/* Read an object written by $D_write (); the tables are grown for all *
+ * of it at once, LISP$M_NULLREF is returned and the error is set if   *
+ * the file can't be read or if it's damaged                           */
+LISP$Ref LISP$D_read (LISP$MachIns * lmi, const char * fileName);
+
+/* Pack 'ref' into a buffer (to be freed) in the format of $D_write (), *
+ * for another LMI to $D_unpack () it; its size is stored at 'length'.  *
+ * NULL is returned and the error is set (for the built-in 'name') if   *
+ * it can't be packed                                                    */
+char * LISP$D_pack (LISP$MachIns * lmi, LISP$Ref ref, size_t * length,
+                    const char * name);
+
+/* Unpack an object packed by $D_pack () */
+LISP$Ref LISP$D_unpack (LISP$MachIns * lmi, const char * data, size_t length,
+                        const char * name);
+
+/* Hash of the source text a cache is checked by */
+uint64_t LISP$D_hashText (const char * text, size_t length);
+
+/* Open the cache if it's valid for the 'text' of 'stamp' -- the same   *
+ * size and mtime, or the same hash (the new mtime is stored then); NULL *
+ * is returned if it's missing or stale                                  */
+LISP$D_Cache * LISP$D_openCache (LISP$MachIns * lmi, const char * cacheName,
+                                 const LISP$D_Stamp * stamp,
+                                 const char * text);
+
+/* The next form of an open cache, or LISP$M_NULLREF at its end (or if *
+ * it's damaged, the error is set then)                                */
+LISP$Ref LISP$D_readForm (LISP$D_Cache * cache);
+
+/* Start a new cache of a source of 'stamp'; it's written aside and it  *
+ * replaces the old one just when it's complete, so a LOAD running      *
+ * meanwhile never sees a half of it; NULL is returned quietly if it    *
+ * can't be written -- the source is just read again next time          */
+LISP$D_Cache * LISP$D_createCache (LISP$MachIns * lmi, const char * cacheName,
+                                   const LISP$D_Stamp * stamp);
+
+/* Append a form just read from the source */
+void LISP$D_writeForm (LISP$D_Cache * cache, LISP$Ref form);
+
+/* Close a cache read, or a cache written -- it's kept just if it's got *
+ * all the forms of the source, 'isComplete'                            */
+void LISP$D_closeCache (LISP$D_Cache * cache, bool isComplete);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
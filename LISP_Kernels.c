@@ -0,0 +1,389 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Kernels -- Numeric kernels over packed double vectors
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifndef _VMS_
+#include <pthread.h>
+#endif
+
+#include "LISP_Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LISP$K_X86  1
+#include <immintrin.h>
+#endif
+
+#define LISP$K_INF  (1.0 / 0.0)
+
+
+/******************************************************
+ * Element-wise loop generator
+ ******************************************************/
+
+/* One element-wise loop over W doubles a step -- the right operand is *
+ * either loaded from 'y' or it's the broadcast scalar 'b'             */
+#define LISP$K_LOOP(W, LOAD, STORE, OP) \
+  if (y != NULL) \
+    for (; i + (W) <= n; i += (W)) \
+      STORE (dst + i, OP (LOAD (x + i), LOAD (y + i))); \
+  else if (swap) \
+    for (; i + (W) <= n; i += (W)) STORE (dst + i, OP (b, LOAD (x + i))); \
+  else \
+    for (; i + (W) <= n; i += (W)) STORE (dst + i, OP (LOAD (x + i), b));
+
+/* The whole map kernel; the operation is switched outside of loops and *
+ * the rest of items, less than W, is left to the scalar kernel         */
+#define LISP$K_DEFINE_MAP(NAME, W, T, LOAD, STORE, SET1, ADD, SUB, MUL, DIV) \
+static void NAME (LISP$KernelOper op, double * dst, const double * x, \
+                  const double * y, double s, bool swap, int n) { \
+  int i = 0; \
+  T   b = SET1 (s); \
+  switch (op) { \
+    case KernelAdd: LISP$K_LOOP (W, LOAD, STORE, ADD); break; \
+    case KernelSub: LISP$K_LOOP (W, LOAD, STORE, SUB); break; \
+    case KernelMul: LISP$K_LOOP (W, LOAD, STORE, MUL); break; \
+    case KernelDiv: LISP$K_LOOP (W, LOAD, STORE, DIV); break; \
+  } \
+  if (i < n && (W) > 1) \
+    LISP$K_mapScalar (op, dst + i, x + i, (y != NULL)? y + i : NULL, \
+                      s, swap, n - i); \
+}
+
+
+/******************************************************
+ * Scalar kernels -- portable fallback
+ ******************************************************/
+
+#define LISP$K_SLOAD(p)      (*(p))
+#define LISP$K_SSTORE(p, v)  (*(p) = (v))
+#define LISP$K_SSET1(s)      (s)
+#define LISP$K_SADD(a, b)    ((a) + (b))
+#define LISP$K_SSUB(a, b)    ((a) - (b))
+#define LISP$K_SMUL(a, b)    ((a) * (b))
+#define LISP$K_SDIV(a, b)    ((a) / (b))
+
+static void LISP$K_mapScalar (LISP$KernelOper op, double * dst,
+                              const double * x, const double * y,
+                              double s, bool swap, int n);
+
+LISP$K_DEFINE_MAP (LISP$K_mapScalar, 1, double,
+                   LISP$K_SLOAD, LISP$K_SSTORE, LISP$K_SSET1,
+                   LISP$K_SADD, LISP$K_SSUB, LISP$K_SMUL, LISP$K_SDIV)
+
+/* Four partial results break the dependency chain of additions */
+static double LISP$K_dotScalar (const double * x, const double * y, int n) {
+
+  int    i;
+  double a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    a0 += x [i]     * y [i];
+    a1 += x [i + 1] * y [i + 1];
+    a2 += x [i + 2] * y [i + 2];
+    a3 += x [i + 3] * y [i + 3];
+  }
+  for (; i < n; i++) a0 += x [i] * y [i];
+
+  return ((a0 + a1) + (a2 + a3));
+}
+
+static double LISP$K_sumScalar (const double * x, int n) {
+
+  int    i;
+  double a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    a0 += x [i];     a1 += x [i + 1];
+    a2 += x [i + 2]; a3 += x [i + 3];
+  }
+  for (; i < n; i++) a0 += x [i];
+
+  return ((a0 + a1) + (a2 + a3));
+}
+
+static double LISP$K_minScalar (const double * x, int n) {
+
+  int    i;
+  double m = LISP$K_INF;
+
+  for (i = 0; i < n; i++) if (x [i] < m) m = x [i];
+
+  return m;
+}
+
+static double LISP$K_maxScalar (const double * x, int n) {
+
+  int    i;
+  double m = -LISP$K_INF;
+
+  for (i = 0; i < n; i++) if (x [i] > m) m = x [i];
+
+  return m;
+}
+
+
+#ifdef LISP$K_X86
+/******************************************************
+ * SSE2 kernels -- two doubles at a time
+ ******************************************************/
+
+#define LISP$K_SSE2_TARGET  __attribute__ ((target ("sse2")))
+
+LISP$K_SSE2_TARGET
+LISP$K_DEFINE_MAP (LISP$K_mapSSE2, 2, __m128d,
+                   _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+                   _mm_add_pd, _mm_sub_pd, _mm_mul_pd, _mm_div_pd)
+
+/* Horizontal sum of a register */
+LISP$K_SSE2_TARGET
+static double LISP$K_hsumSSE2 (__m128d a) {
+
+  return (_mm_cvtsd_f64 (_mm_add_sd (a, _mm_unpackhi_pd (a, a))));
+}
+
+LISP$K_SSE2_TARGET
+static double LISP$K_dotSSE2 (const double * x, const double * y, int n) {
+
+  int     i;
+  __m128d a0 = _mm_setzero_pd (), a1 = _mm_setzero_pd ();
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    a0 = _mm_add_pd (a0, _mm_mul_pd (_mm_loadu_pd (x + i),
+                                     _mm_loadu_pd (y + i)));
+    a1 = _mm_add_pd (a1, _mm_mul_pd (_mm_loadu_pd (x + i + 2),
+                                     _mm_loadu_pd (y + i + 2)));
+  }
+
+  return (LISP$K_hsumSSE2 (_mm_add_pd (a0, a1)) +
+          LISP$K_dotScalar (x + i, y + i, n - i));
+}
+
+LISP$K_SSE2_TARGET
+static double LISP$K_sumSSE2 (const double * x, int n) {
+
+  int     i;
+  __m128d a0 = _mm_setzero_pd (), a1 = _mm_setzero_pd ();
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    a0 = _mm_add_pd (a0, _mm_loadu_pd (x + i));
+    a1 = _mm_add_pd (a1, _mm_loadu_pd (x + i + 2));
+  }
+
+  return (LISP$K_hsumSSE2 (_mm_add_pd (a0, a1)) +
+          LISP$K_sumScalar (x + i, n - i));
+}
+
+LISP$K_SSE2_TARGET
+static double LISP$K_minSSE2 (const double * x, int n) {
+
+  int     i;
+  double  m;
+  __m128d a   = _mm_set1_pd (LISP$K_INF);
+  __m128d inf = a, v, isNaN;
+
+  /* A NaN is skipped as by $K_minScalar -- it's taken for +Inf */
+  for (i = 0; i + 2 <= n; i += 2) {
+    v     = _mm_loadu_pd (x + i);
+    isNaN = _mm_cmpunord_pd (v, v);
+    v     = _mm_or_pd (_mm_andnot_pd (isNaN, v), _mm_and_pd (isNaN, inf));
+    a     = _mm_min_pd (a, v);
+  }
+
+  a = _mm_min_sd (a, _mm_unpackhi_pd (a, a));
+  m = LISP$K_minScalar (x + i, n - i);
+
+  return ((_mm_cvtsd_f64 (a) < m)? _mm_cvtsd_f64 (a) : m);
+}
+
+LISP$K_SSE2_TARGET
+static double LISP$K_maxSSE2 (const double * x, int n) {
+
+  int     i;
+  double  m;
+  __m128d a   = _mm_set1_pd (-LISP$K_INF);
+  __m128d inf = a, v, isNaN;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    v     = _mm_loadu_pd (x + i);
+    isNaN = _mm_cmpunord_pd (v, v);
+    v     = _mm_or_pd (_mm_andnot_pd (isNaN, v), _mm_and_pd (isNaN, inf));
+    a     = _mm_max_pd (a, v);
+  }
+
+  a = _mm_max_sd (a, _mm_unpackhi_pd (a, a));
+  m = LISP$K_maxScalar (x + i, n - i);
+
+  return ((_mm_cvtsd_f64 (a) > m)? _mm_cvtsd_f64 (a) : m);
+}
+
+
+/******************************************************
+ * AVX2 kernels -- four doubles at a time, fused multiply-add
+ ******************************************************/
+
+#define LISP$K_AVX2_TARGET  __attribute__ ((target ("avx2,fma")))
+
+LISP$K_AVX2_TARGET
+LISP$K_DEFINE_MAP (LISP$K_mapAVX2, 4, __m256d,
+                   _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                   _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_div_pd)
+
+LISP$K_AVX2_TARGET
+static double LISP$K_hsumAVX2 (__m256d a) {
+
+  __m128d b = _mm_add_pd (_mm256_castpd256_pd128 (a),
+                          _mm256_extractf128_pd (a, 1));
+
+  return (_mm_cvtsd_f64 (_mm_add_sd (b, _mm_unpackhi_pd (b, b))));
+}
+
+LISP$K_AVX2_TARGET
+static double LISP$K_dotAVX2 (const double * x, const double * y, int n) {
+
+  int     i;
+  __m256d a0 = _mm256_setzero_pd (), a1 = _mm256_setzero_pd ();
+  __m256d a2 = _mm256_setzero_pd (), a3 = _mm256_setzero_pd ();
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    a0 = _mm256_fmadd_pd (_mm256_loadu_pd (x + i),
+                          _mm256_loadu_pd (y + i), a0);
+    a1 = _mm256_fmadd_pd (_mm256_loadu_pd (x + i + 4),
+                          _mm256_loadu_pd (y + i + 4), a1);
+    a2 = _mm256_fmadd_pd (_mm256_loadu_pd (x + i + 8),
+                          _mm256_loadu_pd (y + i + 8), a2);
+    a3 = _mm256_fmadd_pd (_mm256_loadu_pd (x + i + 12),
+                          _mm256_loadu_pd (y + i + 12), a3);
+  }
+
+  return (LISP$K_hsumAVX2 (_mm256_add_pd (_mm256_add_pd (a0, a1),
+                                          _mm256_add_pd (a2, a3))) +
+          LISP$K_dotScalar (x + i, y + i, n - i));
+}
+
+LISP$K_AVX2_TARGET
+static double LISP$K_sumAVX2 (const double * x, int n) {
+
+  int     i;
+  __m256d a0 = _mm256_setzero_pd (), a1 = _mm256_setzero_pd ();
+  __m256d a2 = _mm256_setzero_pd (), a3 = _mm256_setzero_pd ();
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    a0 = _mm256_add_pd (a0, _mm256_loadu_pd (x + i));
+    a1 = _mm256_add_pd (a1, _mm256_loadu_pd (x + i + 4));
+    a2 = _mm256_add_pd (a2, _mm256_loadu_pd (x + i + 8));
+    a3 = _mm256_add_pd (a3, _mm256_loadu_pd (x + i + 12));
+  }
+
+  return (LISP$K_hsumAVX2 (_mm256_add_pd (_mm256_add_pd (a0, a1),
+                                          _mm256_add_pd (a2, a3))) +
+          LISP$K_sumScalar (x + i, n - i));
+}
+
+LISP$K_AVX2_TARGET
+static double LISP$K_minAVX2 (const double * x, int n) {
+
+  int     i;
+  double  m, r;
+  __m256d a   = _mm256_set1_pd (LISP$K_INF);
+  __m256d inf = a, v;
+  __m128d b;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    v = _mm256_loadu_pd (x + i);
+    v = _mm256_blendv_pd (v, inf, _mm256_cmp_pd (v, v, _CMP_UNORD_Q));
+    a = _mm256_min_pd (a, v);
+  }
+
+  b = _mm_min_pd (_mm256_castpd256_pd128 (a), _mm256_extractf128_pd (a, 1));
+  r = _mm_cvtsd_f64 (_mm_min_sd (b, _mm_unpackhi_pd (b, b)));
+  m = LISP$K_minScalar (x + i, n - i);
+
+  return ((r < m)? r : m);
+}
+
+LISP$K_AVX2_TARGET
+static double LISP$K_maxAVX2 (const double * x, int n) {
+
+  int     i;
+  double  m, r;
+  __m256d a   = _mm256_set1_pd (-LISP$K_INF);
+  __m256d inf = a, v;
+  __m128d b;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    v = _mm256_loadu_pd (x + i);
+    v = _mm256_blendv_pd (v, inf, _mm256_cmp_pd (v, v, _CMP_UNORD_Q));
+    a = _mm256_max_pd (a, v);
+  }
+
+  b = _mm_max_pd (_mm256_castpd256_pd128 (a), _mm256_extractf128_pd (a, 1));
+  r = _mm_cvtsd_f64 (_mm_max_sd (b, _mm_unpackhi_pd (b, b)));
+  m = LISP$K_maxScalar (x + i, n - i);
+
+  return ((r > m)? r : m);
+}
+#endif
+
+
+/******************************************************
+ * Kernel selection
+ ******************************************************/
+
+LISP$KernelTab LISP$K_tab = {
+  "SCALAR", LISP$K_mapScalar, LISP$K_dotScalar, LISP$K_sumScalar,
+  LISP$K_minScalar, LISP$K_maxScalar
+};
+
+static void LISP$K_select (void) {
+
+  char   isa [8] = "";
+  char * env     = getenv ("LISP_SIMD");
+  int    i;
+
+  if (env != NULL)
+    for (i = 0; env [i] != '\0' && i < (int) sizeof (isa) - 1; i++)
+      { isa [i] = toupper (env [i]); isa [i + 1] = '\0'; }
+
+#ifdef LISP$K_X86
+  static LISP$KernelTab avx2 = {
+    "AVX2", LISP$K_mapAVX2, LISP$K_dotAVX2, LISP$K_sumAVX2,
+    LISP$K_minAVX2, LISP$K_maxAVX2
+  };
+  static LISP$KernelTab sse2 = {
+    "SSE2", LISP$K_mapSSE2, LISP$K_dotSSE2, LISP$K_sumSSE2,
+    LISP$K_minSSE2, LISP$K_maxSSE2
+  };
+
+  __builtin_cpu_init ();
+
+  if (strcmp (isa, "SCALAR") && strcmp (isa, "SSE2") &&
+      __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+    { LISP$K_tab = avx2; return; }
+
+  if (strcmp (isa, "SCALAR") && __builtin_cpu_supports ("sse2"))
+    { LISP$K_tab = sse2; return; }
+#endif
+}
+
+void LISP$K_init (void) {
+
+  /* Each LMI asks for the kernels, the first one chooses them */
+#ifdef _VMS_
+  static bool isSelected = false;               /* No threads there     */
+
+  if (!isSelected) LISP$K_select ();
+  isSelected = true;
+#else
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+  pthread_once (&once, LISP$K_select);
+#endif
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -0,0 +1,39 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Kernels -- Numeric kernels over packed double vectors
+ */
+
+#ifndef _LISP_KERNELS_H_
+#define _LISP_KERNELS_H_
+
+#include <stdbool.h>
+
+/* Element-wise operation enumeration */
+typedef enum { KernelAdd, KernelSub, KernelMul, KernelDiv } LISP$KernelOper;
+
+/* Kernels of one instruction set -- see $K_init */
+typedef struct {
+  const char * isa;                             /* Instruction set name */
+
+  /* dst [i] = x [i] op y [i]; if 'y' is NULL, the scalar 's' is used  *
+   * instead and 'swap' says if it's the left operand (s op x [i])     */
+  void   (* map) (LISP$KernelOper op, double * dst, const double * x,
+                  const double * y, double s, bool swap, int n);
+
+  double (* dot) (const double * x, const double * y, int n);
+  double (* sum) (const double * x, int n);
+  double (* min) (const double * x, int n);     /* +Inf if empty        */
+  double (* max) (const double * x, int n);     /* -Inf if empty        */
+} LISP$KernelTab;
+
+/* Kernels selected for this CPU */
+extern LISP$KernelTab LISP$K_tab;
+
+/* Select the best kernels the CPU supports; LISP_SIMD environment     *
+ * variable (SCALAR, SSE2 or AVX2) may force a less capable set        */
+void LISP$K_init (void);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
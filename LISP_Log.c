@@ -0,0 +1,215 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Log -- Asynchronous writer of the log file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifndef _VMS_
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#endif
+
+#include "LISP_Log.h"
+
+#ifdef _VMS_
+
+/* No threads there -- each record is written and flushed right away */
+struct LISP$Log {
+  FILE *            stream;
+  char              record [LISP$L_RECORD_SIZE];
+};
+
+LISP$Log * LISP$L_open (FILE * stream) {
+
+  LISP$Log * log = (LISP$Log *) malloc (sizeof (LISP$Log));
+  if (log != NULL) log->stream = stream;
+  return log;
+}
+
+char * LISP$L_reserve (LISP$Log * log) {
+
+  return (log->record);
+}
+
+void LISP$L_commit (LISP$Log * log, size_t length) {
+
+  if (length > LISP$L_RECORD_SIZE) length = LISP$L_RECORD_SIZE;
+  if (log->stream != NULL) {
+    fwrite (log->record, 1, length, log->stream);
+    fflush (log->stream);
+  }
+}
+
+void LISP$L_close (LISP$Log * log) {
+
+  free (log);
+}
+
+#else
+
+/* The writer sleeps at most this long, even if nobody wakes it up */
+#define LISP$L_SLEEP_NS     50000000L
+
+/* The ring has a single producer, the LMI, and a single consumer, the *
+ * thread; 'head' and 'tail' only grow, a record is at their value     *
+ * modulo LISP$L_RECORDS                                               */
+struct LISP$Log {
+  FILE *            stream;
+  _Atomic size_t    head;                       /* Next to be reserved  */
+  _Atomic size_t    tail;                       /* Next to be written   */
+  _Atomic bool      isWaiting;                  /* Writer asleep?       */
+  _Atomic bool      isClosing;
+  bool              isThreaded;
+  pthread_t         thread;
+  pthread_mutex_t   lock;                       /* Just for 'wake'      */
+  pthread_cond_t    wake;
+  uint16_t          lengths [LISP$L_RECORDS];
+  char              records [LISP$L_RECORDS][LISP$L_RECORD_SIZE];
+};
+
+
+/******************************************************
+ * Writer thread
+ ******************************************************/
+
+static void LISP$L_sleep (LISP$Log * log) {
+
+  struct timespec ts;
+
+  /* The producer checks 'isWaiting' after it has moved 'head', so *
+   * either it sees the flag or the check below sees the record    */
+  pthread_mutex_lock (&(log->lock));
+  atomic_store (&(log->isWaiting), true);
+  if (atomic_load (&(log->head)) == atomic_load (&(log->tail)) &&
+      !atomic_load (&(log->isClosing))) {
+    clock_gettime (CLOCK_REALTIME, &ts);
+    ts.tv_nsec += LISP$L_SLEEP_NS;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait (&(log->wake), &(log->lock), &ts);
+  }
+  atomic_store (&(log->isWaiting), false);
+  pthread_mutex_unlock (&(log->lock));
+}
+
+static void * LISP$L_write (void * arg) {
+
+  LISP$Log * log = (LISP$Log *) arg;
+  size_t     tail, head;
+
+  for (;;) {
+    head = atomic_load_explicit (&(log->head), memory_order_acquire);
+    tail = atomic_load_explicit (&(log->tail), memory_order_relaxed);
+
+    /* A burst of records is written at once and flushed once */
+    if (tail != head) {
+      for (; tail != head; tail++)
+        fwrite (log->records [tail % LISP$L_RECORDS], 1,
+                log->lengths [tail % LISP$L_RECORDS], log->stream);
+      atomic_store_explicit (&(log->tail), tail, memory_order_release);
+      continue;
+    }
+
+    fflush (log->stream);
+    if (atomic_load (&(log->isClosing))) break;
+    LISP$L_sleep (log);
+  }
+
+  return NULL;
+}
+
+
+/******************************************************
+ * Public interface
+ ******************************************************/
+
+LISP$Log * LISP$L_open (FILE * stream) {
+
+  sigset_t   all, old;
+  LISP$Log * log = (LISP$Log *) malloc (sizeof (LISP$Log));
+  if (log == NULL) return NULL;
+
+  log->stream = stream;
+  atomic_init (&(log->head), 0);
+  atomic_init (&(log->tail), 0);
+  atomic_init (&(log->isWaiting), false);
+  atomic_init (&(log->isClosing), false);
+  pthread_mutex_init (&(log->lock), NULL);
+  pthread_cond_init (&(log->wake), NULL);
+
+  /* Signals are left to the threads of the LMIs */
+  sigfillset (&all);
+  pthread_sigmask (SIG_SETMASK, &all, &old);
+  log->isThreaded = (stream != NULL &&
+      !pthread_create (&(log->thread), NULL, LISP$L_write, log));
+  pthread_sigmask (SIG_SETMASK, &old, NULL);
+
+  return log;
+}
+
+char * LISP$L_reserve (LISP$Log * log) {
+
+  size_t head = atomic_load_explicit (&(log->head), memory_order_relaxed);
+
+  /* Full -- the writer is surely awake, since it's got records to write */
+  while (log->isThreaded && head - atomic_load_explicit (&(log->tail),
+           memory_order_acquire) >= LISP$L_RECORDS)
+    sched_yield ();
+
+  return (log->records [head % LISP$L_RECORDS]);
+}
+
+void LISP$L_commit (LISP$Log * log, size_t length) {
+
+  size_t head = atomic_load_explicit (&(log->head), memory_order_relaxed);
+
+  if (length > LISP$L_RECORD_SIZE) length = LISP$L_RECORD_SIZE;
+
+  /* Without the thread, the record is written right away */
+  if (!log->isThreaded) {
+    if (log->stream != NULL) {
+      fwrite (log->records [head % LISP$L_RECORDS], 1, length, log->stream);
+      fflush (log->stream);
+    }
+    return;
+  }
+
+  log->lengths [head % LISP$L_RECORDS] = (uint16_t) length;
+  atomic_store (&(log->head), head + 1);
+
+  if (atomic_load (&(log->isWaiting))) {
+    pthread_mutex_lock (&(log->lock));
+    pthread_cond_signal (&(log->wake));
+    pthread_mutex_unlock (&(log->lock));
+  }
+}
+
+void LISP$L_close (LISP$Log * log) {
+
+  if (log == NULL) return;
+
+  if (log->isThreaded) {
+    atomic_store (&(log->isClosing), true);
+    pthread_mutex_lock (&(log->lock));
+    pthread_cond_signal (&(log->wake));
+    pthread_mutex_unlock (&(log->lock));
+    pthread_join (log->thread, NULL);
+  }
+
+  pthread_cond_destroy (&(log->wake));
+  pthread_mutex_destroy (&(log->lock));
+  free (log);
+}
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -0,0 +1,41 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Log -- Asynchronous writer of the log file
+ */
+
+#ifndef _LISP_LOG_H_
+#define _LISP_LOG_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A record longer than this is truncated */
+#define LISP$L_RECORD_SIZE  512
+
+/* Records waiting for the writer -- a power of two */
+#define LISP$L_RECORDS      512
+
+/* Log of one LMI -- records are formatted right into a ring by the LMI *
+ * and written out by a thread of the log, which flushes the stream     *
+ * whenever it has caught up; the LMI waits just if the ring is full    */
+typedef struct LISP$Log LISP$Log;
+
+/* Start writing into 'stream'; if the thread can't be started, records *
+ * are written and flushed right away. NULL is returned if there's no   *
+ * memory for the ring                                                  */
+LISP$Log * LISP$L_open (FILE * stream);
+
+/* Room of LISP$L_RECORD_SIZE chars for the next record */
+char * LISP$L_reserve (LISP$Log * log);
+
+/* Pass the 'length' chars of the reserved record to the writer */
+void LISP$L_commit (LISP$Log * log, size_t length);
+
+/* Write out all the records and stop the thread; the stream isn't closed */
+void LISP$L_close (LISP$Log * log);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -7,45 +7,142 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "LISP_Core.h"
+#include "LISP_Server.h"
 
 #ifdef _VMS_
 #include <ssdef.h>
 #else
 /* Normal completition */
 #define SS$_NORMAL        0
+#define SS$_ABORT         1
 #define SS$_INSFARG      10
 #define SS$_ACCVIO       20
 #endif
 
+/* Workers of --serve, PMAP and FUTURE unless --workers is given */
+#ifdef _VMS_
+#define LISP$WORKERS  1                         /* No threads there     */
+#else
+#define LISP$WORKERS  sysconf (_SC_NPROCESSORS_ONLN)
+#endif
+
 #define LISP$INPUT    stdin
 #define LISP$OUTPUT   stdout
 
 
+static void LISP$usage (const char * name) {
+
+  fprintf (stderr,
+      "Usage: %s [-b] [--no-startup] [--workers N] [-e EXPR] [-] [FILE]...\n"
+      "       %s --serve SOCKET|- [--workers N] [--no-startup] [FILE]...\n"
+      "  FILE          load the file, then read the terminal\n"
+      "  -b            batch mode -- print just the results, load the\n"
+      "                files or read the standard input as a script\n"
+      "  -e EXPR       evaluate the forms of EXPR (batch mode)\n"
+      "  -             read the standard input as a script (batch mode)\n"
+      "  --no-startup  don't load startup.lisp\n"
+      "  --serve PATH  load the files, then evaluate the requests of the\n"
+      "                clients of a Unix socket at PATH (or of the\n"
+      "                standard input, -) by a pool of copies of LISP,\n"
+      "                a line each, answering a line of the results\n"
+      "  --workers N   copies serving the requests or running PMAP and\n"
+      "                PREDUCE (the CPUs online)\n",
+      name, name);
+}
+
 int main (int argc, char * argv []) {
 
   int i;
   LISP$MachIns * lmi;
   LISP$Ref       ref;
+  bool           isBatch   = false;
+  bool           isStartup = true;
+  bool           hasScript = false;
+  char *         serve     = NULL;
+  long           workers   = LISP$WORKERS;
+
+  /* Options go first -- -e and - make a batch run too */
+  for (i = 1; i < argc; i++) {
+    if (!strcmp (argv [i], "-b") || !strcmp (argv [i], "-"))
+      isBatch = true;
+    else if (!strcmp (argv [i], "-e") && i + 1 < argc) {
+      isBatch = true;
+      i++;
+    }
+    else if (!strcmp (argv [i], "--no-startup"))
+      isStartup = false;
+    else if (!strcmp (argv [i], "--serve") && i + 1 < argc) {
+      serve = argv [++i];
+      isBatch = true;
+    }
+    else if (!strcmp (argv [i], "--workers") && i + 1 < argc &&
+             (workers = atol (argv [i + 1])) > 0)
+      i++;
+    else if (argv [i][0] == '-') {
+      LISP$usage (argv [0]);
+      return SS$_INSFARG;
+    }
+  }
 
   /* Initialize LISP Machine */
-  lmi = LISP$M_init (argv [0], LISP$INPUT, LISP$OUTPUT);
+  lmi = LISP$M_init (argv [0], LISP$INPUT, LISP$OUTPUT, isBatch);
 
-  /* Batch mode -- load startup files */
-  for (i = 0; i < argc; i++)
-    LISP$S_loadFile (lmi, (!i)? "startup.lisp" : argv [i]);
+  /* A server keeps just the definitions of the files it loads */
+  if (serve != NULL) lmi->isEchoed = false;
+  if (workers < 1) workers = 1;
+  lmi->workers = (int) workers;
+
+  /* The results of the startup file aren't anybody's business in a batch */
+  if (isStartup) {
+    lmi->isEchoed = !isBatch;
+    LISP$S_loadFile (lmi, "startup.lisp");
+    lmi->isEchoed = (serve == NULL);
+  }
+
+  /* Load the scripts in the order they're given */
+  for (i = 1; i < argc; i++) {
+    if (!strcmp (argv [i], "-b") || !strcmp (argv [i], "--no-startup"))
+      continue;
+    if (!strcmp (argv [i], "--serve") || !strcmp (argv [i], "--workers")) {
+      i++;
+      continue;
+    }
+
+    hasScript = true;
+    if (!strcmp (argv [i], "-e")) {
+      i++;
+      LISP$S_loadText (lmi, argv [i], strlen (argv [i]));
+    }
+    else if (!strcmp (argv [i], "-")) LISP$S_loadStream (lmi, LISP$INPUT);
+    else LISP$S_loadFile (lmi, argv [i]);
+  }
+
+  /* A batch without any script reads the standard input */
+  if (serve != NULL) {
+    lmi->isEchoed = true;
+    if (!LISP$V_serve (lmi, serve, (int) workers)) lmi->errorCount++;
+  }
+  else if (isBatch) {
+    if (!hasScript) LISP$S_loadStream (lmi, LISP$INPUT);
+  }
 
-  while (LISP$M_is2Process (lmi)) {
+  else while (LISP$M_is2Process (lmi)) {
     ref = LISP$S_read (lmi);
     ref = LISP$S_eval (lmi, ref);
 
     LISP$S_write (lmi, ref);
   }
 
+  /* A batch fails if any of its forms has failed */
+  i = (isBatch && lmi->errorCount > 0)? SS$_ABORT : SS$_NORMAL;
   LISP$M_destroy (lmi);
 
-  return SS$_NORMAL;
+  return i;
 }
 
 // vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
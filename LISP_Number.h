@@ -0,0 +1,30 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Number -- Conversion of numeric tokens
+ */
+
+#ifndef _LISP_NUMBER_H_
+#define _LISP_NUMBER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* What a numeric token turned out to be */
+typedef enum {
+  NotNumber,      /* Bad syntax                                   */
+  IntNumber,      /* An integer fitting into 64 bits              */
+  RealNumber,     /* A double -- it has a point or an exponent    */
+  BigNumber       /* An integer which is to be read as a bignum   */
+} LISP$NumberType;
+
+/* Parse 'length' chars of 'text' -- [+-]digits[point digits][e[+-]digits] *
+ * with 'point' as the decimal point; the value is stored into 'integer'   *
+ * or into 'real' according to the type returned. Doubles are correctly    *
+ * rounded (Eisel-Lemire) and they don't depend on the locale              */
+LISP$NumberType LISP$N_parse (const char * text, size_t length, char point,
+                              int64_t * integer, double * real);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
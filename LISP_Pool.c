@@ -0,0 +1,260 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Pool -- Pool of worker threads, each with its own LMI
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _VMS_
+#include <pthread.h>
+#endif
+
+#include "LISP_Pool.h"
+
+#ifdef _VMS_
+
+/* No threads there -- the only worker is run by the caller's thread, *
+ * each task as soon as it's submitted, so it's never idle            */
+struct LISP$Pool {
+  LISP$MachIns *   lmi;                         /* Template of workers  */
+  LISP$MachIns *   worker;
+  bool             isFresh;                     /* New copy each task?  */
+};
+
+LISP$Pool * LISP$P_create (LISP$MachIns * lmi, int workers, bool isFresh) {
+
+  LISP$Pool * pool = (LISP$Pool *) calloc (1, sizeof (LISP$Pool));
+
+  if (pool == NULL) return NULL;
+  if ((pool->worker = LISP$M_clone (lmi, NULL, NULL)) == NULL) {
+    free (pool);
+    return NULL;
+  }
+
+  pool->lmi              = lmi;
+  pool->isFresh          = isFresh;
+  pool->worker->isQuiet  = true;
+  pool->worker->isWorker = true;
+  return pool;
+}
+
+bool LISP$P_submit (LISP$Pool * pool, LISP$P_Task task, void * arg) {
+
+  LISP$MachIns * next;
+
+  task (pool->worker, arg);
+
+  /* Without memory for the refreshed copy nor for a new one, the *
+   * worker goes on with the old one                              */
+  if (pool->isFresh && !LISP$M_reset (pool->worker, pool->lmi) &&
+      (next = LISP$M_clone (pool->lmi, NULL, NULL)) != NULL) {
+    LISP$M_destroy (pool->worker);
+    pool->worker           = next;
+    pool->worker->isQuiet  = true;
+    pool->worker->isWorker = true;
+  }
+  return true;
+}
+
+int LISP$P_idle (LISP$Pool * pool) {
+
+  return 0;
+}
+
+void LISP$P_destroy (LISP$Pool * pool) {
+
+  if (pool == NULL) return;
+  LISP$M_destroy (pool->worker);
+  free (pool);
+}
+
+#else
+
+/* Task waiting in the queue */
+typedef struct LISP$P_Job {
+  LISP$P_Task          task;
+  void *               arg;
+  struct LISP$P_Job *  next;
+} LISP$P_Job;
+
+struct LISP$Pool {
+  LISP$MachIns *   lmi;                         /* Template of workers  */
+  bool             isFresh;                     /* New copy each task?  */
+  pthread_t *      threads;
+  int              workers;
+
+  pthread_mutex_t  lock;                        /* Guards all below     */
+  pthread_cond_t   hasJobs;
+  pthread_cond_t   hasStarted;
+  LISP$P_Job *     first;                       /* Queue of the tasks   */
+  LISP$P_Job **    last;
+  int              started;                     /* Workers with an LMI  */
+  int              failed;                      /* ... and without it   */
+  int              queued;                      /* Tasks in the queue   */
+  int              busy;                        /* Workers on a task    */
+  bool             isClosing;
+};
+
+
+/******************************************************
+ * Worker thread
+ ******************************************************/
+
+static LISP$MachIns * LISP$P_copy (LISP$Pool * pool) {
+
+  LISP$MachIns * lmi = LISP$M_clone (pool->lmi, NULL, NULL);
+
+  if (lmi != NULL) {
+    lmi->isQuiet  = true;
+    lmi->isWorker = true;
+  }
+  return lmi;
+}
+
+static void * LISP$P_work (void * arg) {
+
+  LISP$Pool *    pool = (LISP$Pool *) arg;
+  LISP$MachIns * lmi  = LISP$P_copy (pool);
+  LISP$MachIns * next;
+  LISP$P_Job *   job;
+
+  pthread_mutex_lock (&(pool->lock));
+  if (lmi != NULL) pool->started++; else pool->failed++;
+  pthread_cond_broadcast (&(pool->hasStarted));
+  pthread_mutex_unlock (&(pool->lock));
+
+  if (lmi == NULL) return NULL;
+
+  for (;;) {
+    pthread_mutex_lock (&(pool->lock));
+    while (pool->first == NULL && !pool->isClosing)
+      pthread_cond_wait (&(pool->hasJobs), &(pool->lock));
+
+    /* The queue is emptied before the workers stop */
+    if ((job = pool->first) == NULL) {
+      pthread_mutex_unlock (&(pool->lock));
+      break;
+    }
+    if ((pool->first = job->next) == NULL) pool->last = &(pool->first);
+    pool->queued--;
+    pool->busy++;
+    pthread_mutex_unlock (&(pool->lock));
+
+    job->task (lmi, job->arg);
+    free (job);
+
+    pthread_mutex_lock (&(pool->lock));
+    pool->busy--;
+    pthread_mutex_unlock (&(pool->lock));
+
+    /* The copy is just refreshed; without memory for it nor for a new *
+     * copy, the worker goes on with the old one                       */
+    if (pool->isFresh && !LISP$M_reset (lmi, pool->lmi) &&
+        (next = LISP$P_copy (pool)) != NULL) {
+      LISP$M_destroy (lmi);
+      lmi = next;
+    }
+  }
+
+  LISP$M_destroy (lmi);
+  return NULL;
+}
+
+
+/******************************************************
+ * Public interface
+ ******************************************************/
+
+LISP$Pool * LISP$P_create (LISP$MachIns * lmi, int workers, bool isFresh) {
+
+  int i;
+  LISP$Pool * pool = (LISP$Pool *) calloc (1, sizeof (LISP$Pool));
+
+  if (pool == NULL) return NULL;
+  if ((pool->threads = (pthread_t *) calloc (workers,
+                                             sizeof (pthread_t))) == NULL) {
+    free (pool);
+    return NULL;
+  }
+
+  pool->lmi     = lmi;
+  pool->isFresh = isFresh;
+  pool->last    = &(pool->first);
+  pthread_mutex_init (&(pool->lock), NULL);
+  pthread_cond_init (&(pool->hasJobs), NULL);
+  pthread_cond_init (&(pool->hasStarted), NULL);
+
+  for (i = 0; i < workers; i++, pool->workers++)
+    if (pthread_create (&(pool->threads [i]), NULL, LISP$P_work, pool))
+      break;
+
+  /* Wait for all the copies -- the template mustn't change meanwhile */
+  pthread_mutex_lock (&(pool->lock));
+  while (pool->started + pool->failed < pool->workers)
+    pthread_cond_wait (&(pool->hasStarted), &(pool->lock));
+  pthread_mutex_unlock (&(pool->lock));
+
+  if (pool->workers < workers || pool->failed > 0) {
+    LISP$P_destroy (pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+bool LISP$P_submit (LISP$Pool * pool, LISP$P_Task task, void * arg) {
+
+  LISP$P_Job * job = (LISP$P_Job *) malloc (sizeof (LISP$P_Job));
+
+  if (job == NULL) return false;
+  job->task = task;
+  job->arg  = arg;
+  job->next = NULL;
+
+  pthread_mutex_lock (&(pool->lock));
+  *(pool->last) = job;
+  pool->last    = &(job->next);
+  pool->queued++;
+  pthread_cond_signal (&(pool->hasJobs));
+  pthread_mutex_unlock (&(pool->lock));
+
+  return true;
+}
+
+int LISP$P_idle (LISP$Pool * pool) {
+
+  int idle;
+
+  pthread_mutex_lock (&(pool->lock));
+  idle = pool->started - pool->busy - pool->queued;
+  pthread_mutex_unlock (&(pool->lock));
+
+  return idle;
+}
+
+void LISP$P_destroy (LISP$Pool * pool) {
+
+  int i;
+
+  if (pool == NULL) return;
+
+  pthread_mutex_lock (&(pool->lock));
+  pool->isClosing = true;
+  pthread_cond_broadcast (&(pool->hasJobs));
+  pthread_mutex_unlock (&(pool->lock));
+
+  for (i = 0; i < pool->workers; i++)
+    pthread_join (pool->threads [i], NULL);
+
+  pthread_cond_destroy (&(pool->hasStarted));
+  pthread_cond_destroy (&(pool->hasJobs));
+  pthread_mutex_destroy (&(pool->lock));
+  free (pool->threads);
+  free (pool);
+}
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
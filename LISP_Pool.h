@@ -0,0 +1,40 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Pool -- Pool of worker threads, each with its own LMI
+ */
+
+#ifndef _LISP_POOL_H_
+#define _LISP_POOL_H_
+
+#include "LISP_Core.h"
+
+/* A task is run by one of the workers, on the worker's LMI */
+typedef void (* LISP$P_Task) (LISP$MachIns * lmi, void * arg);
+
+/* Workers take the tasks in the order they've been submitted; each    *
+ * of them runs a copy ($M_clone) of the template LMI, made by its own *
+ * thread                                                              */
+typedef struct LISP$Pool LISP$Pool;
+
+/* Start 'workers' threads with quiet copies of 'lmi', without any     *
+ * input and output -- a task redirects them as it needs; it returns   *
+ * once all the copies are made, so 'lmi' may be changed then. If      *
+ * 'isFresh', each worker makes a new copy after each task, so no task *
+ * sees what another one has left behind, and 'lmi' has to be kept     *
+ * unchanged as long as the pool runs. NULL if not all workers started */
+LISP$Pool * LISP$P_create (LISP$MachIns * lmi, int workers, bool isFresh);
+
+/* Queue a task; false if there's no memory for it */
+bool LISP$P_submit (LISP$Pool * pool, LISP$P_Task task, void * arg);
+
+/* Workers which would take a task submitted now right away; it may  *
+ * change as soon as it's returned, so it's just a hint              */
+int LISP$P_idle (LISP$Pool * pool);
+
+/* Wait for all the tasks queued, stop the workers and drop their LMIs */
+void LISP$P_destroy (LISP$Pool * pool);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
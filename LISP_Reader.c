@@ -0,0 +1,216 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Reader -- Block-buffered input of the S-expr reader
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _VMS_
+#include <sys/mman.h>
+#endif
+
+#include "LISP_Reader.h"
+
+/* Read at least this many chars per a line-wise refill */
+#define LISP$R_LINE_SIZE    4096
+
+
+/******************************************************
+ * Buffer management
+ ******************************************************/
+
+/* Drop the chars nobody points to and make room for 'more' chars */
+static bool LISP$R_reserve (LISP$Reader * r, size_t more) {
+
+  size_t keep = (r->mark < r->lineStart)? r->mark : r->lineStart;
+  size_t size;
+  char * tmp;
+
+  if (keep > 0) {
+    memmove (r->buffer, r->buffer + keep, r->length - keep);
+    r->length    -= keep;
+    r->position  -= keep;
+    r->lineStart -= keep;
+    if (r->mark != LISP$R_NOMARK) r->mark -= keep;
+  }
+
+  if (r->size - r->length >= more) return true;
+
+  /* A long line or token doesn't fit, so the buffer is doubled */
+  for (size = (r->size)? r->size : LISP$R_BLOCK_SIZE;
+       size - r->length < more; size *= 2);
+
+  tmp = (char *) realloc (r->buffer, size);
+  if (tmp == NULL) return false;
+
+  r->buffer = tmp;
+  r->size   = size;
+  return true;
+}
+
+/* Read the next block and return its first char */
+static int LISP$R_fill (LISP$Reader * r) {
+
+  size_t got;
+
+  if (r->isEOF || r->stream == NULL ||
+      !LISP$R_reserve (r, r->isLineWise? LISP$R_LINE_SIZE :
+                                         LISP$R_BLOCK_SIZE / 2)) {
+    r->isEOF = true;
+    return EOF;
+  }
+
+  if (!r->isLineWise)
+    got = fread (r->buffer + r->length, 1, r->size - r->length, r->stream);
+  else if (fgets (r->buffer + r->length, r->size - r->length, r->stream))
+    got = strlen (r->buffer + r->length);
+  else got = 0;
+
+  if (!got) {
+    r->isEOF = true;
+    return EOF;
+  }
+
+  r->length += got;
+  return (LISP$R_getChar (r));
+}
+
+
+/******************************************************
+ * Public interface
+ ******************************************************/
+
+void LISP$R_openStream (LISP$Reader * r, FILE * stream) {
+
+  struct stat st;
+
+  LISP$R_openText (r, NULL, 0);
+  r->stream     = stream;
+  r->isLineWise = (stream != NULL &&
+                   (fstat (fileno (stream), &st) || !S_ISREG (st.st_mode)));
+}
+
+bool LISP$R_openMapped (LISP$Reader * r, FILE * stream) {
+
+#ifdef _VMS_
+  r = r; stream = stream;
+  return false;
+#else
+  struct stat st;
+  void *      text;
+
+  if (fstat (fileno (stream), &st) || !S_ISREG (st.st_mode) ||
+      st.st_size <= 0 || (unsigned long long) st.st_size > (size_t) -1)
+    return false;
+
+  text = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+               fileno (stream), 0);
+  if (text == MAP_FAILED) return false;
+
+  /* The file is parsed from the beginning to the end just once */
+  madvise (text, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+  LISP$R_openText (r, (const char *) text, (size_t) st.st_size);
+  r->isMapped = true;
+  return true;
+#endif
+}
+
+void LISP$R_openText (LISP$Reader * r, const char * text, size_t length) {
+
+  r->stream     = NULL;
+  r->buffer     = (char *) text;
+  r->size       = length;
+  r->length     = length;
+  r->position   = 0;
+  r->mark       = LISP$R_NOMARK;
+  r->lineStart  = 0;
+  r->line       = 1;
+  r->isOwner    = (text == NULL);
+  r->isMapped   = false;
+  r->isLineWise = false;
+  r->isEOF      = false;
+}
+
+bool LISP$R_append (LISP$Reader * r, const char * text, size_t length) {
+
+  if (!r->isOwner || !LISP$R_reserve (r, length)) return false;
+
+  memcpy (r->buffer + r->length, text, length);
+  r->length += length;
+  return true;
+}
+
+void LISP$R_close (LISP$Reader * r) {
+
+  if (r->isOwner) free (r->buffer);
+#ifndef _VMS_
+  if (r->isMapped) munmap (r->buffer, r->size);
+#endif
+  r->isOwner = r->isMapped = false;
+  r->buffer = NULL;
+  r->size = r->length = r->position = r->lineStart = 0;
+  r->mark = LISP$R_NOMARK;
+}
+
+int LISP$R_getChar (LISP$Reader * r) {
+
+  int c;
+
+  if (r->position >= r->length) return (LISP$R_fill (r));
+
+  c = (unsigned char) r->buffer [r->position++];
+  if (c == '\n') {
+    r->line++;
+    r->lineStart = r->position;
+  }
+
+  return c;
+}
+
+bool LISP$R_isEmpty (LISP$Reader * r) {
+
+  return (r->position >= r->length);
+}
+
+void LISP$R_mark (LISP$Reader * r) {
+
+  r->mark = (r->position > 0)? r->position - 1 : 0;
+}
+
+LISP$Span LISP$R_getSpan (LISP$Reader * r, size_t length) {
+
+  LISP$Span span;
+
+  span.text   = (r->mark == LISP$R_NOMARK)? "" : r->buffer + r->mark;
+  span.length = (r->mark == LISP$R_NOMARK)? 0  : length;
+  return span;
+}
+
+int LISP$R_getLine (LISP$Reader * r, char * buf, size_t size) {
+
+  size_t begin = r->lineStart;
+  size_t end   = r->position;
+
+  if (r->buffer == NULL) {
+    buf [0] = '\0';
+    return 0;
+  }
+
+  /* Show the end of a line which is too long */
+  if (end - begin > size / 2) begin = end - size / 2;
+
+  while (end < r->length && end - begin < size - 1 &&
+         r->buffer [end] != '\n') end++;
+
+  memcpy (buf, r->buffer + begin, end - begin);
+  buf [end - begin] = '\0';
+
+  return ((int) (r->position - begin));
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -0,0 +1,86 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Reader -- Block-buffered input of the S-expr reader
+ */
+
+#ifndef _LISP_READER_H_
+#define _LISP_READER_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Size of one block read from a stream */
+#define LISP$R_BLOCK_SIZE   65536
+
+/* No token is being read -- see $R_mark () */
+#define LISP$R_NOMARK       ((size_t) -1)
+
+/* Input of one source -- a stream read block by block or a text given *
+ * at once; chars before the current line (or the current token, if it *
+ * began sooner) are dropped when the buffer is refilled, so tokens and *
+ * the line of an error can be pointed to without copying them          */
+typedef struct {
+  FILE *  stream;                               /* Blocks source, or NULL */
+  char *  buffer;                               /* Chars read so far      */
+  size_t  size;                                 /* Allocated 'buffer'     */
+  size_t  length;                               /* Valid chars of 'buffer'*/
+  size_t  position;                             /* Next char to be read   */
+  size_t  mark;                                 /* Token beginning        */
+  size_t  lineStart;                            /* Current line beginning */
+  long    line;                                 /* Current line, from 1   */
+  bool    isOwner;                              /* Is 'buffer' malloc'd?  */
+  bool    isMapped;                             /* Is 'buffer' mmap'd?    */
+  bool    isLineWise;                           /* Read a line at a time? */
+  bool    isEOF;                                /* Nothing more to read   */
+} LISP$Reader;
+
+/* Token as a part of the reader's buffer -- valid until the next token *
+ * is marked, it isn't terminated by '\0'                               */
+typedef struct {
+  const char * text;
+  size_t       length;
+} LISP$Span;
+
+/* Read 'stream' block by block; terminals and pipes are read line by   *
+ * line, so the reader doesn't wait for the input the user didn't type  */
+void LISP$R_openStream (LISP$Reader * r, FILE * stream);
+
+/* Map a regular file of 'stream' read-only and read it in place; false *
+ * is returned for pipes, devices, empty files and files too large to be *
+ * mapped, they're to be read by $R_openStream ()                        */
+bool LISP$R_openMapped (LISP$Reader * r, FILE * stream);
+
+/* Read 'length' chars of 'text' in place -- it's neither copied nor   *
+ * freed and it must not change until the reader is closed; NULL text  *
+ * makes an empty reader which is fed by $R_append ()                   */
+void LISP$R_openText (LISP$Reader * r, const char * text, size_t length);
+
+/* Append 'length' chars of 'text' to a stream or an empty text reader; *
+ * false is returned if there's no memory                               */
+bool LISP$R_append (LISP$Reader * r, const char * text, size_t length);
+
+/* Free or unmap the buffer; the stream is left open */
+void LISP$R_close (LISP$Reader * r);
+
+/* Next char, EOF at the end of input */
+int  LISP$R_getChar (LISP$Reader * r);
+
+/* Is everything read already buffered and consumed? */
+bool LISP$R_isEmpty (LISP$Reader * r);
+
+/* Mark the char just read as the beginning of a token */
+void LISP$R_mark (LISP$Reader * r);
+
+/* Span of 'length' chars from the mark */
+LISP$Span LISP$R_getSpan (LISP$Reader * r, size_t length);
+
+/* Copy the current line (up to 'size' - 1 chars around the position) *
+ * into 'buf'; the column of the recently read char is returned, it's  *
+ * counted from 1 in 'buf'                                             */
+int  LISP$R_getLine (LISP$Reader * r, char * buf, size_t size);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
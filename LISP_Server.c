@@ -0,0 +1,631 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Server -- Requests evaluated by a pool of LMIs
+ */
+
+#ifndef _VMS_
+#define _GNU_SOURCE                             /* accept4 ()            */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#ifndef _VMS_
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <poll.h>
+#endif
+
+#include "LISP_Server.h"
+#include "LISP_Pool.h"
+
+#ifdef _VMS_
+
+/* Neither epoll nor threads there */
+bool LISP$V_serve (LISP$MachIns * lmi, const char * path, int workers) {
+
+  LISP$M_throwMessage (lmi, 'E', "SERVER",
+                       "Can't serve %s: no sockets nor threads on VMS", path);
+  return false;
+}
+
+#else
+
+/* Events taken by one epoll_wait () and bytes by one read () */
+#define LISP$V_EVENTS     64
+#define LISP$V_READSIZE   65536
+
+/* Growing array of chars */
+typedef struct {
+  char *  data;
+  size_t  length;
+  size_t  size;
+} LISP$V_Buffer;
+
+typedef struct LISP$V_Server  LISP$V_Server;
+typedef struct LISP$V_Client  LISP$V_Client;
+
+/* Line of a client being evaluated by a worker; the response is made *
+ * by the worker, then the request is passed back to the event loop    */
+typedef struct LISP$V_Request {
+  LISP$V_Server *          server;
+  LISP$V_Client *          client;
+  char *                   text;
+  size_t                   length;
+  char *                   response;
+  size_t                   responseLength;
+  struct LISP$V_Request *  next;
+} LISP$V_Request;
+
+/* Connection, or the pipe -- just one of its requests is evaluated at *
+ * a time, so the responses go in the order of the requests; it's     *
+ * freed when it's closed and nothing of it is being evaluated         */
+struct LISP$V_Client {
+  int             fd;                           /* Read (and written)   */
+  int             outFd;                        /* Written, if it's not */
+  bool            isSocket;
+  bool            isBusy;                       /* Request evaluated?   */
+  bool            isEOF;                        /* Nothing more to read */
+  bool            isClosed;                     /* Dropped already?     */
+  bool            isWaiting;                    /* Waiting for EPOLLOUT */
+  bool            isWatched;                    /* Is in the epoll set? */
+  LISP$V_Buffer   in;
+  LISP$V_Buffer   out;
+  size_t          outPos;                       /* Written of 'out'     */
+  LISP$V_Client * prev;
+  LISP$V_Client * next;
+};
+
+struct LISP$V_Server {
+  LISP$MachIns *   lmi;                         /* Template of workers  */
+  LISP$Pool *      pool;
+  int              epoll;
+  int              listener;                    /* Socket, or -1        */
+  int              done;                        /* Eventfd of workers   */
+  int              signals;                     /* Signalfd of SIGINT.. */
+  bool             isRunning;
+  LISP$V_Client *  clients;
+  LISP$V_Client *  pipe;                        /* Client of "-"        */
+
+  pthread_mutex_t  lock;                        /* Guards 'finished'    */
+  LISP$V_Request * finished;
+};
+
+
+/******************************************************
+ * Buffers
+ ******************************************************/
+
+static bool LISP$V_reserve (LISP$V_Buffer * b, size_t n) {
+
+  size_t size = (b->size > 0)? b->size : 256;
+  char * data;
+
+  if (b->length + n <= b->size) return true;
+  while (size < b->length + n) size *= 2;
+  if ((data = (char *) realloc (b->data, size)) == NULL) return false;
+
+  b->data = data;
+  b->size = size;
+  return true;
+}
+
+static bool LISP$V_append (LISP$V_Buffer * b, const char * text, size_t n) {
+
+  if (!LISP$V_reserve (b, n)) return false;
+  memcpy (b->data + b->length, text, n);
+  b->length += n;
+  return true;
+}
+
+static void LISP$V_consume (LISP$V_Buffer * b, size_t n) {
+
+  memmove (b->data, b->data + n, b->length - n);
+  b->length -= n;
+}
+
+
+/******************************************************
+ * Workers
+ ******************************************************/
+
+static void LISP$V_evaluate (LISP$MachIns * lmi, void * arg) {
+
+  LISP$V_Request * req    = (LISP$V_Request *) arg;
+  LISP$V_Server *  server = req->server;
+  uint64_t         one    = 1;
+  FILE *           out;
+
+  /* The results and the messages are written into the response */
+  if ((out = open_memstream (&(req->response),
+                             &(req->responseLength))) != NULL) {
+    LISP$M_setStreams (lmi, NULL, out);
+    LISP$M_setSinks (lmi, out, NULL);
+    LISP$S_loadText (lmi, req->text, req->length);
+    LISP$M_setSinks (lmi, NULL, NULL);
+    LISP$M_setStreams (lmi, NULL, NULL);
+    fclose (out);
+  }
+
+  pthread_mutex_lock (&(server->lock));
+  req->next        = server->finished;
+  server->finished = req;
+  pthread_mutex_unlock (&(server->lock));
+
+  while (write (server->done, &one, sizeof (one)) < 0 && errno == EINTR);
+}
+
+
+/******************************************************
+ * Clients
+ ******************************************************/
+
+static LISP$V_Client * LISP$V_addClient (LISP$V_Server * server,
+                                         int fd, int outFd, bool isSocket) {
+
+  struct epoll_event ev;
+  LISP$V_Client * c = (LISP$V_Client *) calloc (1, sizeof (LISP$V_Client));
+
+  if (c == NULL) return NULL;
+  c->fd       = fd;
+  c->outFd    = outFd;
+  c->isSocket = isSocket;
+
+  ev.events   = EPOLLIN;
+  ev.data.ptr = c;
+  if (epoll_ctl (server->epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    free (c);
+    return NULL;
+  }
+  c->isWatched = true;
+
+  if ((c->next = server->clients) != NULL) c->next->prev = c;
+  server->clients = c;
+
+  return c;
+}
+
+static void LISP$V_freeClient (LISP$V_Server * server, LISP$V_Client * c) {
+
+  if (c->prev != NULL) c->prev->next = c->next;
+  else                 server->clients = c->next;
+  if (c->next != NULL) c->next->prev = c->prev;
+
+  free (c->in.data);
+  free (c->out.data);
+  free (c);
+}
+
+/* Close the client -- it's freed once its request is done */
+static void LISP$V_drop (LISP$V_Server * server, LISP$V_Client * c) {
+
+  if (!c->isClosed) {
+    c->isClosed = true;
+    if (c->isWatched) epoll_ctl (server->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+    if (c->isSocket) close (c->fd);
+    if (c == server->pipe) server->isRunning = false;
+  }
+
+  if (!c->isBusy) LISP$V_freeClient (server, c);
+}
+
+/* Watch the socket for what the client waits for -- more requests *
+ * till the end of them, room for the responses not written yet     */
+static void LISP$V_watch (LISP$V_Server * server, LISP$V_Client * c) {
+
+  struct epoll_event ev;
+
+  ev.events   = ((c->isEOF)? 0 : EPOLLIN) | ((c->isWaiting)? EPOLLOUT : 0);
+  ev.data.ptr = c;
+
+  /* A hang-up would be reported even without any events watched */
+  if (ev.events == 0) {
+    if (c->isWatched) epoll_ctl (server->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+  }
+  else epoll_ctl (server->epoll, (c->isWatched)? EPOLL_CTL_MOD :
+                  EPOLL_CTL_ADD, c->fd, &ev);
+  c->isWatched = (ev.events != 0);
+}
+
+static void LISP$V_waitOutput (LISP$V_Server * server, LISP$V_Client * c,
+                               bool isWaiting) {
+
+  if (c->isWaiting == isWaiting) return;
+  c->isWaiting = isWaiting;
+  LISP$V_watch (server, c);
+}
+
+/* Write out what the client can take now; false if it's gone */
+static bool LISP$V_flush (LISP$V_Server * server, LISP$V_Client * c) {
+
+  ssize_t       n;
+  struct pollfd p;
+
+  while (c->outPos < c->out.length) {
+    n = (c->isSocket)?
+      send (c->fd, c->out.data + c->outPos, c->out.length - c->outPos,
+            MSG_NOSIGNAL) :
+      write (c->outFd, c->out.data + c->outPos, c->out.length - c->outPos);
+
+    if (n >= 0) c->outPos += n;
+    else if (errno == EINTR) continue;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+
+    /* The loop waits for a socket, the pipe is just waited for here */
+    else if (c->isSocket) {
+      LISP$V_waitOutput (server, c, true);
+      return true;
+    }
+    else {
+      p.fd     = c->outFd;
+      p.events = POLLOUT;
+      poll (&p, 1, -1);
+    }
+  }
+
+  c->out.length = c->outPos = 0;
+  LISP$V_waitOutput (server, c, false);
+  return true;
+}
+
+/* Pass the next line of the client to a worker, unless one is there */
+static bool LISP$V_dispatch (LISP$V_Server * server, LISP$V_Client * c) {
+
+  static const char tooLong [] =
+    "%LISP-E-TOOLONG, Request is too long!\n";
+  static const char noMemory [] =
+    "%LISP-E-NOMEM, Not enough memory for the request!\n";
+  LISP$V_Request * req;
+  char *           eol;
+  size_t           length, i;
+
+  while (!c->isBusy && c->in.length > 0) {
+    eol = (char *) memchr (c->in.data, '\n', c->in.length);
+
+    /* The last line may be unfinished */
+    if (eol == NULL && !c->isEOF) {
+      if (c->in.length <= LISP$V_REQUESTMAXLEN) return true;
+      LISP$V_append (&(c->out), tooLong, sizeof (tooLong) - 1);
+      c->in.length = 0;
+      c->isEOF     = true;
+      return true;
+    }
+    length = (eol == NULL)? c->in.length : (size_t) (eol - c->in.data);
+
+    /* Blank lines aren't requests */
+    for (i = 0; i < length && strchr (" \t\r", c->in.data [i]); i++);
+    if (i == length) {
+      LISP$V_consume (&(c->in), length + (eol != NULL));
+      continue;
+    }
+
+    req = (LISP$V_Request *) calloc (1, sizeof (LISP$V_Request));
+    if (req != NULL) req->text = (char *) malloc (length + 2);
+    if (req == NULL || req->text == NULL) {
+      if (req != NULL) free (req);
+      LISP$V_consume (&(c->in), length + (eol != NULL));
+      if (!LISP$V_append (&(c->out), noMemory, sizeof (noMemory) - 1))
+        return false;
+      continue;
+    }
+
+    /* The line ends by a newline even at the end, an atom needs it */
+    memcpy (req->text, c->in.data, length);
+    LISP$V_consume (&(c->in), length + (eol != NULL));
+    req->text [length++] = '\n';
+    req->text [length]   = '\0';
+    req->length = length;
+    req->server = server;
+    req->client = c;
+
+    if (!LISP$P_submit (server->pool, LISP$V_evaluate, req)) {
+      free (req->text);
+      free (req);
+      if (!LISP$V_append (&(c->out), noMemory, sizeof (noMemory) - 1))
+        return false;
+      continue;
+    }
+    c->isBusy = true;
+  }
+
+  return true;
+}
+
+/* Move the client on -- take its next request, write what's to be  *
+ * written, and close it when it's done                              */
+static void LISP$V_serveClient (LISP$V_Server * server, LISP$V_Client * c) {
+
+  if (c->isClosed) {
+    LISP$V_drop (server, c);
+    return;
+  }
+
+  if (!LISP$V_dispatch (server, c) || !LISP$V_flush (server, c)) {
+    LISP$V_drop (server, c);
+    return;
+  }
+
+  if (c->isEOF && !c->isBusy && c->in.length == 0 && c->out.length == 0)
+    LISP$V_drop (server, c);
+}
+
+static void LISP$V_read (LISP$V_Server * server, LISP$V_Client * c) {
+
+  ssize_t n;
+
+  while (!c->isEOF) {
+    if (!LISP$V_reserve (&(c->in), LISP$V_READSIZE)) {
+      LISP$V_drop (server, c);
+      return;
+    }
+
+    n = read (c->fd, c->in.data + c->in.length, LISP$V_READSIZE);
+    if (n > 0) c->in.length += n;
+    else if (n == 0) c->isEOF = true;
+    else if (errno == EINTR) continue;
+    else if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+    else c->isEOF = true;
+
+    /* Don't let one client fill the memory */
+    if (c->in.length > 2 * LISP$V_REQUESTMAXLEN) break;
+  }
+
+  /* Nothing more will come, so it isn't watched for it anymore */
+  if (c->isEOF && !c->isClosed) LISP$V_watch (server, c);
+
+  LISP$V_serveClient (server, c);
+}
+
+static void LISP$V_accept (LISP$V_Server * server) {
+
+  int fd;
+
+  while ((fd = accept4 (server->listener, NULL, NULL,
+                        SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0 ||
+         errno == EINTR || errno == ECONNABORTED) {
+    if (fd >= 0 && LISP$V_addClient (server, fd, fd, true) == NULL)
+      close (fd);
+  }
+}
+
+/* Take the responses made by the workers */
+static void LISP$V_finish (LISP$V_Server * server) {
+
+  static const char noMemory [] =
+    "%LISP-E-NOMEM, Not enough memory for the response!";
+  LISP$V_Request * req;
+  LISP$V_Request * next;
+  LISP$V_Client *  c;
+  uint64_t         count;
+  char *           text;
+  size_t           length, i;
+
+  while (read (server->done, &count, sizeof (count)) < 0 && errno == EINTR);
+
+  pthread_mutex_lock (&(server->lock));
+  req = server->finished;
+  server->finished = NULL;
+  pthread_mutex_unlock (&(server->lock));
+
+  for (; req != NULL; req = next) {
+    next = req->next;
+    c    = req->client;
+    c->isBusy = false;
+
+    /* The results, one per line, make a single line */
+    text   = (req->response != NULL)? req->response : (char *) noMemory;
+    length = (req->response != NULL)? req->responseLength :
+                                      sizeof (noMemory) - 1;
+    while (length > 0 && text [length - 1] == '\n') length--;
+    for (i = 0; i < length; i++)
+      if (text [i] == '\n') text [i] = ' ';
+
+    if (!c->isClosed &&
+        (!LISP$V_append (&(c->out), text, length) ||
+         !LISP$V_append (&(c->out), "\n", 1)))
+      LISP$V_drop (server, c);
+    else LISP$V_serveClient (server, c);
+
+    free (req->response);
+    free (req->text);
+    free (req);
+  }
+}
+
+
+/******************************************************
+ * Event loop
+ ******************************************************/
+
+static bool LISP$V_listen (LISP$V_Server * server, const char * path) {
+
+  struct sockaddr_un addr;
+  struct stat        st;
+  struct epoll_event ev;
+
+  if (strlen (path) >= sizeof (addr.sun_path)) {
+    errno = ENAMETOOLONG;
+    return false;
+  }
+
+  /* A socket left behind by a server killed before is replaced */
+  if (!lstat (path, &st) && S_ISSOCK (st.st_mode)) unlink (path);
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, path);
+
+  server->listener = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK |
+                             SOCK_CLOEXEC, 0);
+  if (server->listener < 0 ||
+      bind (server->listener, (struct sockaddr *) &addr, sizeof (addr)) < 0 ||
+      listen (server->listener, SOMAXCONN) < 0)
+    return false;
+
+  ev.events   = EPOLLIN;
+  ev.data.ptr = &(server->listener);
+  return (epoll_ctl (server->epoll, EPOLL_CTL_ADD, server->listener,
+                     &ev) == 0);
+}
+
+/* The standard input is a client of its own; a regular file can't be *
+ * watched by epoll, so it's read at once                              */
+static bool LISP$V_openPipe (LISP$V_Server * server) {
+
+  LISP$V_Client * c = LISP$V_addClient (server, 0, 1, false);
+
+  if (c == NULL && errno == EPERM &&
+      (c = (LISP$V_Client *) calloc (1, sizeof (LISP$V_Client))) != NULL) {
+    c->fd = 0; c->outFd = 1;
+    if ((c->next = server->clients) != NULL) c->next->prev = c;
+    server->clients = c;
+    LISP$V_read (server, c);
+  }
+
+  server->pipe = c;
+  return (c != NULL);
+}
+
+bool LISP$V_serve (LISP$MachIns * lmi, const char * path, int workers) {
+
+  LISP$V_Server      server;
+  struct epoll_event events [LISP$V_EVENTS];
+  struct epoll_event ev;
+  struct sigaction   sa, oldPipe;
+  sigset_t           mask, oldMask;
+  bool               isPipe = !strcmp (path, "-");
+  int                oldFlags = fcntl (0, F_GETFL);
+  bool               isStarted;
+  struct signalfd_siginfo info;
+  int                i, n;
+  LISP$V_Request *   req;
+  LISP$V_Client *    c;
+
+  memset (&server, 0, sizeof (server));
+  server.lmi       = lmi;
+  server.listener  = server.done = server.signals = -1;
+  server.isRunning = true;
+  pthread_mutex_init (&(server.lock), NULL);
+
+  /* Workers don't take the signals, the loop reads them from a file */
+  sigemptyset (&mask);
+  sigaddset (&mask, SIGINT);
+  sigaddset (&mask, SIGTERM);
+  pthread_sigmask (SIG_BLOCK, &mask, &oldMask);
+  memset (&sa, 0, sizeof (sa));
+  sa.sa_handler = SIG_IGN;
+  sigaction (SIGPIPE, &sa, &oldPipe);
+
+  server.epoll   = epoll_create1 (EPOLL_CLOEXEC);
+  server.done    = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  server.signals = signalfd (-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (server.epoll < 0 || server.done < 0 || server.signals < 0)
+    server.isRunning = false;
+
+  ev.events = EPOLLIN;
+  ev.data.ptr = &(server.done);
+  if (server.isRunning &&
+      epoll_ctl (server.epoll, EPOLL_CTL_ADD, server.done, &ev) < 0)
+    server.isRunning = false;
+  ev.data.ptr = &(server.signals);
+  if (server.isRunning &&
+      epoll_ctl (server.epoll, EPOLL_CTL_ADD, server.signals, &ev) < 0)
+    server.isRunning = false;
+
+  if (server.isRunning &&
+      (server.pool = LISP$P_create (lmi, workers, true)) == NULL)
+    server.isRunning = false;
+
+  if (server.isRunning) {
+    if (isPipe) fcntl (0, F_SETFL, oldFlags | O_NONBLOCK);
+    if (!((isPipe)? LISP$V_openPipe (&server) :
+                    LISP$V_listen (&server, path)))
+      server.isRunning = false;
+  }
+
+  /* A pipe read at once may have been served already, that's fine */
+  isStarted = (server.pool != NULL && (isPipe || server.isRunning));
+  if (!isStarted)
+    LISP$M_throwMessage (lmi, 'E', "SERVER", "Can't serve %s: %s",
+                         path, strerror (errno));
+  else if (!isPipe)
+    LISP$M_throwMessage (lmi, 'I', "SERVER", "Serving %s by %d workers",
+                         path, workers);
+
+  while (server.isRunning) {
+    n = epoll_wait (server.epoll, events, LISP$V_EVENTS, -1);
+    if (n < 0 && errno != EINTR) break;
+
+    for (i = 0; i < n; i++) {
+      if (events [i].data.ptr == &(server.listener))
+        LISP$V_accept (&server);
+      else if (events [i].data.ptr == &(server.done))
+        LISP$V_finish (&server);
+      else if (events [i].data.ptr == &(server.signals)) {
+        /* Taken, so it isn't delivered once it's unblocked again */
+        while (read (server.signals, &info, sizeof (info)) < 0 &&
+               errno == EINTR);
+        server.isRunning = false;
+      }
+      else {
+        c = (LISP$V_Client *) events [i].data.ptr;
+
+        /* Waiting just to write, so a hang-up means it's gone */
+        if (c->isEOF && (events [i].events & (EPOLLHUP | EPOLLERR)))
+          LISP$V_drop (&server, c);
+        else if (events [i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+          LISP$V_read (&server, c);
+        else
+          LISP$V_serveClient (&server, c);
+      }
+
+      /* A dropped pipe stops the server, so nothing is touched further */
+      if (!server.isRunning) break;
+    }
+  }
+
+  /* The workers finish what they've got, then all is dropped */
+  LISP$P_destroy (server.pool);
+  for (req = server.finished; req != NULL; req = server.finished) {
+    server.finished = req->next;
+    free (req->response);
+    free (req->text);
+    free (req);
+  }
+  while (server.clients != NULL) {
+    server.clients->isBusy = false;
+    LISP$V_drop (&server, server.clients);
+  }
+
+  if (server.listener >= 0) {
+    close (server.listener);
+    unlink (path);
+  }
+  if (server.signals >= 0) close (server.signals);
+  if (server.done >= 0)    close (server.done);
+  if (server.epoll >= 0)   close (server.epoll);
+  if (isPipe) fcntl (0, F_SETFL, oldFlags);
+
+  sigaction (SIGPIPE, &oldPipe, NULL);
+  pthread_sigmask (SIG_SETMASK, &oldMask, NULL);
+  pthread_mutex_destroy (&(server.lock));
+
+  return isStarted;
+}
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
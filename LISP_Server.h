@@ -0,0 +1,29 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Server -- Requests evaluated by a pool of LMIs
+ */
+
+#ifndef _LISP_SERVER_H_
+#define _LISP_SERVER_H_
+
+#include "LISP_Core.h"
+
+/* A request longer than this is refused and its connection closed */
+#define LISP$V_REQUESTMAXLEN  (1 << 20)
+
+/* Serve the requests of the clients of a Unix domain socket at 'path', *
+ * or of the standard input ("-"), a pipe, answering to the standard     *
+ * output. A request is a line of forms, its response is a line of their *
+ * results in the writer's format, separated by spaces (an error gives   *
+ * its %LISP message instead); the requests of one client are answered   *
+ * in order. They're evaluated by 'workers' threads, each with a copy of  *
+ * 'lmi' as it's now ($M_clone) -- a new one for each request, so nothing *
+ * is left behind by one request to another. The server runs till it's   *
+ * interrupted (SIGINT, SIGTERM) or till the input pipe ends; false is    *
+ * returned if it can't start at all                                      */
+bool LISP$V_serve (LISP$MachIns * lmi, const char * path, int workers);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -0,0 +1,442 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Writer -- Buffered output of the S-expr printer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#include "LISP_Writer.h"
+
+/* Two-digit groups for $W_formatInteger */
+static const char LISP$W_digits [] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+
+/******************************************************
+ * Buffer management
+ ******************************************************/
+
+/* Make room for 'more' chars -- a stream writer flushes, a string one *
+ * grows                                                               */
+static bool LISP$W_reserve (LISP$Writer * w, size_t more) {
+
+  size_t size;
+  char * tmp;
+
+  if (w->size - w->length >= more) return true;
+
+  if (w->stream != NULL)
+    return (LISP$W_flush (w) && w->size >= more);
+
+  for (size = (w->size)? w->size : LISP$W_BLOCK_SIZE;
+       size - w->length < more; size *= 2);
+
+  tmp = (char *) realloc (w->buffer, size);
+  if (tmp == NULL) { w->isFailed = true; return false; }
+
+  w->buffer = tmp;
+  w->size   = size;
+  return true;
+}
+
+void LISP$W_openStream (LISP$Writer * w, FILE * stream) {
+
+  w->stream   = stream;
+  w->buffer   = w->block;
+  w->size     = sizeof (w->block);
+  w->length   = 0;
+  w->isFailed = false;
+}
+
+void LISP$W_openString (LISP$Writer * w) {
+
+  w->stream   = NULL;
+  w->buffer   = NULL;
+  w->size     = 0;
+  w->length   = 0;
+  w->isFailed = !LISP$W_reserve (w, 1);
+  if (!w->isFailed) w->buffer [0] = '\0';
+}
+
+bool LISP$W_close (LISP$Writer * w) {
+
+  if (w->stream != NULL) LISP$W_flush (w);
+  else free (w->buffer);
+
+  w->buffer = NULL;
+  w->size = w->length = 0;
+
+  return (!w->isFailed);
+}
+
+bool LISP$W_flush (LISP$Writer * w) {
+
+  if (w->stream == NULL) return (!w->isFailed);
+
+  if (w->length &&
+      fwrite (w->buffer, 1, w->length, w->stream) != w->length)
+    w->isFailed = true;
+  w->length = 0;
+
+  return (!w->isFailed);
+}
+
+
+/******************************************************
+ * Output
+ ******************************************************/
+
+void LISP$W_putChar (LISP$Writer * w, char c) {
+
+  /* A string writer keeps room for its terminating '\0' */
+  if (w->size - w->length < 2 && !LISP$W_reserve (w, 2)) return;
+
+  w->buffer [w->length++] = c;
+  if (w->stream == NULL) w->buffer [w->length] = '\0';
+}
+
+void LISP$W_putString (LISP$Writer * w, const char * str, size_t length) {
+
+  /* Strings longer than a block go to the stream directly */
+  if (w->stream != NULL && length >= w->size) {
+    if (LISP$W_flush (w) && fwrite (str, 1, length, w->stream) != length)
+      w->isFailed = true;
+    return;
+  }
+
+  if (!LISP$W_reserve (w, length + 1)) return;
+
+  memcpy (w->buffer + w->length, str, length);
+  w->length += length;
+  if (w->stream == NULL) w->buffer [w->length] = '\0';
+}
+
+void LISP$W_printf (LISP$Writer * w, const char * fmt, ...) {
+
+  char    buf [512];
+  int     len;
+  va_list args;
+
+  va_start (args, fmt);
+  len = vsnprintf (buf, sizeof (buf), fmt, args);
+  va_end (args);
+
+  if (len < 0) { w->isFailed = true; return; }
+  if ((size_t) len >= sizeof (buf)) len = sizeof (buf) - 1;
+
+  LISP$W_putString (w, buf, len);
+}
+
+void LISP$W_putInteger (LISP$Writer * w, int64_t num) {
+
+  char buf [LISP$W_NUMBER_SIZE];
+  LISP$W_putString (w, buf, LISP$W_formatInteger (buf, num));
+}
+
+void LISP$W_putDouble (LISP$Writer * w, double num) {
+
+  char buf [LISP$W_NUMBER_SIZE];
+  LISP$W_putString (w, buf, LISP$W_formatDouble (buf, num));
+}
+
+
+/******************************************************
+ * Number formatting
+ ******************************************************/
+
+int LISP$W_formatInteger (char * buf, int64_t num) {
+
+  char     tmp [LISP$W_NUMBER_SIZE];
+  char *   p = tmp + sizeof (tmp);
+  uint64_t u = (num < 0)? -(uint64_t) num : (uint64_t) num;
+  int      len;
+
+  /* Two digits at a time, from the least significant ones */
+  while (u >= 100) {
+    p -= 2;
+    memcpy (p, LISP$W_digits + 2 * (u % 100), 2);
+    u /= 100;
+  }
+  if (u >= 10) { p -= 2; memcpy (p, LISP$W_digits + 2 * u, 2); }
+  else *--p = (char) ('0' + u);
+  if (num < 0) *--p = '-';
+
+  len = (int) (tmp + sizeof (tmp) - p);
+  memcpy (buf, p, len);
+  buf [len] = '\0';
+
+  return len;
+}
+
+/* Grisu2 by F. Loitsch, "Printing Floating-Point Numbers Quickly and  *
+ * Accurately with Integers" (PLDI 2010) -- the digits always read back *
+ * as the same double and they're the shortest ones in about 99.9 % of  *
+ * cases; the rest gets a digit or two more                             */
+
+/* "Do-it-yourself" floating point -- f * 2^e */
+typedef struct {
+  uint64_t f;
+  int      e;
+} LISP$W_DiyFp;
+
+/* Normalized 10^k = f * 2^e for k = -300, -292, ... 324 */
+typedef struct {
+  uint64_t f;
+  int      e;
+  int      k;
+} LISP$W_CachedPower;
+
+static const LISP$W_CachedPower LISP$W_cachedPowers [] = {
+  { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+  { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+  { 0xBE5691EF416BD60CULL, -1007, -284 },
+  { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+  { 0xD3515C2831559A83ULL,  -954, -268 },
+  { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+  { 0xEA9C227723EE8BCBULL,  -901, -252 },
+  { 0xAECC49914078536DULL,  -874, -244 },
+  { 0x823C12795DB6CE57ULL,  -847, -236 },
+  { 0xC21094364DFB5637ULL,  -821, -228 },
+  { 0x9096EA6F3848984FULL,  -794, -220 },
+  { 0xD77485CB25823AC7ULL,  -768, -212 },
+  { 0xA086CFCD97BF97F4ULL,  -741, -204 },
+  { 0xEF340A98172AACE5ULL,  -715, -196 },
+  { 0xB23867FB2A35B28EULL,  -688, -188 },
+  { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+  { 0xC5DD44271AD3CDBAULL,  -635, -172 },
+  { 0x936B9FCEBB25C996ULL,  -608, -164 },
+  { 0xDBAC6C247D62A584ULL,  -582, -156 },
+  { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+  { 0xF3E2F893DEC3F126ULL,  -529, -140 },
+  { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+  { 0x87625F056C7C4A8BULL,  -475, -124 },
+  { 0xC9BCFF6034C13053ULL,  -449, -116 },
+  { 0x964E858C91BA2655ULL,  -422, -108 },
+  { 0xDFF9772470297EBDULL,  -396, -100 },
+  { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+  { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+  { 0xB94470938FA89BCFULL,  -316,  -76 },
+  { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+  { 0xCDB02555653131B6ULL,  -263,  -60 },
+  { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+  { 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+  { 0xAA242499697392D3ULL,  -183,  -36 },
+  { 0xFD87B5F28300CA0EULL,  -157,  -28 },
+  { 0xBCE5086492111AEBULL,  -130,  -20 },
+  { 0x8CBCCC096F5088CCULL,  -103,  -12 },
+  { 0xD1B71758E219652CULL,   -77,   -4 },
+  { 0x9C40000000000000ULL,   -50,    4 },
+  { 0xE8D4A51000000000ULL,   -24,   12 },
+  { 0xAD78EBC5AC620000ULL,     3,   20 },
+  { 0x813F3978F8940984ULL,    30,   28 },
+  { 0xC097CE7BC90715B3ULL,    56,   36 },
+  { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+  { 0xD5D238A4ABE98068ULL,   109,   52 },
+  { 0x9F4F2726179A2245ULL,   136,   60 },
+  { 0xED63A231D4C4FB27ULL,   162,   68 },
+  { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+  { 0x83C7088E1AAB65DBULL,   216,   84 },
+  { 0xC45D1DF942711D9AULL,   242,   92 },
+  { 0x924D692CA61BE758ULL,   269,  100 },
+  { 0xDA01EE641A708DEAULL,   295,  108 },
+  { 0xA26DA3999AEF774AULL,   322,  116 },
+  { 0xF209787BB47D6B85ULL,   348,  124 },
+  { 0xB454E4A179DD1877ULL,   375,  132 },
+  { 0x865B86925B9BC5C2ULL,   402,  140 },
+  { 0xC83553C5C8965D3DULL,   428,  148 },
+  { 0x952AB45CFA97A0B3ULL,   455,  156 },
+  { 0xDE469FBD99A05FE3ULL,   481,  164 },
+  { 0xA59BC234DB398C25ULL,   508,  172 },
+  { 0xF6C69A72A3989F5CULL,   534,  180 },
+  { 0xB7DCBF5354E9BECEULL,   561,  188 },
+  { 0x88FCF317F22241E2ULL,   588,  196 },
+  { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+  { 0x98165AF37B2153DFULL,   641,  212 },
+  { 0xE2A0B5DC971F303AULL,   667,  220 },
+  { 0xA8D9D1535CE3B396ULL,   694,  228 },
+  { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+  { 0xBB764C4CA7A44410ULL,   747,  244 },
+  { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+  { 0xD01FEF10A657842CULL,   800,  260 },
+  { 0x9B10A4E5E9913129ULL,   827,  268 },
+  { 0xE7109BFBA19C0C9DULL,   853,  276 },
+  { 0xAC2820D9623BF429ULL,   880,  284 },
+  { 0x80444B5E7AA7CF85ULL,   907,  292 },
+  { 0xBF21E44003ACDD2DULL,   933,  300 },
+  { 0x8E679C2F5E44FF8FULL,   960,  308 },
+  { 0xD433179D9C8CB841ULL,   986,  316 },
+  { 0x9E19DB92B4E31BA9ULL,  1013,  324 }
+};
+
+#define LISP$W_CACHED_MIN_K   -300
+#define LISP$W_CACHED_STEP       8
+#define LISP$W_ALPHA           -60    /* Wanted binary exponent range */
+#define LISP$W_GAMMA           -32
+
+static LISP$W_DiyFp LISP$W_diyFp (uint64_t f, int e) {
+
+  LISP$W_DiyFp x;
+  x.f = f; x.e = e;
+  return x;
+}
+
+/* Upper 64 bits of the 128-bit product, rounded */
+static LISP$W_DiyFp LISP$W_mul (LISP$W_DiyFp x, LISP$W_DiyFp y) {
+
+  uint64_t uLo = x.f & 0xFFFFFFFFU, uHi = x.f >> 32;
+  uint64_t vLo = y.f & 0xFFFFFFFFU, vHi = y.f >> 32;
+  uint64_t p0 = uLo * vLo, p1 = uLo * vHi, p2 = uHi * vLo, p3 = uHi * vHi;
+  uint64_t q  = (p0 >> 32) + (p1 & 0xFFFFFFFFU) + (p2 & 0xFFFFFFFFU);
+
+  q += (uint64_t) 1 << 31;
+  return (LISP$W_diyFp (p3 + (p2 >> 32) + (p1 >> 32) + (q >> 32),
+                        x.e + y.e + 64));
+}
+
+static LISP$W_DiyFp LISP$W_normalize (LISP$W_DiyFp x) {
+
+  while (!(x.f >> 63)) { x.f <<= 1; x.e--; }
+  return x;
+}
+
+static int LISP$W_largestPow10 (uint32_t n, uint32_t * pow10) {
+
+  int k = 1;
+
+  for (*pow10 = 1; k < 10 && n >= *pow10 * 10; k++) *pow10 *= 10;
+  return k;
+}
+
+/* Move the last digit down towards 'w' while it stays in the range */
+static void LISP$W_round (char * buf, int len, uint64_t dist, uint64_t delta,
+                          uint64_t rest, uint64_t tenK) {
+
+  while (rest < dist && delta - rest >= tenK &&
+         (rest + tenK < dist || dist - rest > rest + tenK - dist)) {
+    buf [len - 1]--;
+    rest += tenK;
+  }
+}
+
+/* Digits of a positive finite 'num' into 'buf', the value is *
+ * buf * 10^exp10; the number of digits is returned            */
+static int LISP$W_grisu2 (char * buf, double num, int * exp10) {
+
+  uint64_t           bits, delta, dist, p2, rest;
+  uint32_t           p1, pow10, d;
+  int                bitsE, len = 0, n, m, f, k;
+  bool               isCloser;
+  LISP$W_DiyFp       v, mMinus, mPlus, one;
+  LISP$W_CachedPower c;
+
+  memcpy (&bits, &num, sizeof (bits));
+  bitsE = (int) (bits >> 52);
+  bits &= ((uint64_t) 1 << 52) - 1;
+
+  /* Boundaries halfway to the neighbouring doubles */
+  v = (bitsE)? LISP$W_diyFp (bits | ((uint64_t) 1 << 52), bitsE - 1075) :
+               LISP$W_diyFp (bits, 1 - 1075);
+  isCloser = (!bits && bitsE > 1);
+  mPlus  = LISP$W_normalize (LISP$W_diyFp (2 * v.f + 1, v.e - 1));
+  mMinus = isCloser? LISP$W_diyFp (4 * v.f - 1, v.e - 2) :
+                     LISP$W_diyFp (2 * v.f - 1, v.e - 1);
+  mMinus.f <<= mMinus.e - mPlus.e; mMinus.e = mPlus.e;
+  v = LISP$W_normalize (v);
+
+  /* Scale by a cached 10^-k so that the exponent is in [alpha, gamma] */
+  f = LISP$W_ALPHA - mPlus.e - 1;
+  k = (f * 78913) / (1 << 18) + (f > 0);
+  c = LISP$W_cachedPowers [(-LISP$W_CACHED_MIN_K + k +
+                            LISP$W_CACHED_STEP - 1) / LISP$W_CACHED_STEP];
+
+  v      = LISP$W_mul (v,      LISP$W_diyFp (c.f, c.e));
+  mMinus = LISP$W_mul (mMinus, LISP$W_diyFp (c.f, c.e));
+  mPlus  = LISP$W_mul (mPlus,  LISP$W_diyFp (c.f, c.e));
+  mMinus.f++; mPlus.f--;
+  *exp10 = -c.k;
+
+  /* Generate digits of mPlus until they're inside (mMinus, mPlus) */
+  delta = mPlus.f - mMinus.f;
+  dist  = mPlus.f - v.f;
+  one   = LISP$W_diyFp ((uint64_t) 1 << -mPlus.e, mPlus.e);
+  p1    = (uint32_t) (mPlus.f >> -one.e);
+  p2    = mPlus.f & (one.f - 1);
+
+  for (n = LISP$W_largestPow10 (p1, &pow10); n > 0; pow10 /= 10) {
+    d = p1 / pow10; p1 %= pow10;
+    buf [len++] = (char) ('0' + d);
+    n--;
+
+    rest = ((uint64_t) p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *exp10 += n;
+      LISP$W_round (buf, len, dist, delta, rest, (uint64_t) pow10 << -one.e);
+      return len;
+    }
+  }
+
+  for (m = 0; ; ) {
+    p2 *= 10;
+    buf [len++] = (char) ('0' + (p2 >> -one.e));
+    p2 &= one.f - 1;
+    m++;
+    delta *= 10; dist *= 10;
+    if (p2 <= delta) break;
+  }
+
+  *exp10 -= m;
+  LISP$W_round (buf, len, dist, delta, p2, one.f);
+  return len;
+}
+
+int LISP$W_formatDouble (char * buf, double num) {
+
+  char digits [20];
+  int  len, exp10, point, i = 0, j;
+
+  if (isnan (num))  { strcpy (buf, "nan"); return 3; }
+  if (isinf (num))  { strcpy (buf, (num < 0)? "-inf" : "inf");
+                      return ((num < 0)? 4 : 3); }
+
+  if (signbit (num)) { buf [i++] = '-'; num = -num; }
+  if (num == 0)      { strcpy (buf + i, "0.0"); return (i + 3); }
+
+  len   = LISP$W_grisu2 (digits, num, &exp10);
+  point = len + exp10;      /* Position of the decimal point */
+
+  /* 1234.5 or 1200.0 */
+  if (point > 0 && point <= 21) {
+    for (j = 0; j < point; j++) buf [i++] = (j < len)? digits [j] : '0';
+    buf [i++] = '.';
+    if (point >= len) buf [i++] = '0';
+    for (j = point; j < len; j++) buf [i++] = digits [j];
+  }
+
+  /* 0.00012 */
+  else if (point <= 0 && point > -6) {
+    buf [i++] = '0'; buf [i++] = '.';
+    for (j = point; j < 0; j++) buf [i++] = '0';
+    for (j = 0; j < len; j++) buf [i++] = digits [j];
+  }
+
+  /* 1.5e-7 or 1.0e30 */
+  else {
+    buf [i++] = digits [0]; buf [i++] = '.';
+    if (len == 1) buf [i++] = '0';
+    for (j = 1; j < len; j++) buf [i++] = digits [j];
+    buf [i++] = 'e';
+    i += LISP$W_formatInteger (buf + i, point - 1);
+  }
+
+  buf [i] = '\0';
+  return i;
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
@@ -0,0 +1,61 @@
+/*
+ * $Id: $
+ *
+ * Module:  LISP_Writer -- Buffered output of the S-expr printer
+ */
+
+#ifndef _LISP_WRITER_H_
+#define _LISP_WRITER_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A stream writer flushes its buffer by blocks of this size */
+#define LISP$W_BLOCK_SIZE   8192
+
+/* Room for any number formatted by $W_formatInteger/$W_formatDouble */
+#define LISP$W_NUMBER_SIZE  32
+
+/* Output into a stream or into a growable string; the writer never *
+ * stops on errors, it only remembers them in 'isFailed'             */
+typedef struct {
+  FILE *  stream;                               /* Flushed to, or NULL  */
+  char *  buffer;                               /* Chars not flushed    */
+  size_t  size;                                 /* Allocated 'buffer'   */
+  size_t  length;                               /* Valid chars of it    */
+  bool    isFailed;                             /* No memory or EIO?    */
+  char    block [LISP$W_BLOCK_SIZE];            /* Stream's buffer      */
+} LISP$Writer;
+
+/* Write into 'stream' by blocks */
+void LISP$W_openStream (LISP$Writer * w, FILE * stream);
+
+/* Write into a string -- it's in 'buffer' and 'length' until closed; *
+ * it's terminated by '\0' there                                      */
+void LISP$W_openString (LISP$Writer * w);
+
+/* Flush a stream writer, or free the string; false is returned if *
+ * anything has failed                                             */
+bool LISP$W_close (LISP$Writer * w);
+
+/* Pass the buffered chars to the stream */
+bool LISP$W_flush (LISP$Writer * w);
+
+void LISP$W_putChar (LISP$Writer * w, char c);
+void LISP$W_putString (LISP$Writer * w, const char * str, size_t length);
+void LISP$W_printf (LISP$Writer * w, const char * fmt, ...);
+void LISP$W_putInteger (LISP$Writer * w, int64_t num);
+void LISP$W_putDouble (LISP$Writer * w, double num);
+
+/* Format a number into 'buf' of LISP$W_NUMBER_SIZE chars and return *
+ * its length; a double is written by (almost always) the shortest   *
+ * digits that read back as the same double -- Grisu2 -- with ".0"   *
+ * if it's integral                                                  */
+int LISP$W_formatInteger (char * buf, int64_t num);
+int LISP$W_formatDouble (char * buf, double num);
+
+#endif
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
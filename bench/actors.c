@@ -0,0 +1,110 @@
+/*
+ * $Id: $
+ *
+ * Module:  actors -- Latency and throughput of SEND and RECEIVE
+ *
+ * Built and run by bench/actors.sh. An LMI spawns an actor echoing the
+ * messages back and sends it ROUNDS messages one by one, each waiting
+ * for its echo -- a ping-pong; then it spawns WORKERS actors doubling
+ * numbers, sends MESSAGES numbers to them round-robin and takes all the
+ * results back -- a fan-out. The sum of the results is checked.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../LISP_Core.h"
+
+static const char * const LISP$script =
+  "(setq echo (lambda ()\n"
+  "  (while (car (setq m (receive))) (send (car m) (cdr m)))))\n"
+  "(setq ping (lambda (to n)\n"
+  "  (dotimes (i n) (send to (cons (self) i)) (receive))))\n"
+  "(setq double (lambda ()\n"
+  "  (while (car (setq m (receive))) (send (car m) (* 2 (cdr m))))))\n"
+  "(setq fan (lambda (to n) (let ((q to) (sum 0))\n"
+  "  (dotimes (i n (dotimes (j n sum) (setq sum (+ sum (receive)))))\n"
+  "    (and (send (car q) (cons (self) i))\n"
+  "         (setq q (cond ((cdr q) (cdr q)) (t to))))))))\n"
+  "(setq stop (lambda (to)\n"
+  "  (while to (send (car to) (cons nil 0)) (setq to (cdr to)))))\n";
+
+static double LISP$now (void) {
+
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/* Evaluate 'text', the output of the last form is left in 'buf' */
+static void LISP$eval (LISP$MachIns * lmi, FILE * out, char ** buf,
+                       const char * text) {
+
+  fflush (out);
+  rewind (out);
+  (*buf) [0] = '\0';
+  LISP$S_loadText (lmi, text, strlen (text));
+  fflush (out);
+}
+
+int main (int argc, char * argv []) {
+
+  int            rounds, messages, workers, i, failed;
+  char           text [256];
+  char *         buf = NULL;
+  size_t         length = 0;
+  double         t0, t1, t2, t3;
+  long long      sum;
+  FILE *         out = open_memstream (&buf, &length);
+  LISP$MachIns * lmi;
+
+  if (argc != 4 || (rounds = atoi (argv [1])) < 1 ||
+      (messages = atoi (argv [2])) < 1 || (workers = atoi (argv [3])) < 1) {
+    fprintf (stderr, "Usage: %s ROUNDS MESSAGES WORKERS\n", argv [0]);
+    return 1;
+  }
+
+  lmi = LISP$M_init (NULL, NULL, out, true);
+  LISP$M_setSinks (lmi, stderr, NULL);
+  lmi->isEchoed = false;
+  LISP$S_loadFile (lmi, "startup.lisp");
+  LISP$S_loadText (lmi, LISP$script, strlen (LISP$script));
+  lmi->isEchoed = true;
+
+  /* Ping-pong */
+  LISP$eval (lmi, out, &buf, "(setq e (list (spawn echo)))\n");
+  snprintf (text, sizeof (text), "(ping (car e) %d)\n", rounds);
+  t0 = LISP$now ();
+  LISP$eval (lmi, out, &buf, text);
+  t1 = LISP$now ();
+  LISP$eval (lmi, out, &buf, "(stop e)\n");
+
+  /* Fan-out */
+  LISP$eval (lmi, out, &buf, "(setq w nil)\n");
+  for (i = 0; i < workers; i++)
+    LISP$eval (lmi, out, &buf, "(setq w (cons (spawn double) w))\n");
+  snprintf (text, sizeof (text), "(fan w %d)\n", messages);
+  t2 = LISP$now ();
+  LISP$eval (lmi, out, &buf, text);
+  t3 = LISP$now ();
+  sum = atoll (buf);
+  LISP$eval (lmi, out, &buf, "(stop w)\n");
+
+  printf ("BENCH ROUNDTRIP %.2f\n", (t1 - t0) / rounds * 1e6);
+  printf ("BENCH RATE %.1f\n", messages / (t3 - t2));
+  printf ("BENCH SUM %lld\n", sum);
+  failed = (sum != (long long) messages * (messages - 1) ||
+            lmi->errorCount > 0);
+  printf ("BENCH FAILED %d\n", failed);
+
+  LISP$M_destroy (lmi);
+  fclose (out);
+  free (buf);
+
+  return failed;
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
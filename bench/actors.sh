@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  actors -- Ping-pong latency and fan-out throughput of actors
+#
+# Usage: bench/actors.sh [ROUNDS] [MESSAGES] [WORKERS]
+# bench/actors.c is built against the sources; it times ROUNDS messages
+# bounced off an actor one by one, then MESSAGES numbers sent round-robin
+# to WORKERS actors (the CPUs online by default) and all their results
+# received back. Each message is packed by SEND and unpacked by RECEIVE;
+# the run fails if the results don't add up.
+
+CC=${CC:-gcc}
+ROUNDS=${1:-20000}
+MESSAGES=${2:-100000}
+WORKERS=${3:-$(getconf _NPROCESSORS_ONLN 2> /dev/null || echo 1)}
+DIR=${TMPDIR:-/tmp}/lisp-bench-actors.$$
+
+trap 'rm -rf "$DIR"' EXIT
+mkdir -p "$DIR"
+
+$CC -O2 -w -D_HAS_RDLN_=1 -o "$DIR/actors" bench/actors.c \
+    $(ls *.c | grep -v '^LISP_Main\.c$') -lreadline -lm -lpthread || exit 1
+
+"$DIR/actors" "$ROUNDS" "$MESSAGES" "$WORKERS" |
+  awk -v w="$WORKERS" '
+    $2 == "ROUNDTRIP" { rt = $3 }
+    $2 == "RATE"      { rate = $3 }
+    $2 == "FAILED"    { failed = $3 }
+    END {
+      printf "  %-12s %10.2f us a round trip\n", "PING-PONG", rt
+      printf "  %-12s %10.1f messages/s\n", "FAN-OUT/" w, rate
+      printf "  %-12s %10d\n", "FAILED", failed
+      exit (failed != 0)
+    }'
@@ -0,0 +1,51 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  batch -- Many small forms piped in, the REPL against a batch
+#
+# Usage: bench/batch.sh [THOUSANDS-OF-FORMS]
+# The forms are fed to the REPL from a file, then to a batch (-b) from the
+# file and through a pipe, which is read by lines and gets each result
+# flushed. The wall time of each run is measured, the startup included.
+# Before that, -e and - are checked to read the last atom of their input
+# even if no new line ends it.
+
+LISP=${LISP:-bin/LISP}
+K=${1:-20}
+DATA=${TMPDIR:-/tmp}/lisp-bench-batch.$$.lisp
+
+trap 'rm -f "$DATA"' EXIT
+
+awk -v n=$((K * 1000)) 'BEGIN {
+  for (i = 0; i < n; i++) printf "(+ %d (* %d 2))\n", i, i
+}' > "$DATA"
+
+# run NAME COMMAND -- print the wall time of COMMAND
+run () {
+  t0=$(date +%s.%N)
+  sh -c "$2" > /dev/null 2>&1
+  t1=$(date +%s.%N)
+  echo "$1 $t0 $t1" |
+    awk -v n=$((K * 1000)) '{ printf "  %-12s %10.3f s %10.2f k forms/s\n",
+                                $1, $3 - $2, n / 1000 / ($3 - $2) }'
+}
+
+# check COMMAND EXPECTED -- fail unless COMMAND prints the EXPECTED lines
+check () {
+  out=$(sh -c "$1" 2>&1 | tr '\n' ' ')
+  if [ "$out" != "$2" ]; then
+    echo "$1: got '$out', expected '$2'" >&2
+    exit 1
+  fi
+}
+
+check "\"$LISP\" --no-startup -e 42"                  "42 "
+check "\"$LISP\" --no-startup -e '(setq x 2) (+ x 1) x'" "2 3 2 "
+check "printf 42 | \"$LISP\" --no-startup -"          "42 "
+check "printf '(+ 1 2) 42' | \"$LISP\" --no-startup -" "3 42 "
+
+echo "Evaluating $K thousand forms:"
+run REPL  "\"$LISP\" < \"$DATA\""
+run BATCH "\"$LISP\" -b < \"$DATA\""
+run PIPE  "cat \"$DATA\" | \"$LISP\" -b"
@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  bignum -- big integer arithmetic and printing
+#
+# Usage: bench/bignum.sh [N [REPEAT-COUNT]]
+# (FACTORIAL N) is the recursive definition from startup.lisp, so the C
+# stack limit is raised for it -- the evaluator stops with STKFUL when the
+# stack isn't deep enough. Squaring the result multiplies two equally long
+# numbers, which is where Karatsuba takes over; printing is the conversion
+# to decimal digits.
+
+LISP=${LISP:-bin/LISP}
+N=${1:-10000}
+REPS=${2:-5}
+SRC=${TMPDIR:-/tmp}/lisp-bench-bignum.$$.lisp
+
+trap 'rm -f "$SRC"' EXIT
+
+ulimit -s 65536 2>/dev/null || ulimit -s unlimited 2>/dev/null
+
+# repeat NAME FORM -- each repetition is a separate top-level form
+repeat () {
+  i=0
+  echo "(setq bench\$t0 (getlpi cputim))"
+  while [ $i -lt "$REPS" ]; do echo "$2"; i=$((i + 1)); done
+  echo "(list 'BENCH '$1 (/ (- (getlpi cputim) bench\$t0) $REPS))"
+}
+
+{
+  echo "(setq f (factorial $N))"
+  repeat FACTORIAL "(is (factorial $N) nil)"
+  repeat SQUARE    "(is (* f f) nil)"
+  repeat DIVIDE    "(is (/ (* f f) f) nil)"
+  repeat PRINT     "f"
+} > "$SRC"
+
+echo "(FACTORIAL $N), $REPS repetitions:"
+"$LISP" "$SRC" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk '{ printf "  %-12s %12.3e s\n", $1, $2 }'
@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  binary -- binary dump vs. text of the same S-expression
+#
+# Usage: bench/binary.sh [MEGABYTES]
+# The generated text is one quoted list of numbers, atoms, strings and
+# nested lists assigned to a variable; it's LOADed, written by
+# WRITE-BINARY and read back by READ-BINARY, so LOAD and READ-BINARY build
+# the very same structure.
+
+LISP=${LISP:-bin/LISP}
+MB=${1:-8}
+SRC=${TMPDIR:-/tmp}/lisp-bench-binary.$$.lisp
+DATA=${TMPDIR:-/tmp}/lisp-bench-binary.$$.data
+DUMP=${TMPDIR:-/tmp}/lisp-bench-binary.$$.dump
+
+trap 'rm -f "$SRC" "$DATA" "$DUMP"' EXIT
+
+awk -v bytes=$((MB * 1048576)) 'BEGIN {
+  print "(is (setq data (quote ("
+  for (n = 0; n < bytes; ) {
+    line = sprintf ("  (item-%d %d %d.25 \"string %d\" (nested (list %d)))",
+                    i % 1000, i, i, i, i)
+    print line; n += length (line) + 1; i++
+  }
+  print "))) nil)"
+}' > "$DATA"
+
+# Each one is timed inside a single form, so that the collection run
+# after the form isn't counted
+timed () {
+  echo "(list 'BENCH '$1 (- (car (cdr (cdr (list"
+  echo "  (setq bench\$t0 (getlpi cputim)) (is $2 nil) (getlpi cputim)))))"
+  echo "  bench\$t0))"
+}
+
+{
+  timed LOAD "(load \"$DATA\")"
+  timed WRITE-BINARY "(write-binary data \"$DUMP\")"
+  echo "(setq data nil)"
+  timed READ-BINARY "(setq data (read-binary \"$DUMP\"))"
+} > "$SRC"
+
+echo "$(wc -c < "$DATA") bytes of text:"
+"$LISP" "$SRC" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk '{ printf "  %-14s %10.3f s\n", $1, $2 }'
+echo "$(wc -c < "$DUMP") bytes of binary dump"
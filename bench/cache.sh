@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  cache -- LOAD of a library with and without its .lispc cache
+#
+# Usage: bench/cache.sh [THOUSANDS-OF-FUNCTIONS]
+# The generated library defines the given number of functions; it's LOADed
+# from the text with LISP$CACHE disabled, then once to make the cache and
+# a few times from the cache. The GC is disabled, the collection after
+# each form would take most of the time otherwise.
+
+LISP=${LISP:-bin/LISP}
+K=${1:-20}
+DIR=${TMPDIR:-/tmp}/lisp-bench-cache.$$
+RUNS=5
+
+trap 'rm -rf "$DIR"' EXIT
+mkdir -p "$DIR"
+
+awk -v n=$((K * 1000)) 'BEGIN {
+  for (i = 0; i < n; i++)
+    printf "(setq f-%d (lambda (x y) ; function %d\n" \
+           "  (cond ((< x y) (list x y %d 2.5 (quote (a b c))))\n" \
+           "        (t (list y x \"string %d\" 1.0e-3)))))\n", i, i, i, i
+}' > "$DIR/lib.lisp"
+
+# load NAME -- time one LOAD of the library
+load () {
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(load \"$DIR/lib.lisp\")"
+  echo "(list 'BENCH '$1 (- (getlpi cputim) bench\$t0))"
+}
+
+{
+  echo "(setq lisp\$gc nil)"
+  echo "(setq lisp\$cache nil)"
+  load TEXT
+  echo "(setq lisp\$cache t)"
+  load MAKE-CACHE
+  i=0; while [ $i -lt $RUNS ]; do load CACHED; i=$((i + 1)); done
+} > "$DIR/bench.lisp"
+
+# The cache of a file changed just now is checked by the content hash
+touch -t 202001010000 "$DIR/lib.lisp"
+
+echo "$(wc -c < "$DIR/lib.lisp") bytes of $K thousand functions:"
+"$LISP" "$DIR/bench.lisp" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk '{ t [$1] += $2; n [$1]++ }
+       END { for (k in t) printf "  %-12s %10.3f s\n", k, t [k] / n [k] }' |
+  sort
+echo "$(wc -c < "$DIR/lib.lispc") bytes of cache"
@@ -0,0 +1,55 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  futures -- Fan-out of CPU-bound calls, with and without FUTURE
+#
+# Usage: bench/futures.sh [CALLS] [FIB-OF-EACH]
+# A single (+ ...) sums CALLS naive (FIB n) calls -- evaluated one by one,
+# then each of them wrapped in a FUTURE, with 1, 2, 4 and as many workers
+# as there are CPUs online; the futures which find no idle worker are
+# evaluated by the caller. All the runs have to print the same sum; the
+# speed-up is against the plain one.
+
+LISP=${LISP:-bin/LISP}
+N=${1:-8}
+FIB=${2:-22}
+CPUS=$(getconf _NPROCESSORS_ONLN 2> /dev/null || echo 1)
+DATA=${TMPDIR:-/tmp}/lisp-bench-futures.$$
+
+trap 'rm -f "$DATA".*' EXIT
+
+# script [WRAP] -- the script summing the calls, each one in (WRAP ...)
+script () {
+  awk -v n=$N -v fib=$FIB -v wrap="$1" 'BEGIN {
+    print "(SETQ FIB (LAMBDA (N) (COND ((< N 2) N)"
+    print "  (T (+ (FIB (- N 1)) (FIB (- N 2)))))))"
+    printf "(+"
+    for (i = 0; i < n; i++)
+      if (wrap == "") printf " (FIB %d)", fib
+      else printf " (%s (FIB %d))", wrap, fib
+    print ")"
+  }'
+}
+script > "$DATA.seq"
+script FUTURE > "$DATA.par"
+
+# run NAME WORKERS SCRIPT -- print the wall time and the sum
+run () {
+  t0=$(date +%s.%N)
+  sum=$("$LISP" -b --workers $2 "$3" 2> /dev/null | tail -n 1)
+  t1=$(date +%s.%N)
+  echo "$1 $t0 $t1 $sum" |
+    awk -v base="$BASE" '{ t = $3 - $2
+                           printf "  %-12s %10.3f s %8.2fx   %s\n", $1, t,
+                                  (base > 0)? base / t : 1, $4 }'
+  [ -z "$BASE" ] && BASE=$(echo "$t0 $t1" | awk '{ print $2 - $1 }')
+}
+
+echo "Summing $N calls of (FIB $FIB) on $CPUS CPUs:"
+BASE=
+run PLAIN 1 "$DATA.seq"
+for w in $(printf "%s\n" 1 2 4 $CPUS | sort -nu); do
+  run "FUTURE/$w" $w "$DATA.par"
+done
+exit 0
@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  lists -- native list built-ins vs. their former LISP versions
+#
+# Usage: bench/lists.sh [LIST-LENGTH [REPEAT-COUNT]]
+# Each measured call is a separate top-level form, so the garbage
+# collector runs between repetitions.
+
+LISP=${LISP:-bin/LISP}
+N=${1:-20}
+REPS=${2:-200}
+SRC=${TMPDIR:-/tmp}/lisp-bench-lists.$$.lisp
+
+trap 'rm -f "$SRC"' EXIT
+
+repeat () {
+  i=0
+  echo "(setq bench\$t0 (getlpi cputim))"
+  while [ $i -lt "$REPS" ]; do echo "(is $2 nil)"; i=$((i + 1)); done
+  echo "(list 'BENCH '$1 (/ (- (getlpi cputim) bench\$t0) $REPS))"
+}
+
+{
+  cat <<'LISP'
+; The LISP list library as it was in startup.lisp before going native
+(setq lisp-append (lambda (x y)
+  (cond ((is x nil) y)
+        ((isatom x) (cons x y))
+        (t (cons (car x) (lisp-append (cdr x) y))))))
+
+(setq lisp-reverse (lambda (x)
+  (cond ((isatom x) x)
+        (t (lisp-append (lisp-reverse (cdr x)) (cons (car x) nil))))))
+
+(setq lisp-sort (lambda (x)
+   (cond ((is nil x) x)
+         (t (merge (car x) (lisp-sort (cdr x)))))))
+
+(setq lisp-member (lambda (a s)
+  (cond ((is s nil)     nil)
+        ((is a (car s)) t)
+        (t (lisp-member a (cdr s))))))
+
+(setq iota (lambda (n)
+  (cond ((= n 0) nil)
+        (t (cons (% (* n 7919) 101) (iota (- n 1)))))))
+LISP
+  echo "(setq data (iota $N))"
+  repeat lisp-append  "(lisp-append data data)"
+  repeat APPEND       "(append data data)"
+  repeat lisp-reverse "(lisp-reverse data)"
+  repeat REVERSE      "(reverse data)"
+  repeat lisp-sort    "(lisp-sort data)"
+  repeat SORT         "(sort data)"
+  repeat lisp-member  "(lisp-member 'none data)"
+  repeat MEMBER       "(member 'none data)"
+} > "$SRC"
+
+echo "List length $N, $REPS repetitions, CPU seconds per call:"
+"$LISP" "$SRC" < /dev/null | sed -n 's/^.*<-- (BENCH \(.*\))$/  \1/p'
@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  log -- Many warnings thrown, the log disabled against enabled
+#
+# Usage: bench/log.sh [THOUSANDS-OF-FORMS]
+# Each form raises a warning, which goes to stderr and, with the LISP$LOG
+# set to T, to the log as well. Set LISP_DBG to a binary built with
+# -DDEBUG_LMI (make bin/LISP_dbgLMI) to time it too -- it logs a trace of
+# each atom lookup. The log file next to the binary grows by each run.
+
+LISP=${LISP:-bin/LISP}
+K=${1:-20}
+DATA=${TMPDIR:-/tmp}/lisp-bench-log.$$.lisp
+
+trap 'rm -f "$DATA" "$DATA.on"' EXIT
+
+awk -v n=$((K * 1000)) 'BEGIN {
+  for (i = 0; i < n; i++) printf "(CAR %d)\n", i
+}' > "$DATA"
+{ echo '(SETQ LISP$LOG T)'; cat "$DATA"; } > "$DATA.on"
+
+# run NAME COMMAND -- print the wall time of COMMAND
+run () {
+  t0=$(date +%s.%N)
+  sh -c "$2" > /dev/null 2>&1
+  t1=$(date +%s.%N)
+  echo "$1 $t0 $t1" |
+    awk -v n=$((K * 1000)) '{ printf "  %-12s %10.3f s %10.2f k forms/s\n",
+                                $1, $3 - $2, n / 1000 / ($3 - $2) }'
+}
+
+echo "Throwing $K thousand warnings:"
+run NOLOG "\"$LISP\" -b < \"$DATA\""
+run LOG   "\"$LISP\" -b < \"$DATA.on\""
+[ -n "$LISP_DBG" ] && run DEBUG "\"$LISP_DBG\" -b < \"$DATA\""
+exit 0
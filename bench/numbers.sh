@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  numbers -- numeric token parsing throughput
+#
+# Usage: bench/numbers.sh [MILLIONS-OF-NUMBERS]
+# Each generated file holds integers, decimals or numbers with an exponent
+# in quoted lists of 10000 numbers, which are read and thrown away by IS,
+# so the time is spent in the reader, in the number table and in the GC
+# between the lists.
+
+LISP=${LISP:-bin/LISP}
+M=${1:-10}
+DIR=${TMPDIR:-/tmp}/lisp-bench-numbers.$$
+
+trap 'rm -rf "$DIR"' EXIT
+mkdir -p "$DIR"
+
+# generate KIND FORMAT -- M millions of random numbers
+generate () {
+  awk -v n=$((M * 1000000)) -v fmt="$2" 'BEGIN {
+    srand (1)
+    for (i = 0; i < n; i++) {
+      if (i % 10000 == 0) printf "%s(is (quote (", (i? ")) nil)\n" : "")
+      x = rand ()
+      printf fmt "\n", (fmt ~ /d/)? int (x * 2 ^ 53) : x * 1000000, x
+    }
+    print ")) nil)"
+  }' > "$DIR/$1.data"
+
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(load \"$DIR/$1.data\")"
+  echo "(list 'BENCH '$1 (- (getlpi cputim) bench\$t0))"
+}
+
+{
+  generate INTEGERS  "%d"
+  generate DECIMALS  "%.6f"
+  generate EXPONENTS "%.15e"
+} > "$DIR/bench.lisp"
+
+echo "Reading $M million numbers of each kind:"
+"$LISP" "$DIR/bench.lisp" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk -v n="$M" '{ printf "  %-12s %10.3f s %10.2f M numbers/s\n",
+                     $1, $2, n / $2 }'
@@ -0,0 +1,54 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  pmap -- CPU-bound MAP and REDUCE against PMAP and PREDUCE
+#
+# Usage: bench/pmap.sh [ITEMS] [FIB-OF-EACH]
+# Each item of the list costs a naive (FIB n); it's mapped by MAP on a
+# single LMI, then by PMAP with 1, 2, 4 and as many workers as there are
+# CPUs online, and the results are summed by REDUCE and PREDUCE. All the
+# runs have to print the same sum; the speed-up is against MAP, it can't
+# get above the number of CPUs.
+
+LISP=${LISP:-bin/LISP}
+N=${1:-64}
+FIB=${2:-16}
+CPUS=$(getconf _NPROCESSORS_ONLN 2> /dev/null || echo 1)
+DATA=${TMPDIR:-/tmp}/lisp-bench-pmap.$$
+
+trap 'rm -f "$DATA".*' EXIT
+
+# script MAP REDUCE -- the script mapping and summing by the built-ins
+script () {
+  awk -v n=$N -v fib=$FIB -v map=$1 -v reduce=$2 'BEGIN {
+    print "(SETQ FIB (LAMBDA (N) (COND ((< N 2) N)"
+    print "  (T (+ (FIB (- N 1)) (FIB (- N 2)))))))"
+    printf "(SETQ ITEMS (QUOTE ("
+    for (i = 0; i < n; i++) printf " %d", fib
+    print ")))"
+    printf "(%s + 0 (%s FIB ITEMS))\n", reduce, map
+  }'
+}
+script MAP REDUCE > "$DATA.seq"
+script PMAP PREDUCE > "$DATA.par"
+
+# run NAME WORKERS SCRIPT -- print the wall time and the sum
+run () {
+  t0=$(date +%s.%N)
+  sum=$("$LISP" -b --workers $2 "$3" 2> /dev/null | tail -n 1)
+  t1=$(date +%s.%N)
+  echo "$1 $t0 $t1 $sum" |
+    awk -v base="$BASE" '{ t = $3 - $2
+                           printf "  %-12s %10.3f s %8.2fx   %s\n", $1, t,
+                                  (base > 0)? base / t : 1, $4 }'
+  [ -z "$BASE" ] && BASE=$(echo "$t0 $t1" | awk '{ print $2 - $1 }')
+}
+
+echo "Mapping (FIB $FIB) over $N items on $CPUS CPUs:"
+BASE=
+run MAP 1 "$DATA.seq"
+for w in $(printf "%s\n" 1 2 4 $CPUS | sort -nu); do
+  run "PMAP/$w" $w "$DATA.par"
+done
+exit 0
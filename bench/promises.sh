@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  promises -- Forcing lazy streams of CONS-STREAM
+#
+# Usage: bench/promises.sh [THOUSANDS-OF-ITEMS]
+# A stream of integers is walked by STREAM-CDR twice -- the first walk
+# forces the promises, the second one gets their memoized values -- and
+# then summed up by REDUCE over a FILTER of a fresh stream, whose cells
+# are collected as it goes.
+
+LISP=${LISP:-bin/LISP}
+K=${1:-100}
+SRC=${TMPDIR:-/tmp}/lisp-bench-promises.$$.lisp
+
+trap 'rm -f "$SRC" "${SRC}c"' EXIT
+
+# walk NAME -- time a walk of the stream S to its item number N
+walk () {
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(setq x s)"
+  echo "(dotimes (i n) (setq x (stream-cdr x)))"
+  echo "(list 'BENCH '$1 (- (getlpi cputim) bench\$t0))"
+}
+
+{
+  echo "(setq n $((K * 1000)))"
+  echo "(setq ints (lambda (k) (cons-stream k (ints (+ k 1)))))"
+  echo "(setq s (ints 0))"
+  walk FORCE
+  walk MEMOIZED
+  echo "(setq s nil)"
+  echo "(setq x nil)"
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(setq f (lambda (k) (cond ((< k n) (cons-stream k (f (+ k 1)))))))"
+  echo "(reduce (lambda (a x) (+ a x)) 0"
+  echo "  (filter (lambda (x) (= (% x 3) 0)) (f 0)))"
+  echo "(list 'BENCH 'REDUCE (- (getlpi cputim) bench\$t0))"
+} > "$SRC"
+
+echo "Walking $K thousand items of a stream:"
+"$LISP" "$SRC" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk -v n=$((K * 1000)) '{ printf "  %-12s %10.3f s %10.2f M items/s\n",
+                              $1, $2, n / 1000000 / $2 }'
@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  reader -- S-expr parsing throughput
+#
+# Usage: bench/reader.sh [MEGABYTES]
+# The generated file is one quoted list of numbers, atoms, strings and
+# nested lists, which is read and thrown away by IS, so the time is spent
+# in the reader and the GC.
+
+LISP=${LISP:-bin/LISP}
+MB=${1:-8}
+SRC=${TMPDIR:-/tmp}/lisp-bench-reader.$$.lisp
+DATA=${TMPDIR:-/tmp}/lisp-bench-reader.$$.data
+
+trap 'rm -f "$SRC" "$DATA"' EXIT
+
+awk -v bytes=$((MB * 1048576)) 'BEGIN {
+  print "(is (quote ("
+  for (n = 0; n < bytes; ) {
+    line = sprintf ("  (item-%d %d %d.25 \"string %d\" (nested (list %d)))",
+                    i % 1000, i, i, i, i)
+    print line; n += length (line) + 1; i++
+  }
+  print ")) nil)"
+}' > "$DATA"
+
+{
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(load \"$DATA\")"
+  echo "(list 'BENCH 'READ (- (getlpi cputim) bench\$t0))"
+} > "$SRC"
+
+SIZE=$(wc -c < "$DATA")
+echo "Reading $SIZE bytes:"
+"$LISP" "$SRC" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk -v size="$SIZE" '{ printf "  %-12s %10.3f s %10.2f MB/s\n",
+                           $1, $2, size / 1048576 / $2 }'
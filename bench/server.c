@@ -0,0 +1,161 @@
+/*
+ * $Id: $
+ *
+ * Module:  server -- Load generator of LISP --serve
+ *
+ * Built and run by bench/server.sh. CLIENTS threads connect to the socket
+ * and each of them sends REQUESTS lines of REQUEST, one by one, waiting
+ * for the response of each; the latencies of all the requests are sorted
+ * then for their percentiles. Any response other than the first one
+ * counts as a failure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+typedef struct {
+  pthread_t  thread;
+  double *   latencies;
+  int        failed;
+} LISP$Client;
+
+static const char * LISP$path;
+static char *       LISP$request;
+static int          LISP$requests;
+static char         LISP$expected [4096];
+
+static double LISP$now (void) {
+
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/* Read a line of the response, without the newline; false at the end */
+static int LISP$readLine (int fd, char * buf, size_t size) {
+
+  size_t  n = 0;
+  ssize_t r;
+
+  for (;;) {
+    if ((r = read (fd, buf + n, 1)) <= 0) return 0;
+    if (buf [n] == '\n') break;
+    if (n < size - 1) n++;
+  }
+  buf [n] = '\0';
+  return 1;
+}
+
+static void * LISP$runClient (void * arg) {
+
+  LISP$Client *      c = (LISP$Client *) arg;
+  struct sockaddr_un addr;
+  char               buf [4096];
+  size_t             length = strlen (LISP$request);
+  double             t;
+  int                i, fd;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strncpy (addr.sun_path, LISP$path, sizeof (addr.sun_path) - 1);
+
+  fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0) {
+    perror (LISP$path);
+    c->failed = LISP$requests;
+    return NULL;
+  }
+
+  for (i = 0; i < LISP$requests; i++) {
+    t = LISP$now ();
+    if (write (fd, LISP$request, length) != (ssize_t) length ||
+        !LISP$readLine (fd, buf, sizeof (buf))) {
+      c->failed += LISP$requests - i;
+      break;
+    }
+    c->latencies [i] = LISP$now () - t;
+    if (strcmp (buf, LISP$expected)) c->failed++;
+  }
+
+  close (fd);
+  return NULL;
+}
+
+static int LISP$compare (const void * a, const void * b) {
+
+  double x = *(const double *) a, y = *(const double *) b;
+
+  return ((x > y) - (x < y));
+}
+
+int main (int argc, char * argv []) {
+
+  int           i, n, clients, failed = 0;
+  double        t0, t1;
+  double *      all;
+  LISP$Client * c;
+
+  if (argc != 5 || (clients = atoi (argv [2])) < 1 ||
+      (LISP$requests = atoi (argv [3])) < 1) {
+    fprintf (stderr, "Usage: %s SOCKET CLIENTS REQUESTS REQUEST\n", argv [0]);
+    return 1;
+  }
+  LISP$path    = argv [1];
+  LISP$request = (char *) malloc (strlen (argv [4]) + 2);
+  sprintf (LISP$request, "%s\n", argv [4]);
+
+  /* The first response is the one expected of all */
+  {
+    struct sockaddr_un addr;
+    int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+    memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    strncpy (addr.sun_path, LISP$path, sizeof (addr.sun_path) - 1);
+    if (fd < 0 || connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0 ||
+        write (fd, LISP$request, strlen (LISP$request)) < 0 ||
+        !LISP$readLine (fd, LISP$expected, sizeof (LISP$expected))) {
+      perror (LISP$path);
+      return 1;
+    }
+    close (fd);
+  }
+
+  c   = (LISP$Client *) calloc (clients, sizeof (LISP$Client));
+  all = (double *) malloc (clients * LISP$requests * sizeof (double));
+  for (i = 0; i < clients; i++)
+    c [i].latencies = all + i * LISP$requests;
+
+  t0 = LISP$now ();
+  for (i = 0; i < clients; i++)
+    pthread_create (&(c [i].thread), NULL, LISP$runClient, &(c [i]));
+  for (i = 0; i < clients; i++) {
+    pthread_join (c [i].thread, NULL);
+    failed += c [i].failed;
+  }
+  t1 = LISP$now ();
+
+  n = clients * LISP$requests;
+  qsort (all, n, sizeof (double), LISP$compare);
+
+  printf ("BENCH RESPONSE %s\n", LISP$expected);
+  printf ("BENCH RATE %.1f\n", n / (t1 - t0));
+  printf ("BENCH P50 %.1f\n", all [n / 2] * 1e6);
+  printf ("BENCH P99 %.1f\n", all [(int) (n * 0.99)] * 1e6);
+  printf ("BENCH FAILED %d\n", failed);
+
+  free (all);
+  free (c);
+  free (LISP$request);
+
+  return (failed > 0);
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
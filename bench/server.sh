@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  server -- Requests to LISP --serve against a LISP per request
+#
+# Usage: bench/server.sh [CLIENTS] [REQUESTS-PER-CLIENT] [WORKERS]
+# A server with WORKERS copies of LISP (the CPUs online by default) is
+# started on a socket, bench/server.c is built and CLIENTS connections
+# send it their requests one by one; the rate and the latencies are
+# compared with a LISP started for each of 200 requests, as a process per
+# request would do.
+
+CC=${CC:-gcc}
+LISP=${LISP:-bin/LISP}
+CLIENTS=${1:-8}
+REQUESTS=${2:-2000}
+WORKERS=${3:-}
+DIR=${TMPDIR:-/tmp}/lisp-bench-server.$$
+SOCK=$DIR/lisp.sock
+REQUEST='(setq f (lambda (n) (cond ((< n 2) n) (t (+ (f (- n 1)) (f (- n 2))))))) (f 12)'
+
+trap 'kill $PID 2>/dev/null; rm -rf "$DIR"' EXIT
+mkdir -p "$DIR"
+
+$CC -O2 -o "$DIR/server" bench/server.c -lpthread || exit 1
+
+"$LISP" --serve "$SOCK" ${WORKERS:+--workers $WORKERS} 2> /dev/null &
+PID=$!
+i=0
+while [ ! -S "$SOCK" ] && [ $i -lt 100 ]; do sleep 0.05; i=$((i + 1)); done
+
+echo "Serving $CLIENTS clients, $REQUESTS requests each:"
+"$DIR/server" "$SOCK" "$CLIENTS" "$REQUESTS" "$REQUEST" |
+  awk '$2 == "RESPONSE" { sub (/^BENCH RESPONSE /, ""); printf "  %-12s %s\n", "RESPONSE", $0 }
+       $2 == "RATE"     { printf "  %-12s %10.1f requests/s\n", "SERVER", $3 }
+       $2 == "P50"      { printf "  %-12s %10.1f us\n", "P50", $3 }
+       $2 == "P99"      { printf "  %-12s %10.1f us\n", "P99", $3 }
+       $2 == "FAILED"   { printf "  %-12s %10d\n", "FAILED", $3 }'
+
+t0=$(date +%s.%N)
+i=0
+while [ $i -lt 200 ]; do
+  "$LISP" -e "$REQUEST" > /dev/null 2>&1
+  i=$((i + 1))
+done
+t1=$(date +%s.%N)
+echo "$t0 $t1" |
+  awk '{ printf "  %-12s %10.1f requests/s %10.1f us each\n",
+           "PROCESS", 200 / ($2 - $1), ($2 - $1) / 200 * 1e6 }'
@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  streams -- Throughput of READ/READLN/WRITE/WRITELN on files
+#
+# Usage: bench/streams.sh [THOUSANDS-OF-RECORDS]
+# A file of records is copied line by line by READLN/WRITELN, then read
+# form by form by READ and written back by WRITE, each time through the
+# streams of OPEN; at last the records are summed up lazily by REDUCE over
+# a FILTER of READ-FORMS.
+
+LISP=${LISP:-bin/LISP}
+K=${1:-100}
+DIR=${TMPDIR:-/tmp}/lisp-bench-streams.$$
+
+trap 'rm -rf "$DIR"' EXIT
+mkdir -p "$DIR"
+
+awk -v n=$((K * 1000)) 'BEGIN {
+  for (i = 0; i < n; i++)
+    printf "(record %d \"name %d\" %.6f (a b c))\n", i, i, i / 7
+}' > "$DIR/data"
+
+# copy NAME READ WRITE -- time a copy of the data by READ and WRITE
+copy () {
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(setq i (open \"$DIR/data\"))"
+  echo "(setq o (open \"$DIR/$1\" 'output))"
+  echo "(while (not (is (setq x ($2 i 'eof)) 'eof)) ($3 x o))"
+  echo "(close i)"
+  echo "(close o)"
+  echo "(list 'BENCH '$1 (- (getlpi cputim) bench\$t0))"
+}
+
+{
+  copy LINES READLN WRITELN
+  copy FORMS READ WRITELN
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(reduce (lambda (s x) (+ s (nth 1 x))) 0"
+  echo "  (filter (lambda (x) (> (nth 3 x) 1)) (read-forms \"$DIR/data\")))"
+  echo "(list 'BENCH 'REDUCE (- (getlpi cputim) bench\$t0))"
+} > "$DIR/bench.lisp"
+
+echo "Copying $K thousand records, $(wc -c < "$DIR/data") bytes:"
+"$LISP" "$DIR/bench.lisp" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk -v n=$((K * 1000)) '{ printf "  %-12s %10.3f s %10.2f M records/s\n",
+                              $1, $2, n / 1000000 / $2 }'
+cmp -s "$DIR/data" "$DIR/LINES" || echo "  LINES differ from the data!"
@@ -0,0 +1,134 @@
+/*
+ * $Id: $
+ *
+ * Module:  threads -- One script evaluated by many LMIs on many threads
+ *
+ * Built and run by bench/threads.sh. The script is evaluated by a single
+ * LMI first, then by THREADS LMIs at once, each of them on its thread of
+ * its own, with a heap of its own, its results and messages going to a
+ * memory stream and its log to a temporary file. Every run has to give
+ * the same output as the first one, the log has to be as long; the last
+ * line of the output is printed, for the checks of the script.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../LISP_Core.h"
+
+typedef struct {
+  pthread_t thread;
+  char *    output;                             /* Results and messages */
+  size_t    length;
+  long      logLength;
+  long      errors;
+} LISP$Run;
+
+static char * LISP$script;
+static size_t LISP$scriptLength;
+
+static void * LISP$runScript (void * arg) {
+
+  LISP$Run * run = (LISP$Run *) arg;
+  FILE * out = open_memstream (&(run->output), &(run->length));
+  FILE * log = tmpfile ();
+
+  /* The LMI has to be created by the thread which runs it */
+  LISP$MachIns * lmi = LISP$M_init (NULL, NULL, out, true);
+  LISP$M_setSinks (lmi, out, log);
+
+  lmi->isEchoed = false;
+  LISP$S_loadFile (lmi, "startup.lisp");
+  lmi->isEchoed = true;
+
+  LISP$S_loadText (lmi, LISP$script, LISP$scriptLength);
+
+  run->errors = lmi->errorCount;
+  LISP$M_destroy (lmi);
+
+  fclose (out);
+  fseek (log, 0, SEEK_END);
+  run->logLength = ftell (log);
+  fclose (log);
+
+  return NULL;
+}
+
+static double LISP$now (void) {
+
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+int main (int argc, char * argv []) {
+
+  int        i, n, last, failed = 0;
+  double     t0, t1, t2;
+  FILE *     f;
+  LISP$Run   first;
+  LISP$Run * runs;
+
+  if (argc != 3 || (n = atoi (argv [1])) < 1) {
+    fprintf (stderr, "Usage: %s THREADS SCRIPT\n", argv [0]);
+    return 1;
+  }
+
+  if ((f = fopen (argv [2], "rb")) == NULL) {
+    perror (argv [2]);
+    return 1;
+  }
+  fseek (f, 0, SEEK_END);
+  LISP$scriptLength = ftell (f);
+  rewind (f);
+  LISP$script = (char *) malloc (LISP$scriptLength + 1);
+  if (fread (LISP$script, 1, LISP$scriptLength, f) != LISP$scriptLength) {
+    perror (argv [2]);
+    return 1;
+  }
+  fclose (f);
+
+  runs = (LISP$Run *) calloc (n, sizeof (LISP$Run));
+  memset (&first, 0, sizeof (first));
+
+  t0 = LISP$now ();
+  LISP$runScript (&first);
+  t1 = LISP$now ();
+
+  for (i = 0; i < n; i++)
+    pthread_create (&(runs [i].thread), NULL, LISP$runScript, &(runs [i]));
+  for (i = 0; i < n; i++)
+    pthread_join (runs [i].thread, NULL);
+  t2 = LISP$now ();
+
+  for (i = 0; i < n; i++) {
+    if (runs [i].length != first.length || runs [i].errors != first.errors ||
+        runs [i].logLength != first.logLength ||
+        memcmp (runs [i].output, first.output, first.length)) {
+      fprintf (stderr, "LMI #%d differs:\n%.*s\n", i,
+               (int) runs [i].length, runs [i].output);
+      failed++;
+    }
+    free (runs [i].output);
+  }
+
+  printf ("BENCH ONE %.3f\n", t1 - t0);
+  printf ("BENCH ALL %.3f\n", t2 - t1);
+  printf ("BENCH OUTPUT %lu\n", (unsigned long) first.length);
+  for (last = (first.length > 0)? (int) first.length - 1 : 0;
+       last > 0 && first.output [last - 1] != '\n'; last--);
+  printf ("BENCH LAST %.*s", (int) first.length - last, first.output + last);
+  printf ("BENCH FAILED %d\n", failed);
+
+  free (first.output);
+  free (runs);
+  free (LISP$script);
+
+  return (failed > 0);
+}
+
+// vim: fdm=syntax:fdn=1:tw=74:ts=2:syn=c
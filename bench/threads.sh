@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  threads -- Stress of LMIs running on many threads at once
+#
+# Usage: bench/threads.sh [THREADS] [SIZE]
+# bench/threads.c is built against the sources, then it evaluates the
+# script by one LMI and by THREADS LMIs at once, each on its own thread
+# and heap; the run fails if any of them gives other results, messages or
+# log than the one, or if the checks of the last form of the script fail.
+
+CC=${CC:-gcc}
+THREADS=${1:-64}
+N=${2:-18}
+DIR=${TMPDIR:-/tmp}/lisp-bench-threads.$$
+SRC=$DIR/script.lisp
+
+trap 'rm -rf "$DIR"' EXIT
+mkdir -p "$DIR"
+
+$CC -O2 -w -D_HAS_RDLN_=1 -o "$DIR/threads" bench/threads.c \
+    $(ls *.c | grep -v '^LISP_Main\.c$') -lreadline -lm -lpthread || exit 1
+
+cat > "$SRC" <<LISP
+(setq LISP\$LOG T)
+(setq fib (lambda (n) (cond ((< n 2) n) (t (+ (fib (- n 1)) (fib (- n 2)))))))
+(fib $N)
+(setq iota (lambda (n)
+  (cond ((= n 0) nil) (t (cons (% (* n 7919) 1009) (iota (- n 1)))))))
+(setq data (iota 2000))
+(length (sort data))
+(setq h (make-hash))
+(dotimes (i 5000) (puthash i (* i i) h))
+(gethash 4999 h)
+(hash-count h)
+(setq big 1)
+(dotimes (i 200) (setq big (* big 3)))
+big
+(setq total 0)
+(dotimes (i 20000) (setq total (+ total (length (list i i i)))))
+total
+(write-to-string (reverse (iota 10)))
+(car 1)
+(and (= (length (sort data)) 2000) (= (gethash 4999 h) 24990001)
+     (= (hash-count h) 5000) (= total 60000))
+LISP
+
+"$DIR/threads" "$THREADS" "$SRC" |
+  awk -v n="$THREADS" '
+    $2 == "ONE"    { one = $3 }
+    $2 == "ALL"    { all = $3 }
+    $2 == "FAILED" { failed = $3 }
+    $2 == "LAST"   { checked = ($3 == "T") }
+    END {
+      printf "  %-12s %10.3f s\n", "ONE LMI", one
+      printf "  %-12s %10.3f s %10.2f x the work per second\n",
+             n " LMIs", all, n * one / all
+      printf "  %-12s %10d\n", "DIFFERING", failed
+      printf "  %-12s %10s\n", "CHECKED", checked? "T" : "NIL"
+      exit (failed != 0 || !checked)
+    }'
@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  vectors -- SIMD vector kernels vs. list arithmetic
+#
+# Usage: bench/vectors.sh [LIST-LENGTH [VECTOR-LENGTH [REPEAT-COUNT]]]
+# Vector kernels are measured with each instruction set the CPU supports
+# (see LISP_SIMD in LISP_Kernels.h); lists are limited by the list table,
+# so they're shorter than vectors. The time of a call includes the
+# interpreter's overhead of DOTIMES. The default vector length fits into
+# L2 cache; with longer ones all the instruction sets end up waiting for
+# the memory equally.
+
+LISP=${LISP:-bin/LISP}
+N=${1:-1000}
+VN=${2:-100000}
+REPS=${3:-200}
+SRC=${TMPDIR:-/tmp}/lisp-bench-vectors.$$.lisp
+
+trap 'rm -f "$SRC"' EXIT
+
+# repeat NAME FLOPS-PER-CALL FORM -- the calls are repeated by DOTIMES,
+# so the garbage is collected only when the memory is running out
+repeat () {
+  echo "(setq bench\$t0 (getlpi cputim))"
+  echo "(dotimes (bench\$i $REPS) $3)"
+  echo "(list 'BENCH '$1 $2 (/ (- (getlpi cputim) bench\$t0) $REPS))"
+}
+
+report () {
+  "$LISP" "$SRC" < /dev/null | sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+    awk '{ printf "  %-12s %12.3e s %8.3f GFLOP/s\n", $1, $3,
+                  ($3 > 0)? $2 / $3 / 1e9 : 0 }'
+}
+
+{
+  echo "(setq data (vector->list (make-vector $N 1.5 'double)))"
+  repeat LIST-SUM  "$N"             "(eval (cons '+ data))"
+  repeat LIST-DOT  "$((2 * N))"     "(eval (cons '+ (mapcar * data data)))"
+  repeat LIST-ADD  "$N"             "(mapcar + data data)"
+} > "$SRC"
+
+echo "Lists of $N numbers, $REPS repetitions:"
+report
+
+{
+  echo "(setq vx (make-vector $VN 1.5 'double))"
+  echo "(setq vy (make-vector $VN 2.5 'double))"
+  echo "(list 'BENCH (getlpi simd) 0 0)"
+  repeat VSUM      "$VN"            "(vsum vx)"
+  repeat DOT       "$((2 * VN))"    "(dot vx vy)"
+  repeat V+        "$VN"            "(v+ vx vy)"
+  repeat V*        "$VN"            "(v* vx 3)"
+  repeat VMAX      "$VN"            "(vmax vx)"
+} > "$SRC"
+
+for isa in SCALAR SSE2 AVX2; do
+  echo "Vectors of $VN numbers, $REPS repetitions, LISP_SIMD=$isa:"
+  LISP_SIMD=$isa report | sed -n '1s/^ *\([^ ]*\).*/  (using \1)/p; 2,$p'
+done
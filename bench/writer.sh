@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+# $Id: $
+#
+# Module:  writer -- S-expr printing throughput
+#
+# Usage: bench/writer.sh [NUMBER-COUNT [REPEAT-COUNT]]
+# A list of doubles and one of integers are loaded once and then printed
+# by WRITE-TO-STRING, so the time is spent formatting numbers into the
+# growable buffer.
+
+LISP=${LISP:-bin/LISP}
+N=${1:-100000}
+REPS=${2:-10}
+SRC=${TMPDIR:-/tmp}/lisp-bench-writer.$$.lisp
+DATA=${TMPDIR:-/tmp}/lisp-bench-writer.$$.data
+
+trap 'rm -f "$SRC" "$DATA"' EXIT
+
+awk -v n="$N" 'BEGIN {
+  srand (1)
+  print "(setq doubles (quote ("
+  for (i = 0; i < n; i++) printf "  %.17g\n", rand () * 10 ^ int (rand () * 12)
+  print ")))"
+  print "(setq integers (quote ("
+  for (i = 0; i < n; i++) printf "  %d\n", int (rand () * 2 ^ 52)
+  print ")))"
+}' > "$DATA"
+
+repeat () {
+  i=0
+  echo "(setq bench\$t0 (getlpi cputim))"
+  while [ $i -lt "$REPS" ]; do echo "(is $2 nil)"; i=$((i + 1)); done
+  echo "(list 'BENCH '$1 (/ (- (getlpi cputim) bench\$t0) $REPS))"
+}
+
+{
+  echo "(load \"$DATA\")"
+  repeat DOUBLES  "(write-to-string doubles)"
+  repeat INTEGERS "(write-to-string integers)"
+} > "$SRC"
+
+echo "Printing $N numbers, $REPS repetitions:"
+"$LISP" "$SRC" < /dev/null | tr -d '\r' |
+  sed -n 's/^.*<-- (BENCH \(.*\))$/\1/p' |
+  awk -v n="$N" '{ printf "  %-12s %10.4f s %10.2f M numbers/s\n",
+                     $1, $2, n / 1000000 / $2 }'
@@ -20,6 +20,7 @@
 (setq LISP$GC    T) ; this is default
 (setq LISP$LOG   NIL)
 (setq LISP$TRACE NIL)
+(setq LISP$CACHE T) ; this is default
 
 (setq report-error (lambda (code msg) (list '%ERROR-REPORT: code '=> msg) ))
 
@@ -110,7 +111,8 @@
 ;(setq fact$x 256) (setq test$result Inf) (eval test$run)
 
 (test$run (factorial   5) 120)
-(test$run (factorial 256) Inf)
+; Integers overflow into big ones, so even this is exact
+(test$run (/ (factorial 256) (factorial 255)) 256)
 
 (setq ! (lambda (x)
   (cond ((isnumber x) (factorial x))
@@ -120,39 +122,16 @@
 
 ;(setq mycons (lambda (a b) (cons a b)))
 
-(setq not (lambda (x)
-  (cond ((is x nil)   t)
-        (t          nil))))
+; NOT is a built-in function now
 
-(setq abs (lambda (x)
-  (cond ((not (isnumber x)) 'NOT-A-NUMBER)
-        ((>= x 0) x)
-        ((<  x 0) (- x)))))
-
-(setq good-enough (lambda (guess x)
-  (< (abs (- (* guess guess) x)) 0.001)))
-
-(setq improve (lambda (guess x)
-  (/ (+ guess (/ x guess)) 2.0)))
-
-(setq sqrt-iter (lambda (guess x)
-  (cond ((good-enough guess x) guess)
-        (t (sqrt-iter (improve guess x) x)))))
-
-(setq sqrt (lambda (x)
-  (sqrt-iter (/ x 2.0) x)))
+; SQRT, EXPT, EXP, LOG, SIN, COS, ABS, MIN, MAX, FLOOR, CEILING
+; and ROUND are built-in functions now; (exp a x) became (expt a x)
 
 (setq set (special (x y)
   (eval (cons 'setq (cons (eval x) (cons y nil))))))
 
-(setq append (lambda (x y)
-  (cond ((is x nil) y)
-        ((isatom x) (cons x y))
-        (t (cons (car x) (append (cdr x) y))))))
-
-(setq reverse (lambda (x)
-  (cond ((isatom x) x)
-        (t (append (reverse (cdr x)) (cons (car x) nil))))))
+; APPEND, REVERSE, SORT, MEMBER, LENGTH, NTH, ASSOC and MAPCAR
+; are built-in functions now
 
 (setq apply (special (f x) (eval (cons f x))))
 
@@ -161,20 +140,6 @@
         ((<= v (car l)) (cons v l))
         (t (cons (car l) (merge v (cdr l)))))))
 
-(setq sort (lambda (x) 
-   (cond ((is nil x) x)
-         (t (merge (car x) (sort (cdr x)))))))
-
-(setq member (lambda (a s)
-  (cond ((is s nil)     nil)
-        ((is a (car s)) t)
-        (t (member a (cdr s))))))
-
-(setq exp (lambda (a x)
-            (cond
-              ( (> x 0) (* a (exp a (- x 1))) )
-              ( (< x 1) 1 ) )))
-
 (setq bool2bin (lambda (x)
   (cond ( (is x t) 1 )
         ( (is x nil) 0 )
@@ -186,20 +151,15 @@
         ( t (report-error 'BIN2BOOL-E-IVARGS "Only 0/1 arguments are accepted!") ) )))
 
 ; -----------------------------------------------------
-; Logical operators -- implemented in a LISP itself,
-; since their built-in friends are not implemented yet..
-; Note: they are only binary (arity of two) since
-; we don't support a variable lenght argument list for
-; lambdas...
+; Logical operators -- AND, OR and NOT are built-in now;
+; AND and OR are variadic short-circuit special forms.
+; The binary && and || are kept for older scripts only.
 
 ; Binary AND operation
-(setq && (lambda (x y)
-  (bin2bool (* (bool2bin x) (bool2bin y))) ))
+(setq && (lambda (x y) (and x y)))
 
 ; Binary OR operation
-(setq || (lambda (x y)
-  (let ( (res (+ (bool2bin x) (bool2bin y))) )
-       (cond ((> res 0) t) (t nil)) )))
+(setq || (lambda (x y) (or x y)))
 
 ; A bit of set operations
 (setq is-in-set (lambda (key set)
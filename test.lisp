@@ -17,6 +17,12 @@
     (cond ((= (eval test) (eval result)) 'SUCCESS)
           (t                             'FAILURE)))))
 
+; ... and for anything but numbers
+(setq test$same
+  (special (test result) (list test 'EQUAL result '=>
+    (cond ((equal (eval test) (eval result)) 'SUCCESS)
+          (t                                 'FAILURE)))))
+
 ; AND, OR, READ, READLN, WRITE, WRITELN
 
 ; Basic arithmetic test
@@ -56,10 +62,217 @@
 ;(setq fact$x 256) (setq test$result Inf) (eval test$run)
 
 (test$run (factorial   5) 120)
-(test$run (factorial 256) Inf)
+; Integers overflow into big ones, which are below Inf, exactly
+(test$same (< (factorial 256) inf) t)
+(test$run (/ (factorial 256) (factorial 255)) 256)
 
 (setq ! (lambda (x)
   (cond ((isnumber x) (factorial x))
         (T            'NOT-A-NUMBER))))
 
+; AND and OR stop at the first argument which decides -- the rest
+; would fail
+(test$same (and 1 nil (car 1)) nil)
+(test$run (or nil 2 (car 1)) 2)
+(test$same (and) t)
+(test$same (or) nil)
+(test$same (not nil) t)
+(setq test$x 0)
+(or (setq test$x 1) (setq test$x 2))
+(test$run test$x 1)
+
+; The list library; SORT by numbers and by a predicate, stable
+(setq test$l (append '(1 2) '(3) '(4 5)))
+(test$run (length test$l) 5)
+(test$run (nth 4 test$l) 5)
+(test$run (car (reverse test$l)) 5)
+(test$same (member 'b '(a b c)) t)
+(test$run (car (cdr (assoc 'b (list (list 'a 1) (list 'b 2))))) 2)
+(test$run (nth 1 (mapcar + '(1 2 3) '(10 20))) 22)
+(test$run (nth 2 (sort '(3 1 2))) 3)
+(test$run (nth 2 (sort '(3 1 2) (lambda (a b) (> a b)))) 1)
+(setq test$l (sort '((b 2) (a 1) (c 2))
+                   (lambda (x y) (< (car (cdr x)) (car (cdr y))))))
+(test$same (car (nth 0 test$l)) 'a)
+(test$same (car (nth 1 test$l)) 'b)
+(test$same (car (nth 2 test$l)) 'c)
+
+; WHILE, DOTIMES and DO
+(setq test$i 0)
+(test$same (while (< test$i 10) (setq test$i (+ test$i 1))) nil)
+(test$run test$i 10)
+(setq test$s 0)
+(test$same (dotimes (i 10 'done) (setq test$s (+ test$s i))) 'done)
+(test$run test$s 45)
+(setq test$l (do ((i 0 (+ i 1)) (l nil (cons i l))) ((= i 3) l)))
+(test$run (length test$l) 3)
+(test$run (car test$l) 2)
+
+; Hash tables, growing by a thousand keys
+(setq test$h (make-hash))
+(test$run (puthash 'a 1 test$h) 1)
+(puthash "b" 2 test$h)
+(test$run (gethash "b" test$h) 2)
+(test$same (gethash 'c test$h 'none) 'none)
+(test$same (remhash 'a test$h) t)
+(test$same (gethash 'a test$h) nil)
+(dotimes (i 1000) (puthash i (* i i) test$h))
+(test$run (hash-count test$h) 1001)
+(test$run (gethash 999 test$h) 998001)
+
+; Vectors; an index out of the bounds is an error
+(setq test$v (make-vector 3 'x))
+(test$same (vset test$v 0 'a) 'a)
+(test$same (vref test$v 0) 'a)
+(test$run (vlength test$v) 3)
+(vref test$v 3)
+(vset test$v -1 'b)
+(test$same (vector->list test$v) '(a x x))
+(test$run (vref (list->vector '(1 2 3) 'double) 2) 3)
+
+; Vector arithmetic -- nine items go through the SIMD groups and a tail
+(setq test$a (list->vector '(1 2 3 4 5 6 7 8 9) 'double))
+(test$run (vsum (v+ test$a test$a)) 90)
+(test$run (vsum (v- 1 test$a)) -36)
+(test$run (vref (v/ test$a 2) 8) 4.5)
+(test$run (dot test$a test$a) 285)
+(test$run (vmin (v* test$a -1)) -9)
+(test$run (vmax test$a) 9)
+(test$run (vmin (make-vector 0 0 'double)) inf)
+
+; 64-bit integers stay exact, and they're compared with doubles exactly
+(test$run (+ 9007199254740992 1) 9007199254740993)
+(test$same (= 9007199254740993 9007199254740992.0) nil)
+(test$same (> 9007199254740993 9007199254740992.0) t)
+(test$same (< -3 -2.5) t)
+(test$same (< 1 nan) nil)
+
+; Big integers, against doubles by their exact values too
+(test$run (* 3037000500 3037000500) 9223372037000250000)
+(test$run (- (* 3037000500 3037000500) 9223372037000250000) 0)
+(test$same (= (factorial 256) inf) nil)
+(test$same (> (factorial 256) (- inf)) t)
+
+; Mathematical functions
+(test$run (sqrt 16) 4)
+(test$run (expt 2 10) 1024)
+(test$run (expt 2 100) (* (expt 2 50) (expt 2 50)))
+(test$run (floor 7 2) 3)
+(test$run (floor -3.7) -4)
+(test$run (ceiling 7 2) 4)
+(test$run (round 7 2) 4)
+(test$run (round -2.5) -3)
+(test$run (max 3 1.5 2) 3)
+(test$run (abs -5) 5)
+
+; LOAD of a file mapped into memory
+(test$same (load "mode.lisp") t)
+(test$same (member (print-mode) '(we-are-batch we-are-interactive)) t)
+
+; Numbers are written by the shortest digits which read back the same
+(test$same (write-to-string (+ 0.1 0.2)) "0.30000000000000004")
+(test$same (write-to-string (/ 15 100000000.0)) "1.5e-7")
+(test$same (write-to-string '(1 2.5 -3 a)) "(1 2.5 -3 A)")
+
+; ... and their text is read as the nearest double
+(test$run 0.30000000000000004 (+ 0.1 0.2))
+(test$same (= 0.1 (/ 1 10.0)) t)
+(test$same (= 1e23 (* 1e22 10)) t)
+(test$run 1.5e-7 (/ 15 100000000.0))
+
+; WRITE-BINARY and READ-BINARY round trip, sharing kept; vectors are
+; EQUAL just to themselves, so their items are compared
+(setq test$shared '(a b))
+(setq test$data (list 1 -2.5 (factorial 30) "a string" test$shared
+                      test$shared
+                      "a string longer than an atom name may be, so it is an object"))
+(write-binary (cons (list->vector '(1 2 3)) test$data) "test.tmp")
+(setq test$read (read-binary "test.tmp"))
+(test$same (cdr test$read) test$data)
+(test$same (vector->list (car test$read)) '(1 2 3))
+(test$same (is (nth 5 test$read) (nth 6 test$read)) t)
+(read-binary "mode.lisp")
+
+; A cache which doesn't belong to its file is built again
+(write-binary '(setq print-mode 'stale) "mode.lispc")
+(test$same (load "mode.lisp") t)
+(test$same (member (print-mode) '(we-are-batch we-are-interactive)) t)
+(test$same (load "mode.lisp") t)
+(test$same (member (print-mode) '(we-are-batch we-are-interactive)) t)
+
+; File streams
+(setq test$s (open "test.tmp" 'output))
+(test$same (write '(1 "two" 3.5) test$s) '(1 "two" 3.5))
+(writeln " and a line" test$s)
+(writeln 7 test$s)
+(test$same (close test$s) t)
+(setq test$s (open "test.tmp"))
+(test$same (read test$s) '(1 "two" 3.5))
+(test$same (readln test$s) " and a line")
+(test$run (read test$s) 7)
+(test$same (read test$s 'eof) 'eof)
+(close test$s)
+
+; Lazy sequences of the lines and forms of a file
+(setq test$s (open "test.tmp" 'output))
+(dotimes (i 3) (writeln (+ i 1) test$s))
+(close test$s)
+(test$run (reduce (lambda (s x) (+ s x)) 0 (read-forms "test.tmp")) 6)
+(test$run (reduce (lambda (n l) (+ n 1)) 0 (read-lines "test.tmp")) 3)
+(test$run (next (filter (lambda (x) (> x 1)) (read-forms "test.tmp"))) 2)
+
+; A promise is forced once; lazy lists can be infinite
+(setq test$n 0)
+(setq test$p (delay (setq test$n (+ test$n 1))))
+(test$run (force test$p) 1)
+(test$run (force test$p) 1)
+(test$run test$n 1)
+(setq test$ints (lambda (n) (cons-stream n (test$ints (+ n 1)))))
+(test$run (next (map (lambda (x) (* x x)) (test$ints 3))) 9)
+(test$run (stream-car (stream-cdr (test$ints 3))) 4)
+
+; PMAP and PREDUCE, on an empty list too
+(test$same (pmap (lambda (x) (* x x)) '(1 2 3)) '(1 4 9))
+(test$run (preduce + 0 '(1 2 3 4)) 10)
+(test$same (pmap (lambda (x) (* x x)) nil) nil)
+(test$run (preduce + 5 nil) 5)
+
+; An echo actor, stopped by a NIL
+(setq test$echo (lambda () (while (car (setq test$m (receive)))
+  (send (car test$m) (cdr test$m)))))
+(setq test$actor (spawn test$echo))
+(test$same (send test$actor (cons (self) 'hi)) t)
+(test$same (receive 10) 'hi)
+(send test$actor (list nil))
+
+; FUTURE -- its value, and an error raised by its TOUCH
+(test$run (+ (future (* 2 60)) (future (* 2 3)) 1) 127)
+(touch (future (car 1)))
+
+; Names are truncated to 63 chars, the same way when read again
+(setq test$long-name
+  'xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx)
+(test$same test$long-name
+  'xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx)
+
+; NaN items are skipped by VMIN and VMAX, in the last vector group as
+; well as in the tail
+(test$run (vmin (list->vector (list 5 6 7 nan) 'double)) 5)
+(test$run (vmax (list->vector (list 1 2 3 4 5 6 7 nan) 'double)) 7)
+(test$run (vmin (list->vector (list 5 6 7 8 nan) 'double)) 5)
+(test$run (vmax (list->vector (list 1 2 3 4 5 6 7 8 nan) 'double)) 8)
+
+; A file may end just after its last atom
+(setq test$s (open "test.tmp" 'output))
+(write '(setq test$loaded 1) test$s)
+(write 'test$loaded test$s)
+(close test$s)
+(setq test$s (open "test.tmp"))
+(read test$s)
+(test$same (read test$s) 'test$loaded)
+(close test$s)
+(test$run (reduce (lambda (n x) (+ n 1)) 0 (read-forms "test.tmp")) 2)
+(test$same (load "test.tmp") t)
+(test$run test$loaded 1)
+
 ; vim: fdm=syntax:fdn=3:tw=74:ts=2:syn=lisp